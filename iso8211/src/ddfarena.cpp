@@ -0,0 +1,179 @@
+/******************************************************************************
+ *
+ * Project:  ISO 8211 Access
+ * Purpose:  Implements the DDFArena class.
+ *
+ ******************************************************************************
+ * Copyright (c) 2024, OpenCPN development team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ******************************************************************************
+ *
+ */
+
+
+#include "iso8211.h"
+#include "cpl_conv.h"
+
+/* All allocations are rounded up to keep returned pointers aligned. */
+#define DDF_ARENA_ALIGN 8
+
+/************************************************************************/
+/*                              DDFArena()                              */
+/************************************************************************/
+
+/**
+ * The constructor.  No memory is allocated until the first Allocate().
+ *
+ * @param nBlockSizeIn the size of the blocks memory is handed out from.
+ * Larger requests get a block of their own.
+ */
+
+DDFArena::DDFArena(int nBlockSizeIn)
+
+{
+  nBlockSize = nBlockSizeIn < 4096 ? 4096 : nBlockSizeIn;
+
+  nBlockCount = 0;
+  nBlockMax = 0;
+  papachBlocks = NULL;
+
+  pachCurrentBlock = NULL;
+  pachNext = NULL;
+  nBytesLeft = 0;
+
+  nAllocationCount = 0;
+  nBytesUsed = 0;
+  nBytesReserved = 0;
+  nPeakBytesReserved = 0;
+}
+
+/************************************************************************/
+/*                             ~DDFArena()                              */
+/************************************************************************/
+
+DDFArena::~DDFArena()
+
+{
+  Release();
+
+  for (int i = 0; i < nBlockCount; i++) CPLFree(papachBlocks[i]);
+  CPLFree(papachBlocks);
+}
+
+/************************************************************************/
+/*                              AddBlock()                              */
+/************************************************************************/
+
+char *DDFArena::AddBlock(int nSize)
+
+{
+  if (nBlockCount == nBlockMax) {
+    nBlockMax = nBlockMax * 2 + 16;
+    papachBlocks =
+        (char **)CPLRealloc(papachBlocks, sizeof(char *) * nBlockMax);
+  }
+
+  char *pachBlock = (char *)CPLMalloc(nSize);
+
+  papachBlocks[nBlockCount++] = pachBlock;
+
+  nBytesReserved += nSize;
+  if (nBytesReserved > nPeakBytesReserved)
+    nPeakBytesReserved = nBytesReserved;
+
+  return pachBlock;
+}
+
+/************************************************************************/
+/*                              Allocate()                              */
+/************************************************************************/
+
+/**
+ * Allocate memory from the arena.
+ *
+ * The memory is 8 byte aligned and uninitialized.  It stays valid until
+ * Release() and can't be freed individually.
+ *
+ * @param nBytes the number of bytes wanted.
+ *
+ * @return a pointer to the memory.  Like CPLMalloc() this never returns
+ * NULL.
+ */
+
+void *DDFArena::Allocate(int nBytes)
+
+{
+  if (nBytes < 1) nBytes = 1;
+  nBytes = (nBytes + DDF_ARENA_ALIGN - 1) & ~(DDF_ARENA_ALIGN - 1);
+
+  nAllocationCount++;
+  nBytesUsed += nBytes;
+
+  /* -------------------------------------------------------------------- */
+  /*      Large requests get their own block, so they don't waste the     */
+  /*      rest of the current one.                                        */
+  /* -------------------------------------------------------------------- */
+  if (nBytes > nBlockSize / 4) return AddBlock(nBytes);
+
+  if (nBytes > nBytesLeft) {
+    pachCurrentBlock = AddBlock(nBlockSize);
+    pachNext = pachCurrentBlock;
+    nBytesLeft = nBlockSize;
+  }
+
+  char *pachResult = pachNext;
+
+  pachNext += nBytes;
+  nBytesLeft -= nBytes;
+
+  return pachResult;
+}
+
+/************************************************************************/
+/*                              Release()                               */
+/************************************************************************/
+
+/**
+ * Release all memory allocated from the arena.
+ *
+ * One block is kept for reuse, so an arena used for successive batches of
+ * records normally doesn't touch the heap again.
+ */
+
+void DDFArena::Release()
+
+{
+  for (int i = 0; i < nBlockCount; i++) {
+    if (papachBlocks[i] != pachCurrentBlock) CPLFree(papachBlocks[i]);
+  }
+
+  nBlockCount = 0;
+  nBytesReserved = 0;
+
+  if (pachCurrentBlock != NULL) {
+    papachBlocks[nBlockCount++] = pachCurrentBlock;
+    nBytesReserved = nBlockSize;
+    pachNext = pachCurrentBlock;
+    nBytesLeft = nBlockSize;
+  }
+
+  nAllocationCount = 0;
+  nBytesUsed = 0;
+}
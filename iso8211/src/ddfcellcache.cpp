@@ -0,0 +1,832 @@
+/******************************************************************************
+ *
+ * Project:  ISO 8211 Access
+ * Purpose:  Implements the DDFCellCache class, a binary cache of decoded
+ *           ISO 8211 files.
+ *
+ ******************************************************************************
+ * Copyright (c) 2024, OpenCPN development team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ******************************************************************************
+ *
+ */
+
+#include "iso8211.h"
+#include "cpl_conv.h"
+#include "cpl_vsi.h"
+
+/* -------------------------------------------------------------------- */
+/*      Cache file layout.  All offsets are absolute file offsets, all  */
+/*      sections start on an 8 byte boundary and integers are stored    */
+/*      in native byte order (checked with nByteOrder).  Bump           */
+/*      DDF_CACHE_VERSION whenever any of the structures change.        */
+/* -------------------------------------------------------------------- */
+#define DDF_CACHE_MAGIC "DDFCACHE"
+#define DDF_CACHE_VERSION 1
+#define DDF_CACHE_BYTE_ORDER 0x01020304
+
+typedef struct {
+  char achMagic[8];
+  GInt32 nVersion;
+  GInt32 nByteOrder;
+
+  GUInt32 nSourceSize;
+  GUInt32 nSourceMTime;
+  GUInt32 nSourceHash;
+
+  GInt32 nFieldDefnCount;
+  GInt32 nRecordCount;
+  GInt32 nFieldCount;
+  GInt32 nKeyCount;
+  GInt32 nCoordCount;
+
+  GUInt32 nFieldDefnOffset;
+  GUInt32 nRecordOffset;
+  GUInt32 nFieldOffset;
+  GUInt32 nKeyOffset;
+  GUInt32 nCoordOffset;
+  GUInt32 nCacheSize;
+} DDFCacheHeader;
+
+/* One per field definition, the DDR entry bytes are at nEntryOffset. */
+typedef struct {
+  char szTag[8];
+  GUInt32 nEntryOffset;
+  GInt32 nEntrySize;
+} DDFCacheFieldDefn;
+
+/* One per record.  Fields and coordinates are ranges in their tables. */
+typedef struct {
+  GUInt32 nDataOffset;
+  GInt32 nDataSize;
+  GInt32 nDirSize;
+  GInt32 nFirstField;
+  GInt32 nFieldCount;
+  GInt32 nRCNM;
+  GInt32 nRCID;
+  GInt32 nFirstCoord;
+  GInt32 nPointCount;
+  GInt32 nDimension;
+} DDFCacheRecord;
+
+/* One per field instance, nPos is relative to the record data. */
+typedef struct {
+  GInt32 nFieldDefn;
+  GInt32 nPos;
+  GInt32 nSize;
+} DDFCacheField;
+
+/* Sorted on (RCNM, RCID) for FindRecord(). */
+typedef struct {
+  GInt32 nRCNM;
+  GInt32 nRCID;
+  GInt32 iRecord;
+} DDFCacheKey;
+
+/************************************************************************/
+/*                           DDFCacheBuffer                             */
+/*                                                                      */
+/*      Simple growable buffer used while building a cache image.       */
+/************************************************************************/
+
+typedef struct {
+  char *pachData;
+  int nSize;
+  int nMax;
+} DDFCacheBuffer;
+
+static void *DDFCacheAppend(DDFCacheBuffer *psBuffer, const void *pData,
+                            int nBytes)
+
+{
+  if (psBuffer->nSize + nBytes > psBuffer->nMax) {
+    psBuffer->nMax = (psBuffer->nSize + nBytes) * 2 + 1024;
+    psBuffer->pachData =
+        (char *)CPLRealloc(psBuffer->pachData, psBuffer->nMax);
+  }
+
+  void *pTarget = psBuffer->pachData + psBuffer->nSize;
+
+  if (pData != NULL)
+    memcpy(pTarget, pData, nBytes);
+  else
+    memset(pTarget, 0, nBytes);
+
+  psBuffer->nSize += nBytes;
+
+  return pTarget;
+}
+
+static void DDFCacheAlign(DDFCacheBuffer *psBuffer)
+
+{
+  int nPad = (8 - psBuffer->nSize % 8) % 8;
+
+  if (nPad > 0) DDFCacheAppend(psBuffer, NULL, nPad);
+}
+
+static int DDFCompareKeys(const void *pKey1, const void *pKey2)
+
+{
+  const DDFCacheKey *psKey1 = (const DDFCacheKey *)pKey1;
+  const DDFCacheKey *psKey2 = (const DDFCacheKey *)pKey2;
+
+  if (psKey1->nRCNM != psKey2->nRCNM)
+    return psKey1->nRCNM < psKey2->nRCNM ? -1 : 1;
+  if (psKey1->nRCID != psKey2->nRCID)
+    return psKey1->nRCID < psKey2->nRCID ? -1 : 1;
+
+  return 0;
+}
+
+/************************************************************************/
+/*                           DDFCellCache()                             */
+/************************************************************************/
+
+DDFCellCache::DDFCellCache()
+
+{
+  pachCache = NULL;
+  nCacheSize = 0;
+
+  papoRecords = NULL;
+}
+
+/************************************************************************/
+/*                          ~DDFCellCache()                             */
+/************************************************************************/
+
+DDFCellCache::~DDFCellCache()
+
+{
+  Close();
+}
+
+/************************************************************************/
+/*                               Close()                                */
+/************************************************************************/
+
+/**
+ * Release the cache, and all records fetched from it.
+ */
+
+void DDFCellCache::Close()
+
+{
+  if (papoRecords != NULL) {
+    int nRecordCount = GetRecordCount();
+
+    for (int i = 0; i < nRecordCount; i++) delete papoRecords[i];
+    CPLFree(papoRecords);
+    papoRecords = NULL;
+  }
+
+  CPLFree(pachCache);
+  pachCache = NULL;
+  nCacheSize = 0;
+
+  oModule.Close();
+}
+
+/************************************************************************/
+/*                              HashFile()                              */
+/************************************************************************/
+
+/**
+ * Compute a 32 bit FNV-1a hash of the contents of a file.
+ *
+ * @param pszFilename the file to hash.
+ *
+ * @return the hash, or zero if the file can't be read.
+ */
+
+GUInt32 DDFCellCache::HashFile(const char *pszFilename)
+
+{
+  FILE *fp = VSIFOpen(pszFilename, "rb");
+
+  if (fp == NULL) return 0;
+
+  GUInt32 nHash = 2166136261U;
+  unsigned char abyChunk[65536];
+  size_t nRead;
+
+  while ((nRead = VSIFRead(abyChunk, 1, sizeof(abyChunk), fp)) > 0) {
+    for (size_t i = 0; i < nRead; i++) {
+      nHash ^= abyChunk[i];
+      nHash *= 16777619U;
+    }
+  }
+
+  VSIFClose(fp);
+
+  return nHash;
+}
+
+/************************************************************************/
+/*                               Write()                                */
+/************************************************************************/
+
+/**
+ * Parse an ISO 8211 file and write its cache.
+ *
+ * @param pszCacheFilename the cache file to create.
+ * @param pszSourceFilename the ISO 8211 file to cache.
+ *
+ * @return TRUE on success or FALSE on failure.
+ */
+
+int DDFCellCache::Write(const char *pszCacheFilename,
+                        const char *pszSourceFilename)
+
+{
+  VSIStatBuf sStat;
+
+  if (VSIStat(pszSourceFilename, &sStat) != 0) {
+    CPLError(CE_Failure, CPLE_OpenFailed, "Unable to stat `%s'.",
+             pszSourceFilename);
+    return FALSE;
+  }
+
+  DDFModule oSource;
+
+  if (!oSource.Open(pszSourceFilename)) return FALSE;
+
+  /* -------------------------------------------------------------------- */
+  /*      Field definitions, stored as regenerated DDR entries.           */
+  /* -------------------------------------------------------------------- */
+  int nFieldDefnCount = oSource.GetFieldCount();
+  DDFCacheFieldDefn *pasFieldDefns = (DDFCacheFieldDefn *)CPLCalloc(
+      sizeof(DDFCacheFieldDefn), nFieldDefnCount + 1);
+  DDFCacheBuffer sEntries = {NULL, 0, 0};
+
+  for (int i = 0; i < nFieldDefnCount; i++) {
+    DDFFieldDefn *poDefn = oSource.GetField(i);
+    char *pachEntry;
+    int nEntrySize;
+
+    poDefn->GenerateDDREntry(&pachEntry, &nEntrySize);
+
+    strncpy(pasFieldDefns[i].szTag, poDefn->GetName(),
+            sizeof(pasFieldDefns[i].szTag) - 1);
+    pasFieldDefns[i].nEntryOffset = sEntries.nSize;
+    pasFieldDefns[i].nEntrySize = nEntrySize;
+
+    DDFCacheAppend(&sEntries, pachEntry, nEntrySize);
+    CPLFree(pachEntry);
+  }
+
+  /* -------------------------------------------------------------------- */
+  /*      Records, their field directories, keys and coordinates.         */
+  /* -------------------------------------------------------------------- */
+  DDFCacheBuffer sRecords = {NULL, 0, 0};
+  DDFCacheBuffer sFields = {NULL, 0, 0};
+  DDFCacheBuffer sKeys = {NULL, 0, 0};
+  DDFCacheBuffer sCoords = {NULL, 0, 0};
+  DDFCacheBuffer sData = {NULL, 0, 0};
+  int nRecordCount = 0;
+  DDFRecord *poRecord;
+
+  CPLErrorReset();
+  while ((poRecord = oSource.ReadRecord()) != NULL) {
+    DDFCacheRecord sRecord;
+
+    sRecord.nDataOffset = sData.nSize;
+    sRecord.nDataSize = poRecord->GetDataSize();
+    sRecord.nDirSize = poRecord->GetFieldOffset();
+    sRecord.nFirstField = sFields.nSize / sizeof(DDFCacheField);
+    sRecord.nFieldCount = poRecord->GetFieldCount();
+    sRecord.nRCNM = 0;
+    sRecord.nRCID = 0;
+    sRecord.nFirstCoord = sCoords.nSize / sizeof(GInt32);
+    sRecord.nPointCount = 0;
+    sRecord.nDimension = 0;
+
+    DDFCacheAppend(&sData, poRecord->GetData(), poRecord->GetDataSize());
+    DDFCacheAlign(&sData);
+
+    for (int iField = 0; iField < poRecord->GetFieldCount(); iField++) {
+      DDFField *poField = poRecord->GetField(iField);
+      DDFCacheField sField;
+
+      for (sField.nFieldDefn = 0; sField.nFieldDefn < nFieldDefnCount;
+           sField.nFieldDefn++) {
+        if (oSource.GetField(sField.nFieldDefn) == poField->GetFieldDefn())
+          break;
+      }
+      sField.nPos = poField->GetData() - poRecord->GetData();
+      sField.nSize = poField->GetDataSize();
+
+      DDFCacheAppend(&sFields, &sField, sizeof(sField));
+
+      /* ---------------------------------------------------------------- */
+      /*      Pre-decode coordinates.                                     */
+      /* ---------------------------------------------------------------- */
+      const char *pszTag = poField->GetFieldDefn()->GetName();
+
+      if ((EQUAL(pszTag, "SG2D") || EQUAL(pszTag, "SG3D")) &&
+          sRecord.nDimension == 0) {
+        int nDimension = poField->GetFieldDefn()->GetSubfieldCount();
+        int nPointCount = poField->GetRepeatCount();
+        int nValues = nPointCount * nDimension;
+        GInt32 *panValues = (GInt32 *)DDFCacheAppend(
+            &sCoords, NULL, nValues * sizeof(GInt32));
+
+        poField->DecodeIntValues(panValues, nValues);
+
+        sRecord.nPointCount = nPointCount;
+        sRecord.nDimension = nDimension;
+      }
+    }
+
+    /* -------------------------------------------------------------------- */
+    /*      Record identifiers of vector and feature records.               */
+    /* -------------------------------------------------------------------- */
+    if (poRecord->GetFieldCount() > 1) {
+      const char *pszKey = poRecord->GetField(1)->GetFieldDefn()->GetName();
+
+      if (EQUAL(pszKey, "VRID") || EQUAL(pszKey, "FRID")) {
+        DDFCacheKey sKey;
+
+        sRecord.nRCNM = poRecord->GetIntSubfield(pszKey, 0, "RCNM", 0);
+        sRecord.nRCID = poRecord->GetIntSubfield(pszKey, 0, "RCID", 0);
+
+        sKey.nRCNM = sRecord.nRCNM;
+        sKey.nRCID = sRecord.nRCID;
+        sKey.iRecord = nRecordCount;
+        DDFCacheAppend(&sKeys, &sKey, sizeof(sKey));
+      }
+    }
+
+    DDFCacheAppend(&sRecords, &sRecord, sizeof(sRecord));
+    nRecordCount++;
+  }
+
+  /* -------------------------------------------------------------------- */
+  /*      ReadRecord() returns NULL on read errors as well as at the end  */
+  /*      of the file.  A cache of a damaged or truncated file would be   */
+  /*      missing records, so none is written, and an older one at the    */
+  /*      same place is removed.                                          */
+  /* -------------------------------------------------------------------- */
+  if (CPLGetLastErrorNo() != CPLE_None ||
+      VSIFTell(oSource.GetFP()) < (long)sStat.st_size) {
+    CPLError(CE_Failure, CPLE_FileIO,
+             "Failed to read `%s' to its end, no cache written.",
+             pszSourceFilename);
+
+    CPLFree(pasFieldDefns);
+    CPLFree(sEntries.pachData);
+    CPLFree(sRecords.pachData);
+    CPLFree(sFields.pachData);
+    CPLFree(sKeys.pachData);
+    CPLFree(sCoords.pachData);
+    CPLFree(sData.pachData);
+
+    VSIUnlink(pszCacheFilename);
+    return FALSE;
+  }
+
+  int nKeyCount = sKeys.nSize / sizeof(DDFCacheKey);
+
+  if (nKeyCount > 1)
+    qsort(sKeys.pachData, nKeyCount, sizeof(DDFCacheKey), DDFCompareKeys);
+
+  /* -------------------------------------------------------------------- */
+  /*      Assemble the image: header, then each section aligned.          */
+  /* -------------------------------------------------------------------- */
+  DDFCacheBuffer sImage = {NULL, 0, 0};
+  DDFCacheHeader sHeader;
+
+  memset(&sHeader, 0, sizeof(sHeader));
+  memcpy(sHeader.achMagic, DDF_CACHE_MAGIC, sizeof(sHeader.achMagic));
+  sHeader.nVersion = DDF_CACHE_VERSION;
+  sHeader.nByteOrder = DDF_CACHE_BYTE_ORDER;
+  sHeader.nSourceSize = (GUInt32)sStat.st_size;
+  sHeader.nSourceMTime = (GUInt32)sStat.st_mtime;
+  sHeader.nSourceHash = HashFile(pszSourceFilename);
+  sHeader.nFieldDefnCount = nFieldDefnCount;
+  sHeader.nRecordCount = nRecordCount;
+  sHeader.nFieldCount = sFields.nSize / sizeof(DDFCacheField);
+  sHeader.nKeyCount = nKeyCount;
+  sHeader.nCoordCount = sCoords.nSize / sizeof(GInt32);
+
+  DDFCacheAppend(&sImage, NULL, sizeof(sHeader));
+  DDFCacheAlign(&sImage);
+
+  sHeader.nFieldDefnOffset = sImage.nSize;
+  int nEntriesOffset =
+      sImage.nSize + nFieldDefnCount * sizeof(DDFCacheFieldDefn);
+  for (int i = 0; i < nFieldDefnCount; i++)
+    pasFieldDefns[i].nEntryOffset += nEntriesOffset;
+  DDFCacheAppend(&sImage, pasFieldDefns,
+                 nFieldDefnCount * sizeof(DDFCacheFieldDefn));
+  DDFCacheAppend(&sImage, sEntries.pachData, sEntries.nSize);
+  DDFCacheAlign(&sImage);
+
+  // Record data is appended last, so its offsets are known now.
+  int nDataOffset = sImage.nSize + sRecords.nSize + sFields.nSize;
+  nDataOffset += (8 - nDataOffset % 8) % 8;
+  nDataOffset += sKeys.nSize;
+  nDataOffset += (8 - nDataOffset % 8) % 8;
+  nDataOffset += sCoords.nSize;
+  nDataOffset += (8 - nDataOffset % 8) % 8;
+
+  for (int i = 0; i < nRecordCount; i++)
+    ((DDFCacheRecord *)sRecords.pachData)[i].nDataOffset += nDataOffset;
+
+  sHeader.nRecordOffset = sImage.nSize;
+  DDFCacheAppend(&sImage, sRecords.pachData, sRecords.nSize);
+
+  sHeader.nFieldOffset = sImage.nSize;
+  DDFCacheAppend(&sImage, sFields.pachData, sFields.nSize);
+  DDFCacheAlign(&sImage);
+
+  sHeader.nKeyOffset = sImage.nSize;
+  DDFCacheAppend(&sImage, sKeys.pachData, sKeys.nSize);
+  DDFCacheAlign(&sImage);
+
+  sHeader.nCoordOffset = sImage.nSize;
+  DDFCacheAppend(&sImage, sCoords.pachData, sCoords.nSize);
+  DDFCacheAlign(&sImage);
+
+  CPLAssert(sImage.nSize == nDataOffset);
+  DDFCacheAppend(&sImage, sData.pachData, sData.nSize);
+
+  sHeader.nCacheSize = sImage.nSize;
+  memcpy(sImage.pachData, &sHeader, sizeof(sHeader));
+
+  CPLFree(pasFieldDefns);
+  CPLFree(sEntries.pachData);
+  CPLFree(sRecords.pachData);
+  CPLFree(sFields.pachData);
+  CPLFree(sKeys.pachData);
+  CPLFree(sCoords.pachData);
+  CPLFree(sData.pachData);
+
+  /* -------------------------------------------------------------------- */
+  /*      Write it out in one go.                                         */
+  /* -------------------------------------------------------------------- */
+  FILE *fp = VSIFOpen(pszCacheFilename, "wb");
+  int bSuccess = FALSE;
+
+  if (fp == NULL) {
+    CPLError(CE_Failure, CPLE_OpenFailed, "Failed to create cache file `%s'.",
+             pszCacheFilename);
+  } else {
+    bSuccess = VSIFWrite(sImage.pachData, 1, sImage.nSize, fp) ==
+               (size_t)sImage.nSize;
+    VSIFClose(fp);
+
+    if (!bSuccess) {
+      CPLError(CE_Failure, CPLE_FileIO, "Failed to write cache file `%s'.",
+               pszCacheFilename);
+      VSIUnlink(pszCacheFilename);
+    }
+  }
+
+  CPLFree(sImage.pachData);
+
+  return bSuccess;
+}
+
+/************************************************************************/
+/*                                Open()                                */
+/************************************************************************/
+
+/**
+ * Open a cache file.
+ *
+ * The cache is refused if it is damaged, of another version or byte order,
+ * or if the source file changed since the cache was written.  The caller
+ * is then expected to parse the source file, and normally to Write() a
+ * new cache.
+ *
+ * @param pszCacheFilename the cache file.
+ * @param pszSourceFilename the ISO 8211 file the cache was written from.
+ * @param bCheckHash if TRUE the contents of the source file are hashed and
+ * compared as well, otherwise only its size and modification time.
+ *
+ * @return TRUE if the cache is valid and was loaded, otherwise FALSE.
+ */
+
+int DDFCellCache::Open(const char *pszCacheFilename,
+                       const char *pszSourceFilename, int bCheckHash)
+
+{
+  Close();
+
+  /* -------------------------------------------------------------------- */
+  /*      Load the whole cache file.                                      */
+  /* -------------------------------------------------------------------- */
+  FILE *fp = VSIFOpen(pszCacheFilename, "rb");
+
+  if (fp == NULL) return FALSE;
+
+  VSIFSeek(fp, 0, SEEK_END);
+  nCacheSize = VSIFTell(fp);
+  VSIFSeek(fp, 0, SEEK_SET);
+
+  if (nCacheSize < (int)sizeof(DDFCacheHeader)) {
+    VSIFClose(fp);
+    nCacheSize = 0;
+    return FALSE;
+  }
+
+  pachCache = (char *)CPLMalloc(nCacheSize);
+  int bRead = VSIFRead(pachCache, 1, nCacheSize, fp) == (size_t)nCacheSize;
+  VSIFClose(fp);
+
+  const DDFCacheHeader *psHeader = (const DDFCacheHeader *)pachCache;
+
+  /* -------------------------------------------------------------------- */
+  /*      Validate the header and the section bounds.                     */
+  /* -------------------------------------------------------------------- */
+  if (!bRead ||
+      memcmp(psHeader->achMagic, DDF_CACHE_MAGIC, sizeof(psHeader->achMagic)) !=
+          0 ||
+      psHeader->nVersion != DDF_CACHE_VERSION ||
+      psHeader->nByteOrder != DDF_CACHE_BYTE_ORDER ||
+      psHeader->nCacheSize != (GUInt32)nCacheSize) {
+    CPLDebug("ISO8211", "Cache `%s' is invalid or of another version.",
+             pszCacheFilename);
+    Close();
+    return FALSE;
+  }
+
+  if (psHeader->nFieldDefnCount < 0 || psHeader->nRecordCount < 0 ||
+      psHeader->nFieldCount < 0 || psHeader->nKeyCount < 0 ||
+      psHeader->nCoordCount < 0 ||
+      psHeader->nFieldDefnOffset +
+              (double)psHeader->nFieldDefnCount * sizeof(DDFCacheFieldDefn) >
+          nCacheSize ||
+      psHeader->nRecordOffset +
+              (double)psHeader->nRecordCount * sizeof(DDFCacheRecord) >
+          nCacheSize ||
+      psHeader->nFieldOffset +
+              (double)psHeader->nFieldCount * sizeof(DDFCacheField) >
+          nCacheSize ||
+      psHeader->nKeyOffset +
+              (double)psHeader->nKeyCount * sizeof(DDFCacheKey) >
+          nCacheSize ||
+      psHeader->nCoordOffset + (double)psHeader->nCoordCount * sizeof(GInt32) >
+          nCacheSize) {
+    CPLDebug("ISO8211", "Cache `%s' is corrupt.", pszCacheFilename);
+    Close();
+    return FALSE;
+  }
+
+  /* -------------------------------------------------------------------- */
+  /*      Is it still current?                                            */
+  /* -------------------------------------------------------------------- */
+  VSIStatBuf sStat;
+
+  if (VSIStat(pszSourceFilename, &sStat) != 0 ||
+      (GUInt32)sStat.st_size != psHeader->nSourceSize ||
+      (GUInt32)sStat.st_mtime != psHeader->nSourceMTime ||
+      (bCheckHash &&
+       HashFile(pszSourceFilename) != psHeader->nSourceHash)) {
+    CPLDebug("ISO8211", "Cache `%s' is stale.", pszCacheFilename);
+    Close();
+    return FALSE;
+  }
+
+  /* -------------------------------------------------------------------- */
+  /*      Recreate the field definitions.                                 */
+  /* -------------------------------------------------------------------- */
+  const DDFCacheFieldDefn *pasFieldDefns =
+      (const DDFCacheFieldDefn *)(pachCache + psHeader->nFieldDefnOffset);
+
+  oModule.Initialize();
+
+  for (int i = 0; i < psHeader->nFieldDefnCount; i++) {
+    char szTag[sizeof(pasFieldDefns[i].szTag) + 1];
+
+    if (pasFieldDefns[i].nEntrySize < 0 ||
+        pasFieldDefns[i].nEntryOffset + (double)pasFieldDefns[i].nEntrySize >
+            nCacheSize) {
+      Close();
+      return FALSE;
+    }
+
+    memcpy(szTag, pasFieldDefns[i].szTag, sizeof(pasFieldDefns[i].szTag));
+    szTag[sizeof(pasFieldDefns[i].szTag)] = '\0';
+
+    DDFFieldDefn *poDefn = new DDFFieldDefn();
+    poDefn->Initialize(&oModule, szTag, pasFieldDefns[i].nEntrySize,
+                       pachCache + pasFieldDefns[i].nEntryOffset);
+    oModule.AddField(poDefn);
+  }
+
+  papoRecords = (DDFRecord **)CPLCalloc(sizeof(DDFRecord *),
+                                        psHeader->nRecordCount + 1);
+
+  return TRUE;
+}
+
+/************************************************************************/
+/*                           GetRecordCount()                           */
+/************************************************************************/
+
+/** Fetch the number of records in the cache. */
+
+int DDFCellCache::GetRecordCount()
+
+{
+  if (pachCache == NULL) return 0;
+
+  return ((const DDFCacheHeader *)pachCache)->nRecordCount;
+}
+
+/************************************************************************/
+/*                             GetRecord()                              */
+/************************************************************************/
+
+/**
+ * Fetch a record.
+ *
+ * The record is rebuilt from the cache on first use.  Unlike records
+ * returned by DDFModule::ReadRecord() it stays valid, and owned by the
+ * cache, until Close().
+ *
+ * @param iRecord the record number, in file order.
+ *
+ * @return the record, or NULL on failure.
+ */
+
+DDFRecord *DDFCellCache::GetRecord(int iRecord)
+
+{
+  if (iRecord < 0 || iRecord >= GetRecordCount()) return NULL;
+
+  if (papoRecords[iRecord] != NULL) return papoRecords[iRecord];
+
+  const DDFCacheHeader *psHeader = (const DDFCacheHeader *)pachCache;
+  const DDFCacheRecord *psRecord =
+      (const DDFCacheRecord *)(pachCache + psHeader->nRecordOffset) + iRecord;
+  const DDFCacheField *pasFields =
+      (const DDFCacheField *)(pachCache + psHeader->nFieldOffset);
+
+  if (psRecord->nDataSize < 0 ||
+      psRecord->nDataOffset + (double)psRecord->nDataSize > nCacheSize ||
+      psRecord->nFirstField < 0 || psRecord->nFieldCount < 0 ||
+      psRecord->nFirstField + psRecord->nFieldCount > psHeader->nFieldCount)
+    return NULL;
+
+  DDFRecord *poRecord = new DDFRecord(&oModule);
+
+  if (!poRecord->Initialize(pachCache + psRecord->nDataOffset,
+                            psRecord->nDataSize, psRecord->nDirSize,
+                            psRecord->nFieldCount)) {
+    delete poRecord;
+    return NULL;
+  }
+
+  for (int i = 0; i < psRecord->nFieldCount; i++) {
+    const DDFCacheField *psField = pasFields + psRecord->nFirstField + i;
+    DDFFieldDefn *poDefn = oModule.GetField(psField->nFieldDefn);
+
+    if (poDefn == NULL || psField->nPos < 0 || psField->nSize < 0 ||
+        psField->nPos + psField->nSize > psRecord->nDataSize) {
+      delete poRecord;
+      return NULL;
+    }
+
+    poRecord->GetField(i)->Initialize(
+        poDefn, poRecord->GetData() + psField->nPos, psField->nSize);
+  }
+
+  papoRecords[iRecord] = poRecord;
+
+  return poRecord;
+}
+
+/************************************************************************/
+/*                            GetRecordId()                             */
+/************************************************************************/
+
+/**
+ * Fetch the S-57 record name and identifier of a record.
+ *
+ * @param iRecord the record number.
+ * @param pnRCNM location to put the record name, may be NULL.
+ * @param pnRCID location to put the record identifier, may be NULL.
+ *
+ * @return TRUE if the record is a vector or feature record, otherwise
+ * FALSE.
+ */
+
+int DDFCellCache::GetRecordId(int iRecord, int *pnRCNM, int *pnRCID)
+
+{
+  if (iRecord < 0 || iRecord >= GetRecordCount()) return FALSE;
+
+  const DDFCacheHeader *psHeader = (const DDFCacheHeader *)pachCache;
+  const DDFCacheRecord *psRecord =
+      (const DDFCacheRecord *)(pachCache + psHeader->nRecordOffset) + iRecord;
+
+  if (pnRCNM != NULL) *pnRCNM = psRecord->nRCNM;
+  if (pnRCID != NULL) *pnRCID = psRecord->nRCID;
+
+  return psRecord->nRCNM != 0;
+}
+
+/************************************************************************/
+/*                             FindRecord()                             */
+/************************************************************************/
+
+/**
+ * Find a vector or feature record by its identifiers.
+ *
+ * @param nRCNM the record name.
+ * @param nRCID the record identifier.
+ *
+ * @return the record number, or -1 if not found.
+ */
+
+int DDFCellCache::FindRecord(int nRCNM, int nRCID)
+
+{
+  if (pachCache == NULL) return -1;
+
+  const DDFCacheHeader *psHeader = (const DDFCacheHeader *)pachCache;
+  const DDFCacheKey *pasKeys =
+      (const DDFCacheKey *)(pachCache + psHeader->nKeyOffset);
+  DDFCacheKey sKey;
+
+  sKey.nRCNM = nRCNM;
+  sKey.nRCID = nRCID;
+  sKey.iRecord = 0;
+
+  const DDFCacheKey *psFound = (const DDFCacheKey *)bsearch(
+      &sKey, pasKeys, psHeader->nKeyCount, sizeof(DDFCacheKey),
+      DDFCompareKeys);
+
+  if (psFound == NULL || psFound->iRecord < 0 ||
+      psFound->iRecord >= psHeader->nRecordCount)
+    return -1;
+
+  return psFound->iRecord;
+}
+
+/************************************************************************/
+/*                           GetCoordinates()                           */
+/************************************************************************/
+
+/**
+ * Fetch the pre-decoded SG2D or SG3D coordinates of a record.
+ *
+ * The values are the raw integers of the subfields (ie. YCOO, XCOO and
+ * VE3D for soundings), interleaved per point.  Scale them with the
+ * COMF/SOMF of the DSPM record as usual.
+ *
+ * @param iRecord the record number.
+ * @param pnPointCount location to put the number of points.
+ * @param pnDimension location to put the number of values per point, two
+ * or three.  May be NULL.
+ *
+ * @return a pointer to pnPointCount * pnDimension values owned by the
+ * cache, or NULL if the record has no coordinates.
+ */
+
+const GInt32 *DDFCellCache::GetCoordinates(int iRecord, int *pnPointCount,
+                                           int *pnDimension)
+
+{
+  *pnPointCount = 0;
+  if (pnDimension != NULL) *pnDimension = 0;
+
+  if (iRecord < 0 || iRecord >= GetRecordCount()) return NULL;
+
+  const DDFCacheHeader *psHeader = (const DDFCacheHeader *)pachCache;
+  const DDFCacheRecord *psRecord =
+      (const DDFCacheRecord *)(pachCache + psHeader->nRecordOffset) + iRecord;
+
+  if (psRecord->nDimension == 0 || psRecord->nFirstCoord < 0 ||
+      psRecord->nFirstCoord +
+              (double)psRecord->nPointCount * psRecord->nDimension >
+          psHeader->nCoordCount)
+    return NULL;
+
+  *pnPointCount = psRecord->nPointCount;
+  if (pnDimension != NULL) *pnDimension = psRecord->nDimension;
+
+  return (const GInt32 *)(pachCache + psHeader->nCoordOffset) +
+         psRecord->nFirstCoord;
+}
@@ -205,6 +205,27 @@ const char *DDFField::GetSubfieldData(DDFSubfieldDefn *poSFDefn,
     iSubfieldIndex = 0;
   }
 
+  /* -------------------------------------------------------------------- */
+  /*      Subfields at a fixed offset in the instance are found without   */
+  /*      scanning the preceding subfields.                               */
+  /* -------------------------------------------------------------------- */
+  if (iSubfieldIndex == 0) {
+    const DDFSubfieldDecoder *pasDecoders = poDefn->GetDecoders();
+
+    for (int iSF = 0; iSF < poDefn->GetSubfieldCount(); iSF++) {
+      if (poDefn->GetSubfield(iSF) != poSFDefn) continue;
+
+      if (pasDecoders[iSF].nOffset >= 0 &&
+          iOffset + pasDecoders[iSF].nOffset <= nDataSize) {
+        iOffset += pasDecoders[iSF].nOffset;
+        if (pnMaxBytes != NULL) *pnMaxBytes = nDataSize - iOffset;
+
+        return pachData + iOffset;
+      }
+      break;
+    }
+  }
+
   while (iSubfieldIndex >= 0) {
     for (int iSF = 0; iSF < poDefn->GetSubfieldCount(); iSF++) {
       int nBytesConsumed;
@@ -358,3 +379,140 @@ const char *DDFField::GetInstanceData(int nInstance, int *pnInstanceSize)
 
   return pachWrkData;
 }
+
+/************************************************************************/
+/*                          DecodeIntValues()                           */
+/************************************************************************/
+
+/**
+ * Decode all subfields of all instances of this field as integers.
+ *
+ * The values are written instance by instance, in subfield order, so
+ * for an SG2D field they are YCOO, XCOO, YCOO, XCOO, ...  Each value is
+ * what ExtractIntData() would return.  Fields whose subfields are all
+ * fixed width are decoded with the compiled converters of the field
+ * definition (see DDFFieldDefn::GetDecoders()) in a single loop, other
+ * fields fall back to ExtractIntData().
+ *
+ * @param panValues the array to fill.
+ * @param nMaxValues the size of panValues.  GetRepeatCount() times
+ * DDFFieldDefn::GetSubfieldCount() values are needed for the whole field.
+ *
+ * @return the number of values written.
+ */
+
+int DDFField::DecodeIntValues(int *panValues, int nMaxValues)
+
+{
+  int nSubfieldCount = poDefn->GetSubfieldCount();
+  int nRepeatCount = GetRepeatCount();
+  int nWidth = poDefn->GetDecoderWidth();
+  int nValues = 0;
+
+  if (nSubfieldCount == 0) return 0;
+
+  /* -------------------------------------------------------------------- */
+  /*      Fast path, using the compiled decoding program.                 */
+  /* -------------------------------------------------------------------- */
+  if (nWidth > 0 && nRepeatCount * nWidth <= nDataSize) {
+    const DDFSubfieldDecoder *pasDecoders = poDefn->GetDecoders();
+    const char *pachInstance = pachData;
+
+    for (int iRepeat = 0; iRepeat < nRepeatCount; iRepeat++) {
+      for (int iSF = 0; iSF < nSubfieldCount; iSF++) {
+        if (nValues == nMaxValues) return nValues;
+
+        panValues[nValues++] = pasDecoders[iSF].pfnIntDecoder(
+            pachInstance + pasDecoders[iSF].nOffset, pasDecoders[iSF].nWidth);
+      }
+      pachInstance += nWidth;
+    }
+
+    return nValues;
+  }
+
+  /* -------------------------------------------------------------------- */
+  /*      Otherwise interpret each subfield in turn.                      */
+  /* -------------------------------------------------------------------- */
+  int iOffset = 0;
+
+  for (int iRepeat = 0; iRepeat < nRepeatCount; iRepeat++) {
+    for (int iSF = 0; iSF < nSubfieldCount; iSF++) {
+      int nBytesConsumed = 0;
+
+      if (nValues == nMaxValues) return nValues;
+
+      panValues[nValues++] = poDefn->GetSubfield(iSF)->ExtractIntData(
+          pachData + iOffset, nDataSize - iOffset, &nBytesConsumed);
+      iOffset += nBytesConsumed;
+    }
+  }
+
+  return nValues;
+}
+
+/************************************************************************/
+/*                         DecodeFloatValues()                          */
+/************************************************************************/
+
+/**
+ * Decode all subfields of all instances of this field as doubles.
+ *
+ * Like DecodeIntValues(), but each value is what ExtractFloatData() would
+ * return.
+ *
+ * @param padfValues the array to fill.
+ * @param nMaxValues the size of padfValues.
+ *
+ * @return the number of values written.
+ */
+
+int DDFField::DecodeFloatValues(double *padfValues, int nMaxValues)
+
+{
+  int nSubfieldCount = poDefn->GetSubfieldCount();
+  int nRepeatCount = GetRepeatCount();
+  int nWidth = poDefn->GetDecoderWidth();
+  int nValues = 0;
+
+  if (nSubfieldCount == 0) return 0;
+
+  /* -------------------------------------------------------------------- */
+  /*      Fast path, using the compiled decoding program.                 */
+  /* -------------------------------------------------------------------- */
+  if (nWidth > 0 && nRepeatCount * nWidth <= nDataSize) {
+    const DDFSubfieldDecoder *pasDecoders = poDefn->GetDecoders();
+    const char *pachInstance = pachData;
+
+    for (int iRepeat = 0; iRepeat < nRepeatCount; iRepeat++) {
+      for (int iSF = 0; iSF < nSubfieldCount; iSF++) {
+        if (nValues == nMaxValues) return nValues;
+
+        padfValues[nValues++] = pasDecoders[iSF].pfnFloatDecoder(
+            pachInstance + pasDecoders[iSF].nOffset, pasDecoders[iSF].nWidth);
+      }
+      pachInstance += nWidth;
+    }
+
+    return nValues;
+  }
+
+  /* -------------------------------------------------------------------- */
+  /*      Otherwise interpret each subfield in turn.                      */
+  /* -------------------------------------------------------------------- */
+  int iOffset = 0;
+
+  for (int iRepeat = 0; iRepeat < nRepeatCount; iRepeat++) {
+    for (int iSF = 0; iSF < nSubfieldCount; iSF++) {
+      int nBytesConsumed = 0;
+
+      if (nValues == nMaxValues) return nValues;
+
+      padfValues[nValues++] = poDefn->GetSubfield(iSF)->ExtractFloatData(
+          pachData + iOffset, nDataSize - iOffset, &nBytesConsumed);
+      iOffset += nBytesConsumed;
+    }
+  }
+
+  return nValues;
+}
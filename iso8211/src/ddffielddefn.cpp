@@ -120,6 +120,8 @@ DDFFieldDefn::DDFFieldDefn()
   papoSubfields = NULL;
   bRepeatingSubfields = FALSE;
   nFixedWidth = 0;
+  pasDecoders = NULL;
+  nDecoderWidth = 0;
 }
 
 /************************************************************************/
@@ -138,6 +140,8 @@ DDFFieldDefn::~DDFFieldDefn()
 
   for (i = 0; i < nSubfieldCount; i++) delete papoSubfields[i];
   CPLFree(papoSubfields);
+
+  CPLFree(pasDecoders);
 }
 
 /************************************************************************/
@@ -167,6 +171,10 @@ void DDFFieldDefn::AddSubfield(DDFSubfieldDefn *poNewSFDefn,
       papoSubfields, sizeof(void *) * nSubfieldCount);
   papoSubfields[nSubfieldCount - 1] = poNewSFDefn;
 
+  // Recompiled on the next GetDecoders().
+  CPLFree(pasDecoders);
+  pasDecoders = NULL;
+
   if (bDontAddToFormat) return;
 
   /* -------------------------------------------------------------------- */
@@ -739,9 +747,78 @@ int DDFFieldDefn::ApplyFormats()
       nFixedWidth += papoSubfields[i]->GetWidth();
   }
 
+  CompileDecoders();
+
   return TRUE;
 }
 
+/************************************************************************/
+/*                          CompileDecoders()                           */
+/*                                                                      */
+/*      Turn the subfield formats into a flat decoding program: the     */
+/*      offset, width and converters of each subfield.                  */
+/************************************************************************/
+
+void DDFFieldDefn::CompileDecoders()
+
+{
+  CPLFree(pasDecoders);
+  pasDecoders = (DDFSubfieldDecoder *)CPLCalloc(sizeof(DDFSubfieldDecoder),
+                                                nSubfieldCount + 1);
+
+  int nOffset = 0;
+
+  for (int i = 0; i < nSubfieldCount; i++) {
+    DDFSubfieldDecoder *psDecoder = pasDecoders + i;
+
+    psDecoder->nOffset = nOffset;
+    psDecoder->nWidth = papoSubfields[i]->GetWidth();
+    psDecoder->pfnIntDecoder = papoSubfields[i]->GetIntDecoder();
+    psDecoder->pfnFloatDecoder = papoSubfields[i]->GetFloatDecoder();
+
+    // Following subfields have no fixed offset after a variable one.
+    if (nOffset >= 0 && psDecoder->nWidth > 0)
+      nOffset += psDecoder->nWidth;
+    else
+      nOffset = -1;
+  }
+
+  /* -------------------------------------------------------------------- */
+  /*      Instances can only be decoded in one loop if everything is      */
+  /*      fixed width and has a converter.                                */
+  /* -------------------------------------------------------------------- */
+  nDecoderWidth = nSubfieldCount > 0 && nOffset > 0 ? nOffset : 0;
+
+  for (int i = 0; i < nSubfieldCount && nDecoderWidth > 0; i++) {
+    if (pasDecoders[i].pfnIntDecoder == NULL ||
+        pasDecoders[i].pfnFloatDecoder == NULL)
+      nDecoderWidth = 0;
+  }
+}
+
+/************************************************************************/
+/*                            GetDecoders()                             */
+/************************************************************************/
+
+/**
+ * Fetch the compiled decoding program of this field.
+ *
+ * There is one entry per subfield, giving its offset within a field
+ * instance (or -1 if it follows a variable width subfield), its width and
+ * converters to int and double (NULL if there is no fast path).
+ *
+ * @return an array of GetSubfieldCount() entries, owned by the field
+ * definition.
+ */
+
+const DDFSubfieldDecoder *DDFFieldDefn::GetDecoders()
+
+{
+  if (pasDecoders == NULL) CompileDecoders();
+
+  return pasDecoders;
+}
+
 /************************************************************************/
 /*                          FindSubfieldDefn()                          */
 /************************************************************************/
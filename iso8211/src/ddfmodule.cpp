@@ -100,6 +100,8 @@ DDFModule::DDFModule()
   papoClones = NULL;
   nCloneCount = nMaxCloneCount = 0;
 
+  poArena = NULL;
+
   fpDDF = NULL;
   bReadOnly = TRUE;
 
@@ -373,7 +375,7 @@ int DDFModule::Initialize(char chInterchangeLevel, char chLeaderIden,
                           char chCodeExtensionIndicator, char chVersionNumber,
                           char chAppIndicator, const char *pszExtendedCharSet,
                           int nSizeFieldLength, int nSizeFieldPos,
-                          int nSizeFieldTag)
+                          int nSizeFieldTag, int nFieldControlLength)
 
 {
   _interchangeLevel = chInterchangeLevel;
@@ -385,6 +387,7 @@ int DDFModule::Initialize(char chInterchangeLevel, char chLeaderIden,
   _sizeFieldLength = nSizeFieldLength;
   _sizeFieldPos = nSizeFieldPos;
   _sizeFieldTag = nSizeFieldTag;
+  _fieldControlLength = nFieldControlLength;
 
   return TRUE;
 }
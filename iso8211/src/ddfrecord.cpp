@@ -121,6 +121,7 @@
 
 #include "iso8211.h"
 #include "cpl_conv.h"
+#include <new>
 
 static const size_t nLeaderSize = 24;
 
@@ -132,15 +133,18 @@ DDFRecord::DDFRecord(DDFModule *poModuleIn)
 
 {
   poModule = poModuleIn;
+  poArena = NULL;
 
   nReuseHeader = FALSE;
 
   nFieldOffset = 0;
 
   nDataSize = 0;
+  nDataMax = 0;
   pachData = NULL;
 
   nFieldCount = 0;
+  nFieldMax = 0;
   paoFields = NULL;
 
   bIsClone = FALSE;
@@ -303,18 +307,140 @@ int DDFRecord::Write()
 void DDFRecord::Clear()
 
 {
-  if (paoFields != NULL) delete[] paoFields;
+  FreeFields(paoFields, nFieldMax);
 
   paoFields = NULL;
   nFieldCount = 0;
+  nFieldMax = 0;
 
-  if (pachData != NULL) CPLFree(pachData);
+  FreeData(pachData);
 
   pachData = NULL;
   nDataSize = 0;
+  nDataMax = 0;
   nReuseHeader = FALSE;
 }
 
+/************************************************************************/
+/*                            AllocateData()                            */
+/*                                                                      */
+/*      Allocate and free data and field buffers, from the arena of     */
+/*      the record if it has one.  Arena memory is never freed          */
+/*      individually.                                                   */
+/************************************************************************/
+
+char *DDFRecord::AllocateData(int nSize)
+
+{
+  if (poArena != NULL) return (char *)poArena->Allocate(nSize);
+
+  return (char *)CPLMalloc(nSize);
+}
+
+void DDFRecord::FreeData(char *pachOldData)
+
+{
+  if (poArena == NULL) CPLFree(pachOldData);
+}
+
+DDFField *DDFRecord::AllocateFields(int nCount)
+
+{
+  if (poArena != NULL) {
+    // Constructed in place, as new[] does on the heap.
+    DDFField *paoNewFields =
+        (DDFField *)poArena->Allocate(sizeof(DDFField) * nCount);
+
+    for (int i = 0; i < nCount; i++) new (paoNewFields + i) DDFField();
+    return paoNewFields;
+  }
+
+  return new DDFField[nCount];
+}
+
+void DDFRecord::FreeFields(DDFField *paoOldFields, int nCount)
+
+{
+  if (poArena == NULL) {
+    delete[] paoOldFields;
+    return;
+  }
+
+  if (paoOldFields == NULL) return;
+
+  for (int i = 0; i < nCount; i++) paoOldFields[i].~DDFField();
+}
+
+/************************************************************************/
+/*                              GrowData()                              */
+/*                                                                      */
+/*      Make sure pachData can hold at least nNewSize bytes, keeping    */
+/*      the current nDataSize bytes.  Field pointers are not updated.   */
+/************************************************************************/
+
+int DDFRecord::GrowData(int nNewSize)
+
+{
+  if (nNewSize <= nDataMax) return TRUE;
+
+  // Grow geometrically, fields are often built up one instance at a time.
+  int nNewMax = nDataMax + nDataMax / 2;
+  if (nNewMax < nNewSize) nNewMax = nNewSize;
+
+  char *pachNewData = AllocateData(nNewMax);
+
+  if (nDataSize > 0) memcpy(pachNewData, pachData, nDataSize);
+  FreeData(pachData);
+
+  pachData = pachNewData;
+  nDataMax = nNewMax;
+
+  return TRUE;
+}
+
+/************************************************************************/
+/*                             Initialize()                             */
+/************************************************************************/
+
+/**
+ * Initialize the record from already parsed data.
+ *
+ * The raw data (directory and field area, without the leader) is copied,
+ * and room for nFieldCountIn fields is allocated.  The caller must then
+ * Initialize() each field returned by GetField() to point into GetData().
+ * This is used to rebuild records without scanning their directory.
+ *
+ * @param pachDataIn the raw record data.
+ * @param nDataSizeIn the number of bytes in pachDataIn.
+ * @param nFieldOffsetIn the size of the directory at the start of the data.
+ * @param nFieldCountIn the number of fields in the record.
+ *
+ * @return TRUE on success or FALSE on failure.
+ */
+
+int DDFRecord::Initialize(const char *pachDataIn, int nDataSizeIn,
+                          int nFieldOffsetIn, int nFieldCountIn)
+
+{
+  Clear();
+
+  if (nDataSizeIn < 0 || nFieldCountIn < 0 || nFieldOffsetIn > nDataSizeIn)
+    return FALSE;
+
+  nFieldOffset = nFieldOffsetIn;
+
+  nDataSize = nDataSizeIn;
+  nDataMax = nDataSize;
+  pachData = AllocateData(nDataSize);
+  memcpy(pachData, pachDataIn, nDataSize);
+
+  nFieldCount = nFieldCountIn;
+  nFieldMax = nFieldCount;
+  if (nFieldCount > 0) paoFields = AllocateFields(nFieldCount);
+
+  return TRUE;
+}
+
 /************************************************************************/
 /*                             ReadHeader()                             */
 /*                                                                      */
@@ -327,9 +453,12 @@ int DDFRecord::ReadHeader()
 
 {
   /* -------------------------------------------------------------------- */
-  /*      Clear any existing information.                                 */
+  /*      Clear any existing information, but keep the data and field     */
+  /*      buffers for reuse by this record.                               */
   /* -------------------------------------------------------------------- */
-  Clear();
+  nFieldCount = 0;
+  nDataSize = 0;
+  nReuseHeader = FALSE;
 
   /* -------------------------------------------------------------------- */
   /*      Read the 24 byte leader.                                        */
@@ -394,7 +523,11 @@ int DDFRecord::ReadHeader()
     /*      Read the remainder of the record.                               */
     /* -------------------------------------------------------------------- */
     nDataSize = _recLength - nLeaderSize;
-    pachData = (char *)CPLMalloc(nDataSize);
+    if (nDataSize > nDataMax) {
+      FreeData(pachData);
+      pachData = AllocateData(nDataSize);
+      nDataMax = nDataSize;
+    }
 
     if (VSIFRead(pachData, 1, nDataSize, poModule->GetFP()) !=
         (size_t)nDataSize) {
@@ -408,8 +541,8 @@ int DDFRecord::ReadHeader()
     /*      we will read extra bytes till we get to it.                     */
     /* -------------------------------------------------------------------- */
     while (pachData[nDataSize - 1] != DDF_FIELD_TERMINATOR) {
+      GrowData(nDataSize + 1);
       nDataSize++;
-      pachData = (char *)CPLRealloc(pachData, nDataSize);
 
       if (VSIFRead(pachData + nDataSize - 1, 1, 1, poModule->GetFP()) != 1) {
         CPLError(CE_Failure, CPLE_FileIO, "Data record is short on DDF file.");
@@ -436,7 +569,11 @@ int DDFRecord::ReadHeader()
     /* -------------------------------------------------------------------- */
     /*      Allocate, and read field definitions.                           */
     /* -------------------------------------------------------------------- */
-    paoFields = new DDFField[nFieldCount];
+    if (nFieldCount > nFieldMax) {
+      FreeFields(paoFields, nFieldMax);
+      paoFields = AllocateFields(nFieldCount);
+      nFieldMax = nFieldCount;
+    }
 
     for (i = 0; i < nFieldCount; i++) {
       char szTag[128];
@@ -492,7 +629,9 @@ int DDFRecord::ReadHeader()
     /*                                                                   */
     /*   Read the remainder of the record.                               */
     /* ----------------------------------------------------------------- */
+    FreeData(pachData);
     nDataSize = 0;
+    nDataMax = 0;
     pachData = NULL;
 
     /* ----------------------------------------------------------------- */
@@ -563,7 +702,11 @@ int DDFRecord::ReadHeader()
     /* ----------------------------------------------------------------- */
     /*     Allocate, and read field definitions.                         */
     /* ----------------------------------------------------------------- */
-    paoFields = new DDFField[nFieldCount];
+    nDataMax = nDataSize;
+
+    FreeFields(paoFields, nFieldMax);
+    paoFields = AllocateFields(nFieldCount);
+    nFieldMax = nFieldCount;
 
     for (i = 0; i < nFieldCount; i++) {
       char szTag[128];
@@ -870,27 +1013,7 @@ const char *DDFRecord::GetStringSubfield(const char *pszField, int iFieldIndex,
 DDFRecord *DDFRecord::Clone()
 
 {
-  DDFRecord *poNR;
-
-  poNR = new DDFRecord(poModule);
-
-  poNR->nReuseHeader = FALSE;
-  poNR->nFieldOffset = nFieldOffset;
-
-  poNR->nDataSize = nDataSize;
-  poNR->pachData = (char *)CPLMalloc(nDataSize);
-  memcpy(poNR->pachData, pachData, nDataSize);
-
-  poNR->nFieldCount = nFieldCount;
-  poNR->paoFields = new DDFField[nFieldCount];
-  for (int i = 0; i < nFieldCount; i++) {
-    int nOffset;
-
-    nOffset = (paoFields[i].GetData() - pachData);
-    poNR->paoFields[i].Initialize(paoFields[i].GetFieldDefn(),
-                                  poNR->pachData + nOffset,
-                                  paoFields[i].GetDataSize());
-  }
+  DDFRecord *poNR = Duplicate(poModule->GetArena());
 
   poNR->bIsClone = TRUE;
   poModule->AddCloneRecord(poNR);
@@ -942,7 +1065,7 @@ DDFRecord *DDFRecord::CloneOn(DDFModule *poTargetModule)
   /* -------------------------------------------------------------------- */
   DDFRecord *poClone;
 
-  poClone = Clone();
+  poClone = Duplicate(poTargetModule->GetArena());
 
   /* -------------------------------------------------------------------- */
   /*      Update all internal information to reference other module.      */
@@ -956,8 +1079,8 @@ DDFRecord *DDFRecord::CloneOn(DDFModule *poTargetModule)
     poField->Initialize(poDefn, poField->GetData(), poField->GetDataSize());
   }
 
-  poModule->RemoveCloneRecord(poClone);
   poClone->poModule = poTargetModule;
+  poClone->bIsClone = TRUE;
   poTargetModule->AddCloneRecord(poClone);
 
   return poClone;
@@ -979,20 +1102,37 @@ DDFRecord *DDFRecord::CloneOn(DDFModule *poTargetModule)
 
 DDFRecord *DDFRecord::Copy()
 
+{
+  return Duplicate(NULL);
+}
+
+/************************************************************************/
+/*                             Duplicate()                              */
+/*                                                                      */
+/*      Copy the data and fields of this record into a new record on    */
+/*      the same module, allocating them from the given arena (or the   */
+/*      heap if NULL).                                                  */
+/************************************************************************/
+
+DDFRecord *DDFRecord::Duplicate(DDFArena *poArenaIn)
+
 {
   DDFRecord *poNR;
 
   poNR = new DDFRecord(poModule);
+  poNR->poArena = poArenaIn;
 
   poNR->nReuseHeader = FALSE;
   poNR->nFieldOffset = nFieldOffset;
 
   poNR->nDataSize = nDataSize;
-  poNR->pachData = (char *)CPLMalloc(nDataSize);
+  poNR->nDataMax = nDataSize;
+  poNR->pachData = poNR->AllocateData(nDataSize);
   memcpy(poNR->pachData, pachData, nDataSize);
 
   poNR->nFieldCount = nFieldCount;
-  poNR->paoFields = new DDFField[nFieldCount];
+  poNR->nFieldMax = nFieldCount;
+  poNR->paoFields = poNR->AllocateFields(nFieldCount);
   for (int i = 0; i < nFieldCount; i++) {
     int nOffset;
 
@@ -1105,8 +1245,7 @@ int DDFRecord::ResizeField(DDFField *poField, int nNewDataSize)
   const char *pachOldData = pachData;
 
   // Don't realloc things smaller ... we will cut off some data.
-  if (nBytesToAdd > 0)
-    pachData = (char *)CPLRealloc(pachData, nDataSize + nBytesToAdd);
+  if (nBytesToAdd > 0) GrowData(nDataSize + nBytesToAdd);
 
   nDataSize += nBytesToAdd;
 
@@ -1194,17 +1333,19 @@ DDFField *DDFRecord::AddField(DDFFieldDefn *poDefn)
 
 {
   /* -------------------------------------------------------------------- */
-  /*      Reallocate the fields array larger by one, and initialize       */
-  /*      the new field.                                                  */
+  /*      Grow the fields array if needed, and initialize the new field.  */
   /* -------------------------------------------------------------------- */
-  DDFField *paoNewFields;
+  if (nFieldCount == nFieldMax) {
+    DDFField *paoNewFields;
+    int nNewMax = nFieldMax * 2 + 4;
 
-  paoNewFields = new DDFField[nFieldCount + 1];
-  if (nFieldCount > 0) {
-    memcpy(paoNewFields, paoFields, sizeof(DDFField) * nFieldCount);
-    delete[] paoFields;
+    paoNewFields = AllocateFields(nNewMax);
+    if (nFieldCount > 0)
+      memcpy(paoNewFields, paoFields, sizeof(DDFField) * nFieldCount);
+    FreeFields(paoFields, nFieldMax);
+    paoFields = paoNewFields;
+    nFieldMax = nNewMax;
   }
-  paoFields = paoNewFields;
   nFieldCount++;
 
   /* -------------------------------------------------------------------- */
@@ -1442,7 +1583,7 @@ int DDFRecord::ResetDirectory()
     int nNewDataSize;
 
     nNewDataSize = nDataSize - nFieldOffset + nDirSize;
-    pachNewData = (char *)CPLMalloc(nNewDataSize);
+    pachNewData = AllocateData(nNewDataSize);
     memcpy(pachNewData + nDirSize, pachData + nFieldOffset,
            nNewDataSize - nDirSize);
 
@@ -1455,9 +1596,10 @@ int DDFRecord::ResetDirectory()
                           poField->GetDataSize());
     }
 
-    CPLFree(pachData);
+    FreeData(pachData);
     pachData = pachNewData;
     nDataSize = nNewDataSize;
+    nDataMax = nNewDataSize;
     nFieldOffset = nDirSize;
   }
 
@@ -0,0 +1,263 @@
+/******************************************************************************
+ *
+ * Project:  ISO 8211 Access
+ * Purpose:  Implements the DDFRecordIndex class.
+ *
+ ******************************************************************************
+ * Copyright (c) 2024, OpenCPN development team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ******************************************************************************
+ *
+ */
+
+#include "iso8211.h"
+#include "cpl_conv.h"
+
+/************************************************************************/
+/*                           DDFRecordIndex()                           */
+/************************************************************************/
+
+DDFRecordIndex::DDFRecordIndex()
+
+{
+  bSorted = FALSE;
+
+  nRecordCount = 0;
+  nRecordMax = 0;
+  pasRecords = NULL;
+}
+
+/************************************************************************/
+/*                          ~DDFRecordIndex()                           */
+/************************************************************************/
+
+DDFRecordIndex::~DDFRecordIndex()
+
+{
+  Clear();
+}
+
+/************************************************************************/
+/*                               Clear()                                */
+/*                                                                      */
+/*      Clear all entries from the index and deallocate all index       */
+/*      resources.                                                      */
+/************************************************************************/
+
+/**
+ * Remove all records from the index, deleting them.
+ */
+
+void DDFRecordIndex::Clear()
+
+{
+  for (int i = 0; i < nRecordCount; i++) delete pasRecords[i].poRecord;
+
+  CPLFree(pasRecords);
+  pasRecords = NULL;
+
+  nRecordCount = 0;
+  nRecordMax = 0;
+
+  bSorted = FALSE;
+}
+
+/************************************************************************/
+/*                             AddRecord()                              */
+/*                                                                      */
+/*      Add a record to the index.  The index will assume ownership     */
+/*      of the record.  If passing a record just read from a            */
+/*      DDFModule it is imperitive that the caller Clone()'s the        */
+/*      record first.                                                   */
+/************************************************************************/
+
+/**
+ * Add a record to the index.
+ *
+ * The index takes ownership of the record.  A record read with
+ * DDFModule::ReadRecord() must be Clone()'d first, as it is reused by
+ * the module.
+ *
+ * @param nKey the key (normally the RCID) of the record.
+ * @param poRecord the record to add.
+ */
+
+void DDFRecordIndex::AddRecord(int nKey, DDFRecord *poRecord)
+
+{
+  if (nRecordCount == nRecordMax) {
+    nRecordMax = (int)(nRecordCount * 1.3 + 100);
+    pasRecords = (DDFIndexedRecord *)CPLRealloc(
+        pasRecords, sizeof(DDFIndexedRecord) * nRecordMax);
+  }
+
+  bSorted = FALSE;
+
+  pasRecords[nRecordCount].nKey = nKey;
+  pasRecords[nRecordCount].poRecord = poRecord;
+
+  nRecordCount++;
+}
+
+/************************************************************************/
+/*                             FindRecord()                             */
+/************************************************************************/
+
+/**
+ * Find the record with the given key.
+ *
+ * The index is sorted on demand, so a lookup following a series of
+ * AddRecord() calls costs one sort, and later lookups are binary searches.
+ *
+ * @param nKey the key to search for.
+ *
+ * @return the record, still owned by the index, or NULL if not found.
+ */
+
+DDFRecord *DDFRecordIndex::FindRecord(int nKey)
+
+{
+  if (!bSorted) Sort();
+
+  /* -------------------------------------------------------------------- */
+  /*      Do a binary search based on the key to find the desired record. */
+  /* -------------------------------------------------------------------- */
+  int nMinIndex = 0, nMaxIndex = nRecordCount - 1;
+
+  while (nMinIndex <= nMaxIndex) {
+    int nTestIndex = (nMaxIndex + nMinIndex) / 2;
+
+    if (pasRecords[nTestIndex].nKey < nKey)
+      nMinIndex = nTestIndex + 1;
+    else if (pasRecords[nTestIndex].nKey > nKey)
+      nMaxIndex = nTestIndex - 1;
+    else
+      return pasRecords[nTestIndex].poRecord;
+  }
+
+  return NULL;
+}
+
+/************************************************************************/
+/*                            RemoveRecord()                            */
+/************************************************************************/
+
+/**
+ * Remove, and delete, the record with the given key.
+ *
+ * @param nKey the key of the record to remove.
+ *
+ * @return TRUE if the record was found and removed, otherwise FALSE.
+ */
+
+int DDFRecordIndex::RemoveRecord(int nKey)
+
+{
+  if (!bSorted) Sort();
+
+  /* -------------------------------------------------------------------- */
+  /*      Do a binary search based on the key to find the desired record. */
+  /* -------------------------------------------------------------------- */
+  int nMinIndex = 0, nMaxIndex = nRecordCount - 1;
+  int nTestIndex = 0;
+
+  while (nMinIndex <= nMaxIndex) {
+    nTestIndex = (nMaxIndex + nMinIndex) / 2;
+
+    if (pasRecords[nTestIndex].nKey < nKey)
+      nMinIndex = nTestIndex + 1;
+    else if (pasRecords[nTestIndex].nKey > nKey)
+      nMaxIndex = nTestIndex - 1;
+    else
+      break;
+  }
+
+  if (nMinIndex > nMaxIndex) return FALSE;
+
+  /* -------------------------------------------------------------------- */
+  /*      Delete this record, and shift the following ones down.          */
+  /* -------------------------------------------------------------------- */
+  delete pasRecords[nTestIndex].poRecord;
+
+  memmove(pasRecords + nTestIndex, pasRecords + nTestIndex + 1,
+          (nRecordCount - nTestIndex - 1) * sizeof(DDFIndexedRecord));
+
+  nRecordCount--;
+
+  return TRUE;
+}
+
+/************************************************************************/
+/*                             DDFCompare()                             */
+/*                                                                      */
+/*      Compare two DDFIndexedRecord objects for qsort().               */
+/************************************************************************/
+
+static int DDFCompare(const void *pRec1, const void *pRec2)
+
+{
+  const DDFIndexedRecord *psRec1 = (const DDFIndexedRecord *)pRec1;
+  const DDFIndexedRecord *psRec2 = (const DDFIndexedRecord *)pRec2;
+
+  if (psRec1->nKey == psRec2->nKey)
+    return 0;
+  else if (psRec1->nKey < psRec2->nKey)
+    return -1;
+  else
+    return 1;
+}
+
+/************************************************************************/
+/*                                Sort()                                */
+/************************************************************************/
+
+void DDFRecordIndex::Sort()
+
+{
+  if (bSorted) return;
+
+  if (nRecordCount > 1)
+    qsort(pasRecords, nRecordCount, sizeof(DDFIndexedRecord), DDFCompare);
+
+  bSorted = TRUE;
+}
+
+/************************************************************************/
+/*                             GetByIndex()                             */
+/************************************************************************/
+
+/**
+ * Fetch a record by its position in the index.
+ *
+ * @param i the position, between 0 and GetCount()-1.  Records are
+ * returned in ascending key order.
+ *
+ * @return the record, or NULL if the position is out of range.
+ */
+
+DDFRecord *DDFRecordIndex::GetByIndex(int i)
+
+{
+  if (!bSorted) Sort();
+
+  if (i < 0 || i >= nRecordCount) return NULL;
+
+  return pasRecords[i].poRecord;
+}
@@ -702,6 +702,272 @@ int DDFSubfieldDefn::ExtractIntData(const char *pachSourceData, int nMaxBytes,
   return 0;
 }
 
+/************************************************************************/
+/*                          Subfield decoders                           */
+/*                                                                      */
+/*      Converters for fixed width subfields, returned by               */
+/*      GetIntDecoder() and GetFloatDecoder().  These give the same     */
+/*      results as ExtractIntData() and ExtractFloatData(), without     */
+/*      interpreting the format string for every value.                 */
+/************************************************************************/
+
+static int DDFDecodeAsciiInt(const char *pachData, int nWidth)
+
+{
+  char szValue[64];
+
+  memcpy(szValue, pachData, nWidth);
+  szValue[nWidth] = '\0';
+
+  return atoi(szValue);
+}
+
+static double DDFDecodeAsciiFloat(const char *pachData, int nWidth)
+
+{
+  char szValue[64];
+
+  memcpy(szValue, pachData, nWidth);
+  szValue[nWidth] = '\0';
+
+  return atof(szValue);
+}
+
+// 'b' subfields are little endian (LSB first), 'B' subfields big endian.
+
+static GUInt32 DDFGetLSB(const char *pachData, int nWidth)
+
+{
+  const unsigned char *pabyData = (const unsigned char *)pachData;
+  GUInt32 nValue = 0;
+
+  for (int i = nWidth - 1; i >= 0; i--) nValue = (nValue << 8) | pabyData[i];
+
+  return nValue;
+}
+
+static GUInt32 DDFGetMSB(const char *pachData, int nWidth)
+
+{
+  const unsigned char *pabyData = (const unsigned char *)pachData;
+  GUInt32 nValue = 0;
+
+  for (int i = 0; i < nWidth; i++) nValue = (nValue << 8) | pabyData[i];
+
+  return nValue;
+}
+
+static GInt32 DDFSignExtend(GUInt32 nValue, int nWidth)
+
+{
+  int nShift = 32 - 8 * nWidth;
+
+  return ((GInt32)(nValue << nShift)) >> nShift;
+}
+
+static int DDFDecodeUIntLSB(const char *pachData, int nWidth)
+
+{
+  return (int)DDFGetLSB(pachData, nWidth);
+}
+
+static int DDFDecodeUIntMSB(const char *pachData, int nWidth)
+
+{
+  return (int)DDFGetMSB(pachData, nWidth);
+}
+
+static int DDFDecodeSIntLSB(const char *pachData, int nWidth)
+
+{
+  return DDFSignExtend(DDFGetLSB(pachData, nWidth), nWidth);
+}
+
+static int DDFDecodeSIntMSB(const char *pachData, int nWidth)
+
+{
+  return DDFSignExtend(DDFGetMSB(pachData, nWidth), nWidth);
+}
+
+static double DDFDecodeUIntLSBFloat(const char *pachData, int nWidth)
+
+{
+  return DDFGetLSB(pachData, nWidth);
+}
+
+static double DDFDecodeUIntMSBFloat(const char *pachData, int nWidth)
+
+{
+  return DDFGetMSB(pachData, nWidth);
+}
+
+static double DDFDecodeSIntLSBFloat(const char *pachData, int nWidth)
+
+{
+  return DDFSignExtend(DDFGetLSB(pachData, nWidth), nWidth);
+}
+
+static double DDFDecodeSIntMSBFloat(const char *pachData, int nWidth)
+
+{
+  return DDFSignExtend(DDFGetMSB(pachData, nWidth), nWidth);
+}
+
+static double DDFDecodeReal(const char *pachData, int nWidth, int bLSB)
+
+{
+  unsigned char abyData[8];
+
+#ifdef CPL_LSB
+  int bSwap = !bLSB;
+#else
+  int bSwap = bLSB;
+#endif
+
+  if (bSwap) {
+    for (int i = 0; i < nWidth; i++) abyData[nWidth - i - 1] = pachData[i];
+  } else {
+    memcpy(abyData, pachData, nWidth);
+  }
+
+  if (nWidth == 4) {
+    float fValue;
+
+    memcpy(&fValue, abyData, 4);
+    return fValue;
+  } else {
+    double dfValue;
+
+    memcpy(&dfValue, abyData, 8);
+    return dfValue;
+  }
+}
+
+static double DDFDecodeRealLSB(const char *pachData, int nWidth)
+
+{
+  return DDFDecodeReal(pachData, nWidth, TRUE);
+}
+
+static double DDFDecodeRealMSB(const char *pachData, int nWidth)
+
+{
+  return DDFDecodeReal(pachData, nWidth, FALSE);
+}
+
+static int DDFDecodeRealLSBInt(const char *pachData, int nWidth)
+
+{
+  return (int)DDFDecodeReal(pachData, nWidth, TRUE);
+}
+
+static int DDFDecodeRealMSBInt(const char *pachData, int nWidth)
+
+{
+  return (int)DDFDecodeReal(pachData, nWidth, FALSE);
+}
+
+/************************************************************************/
+/*                           GetIntDecoder()                            */
+/************************************************************************/
+
+/**
+ * Fetch a converter for the integer value of this subfield.
+ *
+ * The converter is called with a pointer to the subfield data and
+ * GetWidth(), and returns the same value as ExtractIntData().  The caller
+ * must ensure GetWidth() bytes are available.
+ *
+ * @return the converter, or NULL for variable width subfields and formats
+ * without a fast path.
+ */
+
+DDFIntDecoder DDFSubfieldDefn::GetIntDecoder()
+
+{
+  if (bIsVariable || nFormatWidth <= 0) return NULL;
+
+  int bLSB = pszFormatString[0] == 'b';
+
+  switch (pszFormatString[0]) {
+    case 'A':
+    case 'C':
+    case 'I':
+    case 'R':
+    case 'S':
+      if (nFormatWidth < 64) return DDFDecodeAsciiInt;
+      return NULL;
+
+    case 'B':
+    case 'b':
+      if (eBinaryFormat == UInt &&
+          (nFormatWidth == 1 || nFormatWidth == 2 || nFormatWidth == 4))
+        return bLSB ? DDFDecodeUIntLSB : DDFDecodeUIntMSB;
+
+      if (eBinaryFormat == SInt &&
+          (nFormatWidth == 1 || nFormatWidth == 2 || nFormatWidth == 4))
+        return bLSB ? DDFDecodeSIntLSB : DDFDecodeSIntMSB;
+
+      if (eBinaryFormat == FloatReal && (nFormatWidth == 4 || nFormatWidth == 8))
+        return bLSB ? DDFDecodeRealLSBInt : DDFDecodeRealMSBInt;
+
+      return NULL;
+
+    default:
+      return NULL;
+  }
+}
+
+/************************************************************************/
+/*                          GetFloatDecoder()                           */
+/************************************************************************/
+
+/**
+ * Fetch a converter for the floating point value of this subfield.
+ *
+ * Like GetIntDecoder(), but the converter returns the same value as
+ * ExtractFloatData().
+ *
+ * @return the converter, or NULL for variable width subfields and formats
+ * without a fast path.
+ */
+
+DDFFloatDecoder DDFSubfieldDefn::GetFloatDecoder()
+
+{
+  if (bIsVariable || nFormatWidth <= 0) return NULL;
+
+  int bLSB = pszFormatString[0] == 'b';
+
+  switch (pszFormatString[0]) {
+    case 'A':
+    case 'C':
+    case 'I':
+    case 'R':
+    case 'S':
+      if (nFormatWidth < 64) return DDFDecodeAsciiFloat;
+      return NULL;
+
+    case 'B':
+    case 'b':
+      if (eBinaryFormat == UInt &&
+          (nFormatWidth == 1 || nFormatWidth == 2 || nFormatWidth == 4))
+        return bLSB ? DDFDecodeUIntLSBFloat : DDFDecodeUIntMSBFloat;
+
+      if (eBinaryFormat == SInt &&
+          (nFormatWidth == 1 || nFormatWidth == 2 || nFormatWidth == 4))
+        return bLSB ? DDFDecodeSIntLSBFloat : DDFDecodeSIntMSBFloat;
+
+      if (eBinaryFormat == FloatReal && (nFormatWidth == 4 || nFormatWidth == 8))
+        return bLSB ? DDFDecodeRealLSB : DDFDecodeRealMSB;
+
+      return NULL;
+
+    default:
+      return NULL;
+  }
+}
+
 /************************************************************************/
 /*                              DumpData()                              */
 /*                                                                      */
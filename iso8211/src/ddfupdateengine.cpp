@@ -0,0 +1,813 @@
+/******************************************************************************
+ *
+ * Project:  ISO 8211 Access
+ * Purpose:  Implements the DDFUpdateEngine class, applying S-57 update
+ *           files to a base cell.
+ *
+ ******************************************************************************
+ * Copyright (c) 2024, OpenCPN development team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ******************************************************************************
+ *
+ */
+
+#include "iso8211.h"
+#include "cpl_conv.h"
+#include "cpl_vsi.h"
+
+/* -------------------------------------------------------------------- */
+/*      S-57 record names (RCNM) of the indexed record types.           */
+/* -------------------------------------------------------------------- */
+#define RCNM_FE 100 /* Feature record */
+#define RCNM_VI 110 /* Isolated node */
+#define RCNM_VC 120 /* Connected node */
+#define RCNM_VE 130 /* Edge */
+#define RCNM_VF 140 /* Face */
+
+/* -------------------------------------------------------------------- */
+/*      Record update instructions (RUIN).                              */
+/* -------------------------------------------------------------------- */
+#define RUIN_INSERT 1
+#define RUIN_DELETE 2
+#define RUIN_MODIFY 3
+
+/************************************************************************/
+/*                          DDFUpdateEngine()                           */
+/************************************************************************/
+
+DDFUpdateEngine::DDFUpdateEngine()
+
+{
+  nEdition = 0;
+  nUpdateNumber = 0;
+
+  nHeaderRecordCount = 0;
+  papoHeaderRecords = NULL;
+}
+
+/************************************************************************/
+/*                          ~DDFUpdateEngine()                          */
+/************************************************************************/
+
+DDFUpdateEngine::~DDFUpdateEngine()
+
+{
+  Close();
+}
+
+/************************************************************************/
+/*                               Close()                                */
+/************************************************************************/
+
+/**
+ * Discard all records and close the base module.
+ */
+
+void DDFUpdateEngine::Close()
+
+{
+  oVI_Index.Clear();
+  oVC_Index.Clear();
+  oVE_Index.Clear();
+  oVF_Index.Clear();
+  oFE_Index.Clear();
+
+  for (int i = 0; i < nHeaderRecordCount; i++) delete papoHeaderRecords[i];
+  CPLFree(papoHeaderRecords);
+  papoHeaderRecords = NULL;
+  nHeaderRecordCount = 0;
+
+  oModule.Close();
+  oArena.Release();
+
+  nEdition = 0;
+  nUpdateNumber = 0;
+}
+
+/************************************************************************/
+/*                                Open()                                */
+/************************************************************************/
+
+/**
+ * Read a base cell, or a previously merged cell, into memory.
+ *
+ * All vector (VRID) and feature (FRID) records are cloned into indexes
+ * keyed by RCID, other records (DSID, DSPM, ...) are kept in file order.
+ *
+ * @param pszFilename the cell to read.
+ *
+ * @return TRUE on success or FALSE on failure.
+ */
+
+int DDFUpdateEngine::Open(const char *pszFilename)
+
+{
+  Close();
+
+  if (!oModule.Open(pszFilename)) return FALSE;
+
+  oModule.SetArena(&oArena);
+
+  DDFRecord *poRecord;
+
+  while ((poRecord = oModule.ReadRecord()) != NULL) {
+    if (poRecord->GetFieldCount() < 2) continue;
+
+    const char *pszKey = poRecord->GetField(1)->GetFieldDefn()->GetName();
+
+    if (EQUAL(pszKey, "VRID") || EQUAL(pszKey, "FRID")) {
+      int nRCNM = poRecord->GetIntSubfield(pszKey, 0, "RCNM", 0);
+      int nRCID = poRecord->GetIntSubfield(pszKey, 0, "RCID", 0);
+      DDFRecordIndex *poIndex = GetIndex(nRCNM);
+
+      if (poIndex == NULL) {
+        CPLDebug("ISO8211", "Skipping record with unexpected RCNM=%d.",
+                 nRCNM);
+        continue;
+      }
+
+      poIndex->AddRecord(nRCID, poRecord->Clone());
+    } else {
+      if (EQUAL(pszKey, "DSID")) {
+        nEdition = poRecord->GetIntSubfield("DSID", 0, "EDTN", 0);
+        nUpdateNumber = poRecord->GetIntSubfield("DSID", 0, "UPDN", 0);
+      }
+
+      AddHeaderRecord(poRecord->Clone());
+    }
+  }
+
+  return TRUE;
+}
+
+/************************************************************************/
+/*                          AddHeaderRecord()                           */
+/************************************************************************/
+
+void DDFUpdateEngine::AddHeaderRecord(DDFRecord *poRecord)
+
+{
+  nHeaderRecordCount++;
+  papoHeaderRecords = (DDFRecord **)CPLRealloc(
+      papoHeaderRecords, sizeof(void *) * nHeaderRecordCount);
+  papoHeaderRecords[nHeaderRecordCount - 1] = poRecord;
+}
+
+/************************************************************************/
+/*                          FindHeaderRecord()                          */
+/************************************************************************/
+
+DDFRecord *DDFUpdateEngine::FindHeaderRecord(const char *pszKey)
+
+{
+  for (int i = 0; i < nHeaderRecordCount; i++) {
+    if (papoHeaderRecords[i]->FindField(pszKey) != NULL)
+      return papoHeaderRecords[i];
+  }
+
+  return NULL;
+}
+
+/************************************************************************/
+/*                              GetIndex()                              */
+/************************************************************************/
+
+/**
+ * Fetch the index holding records of one type.
+ *
+ * @param nRCNM the record name, ie. 100 for features, 110 to 140 for
+ * vector records.
+ *
+ * @return the index, or NULL if nRCNM isn't an indexed record type.
+ */
+
+DDFRecordIndex *DDFUpdateEngine::GetIndex(int nRCNM)
+
+{
+  switch (nRCNM) {
+    case RCNM_VI:
+      return &oVI_Index;
+    case RCNM_VC:
+      return &oVC_Index;
+    case RCNM_VE:
+      return &oVE_Index;
+    case RCNM_VF:
+      return &oVF_Index;
+    case RCNM_FE:
+      return &oFE_Index;
+    default:
+      return NULL;
+  }
+}
+
+/************************************************************************/
+/*                             FindRecord()                             */
+/************************************************************************/
+
+/**
+ * Find a vector or feature record.
+ *
+ * @param nRCNM the record name.
+ * @param nRCID the record identifier.
+ *
+ * @return the record, owned by the engine, or NULL if not found.
+ */
+
+DDFRecord *DDFUpdateEngine::FindRecord(int nRCNM, int nRCID)
+
+{
+  DDFRecordIndex *poIndex = GetIndex(nRCNM);
+
+  if (poIndex == NULL) return NULL;
+
+  return poIndex->FindRecord(nRCID);
+}
+
+/************************************************************************/
+/*                            ApplyUpdate()                             */
+/************************************************************************/
+
+/**
+ * Apply one update file to the cell.
+ *
+ * The update must belong to the same edition as the cell.  An update
+ * which has already been applied (UPDN not above GetUpdateNumber()) is
+ * silently skipped.  An update which would leave a gap in the sequence
+ * is refused.
+ *
+ * The update number and date of the cell only advance once the whole
+ * file has been read and every record in it applied.  If a record fails
+ * to apply, or the file can't be read to its end, FALSE is returned and
+ * GetUpdateNumber() is unchanged; the records applied before the failure
+ * remain, so the cell should be reopened before it is written.
+ *
+ * @param pszFilename the update file, ie. US5XX01M.001.
+ *
+ * @return TRUE on success or FALSE on failure.
+ */
+
+int DDFUpdateEngine::ApplyUpdate(const char *pszFilename)
+
+{
+  VSIStatBuf sStat;
+
+  if (VSIStat(pszFilename, &sStat) != 0) {
+    CPLError(CE_Failure, CPLE_OpenFailed, "Unable to stat `%s'.",
+             pszFilename);
+    return FALSE;
+  }
+
+  DDFModule oUpdateModule;
+
+  if (!oUpdateModule.Open(pszFilename)) return FALSE;
+
+  DDFRecord *poRecord;
+  int bSeenDSID = FALSE;
+  int nUPDN = 0;
+  char *pszUPDN = NULL;
+  char *pszUADT = NULL;
+  int nFailedCount = 0;
+
+  CPLErrorReset();
+  while ((poRecord = oUpdateModule.ReadRecord()) != NULL) {
+    if (poRecord->GetFieldCount() < 2) continue;
+
+    DDFField *poKeyField = poRecord->GetField(1);
+    const char *pszKey = poKeyField->GetFieldDefn()->GetName();
+
+    /* -------------------------------------------------------------------- */
+    /*      Check the update sequence against the DSID of the update.       */
+    /* -------------------------------------------------------------------- */
+    if (EQUAL(pszKey, "DSID")) {
+      int nUpdateEdition = poRecord->GetIntSubfield("DSID", 0, "EDTN", 0);
+
+      nUPDN = poRecord->GetIntSubfield("DSID", 0, "UPDN", 0);
+
+      if (nUpdateEdition != nEdition) {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Update `%s' is for edition %d, cell is edition %d.",
+                 pszFilename, nUpdateEdition, nEdition);
+        return FALSE;
+      }
+
+      if (nUPDN <= nUpdateNumber) {
+        CPLDebug("ISO8211", "Update %d already applied, skipping `%s'.",
+                 nUPDN, pszFilename);
+        return TRUE;
+      }
+
+      if (nUPDN != nUpdateNumber + 1) {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Update `%s' is number %d, expected %d.", pszFilename, nUPDN,
+                 nUpdateNumber + 1);
+        return FALSE;
+      }
+
+      /* -------------------------------------------------------------------- */
+      /*      Keep the update number and date for our own DSID, they are      */
+      /*      only carried over once the whole update has applied.            */
+      /* -------------------------------------------------------------------- */
+      CPLFree(pszUPDN);
+      CPLFree(pszUADT);
+      pszUPDN = CPLStrdup(poRecord->GetStringSubfield("DSID", 0, "UPDN", 0));
+      pszUADT = CPLStrdup(poRecord->GetStringSubfield("DSID", 0, "UADT", 0));
+
+      bSeenDSID = TRUE;
+      continue;
+    }
+
+    if (!EQUAL(pszKey, "VRID") && !EQUAL(pszKey, "FRID")) continue;
+
+    if (!bSeenDSID) {
+      CPLError(CE_Failure, CPLE_AppDefined,
+               "Update `%s' has no DSID record ahead of its data records.",
+               pszFilename);
+      return FALSE;
+    }
+
+    /* -------------------------------------------------------------------- */
+    /*      Locate the index this record belongs in.                        */
+    /* -------------------------------------------------------------------- */
+    int nRCNM = poRecord->GetIntSubfield(pszKey, 0, "RCNM", 0);
+    int nRCID = poRecord->GetIntSubfield(pszKey, 0, "RCID", 0);
+    int nRVER = poRecord->GetIntSubfield(pszKey, 0, "RVER", 0);
+    int nRUIN = poRecord->GetIntSubfield(pszKey, 0, "RUIN", 0);
+    DDFRecordIndex *poIndex = GetIndex(nRCNM);
+
+    if (poIndex == NULL) {
+      CPLError(CE_Warning, CPLE_AppDefined,
+               "Update record with unexpected RCNM=%d in `%s', skipped.",
+               nRCNM, pszFilename);
+      nFailedCount++;
+      continue;
+    }
+
+    /* -------------------------------------------------------------------- */
+    /*      Apply the instruction.                                          */
+    /* -------------------------------------------------------------------- */
+    if (nRUIN == RUIN_INSERT) {
+      DDFRecord *poClone = poRecord->CloneOn(&oModule);
+
+      if (poClone == NULL) {
+        CPLError(CE_Warning, CPLE_AppDefined,
+                 "Insert of RCNM=%d/RCID=%d uses fields unknown to the base "
+                 "cell, skipped.",
+                 nRCNM, nRCID);
+        nFailedCount++;
+        continue;
+      }
+
+      if (poIndex->FindRecord(nRCID) != NULL) {
+        CPLDebug("ISO8211", "Insert replaces existing RCNM=%d/RCID=%d.",
+                 nRCNM, nRCID);
+        poIndex->RemoveRecord(nRCID);
+      }
+
+      poIndex->AddRecord(nRCID, poClone);
+    } else if (nRUIN == RUIN_DELETE) {
+      DDFRecord *poTarget = poIndex->FindRecord(nRCID);
+
+      if (poTarget == NULL) {
+        CPLError(CE_Warning, CPLE_AppDefined,
+                 "Can't find RCNM=%d/RCID=%d for delete update.", nRCNM,
+                 nRCID);
+        nFailedCount++;
+      } else if (poTarget->GetIntSubfield(pszKey, 0, "RVER", 0) !=
+                 nRVER - 1) {
+        CPLError(CE_Warning, CPLE_AppDefined,
+                 "Mismatched RVER value on RCNM=%d/RCID=%d for delete "
+                 "update.",
+                 nRCNM, nRCID);
+        nFailedCount++;
+      } else {
+        poIndex->RemoveRecord(nRCID);
+      }
+    } else if (nRUIN == RUIN_MODIFY) {
+      DDFRecord *poTarget = poIndex->FindRecord(nRCID);
+
+      if (poTarget == NULL) {
+        CPLError(CE_Warning, CPLE_AppDefined,
+                 "Can't find RCNM=%d/RCID=%d for update.", nRCNM, nRCID);
+        nFailedCount++;
+      } else if (!ApplyRecordUpdate(poTarget, poRecord)) {
+        CPLError(CE_Warning, CPLE_AppDefined,
+                 "An update to RCNM=%d/RCID=%d failed.", nRCNM, nRCID);
+        nFailedCount++;
+      }
+    } else {
+      CPLError(CE_Warning, CPLE_AppDefined,
+               "Unknown RUIN=%d on RCNM=%d/RCID=%d, skipped.", nRUIN, nRCNM,
+               nRCID);
+      nFailedCount++;
+    }
+  }
+
+  if (!bSeenDSID) {
+    CPLError(CE_Failure, CPLE_AppDefined, "Update `%s' has no DSID record.",
+             pszFilename);
+    return FALSE;
+  }
+
+  /* -------------------------------------------------------------------- */
+  /*      A read error, or a truncated file, stops ReadRecord() early     */
+  /*      just like the end of the file.                                  */
+  /* -------------------------------------------------------------------- */
+  if (nFailedCount > 0 || CPLGetLastErrorNo() != CPLE_None ||
+      VSIFTell(oUpdateModule.GetFP()) < (long)sStat.st_size) {
+    if (nFailedCount > 0)
+      CPLError(CE_Failure, CPLE_AppDefined,
+               "%d records of update `%s' failed to apply.", nFailedCount,
+               pszFilename);
+    else
+      CPLError(CE_Failure, CPLE_FileIO,
+               "Failed to read update `%s' to its end.", pszFilename);
+
+    CPLFree(pszUPDN);
+    CPLFree(pszUADT);
+    return FALSE;
+  }
+
+  /* -------------------------------------------------------------------- */
+  /*      Carry the update number and date over into our own DSID.        */
+  /* -------------------------------------------------------------------- */
+  DDFRecord *poDSID = FindHeaderRecord("DSID");
+
+  if (poDSID != NULL) {
+    poDSID->SetStringSubfield("DSID", 0, "UPDN", 0, pszUPDN);
+    poDSID->SetStringSubfield("DSID", 0, "UADT", 0, pszUADT);
+  }
+
+  nUpdateNumber = nUPDN;
+
+  CPLFree(pszUPDN);
+  CPLFree(pszUADT);
+
+  return TRUE;
+}
+
+/************************************************************************/
+/*                            ApplyUpdates()                            */
+/************************************************************************/
+
+/**
+ * Apply all pending update files of a cell.
+ *
+ * Update files are looked for next to the base cell, replacing its
+ * extension with the update number.  Application starts after
+ * GetUpdateNumber() and stops at the first missing file, so a merged cell
+ * written earlier only pays for updates issued since it was written.
+ *
+ * @param pszBaseFilename the base cell, ie. US5XX01M.000.
+ *
+ * @return TRUE on success, or FALSE if an update failed to apply.
+ */
+
+int DDFUpdateEngine::ApplyUpdates(const char *pszBaseFilename)
+
+{
+  int nBaseLen = strlen(pszBaseFilename);
+  const char *pszExtension = strrchr(pszBaseFilename, '.');
+  char *pszUpdateFilename = (char *)CPLMalloc(nBaseLen + 16);
+
+  if (pszExtension != NULL) nBaseLen = pszExtension - pszBaseFilename;
+
+  for (int iUpdate = nUpdateNumber + 1; iUpdate < 1000; iUpdate++) {
+    strncpy(pszUpdateFilename, pszBaseFilename, nBaseLen);
+    sprintf(pszUpdateFilename + nBaseLen, ".%03d", iUpdate);
+
+    FILE *fp = VSIFOpen(pszUpdateFilename, "rb");
+    if (fp == NULL) break;
+    VSIFClose(fp);
+
+    if (!ApplyUpdate(pszUpdateFilename)) {
+      CPLFree(pszUpdateFilename);
+      return FALSE;
+    }
+  }
+
+  CPLFree(pszUpdateFilename);
+
+  return TRUE;
+}
+
+/************************************************************************/
+/*                         ApplyPointerUpdate()                         */
+/*                                                                      */
+/*      Apply an insert, delete or modify of a range of fixed width     */
+/*      field instances, as used for the FSPT, FFPT, VRPT and           */
+/*      SG2D/SG3D fields.  The control field (ie. FSPC) gives the       */
+/*      instruction, the (one based) index of the first instance and    */
+/*      the number of instances.                                        */
+/************************************************************************/
+
+static int ApplyPointerUpdate(DDFRecord *poTarget, DDFRecord *poUpdate,
+                              const char *pszControlField, const char *pszUI,
+                              const char *pszIX, const char *pszN,
+                              const char *pszSrcField, const char *pszDstField)
+
+{
+  int nUI = poUpdate->GetIntSubfield(pszControlField, 0, pszUI, 0);
+  int nIX = poUpdate->GetIntSubfield(pszControlField, 0, pszIX, 0);
+  int nN = poUpdate->GetIntSubfield(pszControlField, 0, pszN, 0);
+  DDFField *poSrc = poUpdate->FindField(pszSrcField);
+  DDFField *poDst = poTarget->FindField(pszDstField);
+
+  if (poSrc == NULL && nUI != RUIN_DELETE) {
+    CPLDebug("ISO8211", "%s update without %s field.", pszControlField,
+             pszSrcField);
+    return FALSE;
+  }
+
+  /* -------------------------------------------------------------------- */
+  /*      An insert may target a field the record doesn't have yet.       */
+  /* -------------------------------------------------------------------- */
+  if (poDst == NULL) {
+    DDFFieldDefn *poDefn = poTarget->GetModule()->FindFieldDefn(pszDstField);
+
+    if (nUI != RUIN_INSERT || poDefn == NULL) {
+      CPLDebug("ISO8211", "%s update on record without %s field.",
+               pszControlField, pszDstField);
+      return FALSE;
+    }
+
+    poDst = poTarget->AddField(poDefn);
+    if (poDst == NULL) return FALSE;
+
+    // Remove the default instance created by AddField().
+    poTarget->SetFieldRaw(poDst, 0, "", 0);
+  }
+
+  int nPtrSize = poDst->GetFieldDefn()->GetFixedWidth();
+
+  if (nPtrSize == 0 || nIX < 1) {
+    CPLDebug("ISO8211", "Unsupported %s update (%s=%d).", pszControlField,
+             pszIX, nIX);
+    return FALSE;
+  }
+
+  if (nUI == RUIN_INSERT) {
+    int nInsertionBytes = nPtrSize * nN;
+
+    if (nInsertionBytes > poSrc->GetDataSize()) return FALSE;
+
+    char *pachInsertion = (char *)CPLMalloc(nInsertionBytes + nPtrSize);
+    memcpy(pachInsertion, poSrc->GetData(), nInsertionBytes);
+
+    /* -------------------------------------------------------------------- */
+    /*      If we are inserting before an instance that already exists,     */
+    /*      it is replaced by the inserted data followed by itself.         */
+    /* -------------------------------------------------------------------- */
+    if (nIX <= poDst->GetRepeatCount()) {
+      memcpy(pachInsertion + nInsertionBytes,
+             poDst->GetData() + nPtrSize * (nIX - 1), nPtrSize);
+      nInsertionBytes += nPtrSize;
+    }
+
+    int bSuccess = poTarget->SetFieldRaw(poDst, nIX - 1, pachInsertion,
+                                         nInsertionBytes);
+    CPLFree(pachInsertion);
+
+    return bSuccess;
+  } else if (nUI == RUIN_DELETE) {
+    for (int i = nN - 1; i >= 0; i--) {
+      if (!poTarget->SetFieldRaw(poDst, i + nIX - 1, "", 0)) return FALSE;
+    }
+  } else if (nUI == RUIN_MODIFY) {
+    if (nPtrSize * nN > poSrc->GetDataSize()) return FALSE;
+
+    for (int i = 0; i < nN; i++) {
+      if (!poTarget->SetFieldRaw(poDst, i + nIX - 1,
+                                 poSrc->GetData() + nPtrSize * i, nPtrSize))
+        return FALSE;
+    }
+  } else {
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/************************************************************************/
+/*                        ApplyAttributeUpdate()                        */
+/*                                                                      */
+/*      Merge the ATTF or NATF field of an update record into the       */
+/*      target.  Attributes are matched on their label (ATTL); a value  */
+/*      consisting of the delete character (0x7f) removes the           */
+/*      attribute, other values replace or append it.                   */
+/************************************************************************/
+
+static int ApplyAttributeUpdate(DDFRecord *poTarget, DDFRecord *poUpdate,
+                                const char *pszField)
+
+{
+  DDFField *poSrc = poUpdate->FindField(pszField);
+  DDFField *poDst = poTarget->FindField(pszField);
+
+  if (poSrc == NULL) return TRUE;
+
+  if (poDst == NULL) {
+    DDFFieldDefn *poDefn = poTarget->GetModule()->FindFieldDefn(pszField);
+
+    if (poDefn == NULL) return FALSE;
+
+    poDst = poTarget->AddField(poDefn);
+    if (poDst == NULL) return FALSE;
+
+    poTarget->SetFieldRaw(poDst, 0, "", 0);
+  }
+
+  int nRepeatCount = poSrc->GetRepeatCount();
+
+  for (int iAtt = 0; iAtt < nRepeatCount; iAtt++) {
+    int nATTL = poUpdate->GetIntSubfield(pszField, 0, "ATTL", iAtt);
+    int iTAtt;
+
+    for (iTAtt = poDst->GetRepeatCount() - 1; iTAtt >= 0; iTAtt--) {
+      if (poTarget->GetIntSubfield(pszField, 0, "ATTL", iTAtt) == nATTL)
+        break;
+    }
+
+    if (iTAtt == -1) iTAtt = poDst->GetRepeatCount();
+
+    int nDataBytes = 0;
+    const char *pachRawData = poSrc->GetInstanceData(iAtt, &nDataBytes);
+
+    if (pachRawData == NULL || nDataBytes < 3) return FALSE;
+
+    // ATTL is a two byte binary label, the value follows.
+    if (pachRawData[2] == 0x7f) {
+      if (iTAtt < poDst->GetRepeatCount())
+        poTarget->SetFieldRaw(poDst, iTAtt, "", 0);
+    } else {
+      if (!poTarget->SetFieldRaw(poDst, iTAtt, pachRawData, nDataBytes))
+        return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+/************************************************************************/
+/*                         ApplyRecordUpdate()                          */
+/*                                                                      */
+/*      Update one target record based on an S-57 update record         */
+/*      (RUIN=3).                                                       */
+/************************************************************************/
+
+int DDFUpdateEngine::ApplyRecordUpdate(DDFRecord *poTarget,
+                                       DDFRecord *poUpdate)
+
+{
+  const char *pszKey = poUpdate->GetField(1)->GetFieldDefn()->GetName();
+
+  /* -------------------------------------------------------------------- */
+  /*      Validate versioning.                                            */
+  /* -------------------------------------------------------------------- */
+  int nTargetRVER = poTarget->GetIntSubfield(pszKey, 0, "RVER", 0);
+
+  if (nTargetRVER + 1 != poUpdate->GetIntSubfield(pszKey, 0, "RVER", 0)) {
+    CPLDebug("ISO8211", "Mismatched RVER value on RCNM=%d/RCID=%d.",
+             poTarget->GetIntSubfield(pszKey, 0, "RCNM", 0),
+             poTarget->GetIntSubfield(pszKey, 0, "RCID", 0));
+    return FALSE;
+  }
+
+  if (!poTarget->SetIntSubfield(pszKey, 0, "RVER", 0, nTargetRVER + 1))
+    return FALSE;
+
+  /* -------------------------------------------------------------------- */
+  /*      Feature to spatial, and feature to feature pointers.            */
+  /* -------------------------------------------------------------------- */
+  if (poUpdate->FindField("FSPC") != NULL &&
+      !ApplyPointerUpdate(poTarget, poUpdate, "FSPC", "FSUI", "FSIX", "NSPT",
+                          "FSPT", "FSPT"))
+    return FALSE;
+
+  if (poUpdate->FindField("FFPC") != NULL &&
+      !ApplyPointerUpdate(poTarget, poUpdate, "FFPC", "FFUI", "FFIX", "NFPT",
+                          "FFPT", "FFPT"))
+    return FALSE;
+
+  /* -------------------------------------------------------------------- */
+  /*      Vector record pointers.                                         */
+  /* -------------------------------------------------------------------- */
+  if (poUpdate->FindField("VRPC") != NULL &&
+      !ApplyPointerUpdate(poTarget, poUpdate, "VRPC", "VPUI", "VPIX", "NVPT",
+                          "VRPT", "VRPT"))
+    return FALSE;
+
+  /* -------------------------------------------------------------------- */
+  /*      Coordinates.  The target determines whether these are 2D or     */
+  /*      3D (soundings), a record without any gets SG2D.                 */
+  /* -------------------------------------------------------------------- */
+  if (poUpdate->FindField("SGCC") != NULL) {
+    const char *pszCoordField = "SG2D";
+
+    if (poTarget->FindField("SG2D") == NULL &&
+        (poTarget->FindField("SG3D") != NULL ||
+         poUpdate->FindField("SG3D") != NULL))
+      pszCoordField = "SG3D";
+
+    if (!ApplyPointerUpdate(poTarget, poUpdate, "SGCC", "CCUI", "CCIX",
+                            "CCNC", pszCoordField, pszCoordField))
+      return FALSE;
+  }
+
+  /* -------------------------------------------------------------------- */
+  /*      Attributes.                                                     */
+  /* -------------------------------------------------------------------- */
+  if (!ApplyAttributeUpdate(poTarget, poUpdate, "ATTF")) return FALSE;
+
+  if (!ApplyAttributeUpdate(poTarget, poUpdate, "NATF")) return FALSE;
+
+  return TRUE;
+}
+
+/************************************************************************/
+/*                               Write()                                */
+/************************************************************************/
+
+/**
+ * Write the merged cell.
+ *
+ * The cell is written as a new ISO 8211 file using the field definitions
+ * of the base cell.  Header records come first in their original order,
+ * followed by the vector records and then the feature records, each in
+ * RCID order.
+ *
+ * @param pszFilename the file to create.
+ *
+ * @return TRUE on success or FALSE on failure.
+ */
+
+int DDFUpdateEngine::Write(const char *pszFilename)
+
+{
+  if (oModule.GetFieldCount() == 0) return FALSE;
+
+  /* -------------------------------------------------------------------- */
+  /*      Replicate the field definitions on the output module.           */
+  /* -------------------------------------------------------------------- */
+  DDFModule oOutModule;
+
+  oOutModule.Initialize();
+
+  for (int i = 0; i < oModule.GetFieldCount(); i++) {
+    DDFFieldDefn *poSrcDefn = oModule.GetField(i);
+    DDFFieldDefn *poDefn = new DDFFieldDefn();
+
+    poDefn->Create(poSrcDefn->GetName(), poSrcDefn->GetDescription(),
+                   poSrcDefn->GetArrayDescr(), poSrcDefn->GetDataStructCode(),
+                   poSrcDefn->GetDataTypeCode(),
+                   poSrcDefn->GetFormatControls());
+    oOutModule.AddField(poDefn);
+  }
+
+  if (!oOutModule.Create(pszFilename)) return FALSE;
+
+  /* -------------------------------------------------------------------- */
+  /*      Write the records.                                              */
+  /* -------------------------------------------------------------------- */
+  DDFRecordIndex *apoIndexes[] = {&oVI_Index, &oVC_Index, &oVE_Index,
+                                  &oVF_Index, &oFE_Index};
+  int bSuccess = TRUE;
+
+  for (int i = 0; bSuccess && i < nHeaderRecordCount; i++) {
+    DDFRecord *poCopy = papoHeaderRecords[i]->CloneOn(&oOutModule);
+
+    bSuccess = poCopy != NULL && poCopy->Write();
+    delete poCopy;
+  }
+
+  for (int iIndex = 0; bSuccess && iIndex < 5; iIndex++) {
+    DDFRecordIndex *poIndex = apoIndexes[iIndex];
+
+    for (int i = 0; bSuccess && i < poIndex->GetCount(); i++) {
+      DDFRecord *poCopy = poIndex->GetByIndex(i)->CloneOn(&oOutModule);
+
+      bSuccess = poCopy != NULL && poCopy->Write();
+      delete poCopy;
+    }
+  }
+
+  oOutModule.Close();
+
+  return bSuccess;
+}
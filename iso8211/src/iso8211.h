@@ -39,6 +39,24 @@
     */
 typedef enum { DDFInt, DDFFloat, DDFString, DDFBinaryString } DDFDataType;
 
+/**
+  Converters from the raw data of a fixed width subfield, see
+  DDFSubfieldDefn::GetIntDecoder().
+    */
+typedef int (*DDFIntDecoder)(const char *pachData, int nWidth);
+typedef double (*DDFFloatDecoder)(const char *pachData, int nWidth);
+
+/**
+  One step of the compiled decoding program of a field definition, see
+  DDFFieldDefn::GetDecoders().
+    */
+typedef struct {
+  int nOffset;  // Offset within a field instance, -1 if not fixed.
+  int nWidth;   // Zero for variable width subfields.
+  DDFIntDecoder pfnIntDecoder;  // NULL if there is no fast path.
+  DDFFloatDecoder pfnFloatDecoder;
+} DDFSubfieldDecoder;
+
 /************************************************************************/
 /*      These should really be private to the library ... they are      */
 /*      mostly conveniences.                                            */
@@ -61,6 +79,58 @@ class DDFSubfieldDefn;
 class DDFRecord;
 class DDFField;
 
+/************************************************************************/
+/*                               DDFArena                               */
+/************************************************************************/
+
+/**
+ * Bump allocator for record data.
+ *
+ * Memory is handed out from large blocks and is never freed individually;
+ * Release() frees everything in one call.  Attach an arena to a module
+ * with DDFModule::SetArena() to have the data of all records cloned onto
+ * that module allocated from it.
+ */
+
+class DDFArena {
+public:
+  DDFArena(int nBlockSize = 1024 * 1024);
+  ~DDFArena();
+
+  void *Allocate(int nBytes);
+  void Release();
+
+  /** Fetch the number of Allocate() calls since the last Release(). */
+  int GetAllocationCount() { return nAllocationCount; }
+
+  /** Fetch the number of bytes handed out since the last Release(). */
+  size_t GetBytesUsed() { return nBytesUsed; }
+
+  /** Fetch the number of bytes currently held in blocks. */
+  size_t GetBytesReserved() { return nBytesReserved; }
+
+  /** Fetch the largest GetBytesReserved() seen. */
+  size_t GetPeakBytesReserved() { return nPeakBytesReserved; }
+
+private:
+  char *AddBlock(int nSize);
+
+  int nBlockSize;
+
+  int nBlockCount;
+  int nBlockMax;
+  char **papachBlocks;
+
+  char *pachCurrentBlock;
+  char *pachNext;
+  int nBytesLeft;
+
+  int nAllocationCount;
+  size_t nBytesUsed;
+  size_t nBytesReserved;
+  size_t nPeakBytesReserved;
+};
+
 /************************************************************************/
 /*                              DDFModule                               */
 /************************************************************************/
@@ -86,7 +156,7 @@ public:
                  char chVersionNumber = '1', char chAppIndicator = ' ',
                  const char *pszExtendedCharSet = " ! ",
                  int nSizeFieldLength = 3, int nSizeFieldPos = 4,
-                 int nSizeFieldTag = 4);
+                 int nSizeFieldTag = 4, int nFieldControlLength = 9);
 
   void Dump(FILE *fp);
 
@@ -107,6 +177,16 @@ public:
   void AddCloneRecord(DDFRecord *);
   void RemoveCloneRecord(DDFRecord *);
 
+  /**
+   * Set the arena from which the data of records cloned onto this module
+   * is allocated, or NULL to use the heap.  The arena isn't owned by the
+   * module, and must not be released while such records are in use.
+   */
+  void SetArena(DDFArena *poArenaIn) { poArena = poArenaIn; }
+
+  /** Fetch the arena set with SetArena(), or NULL. */
+  DDFArena *GetArena() { return poArena; }
+
   // This is just for DDFRecord.
   FILE *GetFP() { return fpDDF; }
 
@@ -138,6 +218,8 @@ private:
   int nCloneCount;
   int nMaxCloneCount;
   DDFRecord **papoClones;
+
+  DDFArena *poArena;
 };
 
 /************************************************************************/
@@ -194,6 +276,22 @@ public:
    */
   const char *GetDescription() { return _fieldName; }
 
+  /** Fetch the subfield names (array descriptor) of this field.
+   * @return this is an internal copy and shouldn't be freed.
+   */
+  const char *GetArrayDescr() { return _arrayDescr; }
+
+  /** Fetch the format controls of this field.
+   * @return this is an internal copy and shouldn't be freed.
+   */
+  const char *GetFormatControls() { return _formatControls; }
+
+  /** Get the data structure code of this field. */
+  DDF_data_struct_code GetDataStructCode() { return _data_struct_code; }
+
+  /** Get the data type code of this field. */
+  DDF_data_type_code GetDataTypeCode() { return _data_type_code; }
+
   /** Get the number of subfields. */
   int GetSubfieldCount() { return nSubfieldCount; }
 
@@ -223,6 +321,20 @@ public:
 
   char *GetDefaultValue(int *pnSize);
 
+  const DDFSubfieldDecoder *GetDecoders();
+
+  /**
+   * Get the width of a field instance for the compiled decoders.
+   *
+   * @return The width in bytes if all subfields are fixed width and have
+   * a decoder, so that instances can be decoded by a simple loop over
+   * GetDecoders(), otherwise zero.
+   */
+  int GetDecoderWidth() {
+    GetDecoders();
+    return nDecoderWidth;
+  }
+
 private:
   static char *ExtractSubstring(const char *);
 
@@ -245,6 +357,11 @@ private:
 
   int nSubfieldCount;
   DDFSubfieldDefn **papoSubfields;
+
+  void CompileDecoders();
+
+  DDFSubfieldDecoder *pasDecoders;
+  int nDecoderWidth;
 };
 
 /************************************************************************/
@@ -307,6 +424,9 @@ public:
 
   int GetDefaultValue(char *pachData, int nBytesAvailable, int *pnBytesUsed);
 
+  DDFIntDecoder GetIntDecoder();
+  DDFFloatDecoder GetFloatDecoder();
+
   void Dump(FILE *fp);
 
   /**
@@ -401,6 +521,12 @@ public:
    */
   const char *GetData() { return pachData; }
 
+  /**
+   * Fetch the size of the directory at the start of GetData().  The field
+   * data follows the directory.
+   */
+  int GetFieldOffset() { return nFieldOffset; }
+
   /**
    * Fetch the DDFModule with which this record is associated.
    */
@@ -420,6 +546,10 @@ public:
 
   int Write();
 
+  // This is really just for the DDFCellCache class.
+  int Initialize(const char *pachDataIn, int nDataSizeIn, int nFieldOffsetIn,
+                 int nFieldCountIn);
+
   // This is really just for the DDFModule class.
   int Read();
   void Clear();
@@ -428,7 +558,16 @@ public:
 private:
   int ReadHeader();
 
+  DDFRecord *Duplicate(DDFArena *poArenaIn);
+
+  char *AllocateData(int nSize);
+  void FreeData(char *pachOldData);
+  int GrowData(int nNewSize);
+  DDFField *AllocateFields(int nCount);
+  void FreeFields(DDFField *paoOldFields, int nCount);
+
   DDFModule *poModule;
+  DDFArena *poArena;  // Owner of pachData and paoFields, NULL for the heap.
 
   int nReuseHeader;
 
@@ -439,9 +578,11 @@ private:
   int _sizeFieldLength;
 
   int nDataSize;  // Whole record except leader with header
+  int nDataMax;   // Allocated size of pachData.
   char *pachData;
 
   int nFieldCount;
+  int nFieldMax;  // Allocated size of paoFields.
   DDFField *paoFields;
 
   int bIsClone;
@@ -472,6 +613,9 @@ public:
 
   const char *GetInstanceData(int nInstance, int *pnSize);
 
+  int DecodeIntValues(int *panValues, int nMaxValues);
+  int DecodeFloatValues(double *padfValues, int nMaxValues);
+
   /**
    * Return the pointer to the entire data block for this record. This
    * is an internal copy, and shouldn't be freed by the application.
@@ -494,4 +638,158 @@ private:
   const char *pachData;
 };
 
+/************************************************************************/
+/*                            DDFRecordIndex                            */
+/************************************************************************/
+
+typedef struct {
+  int nKey;
+  DDFRecord *poRecord;
+} DDFIndexedRecord;
+
+/**
+ * Maintains an index of DDFRecords keyed by an integer, normally the
+ * record identifier (RCID) of one S-57 record type.  The index takes
+ * ownership of the records added to it.
+ */
+
+class DDFRecordIndex {
+public:
+  DDFRecordIndex();
+  ~DDFRecordIndex();
+
+  void AddRecord(int nKey, DDFRecord *);
+  int RemoveRecord(int nKey);
+  DDFRecord *FindRecord(int nKey);
+
+  void Clear();
+
+  /** Get the number of records in the index. */
+  int GetCount() { return nRecordCount; }
+
+  DDFRecord *GetByIndex(int i);
+
+private:
+  void Sort();
+
+  int bSorted;
+
+  int nRecordCount;
+  int nRecordMax;
+  DDFIndexedRecord *pasRecords;
+};
+
+/************************************************************************/
+/*                           DDFUpdateEngine                            */
+/************************************************************************/
+
+/**
+ * Applies S-57 update files (.001, .002, ...) to a base cell.
+ *
+ * The base cell is read once into per record type indexes, and the
+ * insert, delete and modify instructions (RUIN) of each update file are
+ * applied to those in-memory records.  The merged cell can be written back
+ * to disk with Write().  The DSID of the merged cell carries the number of
+ * the last update applied, so opening the merged cell later and calling
+ * ApplyUpdates() only applies updates issued since then.
+ */
+
+class DDFUpdateEngine {
+public:
+  DDFUpdateEngine();
+  ~DDFUpdateEngine();
+
+  int Open(const char *pszFilename);
+  void Close();
+
+  int ApplyUpdate(const char *pszFilename);
+  int ApplyUpdates(const char *pszBaseFilename);
+
+  int Write(const char *pszFilename);
+
+  /** Fetch the edition number (DSID EDTN) of the cell. */
+  int GetEdition() { return nEdition; }
+
+  /** Fetch the number of the last update (DSID UPDN) applied to the cell. */
+  int GetUpdateNumber() { return nUpdateNumber; }
+
+  DDFRecord *FindRecord(int nRCNM, int nRCID);
+  DDFRecordIndex *GetIndex(int nRCNM);
+
+  /** Fetch the module the indexed records are associated with. */
+  DDFModule *GetModule() { return &oModule; }
+
+private:
+  int ApplyRecordUpdate(DDFRecord *poTarget, DDFRecord *poUpdate);
+  void AddHeaderRecord(DDFRecord *);
+  DDFRecord *FindHeaderRecord(const char *pszKey);
+
+  DDFArena oArena;  // Data of all records held by the engine.
+  DDFModule oModule;
+
+  int nEdition;
+  int nUpdateNumber;
+
+  int nHeaderRecordCount;
+  DDFRecord **papoHeaderRecords;
+
+  DDFRecordIndex oVI_Index;
+  DDFRecordIndex oVC_Index;
+  DDFRecordIndex oVE_Index;
+  DDFRecordIndex oVF_Index;
+  DDFRecordIndex oFE_Index;
+};
+
+/************************************************************************/
+/*                             DDFCellCache                             */
+/************************************************************************/
+
+/**
+ * Binary cache of a fully decoded ISO 8211 file.
+ *
+ * Write() parses a cell once and stores its field definitions, the raw
+ * data and field directory of every record, an index of the S-57 record
+ * identifiers (RCNM, RCID) and the SG2D/SG3D coordinates decoded to native
+ * integers.  All sections are arrays of fixed size entries at 8 byte aligned
+ * offsets, so the file can be used straight from memory.
+ *
+ * Open() validates the cache against the size and modification time of the
+ * source file (and optionally a hash of its contents) and then provides the
+ * records without any directory scanning or subfield decoding.
+ */
+
+class DDFCellCache {
+public:
+  DDFCellCache();
+  ~DDFCellCache();
+
+  static int Write(const char *pszCacheFilename,
+                   const char *pszSourceFilename);
+
+  int Open(const char *pszCacheFilename, const char *pszSourceFilename,
+           int bCheckHash = FALSE);
+  void Close();
+
+  /** Fetch the module holding the field definitions of the cell. */
+  DDFModule *GetModule() { return &oModule; }
+
+  int GetRecordCount();
+  DDFRecord *GetRecord(int iRecord);
+  int FindRecord(int nRCNM, int nRCID);
+  int GetRecordId(int iRecord, int *pnRCNM, int *pnRCID);
+
+  const GInt32 *GetCoordinates(int iRecord, int *pnPointCount,
+                               int *pnDimension);
+
+  static GUInt32 HashFile(const char *pszFilename);
+
+private:
+  DDFModule oModule;
+
+  char *pachCache;
+  int nCacheSize;
+
+  DDFRecord **papoRecords;
+};
+
 #endif /* ndef _ISO8211_H_INCLUDED */
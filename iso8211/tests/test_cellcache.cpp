@@ -0,0 +1,156 @@
+/******************************************************************************
+ *
+ * Project:  ISO 8211 Access
+ * Purpose:  Tests of DDFCellCache.
+ *
+ ******************************************************************************
+ * Copyright (c) 2024, OpenCPN development team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "test_cells.h"
+#include "cpl_error.h"
+
+static const char *pszCell = "test_cellcache.000";
+static const char *pszCache = "test_cellcache.cache";
+
+/************************************************************************/
+/*                           TestRoundTrip()                            */
+/*                                                                      */
+/*      Every cached record must be identical to the one read from     */
+/*      the cell, and the keys and coordinates must be found.           */
+/************************************************************************/
+
+static int TestRoundTrip()
+
+{
+  CHECK(TestWriteCell(pszCell));
+  CHECK(DDFCellCache::Write(pszCache, pszCell));
+
+  DDFCellCache oCache;
+  DDFModule oModule;
+
+  CHECK(oCache.Open(pszCache, pszCell, TRUE));
+  CHECK(oModule.Open(pszCell));
+
+  int iRecord = 0;
+  DDFRecord *poSource;
+
+  while ((poSource = oModule.ReadRecord()) != NULL) {
+    DDFRecord *poCached = oCache.GetRecord(iRecord++);
+
+    CHECK(poCached != NULL);
+    CHECK(poCached->GetFieldCount() == poSource->GetFieldCount());
+    CHECK(poCached->GetDataSize() == poSource->GetDataSize());
+    CHECK(memcmp(poCached->GetData(), poSource->GetData(),
+                 poSource->GetDataSize()) == 0);
+
+    for (int i = 0; i < poSource->GetFieldCount(); i++) {
+      DDFField *poField = poCached->GetField(i);
+
+      CHECK(EQUAL(poField->GetFieldDefn()->GetName(),
+                  poSource->GetField(i)->GetFieldDefn()->GetName()));
+      CHECK(poField->GetRepeatCount() ==
+            poSource->GetField(i)->GetRepeatCount());
+    }
+  }
+  CHECK(iRecord == 4 && oCache.GetRecordCount() == 4);
+
+  int iEdge = oCache.FindRecord(130, 7);
+  int nPoints, nDims;
+  const GInt32 *panCoords = oCache.GetCoordinates(iEdge, &nPoints, &nDims);
+
+  CHECK(iEdge == 1);
+  CHECK(nPoints == 3 && nDims == 2);
+  CHECK(panCoords[0] == 1 && panCoords[5] == 6);
+  CHECK(oCache.FindRecord(100, 1) == 3);
+  CHECK(oCache.FindRecord(100, 2) == -1);
+  CHECK(EQUAL(oCache.GetRecord(3)->GetStringSubfield("ATTF", 0, "ATVL", 0),
+              "Buoy"));
+
+  return 0;
+}
+
+/************************************************************************/
+/*                             TestStale()                              */
+/*                                                                      */
+/*      A cache is refused once its cell has changed, or when it is    */
+/*      itself truncated.                                               */
+/************************************************************************/
+
+static int TestStale()
+
+{
+  CHECK(TestWriteCell(pszCell));
+  CHECK(DDFCellCache::Write(pszCache, pszCell));
+
+  DDFCellCache oCache;
+
+  CHECK(TestTruncateFile(pszCache, 16));
+  CHECK(!oCache.Open(pszCache, pszCell));
+
+  CHECK(DDFCellCache::Write(pszCache, pszCell));
+  FILE *fp = VSIFOpen(pszCell, "ab");
+  CHECK(fp != NULL);
+  VSIFWrite("\0", 1, 1, fp);
+  VSIFClose(fp);
+  CHECK(!oCache.Open(pszCache, pszCell));
+
+  return 0;
+}
+
+/************************************************************************/
+/*                        TestTruncatedSource()                         */
+/*                                                                      */
+/*      A cell which can't be read to its end must not be cached, and  */
+/*      a cache written from it before must be removed.                 */
+/************************************************************************/
+
+static int TestTruncatedSource()
+
+{
+  CHECK(TestWriteCell(pszCell));
+  CHECK(DDFCellCache::Write(pszCache, pszCell));
+
+  CHECK(TestTruncateFile(pszCell, 10));
+
+  CPLPushErrorHandler(CPLQuietErrorHandler);
+  int bWritten = DDFCellCache::Write(pszCache, pszCell);
+  CPLPopErrorHandler();
+
+  VSIStatBuf sStat;
+
+  CHECK(!bWritten);
+  CHECK(VSIStat(pszCache, &sStat) != 0);
+
+  return 0;
+}
+
+int main()
+
+{
+  int nFailures = TestRoundTrip() + TestStale() + TestTruncatedSource();
+
+  VSIUnlink(pszCell);
+  VSIUnlink(pszCache);
+
+  if (nFailures == 0) printf("test_cellcache: all tests passed\n");
+  return nFailures != 0;
+}
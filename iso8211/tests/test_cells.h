@@ -0,0 +1,430 @@
+/******************************************************************************
+ *
+ * Project:  ISO 8211 Access
+ * Purpose:  Helpers for the tests, writing small S-57 like cells.
+ *
+ ******************************************************************************
+ * Copyright (c) 2024, OpenCPN development team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef TEST_CELLS_H_INCLUDED
+#define TEST_CELLS_H_INCLUDED
+
+#include <stdio.h>
+#include <string.h>
+
+#include "iso8211.h"
+#include "cpl_conv.h"
+#include "cpl_string.h"
+#include "cpl_vsi.h"
+
+/* -------------------------------------------------------------------- */
+/*      Fails the current test function with a message, the tests      */
+/*      return the number of failures from main().                      */
+/* -------------------------------------------------------------------- */
+#define CHECK(x)                                                      \
+  do {                                                                \
+    if (!(x)) {                                                       \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, \
+              #x);                                                    \
+      return 1;                                                       \
+    }                                                                 \
+  } while (0)
+
+/************************************************************************/
+/*                          TestAddSubfields()                          */
+/*                                                                      */
+/*      Adds the subfields of a field definition from the '!'         */
+/*      separated list of names and the ',' separated list of formats, */
+/*      without touching its format controls.                           */
+/************************************************************************/
+
+inline void TestAddSubfields(DDFFieldDefn *poDefn, const char *pszNames,
+                             const char *pszFormats)
+
+{
+  char **papszNames =
+      CSLTokenizeStringComplex(pszNames[0] == '*' ? pszNames + 1 : pszNames,
+                               "!", FALSE, FALSE);
+  char **papszFormats = CSLTokenizeStringComplex(pszFormats, ",", FALSE, FALSE);
+
+  for (int i = 0; papszNames[i] != NULL && papszFormats[i] != NULL; i++) {
+    DDFSubfieldDefn *poSFDefn = new DDFSubfieldDefn;
+
+    poSFDefn->SetName(papszNames[i]);
+    poSFDefn->SetFormat(papszFormats[i]);
+    poDefn->AddSubfield(poSFDefn, TRUE);
+  }
+
+  CSLDestroy(papszNames);
+  CSLDestroy(papszFormats);
+}
+
+/************************************************************************/
+/*                           TestAddFieldDefn()                         */
+/************************************************************************/
+
+inline void TestAddFieldDefn(DDFModule &oModule, const char *pszTag,
+                             const char *pszName, const char *pszSubfields,
+                             DDF_data_struct_code eStruct,
+                             const char *pszFormatControls,
+                             const char *pszFormats)
+
+{
+  DDFFieldDefn *poDefn = new DDFFieldDefn();
+
+  poDefn->Create(pszTag, pszName, pszSubfields, eStruct,
+                 pszFormats ? dtc_mixed_data_type : dtc_implicit_point,
+                 pszFormatControls);
+  if (pszFormats != NULL) TestAddSubfields(poDefn, pszSubfields, pszFormats);
+  oModule.AddField(poDefn);
+}
+
+/************************************************************************/
+/*                          TestInitializeS57()                         */
+/*                                                                      */
+/*      Sets up the field definitions of an S-57 cell, restricted to   */
+/*      the fields written by the helpers below.                        */
+/************************************************************************/
+
+inline void TestInitializeS57(DDFModule &oModule)
+
+{
+  oModule.Initialize();
+
+  DDFFieldDefn *poDefn = new DDFFieldDefn();
+  poDefn->Create("0000", "",
+                 "0001DSIDDSIDDSSI0001FRIDFRIDFOIDFRIDATTFFRIDFSPCFSPCFSPT"
+                 "VRIDVRPCVRIDVRPTVRIDSG2D",
+                 dsc_elementary, dtc_char_string);
+  oModule.AddField(poDefn);
+
+  TestAddFieldDefn(oModule, "0001", "ISO 8211 Record Identifier", "",
+                   dsc_elementary, NULL, NULL);
+  TestAddFieldDefn(oModule, "DSID", "Data set identification field",
+                   "RCNM!RCID!EXPP!INTU!DSNM!EDTN!UPDN!UADT!ISDT",
+                   dsc_vector, "(b11,b14,2b11,3A,2A(8))",
+                   "b11,b14,b11,b11,A,A,A,A(8),A(8)");
+  TestAddFieldDefn(oModule, "FRID", "Feature record identifier field",
+                   "RCNM!RCID!PRIM!GRUP!OBJL!RVER!RUIN", dsc_vector,
+                   "(b11,b14,2b11,2b12,b11)", "b11,b14,b11,b11,b12,b12,b11");
+  TestAddFieldDefn(oModule, "ATTF", "Feature record attribute field",
+                   "*ATTL!ATVL", dsc_array, "(b12,A)", "b12,A");
+  TestAddFieldDefn(oModule, "FSPC",
+                   "Feature record to spatial record pointer control field",
+                   "FSUI!FSIX!NSPT", dsc_vector, "(b11,2b12)",
+                   "b11,b12,b12");
+  TestAddFieldDefn(oModule, "FSPT",
+                   "Feature record to spatial record pointer field",
+                   "*NAME!ORNT!USAG!MASK", dsc_array, "(B(40),3b11)",
+                   "B(40),b11,b11,b11");
+  TestAddFieldDefn(oModule, "VRID", "Vector record identifier field",
+                   "RCNM!RCID!RVER!RUIN", dsc_vector, "(b11,b14,b12,b11)",
+                   "b11,b14,b12,b11");
+  TestAddFieldDefn(oModule, "VRPC", "Vector record pointer control field",
+                   "VPUI!VPIX!NVPT", dsc_vector, "(b11,2b12)", "b11,b12,b12");
+  TestAddFieldDefn(oModule, "VRPT", "Vector record pointer field",
+                   "*NAME!ORNT!USAG!TOPI!MASK", dsc_array, "(B(40),4b11)",
+                   "B(40),b11,b11,b11,b11");
+  TestAddFieldDefn(oModule, "SGCC", "Coordinate control field",
+                   "CCUI!CCIX!CCNC", dsc_vector, "(b11,2b12)", "b11,b12,b12");
+  TestAddFieldDefn(oModule, "SG2D", "2-D coordinate field", "*YCOO!XCOO",
+                   dsc_array, "(2b24)", "b24,b24");
+}
+
+/************************************************************************/
+/*                             TestPutInt()                             */
+/*                                                                      */
+/*      Little endian binary subfield.                                  */
+/************************************************************************/
+
+inline int TestPutInt(char *pachData, unsigned nValue, int nBytes)
+
+{
+  for (int i = 0; i < nBytes; i++)
+    pachData[i] = (char)((nValue >> (8 * i)) & 0xff);
+  return nBytes;
+}
+
+/************************************************************************/
+/*                           TestNewRecord()                            */
+/************************************************************************/
+
+inline DDFRecord *TestNewRecord(DDFModule &oModule)
+
+{
+  DDFRecord *poRecord = new DDFRecord(&oModule);
+
+  poRecord->AddField(oModule.FindFieldDefn("0001"));
+  return poRecord;
+}
+
+/************************************************************************/
+/*                           TestSetField()                             */
+/*                                                                      */
+/*      Sets the raw data of a non repeating field, or appends one     */
+/*      instance to a repeating field, adding the field if needed.     */
+/************************************************************************/
+
+inline void TestSetField(DDFRecord *poRecord, const char *pszTag,
+                         const char *pachData, int nBytes)
+
+{
+  DDFModule *poModule = poRecord->GetModule();
+  DDFField *poField = poRecord->FindField(pszTag);
+
+  if (poField == NULL) {
+    poField = poRecord->AddField(poModule->FindFieldDefn(pszTag));
+
+    if (!poField->GetFieldDefn()->IsRepeating()) {
+      poRecord->ResizeField(poField, nBytes + 1);
+      memcpy((char *)poField->GetData(), pachData, nBytes);
+      ((char *)poField->GetData())[nBytes] = DDF_FIELD_TERMINATOR;
+      return;
+    }
+
+    poRecord->SetFieldRaw(poField, 0, pachData, nBytes);
+    return;
+  }
+
+  poRecord->SetFieldRaw(poField, poField->GetRepeatCount(), pachData, nBytes);
+}
+
+/************************************************************************/
+/*                             TestDSID()                               */
+/************************************************************************/
+
+inline void TestDSID(DDFRecord *poRecord, int nEdition, int nUpdate)
+
+{
+  char achData[64];
+  int n = 0;
+
+  n += TestPutInt(achData + n, 10, 1);
+  n += TestPutInt(achData + n, 1, 4);
+  n += TestPutInt(achData + n, 1, 1);
+  n += TestPutInt(achData + n, 1, 1);
+  n += sprintf(achData + n, "TEST.000%c%d%c%d%c", DDF_UNIT_TERMINATOR,
+               nEdition, DDF_UNIT_TERMINATOR, nUpdate, DDF_UNIT_TERMINATOR);
+  memcpy(achData + n, "2026010120260102", 16);
+  n += 16;
+
+  TestSetField(poRecord, "DSID", achData, n);
+}
+
+/************************************************************************/
+/*                             TestVRID()                               */
+/************************************************************************/
+
+inline void TestVRID(DDFRecord *poRecord, int nRCNM, int nRCID, int nRVER,
+                     int nRUIN)
+
+{
+  char achData[8];
+  int n = 0;
+
+  n += TestPutInt(achData + n, nRCNM, 1);
+  n += TestPutInt(achData + n, nRCID, 4);
+  n += TestPutInt(achData + n, nRVER, 2);
+  n += TestPutInt(achData + n, nRUIN, 1);
+
+  TestSetField(poRecord, "VRID", achData, n);
+}
+
+/************************************************************************/
+/*                             TestFRID()                               */
+/************************************************************************/
+
+inline void TestFRID(DDFRecord *poRecord, int nRCID, int nRVER, int nRUIN)
+
+{
+  char achData[12];
+  int n = 0;
+
+  n += TestPutInt(achData + n, 100, 1);
+  n += TestPutInt(achData + n, nRCID, 4);
+  n += TestPutInt(achData + n, 1, 1);   // PRIM
+  n += TestPutInt(achData + n, 1, 1);   // GRUP
+  n += TestPutInt(achData + n, 42, 2);  // OBJL
+  n += TestPutInt(achData + n, nRVER, 2);
+  n += TestPutInt(achData + n, nRUIN, 1);
+
+  TestSetField(poRecord, "FRID", achData, n);
+}
+
+/************************************************************************/
+/*                             TestATTF()                               */
+/************************************************************************/
+
+inline void TestATTF(DDFRecord *poRecord, int nATTL, const char *pszValue)
+
+{
+  char achData[256];
+  int n = TestPutInt(achData, nATTL, 2);
+
+  n += snprintf(achData + n, sizeof(achData) - n - 1, "%s", pszValue);
+  achData[n++] = DDF_UNIT_TERMINATOR;
+
+  TestSetField(poRecord, "ATTF", achData, n);
+}
+
+/************************************************************************/
+/*                             TestSG2D()                               */
+/************************************************************************/
+
+inline void TestSG2D(DDFRecord *poRecord, int nY, int nX)
+
+{
+  char achData[8];
+
+  TestPutInt(achData, nY, 4);
+  TestPutInt(achData + 4, nX, 4);
+
+  TestSetField(poRecord, "SG2D", achData, 8);
+}
+
+/************************************************************************/
+/*                           TestControl()                              */
+/*                                                                      */
+/*      Sets an update control field (FSPC, VRPC or SGCC) from its     */
+/*      instruction, the one based index and the number of instances.  */
+/************************************************************************/
+
+inline void TestControl(DDFRecord *poRecord, const char *pszTag, int nUI,
+                        int nIX, int nN)
+
+{
+  char achData[5];
+  int n = 0;
+
+  n += TestPutInt(achData + n, nUI, 1);
+  n += TestPutInt(achData + n, nIX, 2);
+  n += TestPutInt(achData + n, nN, 2);
+
+  TestSetField(poRecord, pszTag, achData, n);
+}
+
+/************************************************************************/
+/*                           TestPointer()                              */
+/*                                                                      */
+/*      Appends a FSPT or VRPT pointer to a record, its NAME followed  */
+/*      by nFlags one byte subfields (ORNT, USAG, ...) all set to 1.   */
+/************************************************************************/
+
+inline void TestPointer(DDFRecord *poRecord, const char *pszTag, int nRCNM,
+                        int nRCID, int nFlags)
+
+{
+  char achData[16];
+  int n = 0;
+
+  n += TestPutInt(achData + n, nRCNM, 1);
+  n += TestPutInt(achData + n, nRCID, 4);
+  for (int i = 0; i < nFlags; i++) n += TestPutInt(achData + n, 1, 1);
+
+  TestSetField(poRecord, pszTag, achData, n);
+}
+
+/************************************************************************/
+/*                         TestWriteRecord()                            */
+/************************************************************************/
+
+inline int TestWriteRecord(DDFRecord *poRecord)
+
+{
+  int bSuccess = poRecord->Write();
+
+  delete poRecord;
+  return bSuccess;
+}
+
+/************************************************************************/
+/*                          TestWriteCell()                             */
+/*                                                                      */
+/*      Writes a base cell with a dataset record, one edge with three  */
+/*      points, a node and a feature with two attributes.              */
+/************************************************************************/
+
+inline int TestWriteCell(const char *pszFilename)
+
+{
+  DDFModule oModule;
+
+  TestInitializeS57(oModule);
+  if (!oModule.Create(pszFilename)) return FALSE;
+
+  DDFRecord *poRecord = TestNewRecord(oModule);
+  TestDSID(poRecord, 3, 0);
+  int bSuccess = TestWriteRecord(poRecord);
+
+  poRecord = TestNewRecord(oModule);
+  TestVRID(poRecord, 130, 7, 1, 1);
+  TestSG2D(poRecord, 1, 2);
+  TestSG2D(poRecord, 3, 4);
+  TestSG2D(poRecord, 5, 6);
+  bSuccess &= TestWriteRecord(poRecord);
+
+  poRecord = TestNewRecord(oModule);
+  TestVRID(poRecord, 110, 9, 1, 1);
+  TestSG2D(poRecord, 10, 11);
+  bSuccess &= TestWriteRecord(poRecord);
+
+  poRecord = TestNewRecord(oModule);
+  TestFRID(poRecord, 1, 1, 1);
+  TestATTF(poRecord, 116, "Buoy");
+  TestATTF(poRecord, 75, "3");
+  bSuccess &= TestWriteRecord(poRecord);
+
+  oModule.Close();
+  return bSuccess;
+}
+
+/************************************************************************/
+/*                          TestTruncateFile()                          */
+/*                                                                      */
+/*      Cuts nBytes off the end of a file.                              */
+/************************************************************************/
+
+inline int TestTruncateFile(const char *pszFilename, long nBytes)
+
+{
+  FILE *fp = VSIFOpen(pszFilename, "rb");
+  if (fp == NULL) return FALSE;
+
+  VSIFSeek(fp, 0, SEEK_END);
+  long nSize = VSIFTell(fp) - nBytes;
+  char *pachData = (char *)CPLMalloc(nSize > 0 ? nSize : 1);
+
+  VSIFSeek(fp, 0, SEEK_SET);
+  int bSuccess = nSize > 0 && VSIFRead(pachData, 1, nSize, fp) == (size_t)nSize;
+  VSIFClose(fp);
+
+  if (bSuccess) {
+    fp = VSIFOpen(pszFilename, "wb");
+    bSuccess = fp != NULL && VSIFWrite(pachData, 1, nSize, fp) == (size_t)nSize;
+    if (fp != NULL) VSIFClose(fp);
+  }
+
+  CPLFree(pachData);
+  return bSuccess;
+}
+
+#endif /* ndef TEST_CELLS_H_INCLUDED */
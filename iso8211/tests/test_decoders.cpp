@@ -0,0 +1,243 @@
+/******************************************************************************
+ *
+ * Project:  ISO 8211 Access
+ * Purpose:  Tests of the compiled subfield decoders against the
+ *           ExtractIntData() and ExtractFloatData() methods.
+ *
+ ******************************************************************************
+ * Copyright (c) 2024, OpenCPN development team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include <math.h>
+
+#include "test_cells.h"
+
+static const char *pszCell = "test_decoders.000";
+
+/* -------------------------------------------------------------------- */
+/*      One fixed width field with every supported binary and ASCII    */
+/*      format, and one with a variable width subfield which has to    */
+/*      be decoded by the fallback path.                                */
+/* -------------------------------------------------------------------- */
+static const char *pszFixedNames = "*A!B!C!D!E!F!G!H!I!J!K!L!M!N!O!P";
+static const char *pszFixedFormats =
+    "b11,b12,b14,b21,b22,b24,B(16),B(32),A(3),I(5),R(6),b48,b44,B12,B24,B14";
+static const int anFixedWidths[] = {1, 2, 4, 1, 2, 4, 2, 4,
+                                    3, 5, 6, 8, 4, 2, 4, 4};
+static const int nFixedCount = 16;
+
+/************************************************************************/
+/*                              TestRandom()                            */
+/*                                                                      */
+/*      A small generator of our own, so the data is the same on all   */
+/*      platforms.                                                      */
+/************************************************************************/
+
+static unsigned TestRandom()
+
+{
+  static unsigned nState = 42;
+
+  nState = nState * 1103515245 + 12345;
+  return nState >> 8;
+}
+
+/************************************************************************/
+/*                         TestWriteFixedInstance()                     */
+/************************************************************************/
+
+static int TestWriteFixedInstance(char *pachData)
+
+{
+  int nOffset = 0;
+
+  for (int iSF = 0; iSF < nFixedCount; iSF++) {
+    char *pachSF = pachData + nOffset;
+    int nWidth = anFixedWidths[iSF];
+
+    if (iSF >= 8 && iSF <= 10) {
+      for (int i = 0; i < nWidth; i++)
+        pachSF[i] = (char)('0' + TestRandom() % 10);
+      if (iSF == 10) pachSF[2] = '.';
+    } else if (iSF == 11) {
+      double dfValue = ((double)TestRandom() - (1 << 23)) / 7.0;
+      memcpy(pachSF, &dfValue, 8);
+    } else if (iSF == 12) {
+      float fValue = (float)TestRandom() / 3.0f;
+      memcpy(pachSF, &fValue, 4);
+    } else {
+      for (int i = 0; i < nWidth; i++) pachSF[i] = (char)TestRandom();
+    }
+
+    nOffset += nWidth;
+  }
+
+  return nOffset;
+}
+
+/************************************************************************/
+/*                        TestWriteDecoderCell()                        */
+/************************************************************************/
+
+static int TestWriteDecoderCell()
+
+{
+  DDFModule oModule;
+
+  oModule.Initialize();
+  TestAddFieldDefn(oModule, "0001", "ISO 8211 Record Identifier", "",
+                   dsc_elementary, NULL, NULL);
+  TestAddFieldDefn(oModule, "FIXD", "Fixed width field", pszFixedNames,
+                   dsc_array,
+                   "(b11,b12,b14,b21,b22,b24,B(16),B(32),A(3),I(5),R(6),"
+                   "b48,b44,B12,B24,B14)",
+                   pszFixedFormats);
+  TestAddFieldDefn(oModule, "VARF", "Variable width field", "*X!S!Y",
+                   dsc_array, "(b12,A,b14)", "b12,A,b14");
+
+  if (!oModule.Create(pszCell)) return FALSE;
+
+  int bSuccess = TRUE;
+
+  for (int iRecord = 0; iRecord < 200; iRecord++) {
+    DDFRecord *poRecord = TestNewRecord(oModule);
+    char achData[64];
+    int nInstances = 1 + TestRandom() % 50;
+
+    for (int i = 0; i < nInstances; i++) {
+      int nBytes = TestWriteFixedInstance(achData);
+      TestSetField(poRecord, "FIXD", achData, nBytes);
+    }
+
+    for (int i = 0; i < 2; i++) {
+      int nChars = TestRandom() % 5;
+      int nBytes = TestPutInt(achData, TestRandom(), 2);
+
+      for (int j = 0; j < nChars; j++) achData[nBytes++] = (char)('a' + j);
+      achData[nBytes++] = DDF_UNIT_TERMINATOR;
+      nBytes += TestPutInt(achData + nBytes, TestRandom(), 4);
+
+      TestSetField(poRecord, "VARF", achData, nBytes);
+    }
+
+    bSuccess &= TestWriteRecord(poRecord);
+  }
+
+  oModule.Close();
+  return bSuccess;
+}
+
+/************************************************************************/
+/*                           TestDecoders()                             */
+/*                                                                      */
+/*      DecodeIntValues() and DecodeFloatValues() must return exactly  */
+/*      what the Extract*Data() methods return, subfield by subfield.  */
+/************************************************************************/
+
+static int TestDecoders()
+
+{
+  CHECK(TestWriteDecoderCell());
+
+  DDFModule oModule;
+  CHECK(oModule.Open(pszCell));
+  CHECK(oModule.FindFieldDefn("FIXD")->GetDecoderWidth() > 0);
+  CHECK(oModule.FindFieldDefn("VARF")->GetDecoderWidth() == 0);
+
+  static int anValues[4096];
+  static double adfValues[4096];
+  long nChecked = 0;
+  DDFRecord *poRecord;
+
+  while ((poRecord = oModule.ReadRecord()) != NULL) {
+    for (int iField = 1; iField < poRecord->GetFieldCount(); iField++) {
+      DDFField *poField = poRecord->GetField(iField);
+      DDFFieldDefn *poDefn = poField->GetFieldDefn();
+      int nSubfields = poDefn->GetSubfieldCount();
+      int nRepeats = poField->GetRepeatCount();
+
+      int nInts = poField->DecodeIntValues(anValues, 4096);
+      int nFloats = poField->DecodeFloatValues(adfValues, 4096);
+
+      CHECK(nInts == nSubfields * nRepeats);
+      CHECK(nFloats == nInts);
+
+      for (int i = 0; i < nRepeats; i++) {
+        for (int iSF = 0; iSF < nSubfields; iSF++) {
+          DDFSubfieldDefn *poSFDefn = poDefn->GetSubfield(iSF);
+          int nMaxBytes;
+          const char *pachData =
+              poField->GetSubfieldData(poSFDefn, &nMaxBytes, i);
+          int nValue = poSFDefn->ExtractIntData(pachData, nMaxBytes, NULL);
+          double dfValue =
+              poSFDefn->ExtractFloatData(pachData, nMaxBytes, NULL);
+          double dfDecoded = adfValues[i * nSubfields + iSF];
+
+          CHECK(anValues[i * nSubfields + iSF] == nValue);
+          CHECK(dfDecoded == dfValue || (isnan(dfDecoded) && isnan(dfValue)));
+          nChecked++;
+        }
+      }
+    }
+  }
+
+  CHECK(nChecked > 200 * 2 * 3);
+
+  return 0;
+}
+
+/************************************************************************/
+/*                          TestShortBuffer()                           */
+/*                                                                      */
+/*      Decoding stops at the end of the caller's buffer.              */
+/************************************************************************/
+
+static int TestShortBuffer()
+
+{
+  DDFModule oModule;
+  CHECK(oModule.Open(pszCell));
+
+  DDFRecord *poRecord = oModule.ReadRecord();
+  CHECK(poRecord != NULL);
+
+  DDFField *poField = poRecord->FindField("FIXD");
+  int anAll[4096], anFew[5];
+
+  CHECK(poField->DecodeIntValues(anAll, 4096) > 5);
+  CHECK(poField->DecodeIntValues(anFew, 5) == 5);
+  CHECK(memcmp(anAll, anFew, sizeof(anFew)) == 0);
+
+  return 0;
+}
+
+int main()
+
+{
+  int nFailures = TestDecoders();
+
+  if (nFailures == 0) nFailures += TestShortBuffer();
+
+  VSIUnlink(pszCell);
+
+  if (nFailures == 0) printf("test_decoders: all tests passed\n");
+  return nFailures != 0;
+}
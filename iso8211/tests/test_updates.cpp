@@ -0,0 +1,377 @@
+/******************************************************************************
+ *
+ * Project:  ISO 8211 Access
+ * Purpose:  Tests of DDFUpdateEngine.
+ *
+ ******************************************************************************
+ * Copyright (c) 2024, OpenCPN development team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "test_cells.h"
+#include "cpl_error.h"
+
+static const char *pszCell = "test_updates.000";
+static const char *pszUpdate1 = "test_updates.001";
+static const char *pszUpdate2 = "test_updates.002";
+static const char *pszMerged = "test_updates_merged.000";
+
+/************************************************************************/
+/*                         TestCreateUpdate()                           */
+/*                                                                      */
+/*      Creates an update file holding its dataset record, the data    */
+/*      records are written by the caller before closing the module.   */
+/************************************************************************/
+
+static int TestCreateUpdate(DDFModule &oModule, const char *pszFilename,
+                            int nEdition, int nUpdate)
+
+{
+  TestInitializeS57(oModule);
+  if (!oModule.Create(pszFilename)) return FALSE;
+
+  DDFRecord *poRecord = TestNewRecord(oModule);
+  TestDSID(poRecord, nEdition, nUpdate);
+  return TestWriteRecord(poRecord);
+}
+
+/************************************************************************/
+/*                          TestWriteUpdate1()                          */
+/*                                                                      */
+/*      Inserts a feature and an edge with pointers, deletes the node, */
+/*      and modifies the attributes of the feature and one coordinate  */
+/*      of the edge of the base cell.                                   */
+/************************************************************************/
+
+static int TestWriteUpdate1(const char *pszFilename)
+
+{
+  DDFModule oModule;
+
+  if (!TestCreateUpdate(oModule, pszFilename, 3, 1)) return FALSE;
+
+  DDFRecord *poRecord = TestNewRecord(oModule);
+  TestFRID(poRecord, 2, 1, 1);
+  TestATTF(poRecord, 116, "Light");
+  TestPointer(poRecord, "FSPT", 130, 7, 3);
+  int bSuccess = TestWriteRecord(poRecord);
+
+  poRecord = TestNewRecord(oModule);
+  TestVRID(poRecord, 130, 8, 1, 1);
+  TestPointer(poRecord, "VRPT", 110, 9, 4);
+  TestPointer(poRecord, "VRPT", 120, 4, 4);
+  TestSG2D(poRecord, 20, 21);
+  TestSG2D(poRecord, 22, 23);
+  bSuccess &= TestWriteRecord(poRecord);
+
+  poRecord = TestNewRecord(oModule);
+  TestVRID(poRecord, 110, 9, 2, 2);
+  bSuccess &= TestWriteRecord(poRecord);
+
+  poRecord = TestNewRecord(oModule);
+  TestFRID(poRecord, 1, 2, 3);
+  TestATTF(poRecord, 75, "\x7f");
+  TestATTF(poRecord, 116, "Beacon");
+  TestATTF(poRecord, 300, "new");
+  bSuccess &= TestWriteRecord(poRecord);
+
+  poRecord = TestNewRecord(oModule);
+  TestVRID(poRecord, 130, 7, 2, 3);
+  TestControl(poRecord, "SGCC", 3, 2, 1);
+  TestSG2D(poRecord, 30, 40);
+  bSuccess &= TestWriteRecord(poRecord);
+
+  oModule.Close();
+  return bSuccess;
+}
+
+/************************************************************************/
+/*                          TestWriteUpdate2()                          */
+/*                                                                      */
+/*      Pointer and coordinate inserts and deletes on the records      */
+/*      inserted by the first update.                                   */
+/************************************************************************/
+
+static int TestWriteUpdate2(const char *pszFilename)
+
+{
+  DDFModule oModule;
+
+  if (!TestCreateUpdate(oModule, pszFilename, 3, 2)) return FALSE;
+
+  DDFRecord *poRecord = TestNewRecord(oModule);
+  TestFRID(poRecord, 2, 2, 3);
+  TestControl(poRecord, "FSPC", 1, 1, 1);
+  TestPointer(poRecord, "FSPT", 130, 8, 3);
+  int bSuccess = TestWriteRecord(poRecord);
+
+  poRecord = TestNewRecord(oModule);
+  TestVRID(poRecord, 130, 8, 2, 3);
+  TestControl(poRecord, "VRPC", 2, 1, 1);
+  TestControl(poRecord, "SGCC", 1, 1, 1);
+  TestSG2D(poRecord, 50, 60);
+  bSuccess &= TestWriteRecord(poRecord);
+
+  oModule.Close();
+  return bSuccess;
+}
+
+/************************************************************************/
+/*                          TestInstructions()                          */
+/*                                                                      */
+/*      Record inserts, deletes and modifies, with pointer, coordinate */
+/*      and attribute updates.                                          */
+/************************************************************************/
+
+static int TestInstructions()
+
+{
+  CHECK(TestWriteCell(pszCell));
+  CHECK(TestWriteUpdate1(pszUpdate1));
+  CHECK(TestWriteUpdate2(pszUpdate2));
+
+  DDFUpdateEngine oEngine;
+
+  CHECK(oEngine.Open(pszCell));
+  CHECK(oEngine.GetEdition() == 3 && oEngine.GetUpdateNumber() == 0);
+
+  CHECK(oEngine.ApplyUpdate(pszUpdate1));
+  CHECK(oEngine.GetUpdateNumber() == 1);
+
+  CHECK(oEngine.FindRecord(110, 9) == NULL);
+
+  DDFRecord *poFeature = oEngine.FindRecord(100, 1);
+  CHECK(poFeature != NULL);
+  CHECK(poFeature->GetIntSubfield("FRID", 0, "RVER", 0) == 2);
+  CHECK(poFeature->FindField("ATTF")->GetRepeatCount() == 2);
+  CHECK(poFeature->GetIntSubfield("ATTF", 0, "ATTL", 0) == 116);
+  CHECK(EQUAL(poFeature->GetStringSubfield("ATTF", 0, "ATVL", 0), "Beacon"));
+  CHECK(poFeature->GetIntSubfield("ATTF", 0, "ATTL", 1) == 300);
+  CHECK(EQUAL(poFeature->GetStringSubfield("ATTF", 0, "ATVL", 1), "new"));
+
+  DDFRecord *poEdge = oEngine.FindRecord(130, 7);
+  CHECK(poEdge != NULL);
+  CHECK(poEdge->FindField("SG2D")->GetRepeatCount() == 3);
+  CHECK(poEdge->GetIntSubfield("SG2D", 0, "YCOO", 0) == 1);
+  CHECK(poEdge->GetIntSubfield("SG2D", 0, "YCOO", 1) == 30);
+  CHECK(poEdge->GetIntSubfield("SG2D", 0, "XCOO", 1) == 40);
+  CHECK(poEdge->GetIntSubfield("SG2D", 0, "YCOO", 2) == 5);
+
+  CHECK(oEngine.FindRecord(100, 2) != NULL);
+  CHECK(oEngine.FindRecord(130, 8) != NULL);
+
+  CHECK(oEngine.ApplyUpdate(pszUpdate2));
+  CHECK(oEngine.GetUpdateNumber() == 2);
+
+  poFeature = oEngine.FindRecord(100, 2);
+  DDFField *poFSPT = poFeature->FindField("FSPT");
+  CHECK(poFeature->GetIntSubfield("FRID", 0, "RVER", 0) == 2);
+  CHECK(poFSPT != NULL && poFSPT->GetRepeatCount() == 2);
+  CHECK((unsigned char)poFSPT->GetInstanceData(0, NULL)[1] == 8);
+  CHECK((unsigned char)poFSPT->GetInstanceData(1, NULL)[1] == 7);
+  CHECK(EQUAL(poFeature->GetStringSubfield("ATTF", 0, "ATVL", 0), "Light"));
+
+  poEdge = oEngine.FindRecord(130, 8);
+  DDFField *poVRPT = poEdge->FindField("VRPT");
+  CHECK(poVRPT != NULL && poVRPT->GetRepeatCount() == 1);
+  CHECK((unsigned char)poVRPT->GetInstanceData(0, NULL)[0] == 120);
+  CHECK(poEdge->FindField("SG2D")->GetRepeatCount() == 3);
+  CHECK(poEdge->GetIntSubfield("SG2D", 0, "YCOO", 0) == 50);
+  CHECK(poEdge->GetIntSubfield("SG2D", 0, "XCOO", 2) == 23);
+
+  return 0;
+}
+
+/************************************************************************/
+/*                         TestRVERMismatch()                           */
+/*                                                                      */
+/*      An update whose records don't follow the record versions of    */
+/*      the cell fails, and doesn't advance the update number.         */
+/************************************************************************/
+
+static int TestRVERMismatch()
+
+{
+  CHECK(TestWriteCell(pszCell));
+
+  DDFModule oModule;
+  CHECK(TestCreateUpdate(oModule, pszUpdate1, 3, 1));
+
+  DDFRecord *poRecord = TestNewRecord(oModule);
+  TestFRID(poRecord, 1, 3, 3);
+  TestATTF(poRecord, 116, "Beacon");
+  CHECK(TestWriteRecord(poRecord));
+
+  poRecord = TestNewRecord(oModule);
+  TestVRID(poRecord, 110, 9, 5, 2);
+  CHECK(TestWriteRecord(poRecord));
+  oModule.Close();
+
+  DDFUpdateEngine oEngine;
+
+  CHECK(oEngine.Open(pszCell));
+
+  CPLPushErrorHandler(CPLQuietErrorHandler);
+  int bApplied = oEngine.ApplyUpdate(pszUpdate1);
+  CPLPopErrorHandler();
+
+  CHECK(!bApplied);
+  CHECK(oEngine.GetUpdateNumber() == 0);
+
+  DDFRecord *poFeature = oEngine.FindRecord(100, 1);
+  CHECK(poFeature->GetIntSubfield("FRID", 0, "RVER", 0) == 1);
+  CHECK(EQUAL(poFeature->GetStringSubfield("ATTF", 0, "ATVL", 0), "Buoy"));
+  CHECK(oEngine.FindRecord(110, 9) != NULL);
+
+  CHECK(oEngine.Write(pszMerged));
+  oEngine.Close();
+  CHECK(oEngine.Open(pszMerged));
+  CHECK(oEngine.GetUpdateNumber() == 0);
+
+  return 0;
+}
+
+/************************************************************************/
+/*                           TestSequence()                             */
+/*                                                                      */
+/*      Updates of another edition or out of sequence are refused,     */
+/*      updates already applied are skipped.                            */
+/************************************************************************/
+
+static int TestSequence()
+
+{
+  CHECK(TestWriteCell(pszCell));
+
+  DDFUpdateEngine oEngine;
+  DDFModule oModule;
+
+  CHECK(oEngine.Open(pszCell));
+
+  CHECK(TestCreateUpdate(oModule, pszUpdate1, 4, 1));
+  oModule.Close();
+  CPLPushErrorHandler(CPLQuietErrorHandler);
+  int bApplied = oEngine.ApplyUpdate(pszUpdate1);
+  CPLPopErrorHandler();
+  CHECK(!bApplied);
+  CHECK(oEngine.GetUpdateNumber() == 0);
+
+  CHECK(TestCreateUpdate(oModule, pszUpdate2, 3, 2));
+  oModule.Close();
+  CPLPushErrorHandler(CPLQuietErrorHandler);
+  bApplied = oEngine.ApplyUpdate(pszUpdate2);
+  CPLPopErrorHandler();
+  CHECK(!bApplied);
+  CHECK(oEngine.GetUpdateNumber() == 0);
+
+  CHECK(TestWriteUpdate1(pszUpdate1));
+  CHECK(oEngine.ApplyUpdate(pszUpdate1));
+  CHECK(oEngine.GetUpdateNumber() == 1);
+
+  CHECK(oEngine.ApplyUpdate(pszUpdate1));
+  CHECK(oEngine.GetUpdateNumber() == 1);
+  CHECK(oEngine.FindRecord(100, 1)->GetIntSubfield("FRID", 0, "RVER", 0) ==
+        2);
+
+  return 0;
+}
+
+/************************************************************************/
+/*                          TestTruncated()                             */
+/*                                                                      */
+/*      An update which can't be read to its end doesn't advance the   */
+/*      update number.                                                  */
+/************************************************************************/
+
+static int TestTruncated()
+
+{
+  CHECK(TestWriteCell(pszCell));
+  CHECK(TestWriteUpdate1(pszUpdate1));
+  CHECK(TestTruncateFile(pszUpdate1, 10));
+
+  DDFUpdateEngine oEngine;
+
+  CHECK(oEngine.Open(pszCell));
+
+  CPLPushErrorHandler(CPLQuietErrorHandler);
+  int bApplied = oEngine.ApplyUpdate(pszUpdate1);
+  CPLPopErrorHandler();
+
+  CHECK(!bApplied);
+  CHECK(oEngine.GetUpdateNumber() == 0);
+
+  return 0;
+}
+
+/************************************************************************/
+/*                          TestWriteReopen()                           */
+/*                                                                      */
+/*      A merged cell keeps its update number, so applying the same    */
+/*      updates to it again changes nothing.                            */
+/************************************************************************/
+
+static int TestWriteReopen()
+
+{
+  CHECK(TestWriteCell(pszCell));
+  CHECK(TestWriteUpdate1(pszUpdate1));
+  VSIUnlink(pszUpdate2);
+
+  DDFUpdateEngine oEngine;
+
+  CHECK(oEngine.Open(pszCell));
+  CHECK(oEngine.ApplyUpdates(pszCell));
+  CHECK(oEngine.GetUpdateNumber() == 1);
+  CHECK(oEngine.Write(pszMerged));
+  oEngine.Close();
+
+  CHECK(oEngine.Open(pszMerged));
+  CHECK(oEngine.GetEdition() == 3 && oEngine.GetUpdateNumber() == 1);
+
+  CHECK(oEngine.ApplyUpdate(pszUpdate1));
+  CHECK(oEngine.ApplyUpdates(pszCell));
+  CHECK(oEngine.GetUpdateNumber() == 1);
+
+  DDFRecord *poFeature = oEngine.FindRecord(100, 1);
+  CHECK(poFeature->GetIntSubfield("FRID", 0, "RVER", 0) == 2);
+  CHECK(poFeature->FindField("ATTF")->GetRepeatCount() == 2);
+  CHECK(oEngine.FindRecord(130, 7)->GetIntSubfield("SG2D", 0, "YCOO", 1) ==
+        30);
+  CHECK(oEngine.FindRecord(110, 9) == NULL);
+
+  return 0;
+}
+
+int main()
+
+{
+  int nFailures = TestInstructions() + TestRVERMismatch() + TestSequence() +
+                  TestTruncated() + TestWriteReopen();
+
+  VSIUnlink(pszCell);
+  VSIUnlink(pszUpdate1);
+  VSIUnlink(pszUpdate2);
+  VSIUnlink(pszMerged);
+
+  if (nFailures == 0) printf("test_updates: all tests passed\n");
+  return nFailures != 0;
+}
@@ -0,0 +1,463 @@
+/******************************************************************************
+ *
+ * Project:  ISO 8211 Access
+ * Purpose:  8211arenabench, timing the reading and cloning of records on
+ *           the heap and on a DDFArena.
+ *
+ ******************************************************************************
+ * Copyright (c) 2024, OpenCPN development team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ******************************************************************************
+ *
+ * Usage: 8211arenabench [-rounds n] [-decode] file...
+ *
+ * Each file is read n times (10 by default) in three ways: reading only,
+ * which reuses the buffers of the one record returned by ReadRecord(),
+ * keeping a Clone() of every record on the heap, as the S-57 reader does,
+ * and keeping the clones on a DDFArena released in one call.  The best
+ * time of the rounds is reported for each, with the malloc() calls (which
+ * operator new goes through) of one more round, and the peak resident set
+ * size (ru_maxrss) of a process doing one round.  Those two need glibc and
+ * are reported as -1 elsewhere.
+ *
+ * With -decode the records of each file are read once and kept, and the
+ * decoding of all their fields is timed instead: DDFField::DecodeIntValues()
+ * and DecodeFloatValues() against ExtractIntData() and ExtractFloatData()
+ * called for each subfield in turn.  Both must give the same values.
+ */
+
+#include <chrono>
+#include <vector>
+
+#include "iso8211.h"
+#include "cpl_conv.h"
+#include "cpl_error.h"
+
+#if defined(__GLIBC__)
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+/* -------------------------------------------------------------------- */
+/*      Counting allocations needs malloc() interposition, which only   */
+/*      glibc makes easy.                                               */
+/* -------------------------------------------------------------------- */
+#if defined(__GLIBC__)
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+
+static bool bCounting = false;
+static long long nAllocs = 0;
+
+extern "C" void *malloc(size_t size) __THROW
+
+{
+  if (bCounting) nAllocs++;
+  return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size) __THROW
+
+{
+  if (bCounting) nAllocs++;
+  return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size) __THROW
+
+{
+  if (bCounting) nAllocs++;
+  return __libc_realloc(ptr, size);
+}
+
+static void StartCounting()
+
+{
+  nAllocs = 0;
+  bCounting = true;
+}
+
+static long long StopCounting()
+
+{
+  bCounting = false;
+  return nAllocs;
+}
+#else
+static void StartCounting() {}
+static long long StopCounting() { return -1; }
+#endif
+
+static double Now()
+
+{
+  return std::chrono::duration<double>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/************************************************************************/
+/*                              ReadOnce()                              */
+/*                                                                      */
+/*      Read all records of a file, cloning them on the heap or on     */
+/*      poArena when bClone is set.  Returns the number of records, or */
+/*      -1 if the file can't be opened.                                 */
+/************************************************************************/
+
+static int ReadOnce(const char *pszFilename, int bClone, DDFArena *poArena)
+
+{
+  DDFModule oModule;
+
+  if (!oModule.Open(pszFilename)) return -1;
+
+  oModule.SetArena(poArena);
+
+  std::vector<DDFRecord *> apoClones;
+  DDFRecord *poRecord;
+  int nRecords = 0;
+
+  while ((poRecord = oModule.ReadRecord()) != NULL) {
+    if (bClone) apoClones.push_back(poRecord->Clone());
+    nRecords++;
+  }
+
+  for (size_t i = 0; i < apoClones.size(); i++) delete apoClones[i];
+  oModule.Close();
+
+  if (poArena != NULL) poArena->Release();
+
+  return nRecords;
+}
+
+/************************************************************************/
+/*                              BestTime()                              */
+/************************************************************************/
+
+static double BestTime(const char *pszFilename, int nRounds, int bClone,
+                       DDFArena *poArena, int *pnRecords)
+
+{
+  double dfBest = 0.0;
+
+  for (int i = 0; i < nRounds; i++) {
+    double dfStart = Now();
+
+    *pnRecords = ReadOnce(pszFilename, bClone, poArena);
+    if (*pnRecords < 0) return 0.0;
+
+    double dfSeconds = Now() - dfStart;
+    if (i == 0 || dfSeconds < dfBest) dfBest = dfSeconds;
+  }
+
+  return dfBest;
+}
+
+/************************************************************************/
+/*                            DecodeAll()                               */
+/*                                                                      */
+/*      Decode every field of the records into padfValues, with the    */
+/*      DDFField decoders or one Extract*Data() call per subfield, as  */
+/*      integers or doubles.  Returns the number of values.             */
+/************************************************************************/
+
+static int DecodeAll(std::vector<DDFRecord *> &apoRecords, int bExtract,
+                     int bFloat, int *panValues, double *padfValues)
+
+{
+  int nValues = 0;
+
+  for (size_t iRecord = 0; iRecord < apoRecords.size(); iRecord++) {
+    DDFRecord *poRecord = apoRecords[iRecord];
+
+    for (int iField = 0; iField < poRecord->GetFieldCount(); iField++) {
+      DDFField *poField = poRecord->GetField(iField);
+      DDFFieldDefn *poDefn = poField->GetFieldDefn();
+      int nFieldValues =
+          poField->GetRepeatCount() * poDefn->GetSubfieldCount();
+
+      if (!bExtract) {
+        if (bFloat)
+          nValues +=
+              poField->DecodeFloatValues(padfValues + nValues, nFieldValues);
+        else
+          nValues +=
+              poField->DecodeIntValues(panValues + nValues, nFieldValues);
+        continue;
+      }
+
+      const char *pachData = poField->GetData();
+      int nDataSize = poField->GetDataSize();
+      int iOffset = 0;
+
+      for (int iRepeat = 0; iRepeat < poField->GetRepeatCount(); iRepeat++) {
+        for (int iSF = 0; iSF < poDefn->GetSubfieldCount(); iSF++) {
+          DDFSubfieldDefn *poSFDefn = poDefn->GetSubfield(iSF);
+          int nBytesConsumed = 0;
+
+          if (bFloat)
+            padfValues[nValues++] = poSFDefn->ExtractFloatData(
+                pachData + iOffset, nDataSize - iOffset, &nBytesConsumed);
+          else
+            panValues[nValues++] = poSFDefn->ExtractIntData(
+                pachData + iOffset, nDataSize - iOffset, &nBytesConsumed);
+          iOffset += nBytesConsumed;
+        }
+      }
+    }
+  }
+
+  return nValues;
+}
+
+/************************************************************************/
+/*                           BestDecodeTime()                           */
+/************************************************************************/
+
+static double BestDecodeTime(std::vector<DDFRecord *> &apoRecords,
+                             int nRounds, int bExtract, int bFloat,
+                             int *panValues, double *padfValues)
+
+{
+  double dfBest = 0.0;
+
+  for (int i = 0; i < nRounds; i++) {
+    double dfStart = Now();
+
+    DecodeAll(apoRecords, bExtract, bFloat, panValues, padfValues);
+
+    double dfSeconds = Now() - dfStart;
+    if (i == 0 || dfSeconds < dfBest) dfBest = dfSeconds;
+  }
+
+  return dfBest;
+}
+
+/************************************************************************/
+/*                             DecodeFile()                             */
+/*                                                                      */
+/*      Time the decoding of all fields of a file, returns FALSE if    */
+/*      the file can't be opened or the decoders disagree.              */
+/************************************************************************/
+
+static int DecodeFile(const char *pszFilename, int nRounds)
+
+{
+  DDFModule oModule;
+
+  if (!oModule.Open(pszFilename)) {
+    fprintf(stderr, "%s: can't open.\n", pszFilename);
+    return FALSE;
+  }
+
+  std::vector<DDFRecord *> apoRecords;
+  DDFRecord *poRecord;
+  int nValues = 0;
+
+  while ((poRecord = oModule.ReadRecord()) != NULL) {
+    apoRecords.push_back(poRecord->Clone());
+
+    for (int iField = 0; iField < poRecord->GetFieldCount(); iField++) {
+      DDFField *poField = poRecord->GetField(iField);
+
+      nValues += poField->GetRepeatCount() *
+                 poField->GetFieldDefn()->GetSubfieldCount();
+    }
+  }
+
+  std::vector<int> anDecoded(nValues + 1), anExtracted(nValues + 1);
+  std::vector<double> adfDecoded(nValues + 1), adfExtracted(nValues + 1);
+
+  double dfIntDecode = BestDecodeTime(apoRecords, nRounds, FALSE, FALSE,
+                                      &anDecoded[0], NULL);
+  double dfIntExtract = BestDecodeTime(apoRecords, nRounds, TRUE, FALSE,
+                                       &anExtracted[0], NULL);
+  double dfFloatDecode = BestDecodeTime(apoRecords, nRounds, FALSE, TRUE,
+                                        NULL, &adfDecoded[0]);
+  double dfFloatExtract = BestDecodeTime(apoRecords, nRounds, TRUE, TRUE,
+                                         NULL, &adfExtracted[0]);
+
+  printf("%-24s %10d %10.3f %10.3f %10.3f %10.3f\n", pszFilename, nValues,
+         dfIntDecode * 1000.0, dfIntExtract * 1000.0, dfFloatDecode * 1000.0,
+         dfFloatExtract * 1000.0);
+
+  int bSame = anDecoded == anExtracted;
+
+  // NaN compares unequal to itself, compare the bits.
+  if (nValues > 0 && memcmp(&adfDecoded[0], &adfExtracted[0],
+                            sizeof(double) * nValues) != 0)
+    bSame = FALSE;
+
+  if (!bSame)
+    fprintf(stderr, "%s: decoded and extracted values differ.\n",
+            pszFilename);
+
+  for (size_t i = 0; i < apoRecords.size(); i++) delete apoRecords[i];
+  oModule.Close();
+
+  return bSame;
+}
+
+/************************************************************************/
+/*                          CountAllocations()                          */
+/************************************************************************/
+
+static long long CountAllocations(const char *pszFilename, int bClone,
+                                  DDFArena *poArena)
+
+{
+  StartCounting();
+  ReadOnce(pszFilename, bClone, poArena);
+  return StopCounting();
+}
+
+/************************************************************************/
+/*                              MaxRSS()                                */
+/*                                                                      */
+/*      Peak resident set size in kB of a child process reading the    */
+/*      file once.  The child starts out with the pages of this one,   */
+/*      so the read only mode gives the baseline.                       */
+/************************************************************************/
+
+static long MaxRSS(const char *pszFilename, int bClone, DDFArena *poArena)
+
+{
+#if defined(__GLIBC__)
+  fflush(stdout);
+
+  pid_t nPid = fork();
+
+  if (nPid == 0) _exit(ReadOnce(pszFilename, bClone, poArena) < 0 ? 1 : 0);
+  if (nPid < 0) return -1;
+
+  int nStatus;
+  struct rusage sUsage;
+
+  if (wait4(nPid, &nStatus, 0, &sUsage) != nPid) return -1;
+
+  return sUsage.ru_maxrss;
+#else
+  return -1;
+#endif
+}
+
+/************************************************************************/
+/*                               Usage()                                */
+/************************************************************************/
+
+static void Usage()
+
+{
+  fprintf(stderr, "Usage: 8211arenabench [-rounds n] [-decode] file...\n");
+  exit(2);
+}
+
+/************************************************************************/
+/*                                main()                                */
+/************************************************************************/
+
+int main(int nArgc, char **papszArgv)
+
+{
+  int nRounds = 10;
+  int bDecode = FALSE;
+  int iArg;
+
+  for (iArg = 1; iArg < nArgc && papszArgv[iArg][0] == '-'; iArg++) {
+    if (EQUAL(papszArgv[iArg], "-rounds") && iArg + 1 < nArgc)
+      nRounds = atoi(papszArgv[++iArg]);
+    else if (EQUAL(papszArgv[iArg], "-decode"))
+      bDecode = TRUE;
+    else
+      Usage();
+  }
+
+  if (iArg == nArgc || nRounds < 1) Usage();
+
+  int nFailed = 0;
+
+  if (bDecode) {
+    printf("%-24s %10s %10s %10s %10s %10s\n", "file", "values",
+           "int dec ms", "int ext ms", "flt dec ms", "flt ext ms");
+
+    for (; iArg < nArgc; iArg++) {
+      if (!DecodeFile(papszArgv[iArg], nRounds)) nFailed++;
+    }
+
+    return nFailed > 0 ? 1 : 0;
+  }
+
+  printf("%-24s %-6s %8s %10s %10s %10s %10s %10s\n", "file", "mode",
+         "records", "best ms", "mallocs", "maxrss kB", "arena kB", "allocs");
+
+  for (; iArg < nArgc; iArg++) {
+    const char *pszFilename = papszArgv[iArg];
+    DDFArena oArena;
+    int nRecords;
+
+    // Ahead of the timed rounds, which grow the heap the children start
+    // out with.
+    long nReadRSS = MaxRSS(pszFilename, FALSE, NULL);
+    long nHeapRSS = MaxRSS(pszFilename, TRUE, NULL);
+    long nArenaRSS = MaxRSS(pszFilename, TRUE, &oArena);
+
+    double dfRead = BestTime(pszFilename, nRounds, FALSE, NULL, &nRecords);
+    if (nRecords < 0) {
+      fprintf(stderr, "%s: can't open.\n", pszFilename);
+      nFailed++;
+      continue;
+    }
+    double dfHeap = BestTime(pszFilename, nRounds, TRUE, NULL, &nRecords);
+    double dfArena = BestTime(pszFilename, nRounds, TRUE, &oArena, &nRecords);
+
+    long long nReadAllocs = CountAllocations(pszFilename, FALSE, NULL);
+    long long nHeapAllocs = CountAllocations(pszFilename, TRUE, NULL);
+    long long nArenaAllocs = CountAllocations(pszFilename, TRUE, &oArena);
+
+    // One more round outside of the timing, for the arena statistics.
+    DDFModule oModule;
+    std::vector<DDFRecord *> apoClones;
+    DDFRecord *poRecord;
+
+    if (!oModule.Open(pszFilename)) {
+      nFailed++;
+      continue;
+    }
+    oModule.SetArena(&oArena);
+    while ((poRecord = oModule.ReadRecord()) != NULL)
+      apoClones.push_back(poRecord->Clone());
+
+    printf("%-24s %-6s %8d %10.3f %10lld %10ld\n", pszFilename, "read",
+           nRecords, dfRead * 1000.0, nReadAllocs, nReadRSS);
+    printf("%-24s %-6s %8d %10.3f %10lld %10ld\n", "", "heap", nRecords,
+           dfHeap * 1000.0, nHeapAllocs, nHeapRSS);
+    printf("%-24s %-6s %8d %10.3f %10lld %10ld %10.1f %10d\n", "", "arena",
+           nRecords, dfArena * 1000.0, nArenaAllocs, nArenaRSS,
+           oArena.GetPeakBytesReserved() / 1024.0,
+           oArena.GetAllocationCount());
+
+    for (size_t i = 0; i < apoClones.size(); i++) delete apoClones[i];
+    oModule.Close();
+  }
+
+  return nFailed > 0 ? 1 : 0;
+}
@@ -0,0 +1,500 @@
+/******************************************************************************
+ *
+ * Project:  ISO 8211 Access
+ * Purpose:  8211stat, a streaming validator of ISO 8211 files reporting
+ *           per field tag statistics and read/decode throughput.
+ *
+ ******************************************************************************
+ * Copyright (c) 2024, OpenCPN development team
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ******************************************************************************
+ *
+ * Usage: 8211stat [-json] [-max-messages n] file...
+ *
+ * Each file is read one record at a time, so memory use doesn't depend on
+ * the size of the file.  Every field of every record is checked and fully
+ * decoded.  The exit status is 0 if all files are valid, 1 otherwise.
+ */
+
+#include <chrono>
+
+#include "iso8211.h"
+#include "cpl_conv.h"
+#include "cpl_error.h"
+
+/* -------------------------------------------------------------------- */
+/*      Statistics gathered for each field tag of a file.               */
+/* -------------------------------------------------------------------- */
+typedef struct {
+  int nRecords;  // records holding at least one such field
+  long long nFields;
+  long long nInstances;
+  long long nBytes;
+  double dfDecodeSeconds;
+  int nLastRecord;
+} TagStats;
+
+/* -------------------------------------------------------------------- */
+/*      Statistics and problems of one file.                            */
+/* -------------------------------------------------------------------- */
+typedef struct {
+  const char *pszFilename;
+  int bOpened;
+
+  int nRecords;
+  long long nBytes;
+  double dfSeconds;
+
+  int nLargestRecord;
+  int nLargestRecordSize;
+  int nSlowestRecord;
+  double dfSlowestRecordSeconds;
+
+  int nProblems;
+  int nMessages;
+  char **papszMessages;
+
+  int nTagCount;
+  TagStats *pasTags;
+} FileStats;
+
+static int nMaxMessages = 10;
+
+static double Now()
+
+{
+  return std::chrono::duration<double>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/************************************************************************/
+/*                             AddProblem()                             */
+/*                                                                      */
+/*      Count a problem, keeping the message of the first few.          */
+/************************************************************************/
+
+static void AddProblem(FileStats *psStats, int iRecord, const char *pszMsg)
+
+{
+  psStats->nProblems++;
+
+  if (psStats->nMessages >= nMaxMessages) return;
+
+  char szMessage[512];
+
+  if (iRecord >= 0)
+    snprintf(szMessage, sizeof(szMessage), "record %d: %s", iRecord, pszMsg);
+  else
+    snprintf(szMessage, sizeof(szMessage), "%s", pszMsg);
+
+  psStats->papszMessages = (char **)CPLRealloc(
+      psStats->papszMessages, sizeof(char *) * (psStats->nMessages + 1));
+  psStats->papszMessages[psStats->nMessages++] = CPLStrdup(szMessage);
+}
+
+/************************************************************************/
+/*                           CheckLastError()                           */
+/************************************************************************/
+
+static void CheckLastError(FileStats *psStats, int iRecord)
+
+{
+  if (CPLGetLastErrorNo() != 0) {
+    AddProblem(psStats, iRecord, CPLGetLastErrorMsg());
+    CPLErrorReset();
+  }
+}
+
+/************************************************************************/
+/*                            CheckRecord()                             */
+/*                                                                      */
+/*      Validate the directory and fields of a record, and decode all   */
+/*      of its subfields.                                               */
+/************************************************************************/
+
+static void CheckRecord(FileStats *psStats, DDFModule *poModule,
+                        DDFRecord *poRecord, int iRecord,
+                        double **ppadfValues, int *pnMaxValues)
+
+{
+  const char *pachData = poRecord->GetData();
+  int nDataSize = poRecord->GetDataSize();
+  int nFieldOffset = poRecord->GetFieldOffset();
+  char szMsg[256];
+
+  /* -------------------------------------------------------------------- */
+  /*      The directory ends with a field terminator.                     */
+  /* -------------------------------------------------------------------- */
+  if (nFieldOffset < 1 || nFieldOffset > nDataSize ||
+      pachData[nFieldOffset - 1] != DDF_FIELD_TERMINATOR)
+    AddProblem(psStats, iRecord, "directory isn't terminated.");
+
+  for (int iField = 0; iField < poRecord->GetFieldCount(); iField++) {
+    DDFField *poField = poRecord->GetField(iField);
+    DDFFieldDefn *poDefn = poField->GetFieldDefn();
+    const char *pszTag = poDefn->GetName();
+    int nSize = poField->GetDataSize();
+    int nStart = poField->GetData() - pachData;
+
+    /* ---------------------------------------------------------------- */
+    /*      Field data inside the record, and terminated.               */
+    /* ---------------------------------------------------------------- */
+    if (nStart < nFieldOffset || nSize < 0 || nStart + nSize > nDataSize) {
+      snprintf(szMsg, sizeof(szMsg),
+               "field %s (%d bytes at %d) is outside the record data.", pszTag,
+               nSize, nStart);
+      AddProblem(psStats, iRecord, szMsg);
+      continue;
+    }
+
+    if (nSize == 0 || poField->GetData()[nSize - 1] != DDF_FIELD_TERMINATOR) {
+      snprintf(szMsg, sizeof(szMsg), "field %s isn't terminated.", pszTag);
+      AddProblem(psStats, iRecord, szMsg);
+    }
+
+    /* ---------------------------------------------------------------- */
+    /*      Fixed width repeating fields hold whole instances.          */
+    /* ---------------------------------------------------------------- */
+    int nRepeatCount = poField->GetRepeatCount();
+
+    if (poDefn->IsRepeating() && poDefn->GetFixedWidth() > 0 && nSize > 0 &&
+        (nSize - 1) % poDefn->GetFixedWidth() != 0) {
+      snprintf(szMsg, sizeof(szMsg),
+               "field %s holds %d bytes, not a multiple of its %d byte "
+               "instances.",
+               pszTag, nSize - 1, poDefn->GetFixedWidth());
+      AddProblem(psStats, iRecord, szMsg);
+    }
+
+    /* ---------------------------------------------------------------- */
+    /*      Decode all the values.                                      */
+    /* ---------------------------------------------------------------- */
+    int nValues = nRepeatCount * poDefn->GetSubfieldCount();
+
+    if (nValues > *pnMaxValues) {
+      *pnMaxValues = nValues;
+      *ppadfValues =
+          (double *)CPLRealloc(*ppadfValues, sizeof(double) * nValues);
+    }
+
+    double dfStart = Now();
+    poField->DecodeFloatValues(*ppadfValues, nValues);
+    double dfDecodeSeconds = Now() - dfStart;
+
+    CheckLastError(psStats, iRecord);
+
+    /* ---------------------------------------------------------------- */
+    /*      Accumulate, the field definition index is our tag index.    */
+    /* ---------------------------------------------------------------- */
+    int iTag;
+
+    for (iTag = 0; iTag < psStats->nTagCount; iTag++) {
+      if (poModule->GetField(iTag) == poDefn) break;
+    }
+
+    if (iTag == psStats->nTagCount) continue;
+
+    TagStats *psTag = psStats->pasTags + iTag;
+
+    if (psTag->nLastRecord != iRecord) {
+      psTag->nRecords++;
+      psTag->nLastRecord = iRecord;
+    }
+    psTag->nFields++;
+    psTag->nInstances += nRepeatCount;
+    psTag->nBytes += nSize;
+    psTag->dfDecodeSeconds += dfDecodeSeconds;
+  }
+}
+
+/************************************************************************/
+/*                              ReadFile()                              */
+/************************************************************************/
+
+static void ReadFile(FileStats *psStats, DDFModule &oModule)
+
+{
+  double dfStart = Now();
+
+  CPLErrorReset();
+
+  if (!oModule.Open(psStats->pszFilename)) {
+    CheckLastError(psStats, -1);
+    if (psStats->nProblems == 0) AddProblem(psStats, -1, "unable to open.");
+    return;
+  }
+
+  psStats->bOpened = TRUE;
+
+  psStats->nTagCount = oModule.GetFieldCount();
+  psStats->pasTags =
+      (TagStats *)CPLCalloc(sizeof(TagStats), psStats->nTagCount + 1);
+  for (int i = 0; i < psStats->nTagCount; i++)
+    psStats->pasTags[i].nLastRecord = -1;
+
+  /* -------------------------------------------------------------------- */
+  /*      Stream the records.  The record returned by ReadRecord() is     */
+  /*      reused, so memory use is bounded by the largest record.         */
+  /* -------------------------------------------------------------------- */
+  double *padfValues = NULL;
+  int nMaxValues = 0;
+
+  while (TRUE) {
+    double dfRecordStart = Now();
+    DDFRecord *poRecord = oModule.ReadRecord();
+
+    if (poRecord == NULL) {
+      // Distinguish the end of the file from a damaged record.
+      CheckLastError(psStats, psStats->nRecords);
+      break;
+    }
+
+    CheckLastError(psStats, psStats->nRecords);
+    CheckRecord(psStats, &oModule, poRecord, psStats->nRecords, &padfValues,
+                &nMaxValues);
+
+    double dfRecordSeconds = Now() - dfRecordStart;
+    int nRecordSize = poRecord->GetDataSize();
+
+    if (dfRecordSeconds > psStats->dfSlowestRecordSeconds) {
+      psStats->dfSlowestRecordSeconds = dfRecordSeconds;
+      psStats->nSlowestRecord = psStats->nRecords;
+    }
+    if (nRecordSize > psStats->nLargestRecordSize) {
+      psStats->nLargestRecordSize = nRecordSize;
+      psStats->nLargestRecord = psStats->nRecords;
+    }
+
+    psStats->nBytes += nRecordSize;
+    psStats->nRecords++;
+  }
+
+  CPLFree(padfValues);
+
+  /* -------------------------------------------------------------------- */
+  /*      Anything left after the last record we could read?             */
+  /* -------------------------------------------------------------------- */
+  FILE *fp = oModule.GetFP();
+  long nPos = VSIFTell(fp);
+
+  VSIFSeek(fp, 0, SEEK_END);
+  if (VSIFTell(fp) > nPos) {
+    char szMsg[128];
+
+    snprintf(szMsg, sizeof(szMsg), "%ld bytes after the last record.",
+             VSIFTell(fp) - nPos);
+    AddProblem(psStats, -1, szMsg);
+  }
+
+  psStats->dfSeconds = Now() - dfStart;
+}
+
+/************************************************************************/
+/*                             WriteJSON()                              */
+/************************************************************************/
+
+static void WriteJSONString(const char *pszText)
+
+{
+  putchar('"');
+  for (; *pszText != '\0'; pszText++) {
+    unsigned char ch = (unsigned char)*pszText;
+
+    if (ch == '"' || ch == '\\')
+      printf("\\%c", ch);
+    else if (ch == '\n')
+      printf("\\n");
+    else if (ch < 32 || ch >= 127)
+      printf("\\u%04x", ch);
+    else
+      putchar(ch);
+  }
+  putchar('"');
+}
+
+static void WriteJSON(FileStats *psStats, DDFModule *poModule, int bFirst)
+
+{
+  printf("%s\n    {\"file\": ", bFirst ? "" : ",");
+  WriteJSONString(psStats->pszFilename);
+  printf(",\n     \"valid\": %s, \"records\": %d, \"bytes\": %lld"
+         ", \"seconds\": %.6f, \"mb_per_second\": %.3f,\n",
+         psStats->nProblems == 0 ? "true" : "false", psStats->nRecords,
+         psStats->nBytes, psStats->dfSeconds,
+         psStats->dfSeconds > 0 ? psStats->nBytes / 1e6 / psStats->dfSeconds
+                                : 0.0);
+  printf(
+      "     \"largest_record\": {\"index\": %d, \"bytes\": %d},\n"
+      "     \"slowest_record\": {\"index\": %d, \"seconds\": %.6f},\n",
+      psStats->nLargestRecord, psStats->nLargestRecordSize,
+      psStats->nSlowestRecord, psStats->dfSlowestRecordSeconds);
+
+  printf("     \"problems\": %d, \"messages\": [", psStats->nProblems);
+  for (int i = 0; i < psStats->nMessages; i++) {
+    if (i > 0) printf(", ");
+    WriteJSONString(psStats->papszMessages[i]);
+  }
+  printf("],\n     \"tags\": [");
+
+  int bFirstTag = TRUE;
+
+  for (int i = 0; i < psStats->nTagCount; i++) {
+    TagStats *psTag = psStats->pasTags + i;
+
+    if (psTag->nFields == 0) continue;
+
+    printf("%s\n       {\"tag\": ", bFirstTag ? "" : ",");
+    WriteJSONString(poModule->GetField(i)->GetName());
+    printf(", \"records\": %d, \"fields\": %lld"
+           ", \"instances\": %lld, \"bytes\": %lld"
+           ", \"decode_seconds\": %.6f}",
+           psTag->nRecords, psTag->nFields, psTag->nInstances, psTag->nBytes,
+           psTag->dfDecodeSeconds);
+    bFirstTag = FALSE;
+  }
+  printf("]}");
+}
+
+/************************************************************************/
+/*                             WriteText()                              */
+/************************************************************************/
+
+static void WriteText(FileStats *psStats, DDFModule *poModule)
+
+{
+  printf("%s: %s\n", psStats->pszFilename,
+         psStats->nProblems == 0 ? "valid" : "INVALID");
+
+  if (psStats->bOpened) {
+    printf("  %d records, %lld bytes in %.3f s (%.1f MB/s)\n",
+           psStats->nRecords, psStats->nBytes, psStats->dfSeconds,
+           psStats->dfSeconds > 0 ? psStats->nBytes / 1e6 / psStats->dfSeconds
+                                  : 0.0);
+    printf("  largest record %d (%d bytes), slowest record %d (%.3f ms)\n",
+           psStats->nLargestRecord, psStats->nLargestRecordSize,
+           psStats->nSlowestRecord, psStats->dfSlowestRecordSeconds * 1000.0);
+
+    printf("  %-6s %9s %10s %11s %12s %10s\n", "tag", "records", "fields",
+           "instances", "bytes", "decode ms");
+    for (int i = 0; i < psStats->nTagCount; i++) {
+      TagStats *psTag = psStats->pasTags + i;
+
+      if (psTag->nFields == 0) continue;
+
+      printf("  %-6s %9d %10lld %11lld %12lld %10.3f\n",
+             poModule->GetField(i)->GetName(), psTag->nRecords,
+             psTag->nFields, psTag->nInstances, psTag->nBytes,
+             psTag->dfDecodeSeconds * 1000.0);
+    }
+  }
+
+  if (psStats->nProblems > 0) {
+    printf("  %d problems:\n", psStats->nProblems);
+    for (int i = 0; i < psStats->nMessages; i++)
+      printf("    %s\n", psStats->papszMessages[i]);
+    if (psStats->nProblems > psStats->nMessages) printf("    ...\n");
+  }
+}
+
+/************************************************************************/
+/*                               Usage()                                */
+/************************************************************************/
+
+static void Usage()
+
+{
+  fprintf(stderr, "Usage: 8211stat [-json] [-max-messages n] file...\n");
+  exit(2);
+}
+
+/************************************************************************/
+/*                                main()                                */
+/************************************************************************/
+
+int main(int nArgc, char **papszArgv)
+
+{
+  int bJSON = FALSE;
+  int iArg;
+
+  for (iArg = 1; iArg < nArgc && papszArgv[iArg][0] == '-'; iArg++) {
+    if (EQUAL(papszArgv[iArg], "-json"))
+      bJSON = TRUE;
+    else if (EQUAL(papszArgv[iArg], "-max-messages") && iArg + 1 < nArgc)
+      nMaxMessages = atoi(papszArgv[++iArg]);
+    else
+      Usage();
+  }
+
+  if (iArg == nArgc) Usage();
+
+  // Problems are collected and reported per file, not as they occur.
+  CPLPushErrorHandler(CPLQuietErrorHandler);
+
+  int nFiles = 0, nInvalid = 0, nRecords = 0;
+  long long nBytes = 0;
+  double dfSeconds = 0.0;
+
+  if (bJSON) printf("{\"files\": [");
+
+  for (; iArg < nArgc; iArg++) {
+    FileStats sStats;
+    DDFModule oModule;
+
+    memset(&sStats, 0, sizeof(sStats));
+    sStats.pszFilename = papszArgv[iArg];
+    sStats.nLargestRecord = -1;
+    sStats.nSlowestRecord = -1;
+
+    ReadFile(&sStats, oModule);
+
+    if (bJSON)
+      WriteJSON(&sStats, &oModule, nFiles == 0);
+    else
+      WriteText(&sStats, &oModule);
+    fflush(stdout);
+
+    nFiles++;
+    if (sStats.nProblems > 0) nInvalid++;
+    nRecords += sStats.nRecords;
+    nBytes += sStats.nBytes;
+    dfSeconds += sStats.dfSeconds;
+
+    for (int i = 0; i < sStats.nMessages; i++) CPLFree(sStats.papszMessages[i]);
+    CPLFree(sStats.papszMessages);
+    CPLFree(sStats.pasTags);
+  }
+
+  if (bJSON) {
+    printf("\n  ],\n  \"totals\": {\"files\": %d, \"invalid\": %d, "
+           "\"records\": %d, \"bytes\": %lld"
+           ", \"seconds\": %.6f}}\n",
+           nFiles, nInvalid, nRecords, nBytes, dfSeconds);
+  } else if (nFiles > 1) {
+    printf("%d files, %d invalid, %d records, %lld"
+           " bytes in %.3f s\n",
+           nFiles, nInvalid, nRecords, nBytes, dfSeconds);
+  }
+
+  CPLPopErrorHandler();
+
+  return nInvalid > 0 ? 1 : 0;
+}
@@ -53,6 +53,7 @@ struct BucketAlloc *createBucketAlloc(TESSalloc *alloc, const char *name,
                                       unsigned int bucketSize);
 void *bucketAlloc(struct BucketAlloc *ba);
 void bucketFree(struct BucketAlloc *ba, void *ptr);
+void resetBucketAlloc(struct BucketAlloc *ba);
 void deleteBucketAlloc(struct BucketAlloc *ba);
 
 #ifdef __cplusplus
@@ -49,6 +49,7 @@ typedef struct DictNode DictNode;
 Dict *dictNewDict(TESSalloc *alloc, void *frame,
                   int (*leq)(void *frame, DictKey key1, DictKey key2));
 
+void dictReset(Dict *dict);
 void dictDeleteDict(TESSalloc *alloc, Dict *dict);
 
 /* Search returns the node with the smallest key greater than or equal
@@ -209,7 +209,11 @@ struct TESSmesh {
  * Similarly (and independently) for the face structure,
  *  - if eOrg->Lface == eDst->Lface, one loop is split into two
  *  - if eOrg->Lface != eDst->Lface, two distinct loops are joined into one
- * In both cases, eDst->Lface is changed and eOrg->Lface is unaffected.
+ * When joining, the face of the shorter loop is destroyed (eDst->Lface if
+ * they have the same length), and the remaining face takes the "inside"
+ * flag of eOrg->Lface.  When splitting, the new face is given to the
+ * shorter of the two loops (eDst's loop if they have the same length).
+ * Either way the work done is proportional to the shorter loop.
  *
  * tessMeshDelete( eDel ) removes the edge eDel.  There are several cases:
  * if (eDel->Lface != eDel->Rface), we join two loops into one; the loop
@@ -230,14 +234,17 @@ struct TESSmesh {
  * tessMeshConnect( eOrg, eDst ) creates a new edge from eOrg->Dst
  * to eDst->Org, and returns the corresponding half-edge eNew.
  * If eOrg->Lface == eDst->Lface, this splits one loop into two,
- * and the newly created loop is eNew->Lface.  Otherwise, two disjoint
- * loops are merged into one, and the loop eDst->Lface is destroyed.
+ * and the new face is given to the shorter of eNew->Lface and
+ * eNew->Rface (eNew->Lface if they have the same length).  Otherwise, two
+ * disjoint loops are merged into one, as in tessMeshSplice().
  *
  * ************************ Other Operations *****************************
  *
  * tessMeshNewMesh() creates a new mesh with no edges, no vertices,
  * and no loops (what we usually call a "face").
  *
+ * tessMeshResetMesh( mesh ) empties a mesh, keeping its memory for reuse.
+ *
  * tessMeshUnion( mesh1, mesh2 ) forms the union of all structures in
  * both meshes, and returns the new mesh (the old meshes are destroyed).
  *
@@ -263,6 +270,7 @@ TESShalfEdge *tessMeshConnect(TESSmesh *mesh, TESShalfEdge *eOrg,
                               TESShalfEdge *eDst);
 
 TESSmesh *tessMeshNewMesh(TESSalloc *alloc);
+void tessMeshResetMesh(TESSmesh *mesh);
 TESSmesh *tessMeshUnion(TESSalloc *alloc, TESSmesh *mesh1, TESSmesh *mesh2);
 int tessMeshMergeConvexFaces(TESSmesh *mesh, int maxVertsPerFace);
 void tessMeshDeleteMesh(TESSalloc *alloc, TESSmesh *mesh);
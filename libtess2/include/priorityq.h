@@ -99,6 +99,9 @@ struct PriorityQ {
   PQkey *keys;
   PQkey **order;
   PQhandle size, max;
+  PQhandle keysMax, orderMax; /* allocated sizes, kept across pqReset */
+  void *sortItems;            /* scratch of the radix sort in pqInit, */
+  int sortItemsMax;           /* and its size in bytes */
   int initialized;
 
   int (*leq)(PQkey key1, PQkey key2);
@@ -107,6 +110,7 @@ struct PriorityQ {
 PriorityQ *pqNewPriorityQ(TESSalloc *alloc, int size,
                           int (*leq)(PQkey key1, PQkey key2));
 void pqDeletePriorityQ(TESSalloc *alloc, PriorityQ *pq);
+int pqReset(TESSalloc *alloc, PriorityQ *pq, int size);
 
 int pqInit(TESSalloc *alloc, PriorityQ *pq);
 PQhandle pqInsert(TESSalloc *alloc, PriorityQ *pq, PQkey key);
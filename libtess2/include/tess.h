@@ -69,6 +69,7 @@ struct TESStesselator {
 
   TESSreal bmin[2];
   TESSreal bmax[2];
+  int normalize; /* TESS_NORMALIZE option */
 
   /*** state needed for the line sweep ***/
   int windingRule; /* rule for determining polygon interior */
@@ -81,12 +82,26 @@ struct TESStesselator {
 
   TESSindex vertexIndexCounter;
 
+  TESSmesh *spareMesh; /* emptied mesh kept for the next contours */
+
   TESSreal *vertices;
   TESSindex *vertexIndices;
   int vertexCount;
   TESSindex *elements;
   int elementCount;
 
+  /* allocated sizes of the output arrays, which are reused */
+  int verticesMax;
+  int vertexIndicesMax;
+  int elementsMax;
+
+  /*** state needed for the single contour fast path ***/
+  int fastPath;              /* TESS_FAST_PATH option */
+  TESSvertex **simpleVerts;  /* vertices of the contour */
+  int simpleVertsMax;
+  int *simpleIndices;        /* links and triangles of the ear clipping */
+  int simpleIndicesMax;
+
   TESSalloc alloc;
 
   jmp_buf env; /* place to jump to when memAllocs fail */
@@ -123,7 +123,30 @@ enum TessElementType {
   TESS_BOUNDARY_CONTOURS,
 };
 
+// Options of tessSetOption().
+// TESS_FAST_PATH
+//   If set (the default), a single contour which is convex, or simple and
+//   small, is tesselated into TESS_POLYGONS without the sweep: convex contours
+//   are split into fans, simple ones triangulated by ear clipping. Every
+//   input vertex is part of the output; contours with repeated or collinear
+//   consecutive vertices are left to the sweep.
+// TESS_NORMALIZE
+//   If set (the default), the polygon is moved next to the origin before the
+//   sweep when it lies far from it, as with geographic or projected
+//   coordinates. The move is exact and the output keeps the input
+//   coordinates; only the rounding of computed intersections improves.
+enum TessOption {
+  TESS_FAST_PATH,
+  TESS_NORMALIZE,
+};
+
+// TESSreal is float, or double when the library and its users are compiled
+// with TESS_USE_DOUBLE defined (the LIBTESS2_USE_DOUBLE CMake option).
+#ifdef TESS_USE_DOUBLE
+typedef double TESSreal;
+#else
 typedef float TESSreal;
+#endif
 typedef int TESSindex;
 typedef struct TESStesselator TESStesselator;
 typedef struct TESSalloc TESSalloc;
@@ -187,6 +210,25 @@ TESStesselator *tessNewTess(TESSalloc *alloc);
 //   tess - pointer to tesselator object to be deleted.
 void tessDeleteTess(TESStesselator *tess);
 
+// tessReset() - Discards any contours added since the last tessTesselate()
+// call, forgets the last result and the normal, and leaves the tesselator
+// ready for new contours.
+// The memory of the mesh, the sweep structures and the output arrays is kept,
+// so a tesselator reused for many polygons stops allocating once it has
+// processed the largest of them. tessTesselate() does the same on its own;
+// tessReset() is only needed to abandon contours, or to start afresh after a
+// failure. The memory is released by tessDeleteTess().
+// Parameters:
+//   tess - pointer to tesselator object.
+void tessReset(TESStesselator *tess);
+
+// tessSetOption() - Toggles an optional feature of the tesselator.
+// Parameters:
+//   tess - pointer to tesselator object.
+//   option - one of TessOption.
+//   value - 1 to enable the option, 0 to disable it.
+void tessSetOption(TESStesselator *tess, int option, int value);
+
 // tessAddContour() - Adds a contour to be tesselated.
 // The type of the vertex coordinates is assumed to be TESSreal.
 // Parameters:
@@ -208,6 +250,8 @@ void tessAddContour(TESStesselator *tess, int size, const void *pointer,
 //   coordinates in tesselation result vertex, must be 2 or 3. normal - defines
 //   the normal of the input contours, of null the normal is calculated
 //   automatically.
+// The contours are consumed, whether or not the tesselation succeeds. The
+// results stay valid until the next call to tessTesselate() or tessReset().
 // Returns:
 //   1 if succeed, 0 if failed.
 int tessTesselate(TESStesselator *tess, int windingRule, int elementType,
@@ -233,6 +277,70 @@ int tessGetElementCount(TESStesselator *tess);
 // tessGetElements() - Returns pointer to the first element.
 const TESSindex *tessGetElements(TESStesselator *tess);
 
+// Batch tesselation.
+// A batch tesselates many independent polygons on a pool of threads, one
+// tesselator per thread, and returns the results concatenated in the order of
+// the polygons, whichever thread handled them. The allocator given to
+// tessNewBatch() is called from all the threads, so it must be thread safe.
+// The batch functions are only built with the LIBTESS2_BATCH CMake option.
+
+typedef struct TESSbatch TESSbatch;
+
+// A polygon of a batch: contourCount contours, stored one after the other,
+// the i-th one having counts[i] vertices.
+typedef struct TESSpolygon {
+  const void *vertices;  // first coordinate of the first vertex.
+  int size;              // number of coordinates per vertex, 2 or 3.
+  int stride;            // offset in bytes between vertices, or 0 if packed.
+  const int *counts;     // number of vertices of each contour.
+  int contourCount;
+  int windingRule;       // one of TessWindingRule.
+} TESSpolygon;
+
+// tessNewBatch() - Creates a batch tesselator.
+// Parameters:
+//   alloc - pointer to a filled TESSalloc struct or NULL to use default malloc
+//   based allocator.
+//   threadCount - number of threads, including the calling one, or 0 to use
+//   one per processor.
+// Returns:
+//   new batch object, or NULL if out of memory.
+TESSbatch *tessNewBatch(TESSalloc *alloc, int threadCount);
+
+// tessDeleteBatch() - Stops the threads and deletes a batch tesselator.
+void tessDeleteBatch(TESSbatch *batch);
+// tessBatchSetOption() - Toggles an optional feature of the tesselators of
+// all the threads, see tessSetOption(). Must not be called during
+// tessBatchTesselate().
+void tessBatchSetOption(TESSbatch *batch, int option, int value);
+
+// tessBatchTesselate() - tesselates polygons, blocking until all are done.
+// The parameters after polygonCount are those of tessTesselate(). The element
+// indices refer to the concatenated vertices, and neighbour indices of
+// TESS_CONNECTED_POLYGONS to the concatenated elements. The vertex indices
+// refer to the vertices of each polygon, as given in TESSpolygon.
+// The results stay valid until the next call.
+// Returns:
+//   number of polygons successfully tesselated.
+int tessBatchTesselate(TESSbatch *batch, const TESSpolygon *polygons,
+                       int polygonCount, int elementType, int polySize,
+                       int vertexSize, const TESSreal *normal);
+
+// tessBatchGetRange() - Returns the part of the output of a polygon.
+// Any of the pointers may be NULL.
+// Returns:
+//   1 if the polygon was tesselated, 0 if it failed, its ranges then being
+//   empty.
+int tessBatchGetRange(TESSbatch *batch, int polygon, int *firstVertex,
+                      int *vertexCount, int *firstElement, int *elementCount);
+
+// Concatenated output, see tessGetVertexCount() etc.
+int tessBatchGetVertexCount(TESSbatch *batch);
+const TESSreal *tessBatchGetVertices(TESSbatch *batch);
+const TESSindex *tessBatchGetVertexIndices(TESSbatch *batch);
+int tessBatchGetElementCount(TESSbatch *batch);
+const TESSindex *tessBatchGetElements(TESSbatch *batch);
+
 #ifdef __cplusplus
 };
 #endif
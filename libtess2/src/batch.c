@@ -0,0 +1,656 @@
+/*
+** SGI FREE SOFTWARE LICENSE B (Version 2.0, Sept. 18, 2008)
+** Copyright (C) [dates of first publication] Silicon Graphics, Inc.
+** All Rights Reserved.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+** of the Software, and to permit persons to whom the Software is furnished to do so,
+** subject to the following conditions:
+**
+** The above copyright notice including the dates of first publication and either this
+** permission notice or a reference to http://oss.sgi.com/projects/FreeB/ shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+** INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+** PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL SILICON GRAPHICS, INC.
+** BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+** TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+** OR OTHER DEALINGS IN THE SOFTWARE.
+**
+** Except as contained in this notice, the name of Silicon Graphics, Inc. shall not
+** be used in advertising or otherwise to promote the sale, use or other dealings in
+** this Software without prior written authorization from Silicon Graphics, Inc.
+*/
+
+/* Batch tesselation of many independent polygons on a pool of threads.
+*
+* Each worker thread owns a tesselator, so the pools kept by the tesselators
+* stay warm from one batch to the next.  A batch runs in two phases:
+* the workers first tesselate chunks of polygons into their own buffers,
+* then, once the position of every polygon in the output is known, copy
+* their results into the concatenated output.  The output only depends on
+* the order of the polygons, not on which worker tesselated them.
+*/
+
+#include <limits.h>
+#include <stddef.h>
+#include <string.h>
+#include "tesselator.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#define TRUE 1
+#define FALSE 0
+
+#define MAX_THREADS 64
+
+/************************************************************************/
+/*      Thin wrappers over the native threads.                          */
+/************************************************************************/
+
+#ifdef _WIN32
+typedef HANDLE TESSthread;
+typedef CRITICAL_SECTION TESSmutex;
+typedef CONDITION_VARIABLE TESScond;
+
+#define MutexInit(m)	InitializeCriticalSection(m)
+#define MutexDestroy(m)	DeleteCriticalSection(m)
+#define MutexLock(m)	EnterCriticalSection(m)
+#define MutexUnlock(m)	LeaveCriticalSection(m)
+#define CondInit(c)		InitializeConditionVariable(c)
+#define CondDestroy(c)
+#define CondWait(c,m)	SleepConditionVariableCS(c, m, INFINITE)
+#define CondBroadcast(c) WakeAllConditionVariable(c)
+#else
+typedef pthread_t TESSthread;
+typedef pthread_mutex_t TESSmutex;
+typedef pthread_cond_t TESScond;
+
+#define MutexInit(m)	pthread_mutex_init(m, NULL)
+#define MutexDestroy(m)	pthread_mutex_destroy(m)
+#define MutexLock(m)	pthread_mutex_lock(m)
+#define MutexUnlock(m)	pthread_mutex_unlock(m)
+#define CondInit(c)		pthread_cond_init(c, NULL)
+#define CondDestroy(c)	pthread_cond_destroy(c)
+#define CondWait(c,m)	pthread_cond_wait(c, m)
+#define CondBroadcast(c) pthread_cond_broadcast(c)
+#endif
+
+enum BatchPhase {
+	PHASE_TESSELATE,
+	PHASE_GATHER,
+};
+
+typedef struct TESSbatchRange TESSbatchRange;
+typedef struct TESSbatchWorker TESSbatchWorker;
+
+struct TESSbatchRange
+{
+	int ok;
+	int worker;			/* worker holding the result after the first phase */
+	int localVertex;	/* position in the worker buffers */
+	int localElement;
+	int firstVertex;	/* position in the batch output */
+	int firstElement;
+	int vertexCount;
+	int elementCount;
+};
+
+struct TESSbatchWorker
+{
+	TESSbatch *batch;
+	int index;
+	TESStesselator *tess;
+	TESSthread thread;
+
+	TESSreal *vertices;
+	TESSindex *vertexIndices;
+	TESSindex *elements;
+	int vertexCount, verticesMax, vertexIndicesMax;
+	int elementCount, elementsMax;
+};
+
+struct TESSbatch
+{
+	TESSalloc alloc;
+
+	int threadCount;
+	TESSbatchWorker workers[MAX_THREADS];
+
+	TESSmutex lock;
+	TESScond wake;		/* signalled when a phase starts, or on exit */
+	TESScond done;		/* signalled when the last worker finished a phase */
+	int generation;
+	int busy;
+	int quit;
+
+	/* the current batch */
+	const TESSpolygon *polygons;
+	int polygonCount;
+	int elementType;
+	int polySize;
+	int vertexSize;
+	int elementSize;	/* indices per element */
+	const TESSreal *normal;
+	TESSreal normalStore[3];
+	int phase;
+	int chunkSize;
+	int chunkCount;
+	int nextChunk;
+
+	TESSbatchRange *ranges;
+	int rangesMax;
+	int rangeCount;		/* polygons of the last successful batch */
+
+	TESSreal *vertices;
+	TESSindex *vertexIndices;
+	TESSindex *elements;
+	int vertexCount, verticesMax, vertexIndicesMax;
+	int elementCount, elementsMax;
+};
+
+/* GrowArray() makes room for count items in an array holding used items,
+* growing it geometrically.  Sizes are computed in size_t, as the counts of
+* a large batch times the item size can exceed an int.  Returns NULL,
+* leaving array untouched, if out of memory or if the array would not fit
+* the unsigned int size taken by the allocator.
+*/
+static void* GrowArray( TESSalloc *alloc, void *array, int *max, size_t count,
+					   size_t used, size_t itemSize )
+{
+	void *newArray;
+
+	if( array != NULL && count <= (size_t)*max )
+		return array;
+
+	if( count < (size_t)*max * 2 )
+		count = (size_t)*max * 2;
+	if( count < 256 )
+		count = 256;
+	if( count > INT_MAX || count > UINT_MAX / itemSize )
+		return NULL;
+
+	newArray = alloc->memalloc( alloc->userData, (unsigned int)(count * itemSize) );
+	if( newArray == NULL )
+		return NULL;
+	if( array != NULL ) {
+		memcpy( newArray, array, used * itemSize );
+		alloc->memfree( alloc->userData, array );
+	}
+	*max = (int)count;
+	return newArray;
+}
+
+/* TesselatePolygon() tesselates one polygon of the batch, and appends the
+* result to the buffers of the worker.
+*/
+static void TesselatePolygon( TESSbatchWorker *w, int i )
+{
+	TESSbatch *batch = w->batch;
+	const TESSpolygon *poly = &batch->polygons[i];
+	TESSbatchRange *range = &batch->ranges[i];
+	const unsigned char *src = (const unsigned char*)poly->vertices;
+	int stride, c, nverts, nelems;
+	void *array;
+
+	range->ok = FALSE;
+	range->worker = w->index;
+	range->vertexCount = 0;
+	range->elementCount = 0;
+
+	/* Start afresh, so that no normal is kept from an earlier batch. */
+	tessReset( w->tess );
+
+	stride = poly->stride > 0 ? poly->stride : poly->size * (int)sizeof(TESSreal);
+	for( c = 0; c < poly->contourCount; ++c ) {
+		tessAddContour( w->tess, poly->size, src, stride, poly->counts[c] );
+		src += stride * poly->counts[c];
+	}
+
+	if( !tessTesselate( w->tess, poly->windingRule, batch->elementType,
+					   batch->polySize, batch->vertexSize, batch->normal ) )
+		return;
+
+	nverts = tessGetVertexCount( w->tess );
+	nelems = tessGetElementCount( w->tess );
+
+	array = GrowArray( &batch->alloc, w->vertices, &w->verticesMax,
+					  ((size_t)w->vertexCount + nverts) * batch->vertexSize,
+					  (size_t)w->vertexCount * batch->vertexSize, sizeof(TESSreal) );
+	if( array == NULL ) return;
+	w->vertices = (TESSreal*)array;
+
+	array = GrowArray( &batch->alloc, w->vertexIndices, &w->vertexIndicesMax,
+					  (size_t)w->vertexCount + nverts, w->vertexCount, sizeof(TESSindex) );
+	if( array == NULL ) return;
+	w->vertexIndices = (TESSindex*)array;
+
+	array = GrowArray( &batch->alloc, w->elements, &w->elementsMax,
+					  ((size_t)w->elementCount + nelems) * batch->elementSize,
+					  (size_t)w->elementCount * batch->elementSize, sizeof(TESSindex) );
+	if( array == NULL ) return;
+	w->elements = (TESSindex*)array;
+
+	memcpy( w->vertices + w->vertexCount * batch->vertexSize, tessGetVertices( w->tess ),
+		   nverts * batch->vertexSize * sizeof(TESSreal) );
+	memcpy( w->vertexIndices + w->vertexCount, tessGetVertexIndices( w->tess ),
+		   nverts * sizeof(TESSindex) );
+	memcpy( w->elements + w->elementCount * batch->elementSize, tessGetElements( w->tess ),
+		   nelems * batch->elementSize * sizeof(TESSindex) );
+
+	range->localVertex = w->vertexCount;
+	range->localElement = w->elementCount;
+	range->vertexCount = nverts;
+	range->elementCount = nelems;
+	range->ok = TRUE;
+
+	w->vertexCount += nverts;
+	w->elementCount += nelems;
+}
+
+/* GatherPolygon() copies the result of one polygon from the buffers of the
+* worker which tesselated it to its place in the batch output, making the
+* indices refer to the concatenated arrays.
+*/
+static void GatherPolygon( TESSbatch *batch, int i )
+{
+	const TESSbatchRange *range = &batch->ranges[i];
+	const TESSbatchWorker *w = &batch->workers[range->worker];
+	const TESSindex *src;
+	TESSindex *dst;
+	int j, k, n;
+
+	if( !range->ok ) return;
+
+	memcpy( batch->vertices + range->firstVertex * batch->vertexSize,
+		   w->vertices + range->localVertex * batch->vertexSize,
+		   range->vertexCount * batch->vertexSize * sizeof(TESSreal) );
+	memcpy( batch->vertexIndices + range->firstVertex,
+		   w->vertexIndices + range->localVertex,
+		   range->vertexCount * sizeof(TESSindex) );
+
+	src = w->elements + range->localElement * batch->elementSize;
+	dst = batch->elements + range->firstElement * batch->elementSize;
+	n = range->elementCount;
+
+	if( batch->elementType == TESS_BOUNDARY_CONTOURS ) {
+		/* [base, count] pairs, only the base is an index. */
+		for( j = 0; j < n; ++j, src += 2, dst += 2 ) {
+			dst[0] = src[0] + range->firstVertex;
+			dst[1] = src[1];
+		}
+		return;
+	}
+
+	for( j = 0; j < n; ++j ) {
+		for( k = 0; k < batch->polySize; ++k, ++src, ++dst )
+			*dst = *src == TESS_UNDEF ? TESS_UNDEF : *src + range->firstVertex;
+		if( batch->elementType == TESS_CONNECTED_POLYGONS ) {
+			/* Followed by the indices of the neighbour polygons. */
+			for( k = 0; k < batch->polySize; ++k, ++src, ++dst )
+				*dst = *src == TESS_UNDEF ? TESS_UNDEF : *src + range->firstElement;
+		}
+	}
+}
+
+/* RunChunks() takes chunks of the current phase until none are left. */
+static void RunChunks( TESSbatchWorker *w )
+{
+	TESSbatch *batch = w->batch;
+	int chunk, i, end;
+
+	for( ;; ) {
+		MutexLock( &batch->lock );
+		chunk = batch->nextChunk++;
+		MutexUnlock( &batch->lock );
+		if( chunk >= batch->chunkCount )
+			break;
+
+		i = chunk * batch->chunkSize;
+		end = i + batch->chunkSize;
+		if( end > batch->polygonCount )
+			end = batch->polygonCount;
+
+		for( ; i < end; ++i ) {
+			if( batch->phase == PHASE_TESSELATE )
+				TesselatePolygon( w, i );
+			else
+				GatherPolygon( batch, i );
+		}
+	}
+}
+
+static void WorkerLoop( TESSbatchWorker *w )
+{
+	TESSbatch *batch = w->batch;
+	int seen = 0;
+
+	for( ;; ) {
+		MutexLock( &batch->lock );
+		while( batch->generation == seen && !batch->quit )
+			CondWait( &batch->wake, &batch->lock );
+		if( batch->quit ) {
+			MutexUnlock( &batch->lock );
+			return;
+		}
+		seen = batch->generation;
+		MutexUnlock( &batch->lock );
+
+		RunChunks( w );
+
+		MutexLock( &batch->lock );
+		if( --batch->busy == 0 )
+			CondBroadcast( &batch->done );
+		MutexUnlock( &batch->lock );
+	}
+}
+
+#ifdef _WIN32
+static DWORD WINAPI WorkerMain( LPVOID arg )
+{
+	WorkerLoop( (TESSbatchWorker*)arg );
+	return 0;
+}
+#else
+static void* WorkerMain( void *arg )
+{
+	WorkerLoop( (TESSbatchWorker*)arg );
+	return NULL;
+}
+#endif
+
+/* RunPhase() runs a phase on all the workers, the calling thread being
+* worker 0, and returns when the phase is complete.
+*/
+static void RunPhase( TESSbatch *batch, int phase )
+{
+	MutexLock( &batch->lock );
+	batch->phase = phase;
+	batch->nextChunk = 0;
+	batch->busy = batch->threadCount - 1;
+	batch->generation++;
+	CondBroadcast( &batch->wake );
+	MutexUnlock( &batch->lock );
+
+	RunChunks( &batch->workers[0] );
+
+	MutexLock( &batch->lock );
+	while( batch->busy > 0 )
+		CondWait( &batch->done, &batch->lock );
+	MutexUnlock( &batch->lock );
+}
+
+static int CPUCount( void )
+{
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo( &info );
+	return (int)info.dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+	long n = sysconf( _SC_NPROCESSORS_ONLN );
+	return n > 0 ? (int)n : 1;
+#else
+	return 1;
+#endif
+}
+
+extern void* heapAlloc( void* userData, unsigned int size );
+extern void* heapRealloc( void *userData, void* ptr, unsigned int size );
+extern void heapFree( void* userData, void* ptr );
+
+TESSbatch* tessNewBatch( TESSalloc* alloc, int threadCount )
+{
+	TESSalloc defaultAlloc;
+	TESSbatch* batch;
+	int i;
+
+	if( alloc == NULL ) {
+		memset( &defaultAlloc, 0, sizeof(defaultAlloc) );
+		defaultAlloc.memalloc = heapAlloc;
+		defaultAlloc.memrealloc = heapRealloc;
+		defaultAlloc.memfree = heapFree;
+		alloc = &defaultAlloc;
+	}
+
+	if( threadCount <= 0 )
+		threadCount = CPUCount();
+	if( threadCount > MAX_THREADS )
+		threadCount = MAX_THREADS;
+
+	batch = (TESSbatch*)alloc->memalloc( alloc->userData, sizeof(TESSbatch) );
+	if( batch == NULL )
+		return NULL;
+	memset( batch, 0, sizeof(TESSbatch) );
+	batch->alloc = *alloc;
+
+	MutexInit( &batch->lock );
+	CondInit( &batch->wake );
+	CondInit( &batch->done );
+
+	for( i = 0; i < threadCount; ++i ) {
+		TESSbatchWorker *w = &batch->workers[i];
+
+		w->batch = batch;
+		w->index = i;
+		w->tess = tessNewTess( &batch->alloc );
+		if( w->tess == NULL )
+			break;
+
+		/* Worker 0 is the thread calling tessBatchTesselate(). */
+		if( i > 0 ) {
+#ifdef _WIN32
+			w->thread = CreateThread( NULL, 0, WorkerMain, w, 0, NULL );
+			if( w->thread == NULL ) {
+#else
+			if( pthread_create( &w->thread, NULL, WorkerMain, w ) != 0 ) {
+#endif
+				tessDeleteTess( w->tess );
+				w->tess = NULL;
+				break;
+			}
+		}
+		batch->threadCount = i + 1;
+	}
+
+	if( batch->threadCount == 0 ) {
+		tessDeleteBatch( batch );
+		return NULL;
+	}
+
+	return batch;
+}
+
+void tessDeleteBatch( TESSbatch *batch )
+{
+	TESSalloc alloc = batch->alloc;
+	int i;
+
+	MutexLock( &batch->lock );
+	batch->quit = TRUE;
+	CondBroadcast( &batch->wake );
+	MutexUnlock( &batch->lock );
+
+	for( i = 0; i < batch->threadCount; ++i ) {
+		TESSbatchWorker *w = &batch->workers[i];
+
+		if( i > 0 ) {
+#ifdef _WIN32
+			WaitForSingleObject( w->thread, INFINITE );
+			CloseHandle( w->thread );
+#else
+			pthread_join( w->thread, NULL );
+#endif
+		}
+		tessDeleteTess( w->tess );
+		if( w->vertices ) alloc.memfree( alloc.userData, w->vertices );
+		if( w->vertexIndices ) alloc.memfree( alloc.userData, w->vertexIndices );
+		if( w->elements ) alloc.memfree( alloc.userData, w->elements );
+	}
+
+	CondDestroy( &batch->done );
+	CondDestroy( &batch->wake );
+	MutexDestroy( &batch->lock );
+
+	if( batch->ranges ) alloc.memfree( alloc.userData, batch->ranges );
+	if( batch->vertices ) alloc.memfree( alloc.userData, batch->vertices );
+	if( batch->vertexIndices ) alloc.memfree( alloc.userData, batch->vertexIndices );
+	if( batch->elements ) alloc.memfree( alloc.userData, batch->elements );
+
+	alloc.memfree( alloc.userData, batch );
+}
+
+void tessBatchSetOption( TESSbatch *batch, int option, int value )
+{
+	int i;
+
+	for( i = 0; i < batch->threadCount; ++i )
+		tessSetOption( batch->workers[i].tess, option, value );
+}
+
+int tessBatchTesselate( TESSbatch *batch, const TESSpolygon *polygons, int polygonCount,
+					   int elementType, int polySize, int vertexSize, const TESSreal *normal )
+{
+	void *array;
+	int i, ok = 0;
+	int vertexCount = 0, elementCount = 0;
+
+	batch->vertexCount = 0;
+	batch->elementCount = 0;
+	batch->rangeCount = 0;
+
+	if( vertexSize < 2 )
+		vertexSize = 2;
+	if( vertexSize > 3 )
+		vertexSize = 3;
+
+	batch->polygons = polygons;
+	batch->polygonCount = polygonCount;
+	batch->elementType = elementType;
+	batch->polySize = polySize;
+	batch->vertexSize = vertexSize;
+	if( elementType == TESS_BOUNDARY_CONTOURS )
+		batch->elementSize = 2;
+	else if( elementType == TESS_CONNECTED_POLYGONS )
+		batch->elementSize = polySize * 2;
+	else
+		batch->elementSize = polySize;
+
+	batch->normal = NULL;
+	if( normal ) {
+		batch->normalStore[0] = normal[0];
+		batch->normalStore[1] = normal[1];
+		batch->normalStore[2] = normal[2];
+		batch->normal = batch->normalStore;
+	}
+
+	if( polygonCount <= 0 )
+		return 0;
+
+	array = GrowArray( &batch->alloc, batch->ranges, &batch->rangesMax,
+					  polygonCount, 0, sizeof(TESSbatchRange) );
+	if( array == NULL )
+		return 0;
+	batch->ranges = (TESSbatchRange*)array;
+
+	/* Small chunks balance the load, large ones limit the locking. */
+	batch->chunkSize = polygonCount / (batch->threadCount * 16);
+	if( batch->chunkSize < 1 )
+		batch->chunkSize = 1;
+	batch->chunkCount = (polygonCount + batch->chunkSize - 1) / batch->chunkSize;
+
+	for( i = 0; i < batch->threadCount; ++i ) {
+		batch->workers[i].vertexCount = 0;
+		batch->workers[i].elementCount = 0;
+	}
+
+	RunPhase( batch, PHASE_TESSELATE );
+
+	/* Lay the results out in the order of the polygons. */
+	for( i = 0; i < polygonCount; ++i ) {
+		TESSbatchRange *range = &batch->ranges[i];
+
+		range->firstVertex = vertexCount;
+		range->firstElement = elementCount;
+		vertexCount += range->vertexCount;
+		elementCount += range->elementCount;
+		if( range->ok )
+			ok++;
+	}
+
+	array = GrowArray( &batch->alloc, batch->vertices, &batch->verticesMax,
+					  (size_t)vertexCount * vertexSize, 0, sizeof(TESSreal) );
+	if( array == NULL )
+		return 0;
+	batch->vertices = (TESSreal*)array;
+
+	array = GrowArray( &batch->alloc, batch->vertexIndices, &batch->vertexIndicesMax,
+					  vertexCount, 0, sizeof(TESSindex) );
+	if( array == NULL )
+		return 0;
+	batch->vertexIndices = (TESSindex*)array;
+
+	array = GrowArray( &batch->alloc, batch->elements, &batch->elementsMax,
+					  (size_t)elementCount * batch->elementSize, 0, sizeof(TESSindex) );
+	if( array == NULL )
+		return 0;
+	batch->elements = (TESSindex*)array;
+
+	RunPhase( batch, PHASE_GATHER );
+
+	batch->vertexCount = vertexCount;
+	batch->elementCount = elementCount;
+	batch->rangeCount = polygonCount;
+
+	return ok;
+}
+
+int tessBatchGetVertexCount( TESSbatch *batch )
+{
+	return batch->vertexCount;
+}
+
+const TESSreal* tessBatchGetVertices( TESSbatch *batch )
+{
+	return batch->vertices;
+}
+
+const TESSindex* tessBatchGetVertexIndices( TESSbatch *batch )
+{
+	return batch->vertexIndices;
+}
+
+int tessBatchGetElementCount( TESSbatch *batch )
+{
+	return batch->elementCount;
+}
+
+const TESSindex* tessBatchGetElements( TESSbatch *batch )
+{
+	return batch->elements;
+}
+
+int tessBatchGetRange( TESSbatch *batch, int polygon, int *firstVertex, int *vertexCount,
+					  int *firstElement, int *elementCount )
+{
+	const TESSbatchRange *range;
+
+	if( polygon < 0 || polygon >= batch->rangeCount )
+		return 0;
+
+	range = &batch->ranges[polygon];
+	if( firstVertex ) *firstVertex = range->firstVertex;
+	if( vertexCount ) *vertexCount = range->vertexCount;
+	if( firstElement ) *firstElement = range->firstElement;
+	if( elementCount ) *elementCount = range->elementCount;
+
+	return range->ok;
+}
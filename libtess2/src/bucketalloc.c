@@ -47,19 +47,26 @@ struct BucketAlloc
 {
 	void *freelist;
 	Bucket *buckets;
+	Bucket *current;		// Bucket handing out its never used items.
+	unsigned char *unused;	// Next never used item of the current bucket.
+	unsigned char *end;
 	unsigned int itemSize;
 	unsigned int bucketSize;
 	const char *name;
 	TESSalloc* alloc;
 };
 
+static void UseBucket( struct BucketAlloc* ba, Bucket* bucket )
+{
+	ba->current = bucket;
+	ba->unused = (unsigned char*)bucket + sizeof(Bucket);
+	ba->end = ba->unused + ba->itemSize * ba->bucketSize;
+}
+
 static int CreateBucket( struct BucketAlloc* ba )
 {
 	size_t size;
 	Bucket* bucket;
-	void* freelist;
-	unsigned char* head;
-	unsigned char* it;
 
 	// Allocate memory for the bucket
 	size = sizeof(Bucket) + ba->itemSize * ba->bucketSize;
@@ -68,38 +75,24 @@ static int CreateBucket( struct BucketAlloc* ba )
 		return 0;
 	bucket->next = 0;
 
-	// Add the bucket into the list of buckets.
-	bucket->next = ba->buckets;
-	ba->buckets = bucket;
+	// Add the bucket at the end of the list of buckets, which is walked
+	// in order as the items are used.
+	if ( ba->current )
+		ba->current->next = bucket;
+	else
+		ba->buckets = bucket;
 
-	// Add new items to the free list.
-	freelist = ba->freelist;
-	head = (unsigned char*)bucket + sizeof(Bucket);
-	it = head + ba->itemSize * ba->bucketSize;
-	do
-	{
-		it -= ba->itemSize;
-		// Store pointer to next free item.
-		*((void**)it) = freelist;
-		// Pointer to next location containing a free item.
-		freelist = (void*)it;
-	}
-	while ( it != head );
-	// Update pointer to next location containing a free item.
-	ba->freelist = (void*)it;
+	UseBucket( ba, bucket );
 
 	return 1;
 }
 
-static void *NextFreeItem( struct BucketAlloc *ba )
-{
-	return *(void**)ba->freelist;
-}
-
 struct BucketAlloc* createBucketAlloc( TESSalloc* alloc, const char* name,
 									  unsigned int itemSize, unsigned int bucketSize )
 {
 	BucketAlloc* ba = (BucketAlloc*)alloc->memalloc( alloc->userData, sizeof(BucketAlloc) );
+	if ( !ba )
+		return 0;
 
 	ba->alloc = alloc;
 	ba->name = name;
@@ -109,6 +102,9 @@ struct BucketAlloc* createBucketAlloc( TESSalloc* alloc, const char* name,
 	ba->bucketSize = bucketSize;
 	ba->freelist = 0;
 	ba->buckets = 0;
+	ba->current = 0;
+	ba->unused = 0;
+	ba->end = 0;
 
 	if ( !CreateBucket( ba ) )
 	{
@@ -123,16 +119,25 @@ void* bucketAlloc( struct BucketAlloc *ba )
 {
 	void *it;
 
-	// If running out of memory, allocate new bucket and update the freelist.
-	if ( !ba->freelist || !NextFreeItem( ba ) )
+	// Pop item from in front of the free list.
+	if ( ba->freelist )
 	{
-		if ( !CreateBucket( ba ) )
-			return 0;
+		it = ba->freelist;
+		ba->freelist = *(void**)it;
+		return it;
 	}
 
-	// Pop item from in front of the free list.
-	it = ba->freelist;
-	ba->freelist = NextFreeItem( ba );
+	// Otherwise take the next never used item, moving to the next bucket,
+	// or allocating a new one, when the current bucket is used up.
+	if ( ba->unused == ba->end )
+	{
+		if ( ba->current->next )
+			UseBucket( ba, ba->current->next );
+		else if ( !CreateBucket( ba ) )
+			return 0;
+	}
+	it = ba->unused;
+	ba->unused += ba->itemSize;
 
 	return it;
 }
@@ -174,6 +179,15 @@ void bucketFree( struct BucketAlloc *ba, void *ptr )
 #endif
 }
 
+// Makes every item available again in constant time, keeping the buckets
+// allocated.
+// Any pointer previously returned by bucketAlloc() becomes invalid.
+void resetBucketAlloc( struct BucketAlloc *ba )
+{
+	ba->freelist = 0;
+	UseBucket( ba, ba->buckets );
+}
+
 void deleteBucketAlloc( struct BucketAlloc *ba )
 {
 	TESSalloc* alloc = ba->alloc;
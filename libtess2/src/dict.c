@@ -56,10 +56,26 @@ Dict *dictNewDict( TESSalloc* alloc, void *frame, int (*leq)(void *frame, DictKe
 	if (alloc->dictNodeBucketSize > 4096)
 		alloc->dictNodeBucketSize = 4096;
 	dict->nodePool = createBucketAlloc( alloc, "Dict", sizeof(DictNode), alloc->dictNodeBucketSize );
+	if (dict->nodePool == NULL) {
+		alloc->memfree( alloc->userData, dict );
+		return NULL;
+	}
 
 	return dict;
 }
 
+/* really tessDictListReset */
+void dictReset( Dict *dict )
+{
+	DictNode *head = &dict->head;
+
+	head->key = NULL;
+	head->next = head;
+	head->prev = head;
+
+	resetBucketAlloc( dict->nodePool );
+}
+
 /* really tessDictListDeleteDict */
 void dictDeleteDict( TESSalloc* alloc, Dict *dict )
 {
@@ -248,6 +248,56 @@ static void KillFace( TESSmesh *mesh, TESSface *fDel, TESSface *newLface )
 	bucketFree( mesh->faceBucket, fDel );
 }
 
+/* ShorterLoop( a, b ) walks the face loops of a and b in step, and returns
+* the one of a and b whose loop is shorter, or a if they have the same
+* length.  The work done is proportional to the shorter loop.
+*/
+static TESShalfEdge *ShorterLoop( TESShalfEdge *a, TESShalfEdge *b )
+{
+	TESShalfEdge *ea = a->Lnext;
+	TESShalfEdge *eb = b->Lnext;
+
+	for( ;; ) {
+		if( ea == a ) return a;
+		if( eb == b ) return b;
+		ea = ea->Lnext;
+		eb = eb->Lnext;
+	}
+}
+
+/* SplitFace( newFace, eNew, eOld ) is called once one loop has been split in
+* two, eNew and eOld being on either side, and all edges still pointing to the
+* old face.  The new face is attached to the shorter of the two loops, so that
+* splitting a long loop repeatedly is not quadratic.  Both faces are left
+* pointing to a valid half-edge.
+*/
+static void SplitFace( TESSface *newFace, TESShalfEdge *eNew, TESShalfEdge *eOld )
+{
+	TESSface *fOld = eOld->Lface;
+
+	if( ShorterLoop( eNew, eOld ) == eOld ) {
+		TESShalfEdge *e = eNew;
+		eNew = eOld;
+		eOld = e;
+	}
+	MakeFace( newFace, eNew, fOld );
+	fOld->anEdge = eOld;
+}
+
+/* JoinFaces( fDel, fKeep ) is called before two loops are joined into one,
+* which keeps the "inside" flag of fKeep.  The face of the shorter loop is
+* destroyed, fDel if they have the same length, and the other one updated.
+*/
+static void JoinFaces( TESSmesh *mesh, TESSface *fDel, TESSface *fKeep )
+{
+	if( ShorterLoop( fDel->anEdge, fKeep->anEdge ) == fDel->anEdge ) {
+		KillFace( mesh, fDel, fKeep );
+	} else {
+		fDel->inside = fKeep->inside;
+		KillFace( mesh, fKeep, fDel );
+	}
+}
+
 
 /****************** Basic Edge Operations **********************/
 
@@ -293,7 +343,11 @@ TESShalfEdge *tessMeshMakeEdge( TESSmesh *mesh )
 * Similarly (and independently) for the face structure,
 *  - if eOrg->Lface == eDst->Lface, one loop is split into two
 *  - if eOrg->Lface != eDst->Lface, two distinct loops are joined into one
-* In both cases, eDst->Lface is changed and eOrg->Lface is unaffected.
+* When joining, the face of the shorter loop is destroyed (eDst->Lface if
+* they have the same length), and the remaining face takes the "inside"
+* flag of eOrg->Lface.  When splitting, the new face is given to the
+* shorter of the two loops (eDst's loop if they have the same length).
+* Either way the work done is proportional to the shorter loop.
 *
 * Some special cases:
 * If eDst == eOrg, the operation has no effect.
@@ -315,9 +369,9 @@ int tessMeshSplice( TESSmesh* mesh, TESShalfEdge *eOrg, TESShalfEdge *eDst )
 		KillVertex( mesh, eDst->Org, eOrg->Org );
 	}
 	if( eDst->Lface != eOrg->Lface ) {
-		/* We are connecting two disjoint loops -- destroy eDst->Lface */
+		/* We are connecting two disjoint loops -- destroy one face */
 		joiningLoops = TRUE;
-		KillFace( mesh, eDst->Lface, eOrg->Lface );
+		JoinFaces( mesh, eDst->Lface, eOrg->Lface );
 	}
 
 	/* Change the edge structure */
@@ -337,11 +391,10 @@ int tessMeshSplice( TESSmesh* mesh, TESShalfEdge *eOrg, TESShalfEdge *eDst )
 		TESSface *newFace = (TESSface*)bucketAlloc( mesh->faceBucket );  
 		if (newFace == NULL) return 0;
 
-		/* We split one loop into two -- the new loop is eDst->Lface.
-		* Make sure the old face points to a valid half-edge.
+		/* We split one loop into two -- the new loop is the shorter of
+		* eDst->Lface and eOrg->Lface.
 		*/
-		MakeFace( newFace, eDst, eOrg->Lface );
-		eOrg->Lface->anEdge = eOrg;
+		SplitFace( newFace, eDst, eOrg );
 	}
 
 	return 1;
@@ -475,8 +528,9 @@ TESShalfEdge *tessMeshSplitEdge( TESSmesh *mesh, TESShalfEdge *eOrg )
 /* tessMeshConnect( eOrg, eDst ) creates a new edge from eOrg->Dst
 * to eDst->Org, and returns the corresponding half-edge eNew.
 * If eOrg->Lface == eDst->Lface, this splits one loop into two,
-* and the newly created loop is eNew->Lface.  Otherwise, two disjoint
-* loops are merged into one, and the loop eDst->Lface is destroyed.
+* and the new face is given to the shorter of eNew->Lface and
+* eNew->Rface (eNew->Lface if they have the same length).  Otherwise, two
+* disjoint loops are merged into one, as in tessMeshSplice().
 *
 * If (eOrg == eDst), the new face will have only two edges.
 * If (eOrg->Lnext == eDst), the old face is reduced to a single edge.
@@ -492,9 +546,9 @@ TESShalfEdge *tessMeshConnect( TESSmesh *mesh, TESShalfEdge *eOrg, TESShalfEdge
 	eNewSym = eNew->Sym;
 
 	if( eDst->Lface != eOrg->Lface ) {
-		/* We are connecting two disjoint loops -- destroy eDst->Lface */
+		/* We are connecting two disjoint loops -- destroy one face */
 		joiningLoops = TRUE;
-		KillFace( mesh, eDst->Lface, eOrg->Lface );
+		JoinFaces( mesh, eDst->Lface, eOrg->Lface );
 	}
 
 	/* Connect the new edge appropriately */
@@ -513,8 +567,10 @@ TESShalfEdge *tessMeshConnect( TESSmesh *mesh, TESShalfEdge *eOrg, TESShalfEdge
 		TESSface *newFace= (TESSface*)bucketAlloc( mesh->faceBucket );
 		if (newFace == NULL) return NULL;
 
-		/* We split one loop into two -- the new loop is eNew->Lface */
-		MakeFace( newFace, eNew, eOrg->Lface );
+		/* We split one loop into two -- the new loop is the shorter of
+		* eNew->Lface and eNewSym->Lface.
+		*/
+		SplitFace( newFace, eNew, eNewSym );
 	}
 	return eNew;
 }
@@ -574,38 +630,14 @@ void tessMeshZapFace( TESSmesh *mesh, TESSface *fZap )
 }
 
 
-/* tessMeshNewMesh() creates a new mesh with no edges, no vertices,
-* and no loops (what we usually call a "face").
+/* InitMeshHeads( mesh ) sets up the dummy header nodes of an empty mesh.
 */
-TESSmesh *tessMeshNewMesh( TESSalloc* alloc )
+static void InitMeshHeads( TESSmesh *mesh )
 {
 	TESSvertex *v;
 	TESSface *f;
 	TESShalfEdge *e;
 	TESShalfEdge *eSym;
-	TESSmesh *mesh = (TESSmesh *)alloc->memalloc( alloc->userData, sizeof( TESSmesh ));
-	if (mesh == NULL) {
-		return NULL;
-	}
-	
-	if (alloc->meshEdgeBucketSize < 16)
-		alloc->meshEdgeBucketSize = 16;
-	if (alloc->meshEdgeBucketSize > 4096)
-		alloc->meshEdgeBucketSize = 4096;
-	
-	if (alloc->meshVertexBucketSize < 16)
-		alloc->meshVertexBucketSize = 16;
-	if (alloc->meshVertexBucketSize > 4096)
-		alloc->meshVertexBucketSize = 4096;
-	
-	if (alloc->meshFaceBucketSize < 16)
-		alloc->meshFaceBucketSize = 16;
-	if (alloc->meshFaceBucketSize > 4096)
-		alloc->meshFaceBucketSize = 4096;
-
-	mesh->edgeBucket = createBucketAlloc( alloc, "Mesh Edges", sizeof(EdgePair), alloc->meshEdgeBucketSize );
-	mesh->vertexBucket = createBucketAlloc( alloc, "Mesh Vertices", sizeof(TESSvertex), alloc->meshVertexBucketSize );
-	mesh->faceBucket = createBucketAlloc( alloc, "Mesh Faces", sizeof(TESSface), alloc->meshFaceBucketSize );
 
 	v = &mesh->vHead;
 	f = &mesh->fHead;
@@ -638,11 +670,56 @@ TESSmesh *tessMeshNewMesh( TESSalloc* alloc )
 	eSym->Lface = NULL;
 	eSym->winding = 0;
 	eSym->activeRegion = NULL;
+}
+
+/* tessMeshNewMesh() creates a new mesh with no edges, no vertices,
+* and no loops (what we usually call a "face").
+*/
+TESSmesh *tessMeshNewMesh( TESSalloc* alloc )
+{
+	TESSmesh *mesh = (TESSmesh *)alloc->memalloc( alloc->userData, sizeof( TESSmesh ));
+	if (mesh == NULL) {
+		return NULL;
+	}
+	
+	if (alloc->meshEdgeBucketSize < 16)
+		alloc->meshEdgeBucketSize = 16;
+	if (alloc->meshEdgeBucketSize > 4096)
+		alloc->meshEdgeBucketSize = 4096;
+	
+	if (alloc->meshVertexBucketSize < 16)
+		alloc->meshVertexBucketSize = 16;
+	if (alloc->meshVertexBucketSize > 4096)
+		alloc->meshVertexBucketSize = 4096;
+	
+	if (alloc->meshFaceBucketSize < 16)
+		alloc->meshFaceBucketSize = 16;
+	if (alloc->meshFaceBucketSize > 4096)
+		alloc->meshFaceBucketSize = 4096;
+
+	mesh->edgeBucket = createBucketAlloc( alloc, "Mesh Edges", sizeof(EdgePair), alloc->meshEdgeBucketSize );
+	mesh->vertexBucket = createBucketAlloc( alloc, "Mesh Vertices", sizeof(TESSvertex), alloc->meshVertexBucketSize );
+	mesh->faceBucket = createBucketAlloc( alloc, "Mesh Faces", sizeof(TESSface), alloc->meshFaceBucketSize );
+
+	InitMeshHeads( mesh );
 
 	return mesh;
 }
 
 
+/* tessMeshResetMesh( mesh ) empties a mesh, keeping the memory of its
+* edges, vertices and faces for reuse.
+*/
+void tessMeshResetMesh( TESSmesh *mesh )
+{
+	resetBucketAlloc( mesh->edgeBucket );
+	resetBucketAlloc( mesh->vertexBucket );
+	resetBucketAlloc( mesh->faceBucket );
+
+	InitMeshHeads( mesh );
+}
+
+
 /* tessMeshUnion( mesh1, mesh2 ) forms the union of all structures in
 * both meshes, and returns the new mesh (the old meshes are destroyed).
 */
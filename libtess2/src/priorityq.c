@@ -31,6 +31,7 @@
 
 //#include "tesos.h"
 #include <stddef.h>
+#include <string.h>
 #include <assert.h>
 #include "tesselator.h"
 #include "priorityq.h"
@@ -175,6 +176,36 @@ static void FloatUp( PriorityQHeap *pq, int curr )
 	}
 }
 
+/* really pqHeapReset */
+static int pqHeapReset( TESSalloc* alloc, PriorityQHeap *pq, int size )
+{
+	if( size > pq->max ) {
+		PQnode *nodes;
+		PQhandleElem *handles;
+
+		nodes = (PQnode *)alloc->memalloc( alloc->userData, (size + 1) * sizeof(pq->nodes[0]) );
+		handles = (PQhandleElem *)alloc->memalloc( alloc->userData, (size + 1) * sizeof(pq->handles[0]) );
+		if (nodes == NULL || handles == NULL) {
+			if (nodes != NULL) alloc->memfree( alloc->userData, nodes );
+			if (handles != NULL) alloc->memfree( alloc->userData, handles );
+			return 0;
+		}
+		alloc->memfree( alloc->userData, pq->nodes );
+		alloc->memfree( alloc->userData, pq->handles );
+		pq->nodes = nodes;
+		pq->handles = handles;
+		pq->max = size;
+	}
+
+	pq->size = 0;
+	pq->initialized = FALSE;
+	pq->freeList = 0;
+
+	pq->nodes[1].handle = 1;	/* so that Minimum() returns NULL */
+	pq->handles[1].key = NULL;
+	return 1;
+}
+
 /* really pqHeapInit */
 void pqHeapInit( PriorityQHeap *pq )
 {
@@ -313,20 +344,48 @@ PriorityQ *pqNewPriorityQ( TESSalloc* alloc, int size, int (*leq)(PQkey key1, PQ
 		return NULL;
 	}
 
+	pq->order = NULL;
+	pq->orderMax = 0;
+	pq->sortItems = NULL;
+	pq->sortItemsMax = 0;
+
 	pq->size = 0;
 	pq->max = size; //INIT_SIZE;
+	pq->keysMax = size;
 	pq->initialized = FALSE;
 	pq->leq = leq;
 	
 	return pq;
 }
 
+/* really tessPqSortReset */
+/* empties the queue for reuse, making room for at least size keys */
+int pqReset( TESSalloc* alloc, PriorityQ *pq, int size )
+{
+	if (!pqHeapReset( alloc, pq->heap, size )) return 0;
+
+	if( size > pq->keysMax ) {
+		PQkey *keys = (PQkey *)alloc->memalloc( alloc->userData, size * sizeof(pq->keys[0]) );
+		if (keys == NULL) return 0;
+		alloc->memfree( alloc->userData, pq->keys );
+		pq->keys = keys;
+		pq->keysMax = size;
+	}
+
+	pq->size = 0;
+	pq->max = pq->keysMax;
+	pq->initialized = FALSE;
+
+	return 1;
+}
+
 /* really tessPqSortDeletePriorityQ */
 void pqDeletePriorityQ( TESSalloc* alloc, PriorityQ *pq )
 {
 	assert(pq != NULL); 
 	if (pq->heap != NULL) pqHeapDeletePriorityQ( alloc, pq->heap );
 	if (pq->order != NULL) alloc->memfree( alloc->userData, pq->order );
+	if (pq->sortItems != NULL) alloc->memfree( alloc->userData, pq->sortItems );
 	if (pq->keys != NULL) alloc->memfree( alloc->userData, pq->keys );
 	alloc->memfree( alloc->userData, pq );
 }
@@ -336,37 +395,17 @@ void pqDeletePriorityQ( TESSalloc* alloc, PriorityQ *pq )
 #define GT(x,y)     (! LEQ(x,y))
 #define Swap(a,b)   if(1){PQkey *tmp = *a; *a = *b; *b = tmp;}else
 
-/* really tessPqSortInit */
-int pqInit( TESSalloc* alloc, PriorityQ *pq )
+/* Sort the indirect pointers in descending order,
+* using randomized Quicksort
+*/
+static void QuickSort( PriorityQ *pq )
 {
 	PQkey **p, **r, **i, **j, *piv;
 	struct { PQkey **p, **r; } Stack[50], *top = Stack;
 	unsigned int seed = 2016473283;
 
-	/* Create an array of indirect pointers to the keys, so that we
-	* the handles we have returned are still valid.
-	*/
-	/*
-	pq->order = (PQkey **)memAlloc( (size_t)
-	(pq->size * sizeof(pq->order[0])) );
-	*/
-	pq->order = (PQkey **)alloc->memalloc( alloc->userData,
-										  (size_t)((pq->size+1) * sizeof(pq->order[0])) );
-	/* the previous line is a patch to compensate for the fact that IBM */
-	/* machines return a null on a malloc of zero bytes (unlike SGI),   */
-	/* so we have to put in this defense to guard against a memory      */
-	/* fault four lines down. from fossum@austin.ibm.com.               */
-	if (pq->order == NULL) return 0;
-
 	p = pq->order;
 	r = p + pq->size - 1;
-	for( piv = pq->keys, i = p; i <= r; ++piv, ++i ) {
-		*i = piv;
-	}
-
-	/* Sort the indirect pointers in descending order,
-	* using randomized Quicksort
-	*/
 	top->p = p; top->r = r; ++top;
 	while( --top >= Stack ) {
 		p = top->p;
@@ -402,6 +441,147 @@ int pqInit( TESSalloc* alloc, PriorityQ *pq )
 			*j = piv;
 		}
 	}
+}
+
+#ifndef FOR_TRITE_TEST_PROGRAM
+
+/* Large queues are sorted by radix on the vertex coordinates instead,
+* which is only possible when the keys are known to be vertices.
+*/
+#define RADIX_SORT_MIN	4096
+#define RADIX_BITS	11
+#define RADIX_SIZE	(1 << RADIX_BITS)
+
+#ifdef TESS_USE_DOUBLE
+typedef unsigned long long PQsortBits;
+#else
+typedef unsigned int PQsortBits;
+#endif
+
+typedef struct {
+	PQsortBits s, t;
+	PQkey *key;
+} PQsortItem;
+
+/* SortBits() maps a coordinate to an unsigned integer of the same order,
+* inverted so that an ascending sort gives the descending order we want.
+*/
+static PQsortBits SortBits( TESSreal x )
+{
+	const PQsortBits sign = (PQsortBits)1 << (sizeof(PQsortBits) * 8 - 1);
+	PQsortBits bits;
+
+	if( x == 0 ) x = 0;		/* -0 and +0 are equal for VertLeq */
+	memcpy( &bits, &x, sizeof(bits) );
+	bits = (bits & sign) ? ~bits : (bits | sign);
+	return ~bits;
+}
+
+#define WORD_DIGITS	(((int)sizeof(PQsortBits) * 8 + RADIX_BITS - 1) / RADIX_BITS)
+#define SORT_DIGITS	(2 * WORD_DIGITS)
+#define SortDigit(item,d)	((unsigned int)(((d) < WORD_DIGITS \
+	? (item)->t >> ((d) * RADIX_BITS) \
+	: (item)->s >> (((d) - WORD_DIGITS) * RADIX_BITS)) & (RADIX_SIZE - 1)))
+
+/* RadixSort() sorts the indirect pointers in the same order as QuickSort(),
+* with one least significant digit first pass per 11 bits of t, then of s.
+* Passes over a digit which is the same for all keys are skipped, which is
+* common for the high digits of nearby coordinates.  The digit counts live
+* in the scratch buffer too, to keep them off the stack.
+*/
+static int RadixSort( TESSalloc* alloc, PriorityQ *pq )
+{
+	const int countSize = SORT_DIGITS * RADIX_SIZE * (int)sizeof(int);
+	const int itemsOffset = (countSize + (int)sizeof(PQsortItem) - 1)
+		/ (int)sizeof(PQsortItem) * (int)sizeof(PQsortItem);
+	PQsortItem *src, *dst, *tmp, *item;
+	int *count;
+	int i, d, n = pq->size;
+	int size = itemsOffset + 2 * n * (int)sizeof(PQsortItem);
+
+	if( pq->sortItems == NULL || size > pq->sortItemsMax ) {
+		if (pq->sortItems != NULL) alloc->memfree( alloc->userData, pq->sortItems );
+		pq->sortItemsMax = 0;
+		pq->sortItems = alloc->memalloc( alloc->userData, (size_t)size );
+		if (pq->sortItems == NULL) return 0;
+		pq->sortItemsMax = size;
+	}
+	count = (int *)pq->sortItems;
+	src = (PQsortItem *)((char *)pq->sortItems + itemsOffset);
+	dst = src + n;
+
+	memset( count, 0, (size_t)countSize );
+	for( i = 0, item = src; i < n; ++i, ++item ) {
+		TESSvertex *v = (TESSvertex *)pq->keys[i];
+		item->s = SortBits( v->s );
+		item->t = SortBits( v->t );
+		item->key = &pq->keys[i];
+		for( d = 0; d < SORT_DIGITS; ++d )
+			++count[d * RADIX_SIZE + SortDigit( item, d )];
+	}
+
+	for( d = 0; d < SORT_DIGITS; ++d ) {
+		int *c = count + d * RADIX_SIZE;
+		int sum = 0, k;
+
+		if( c[SortDigit( src, d )] == n )
+			continue;
+		for( k = 0; k < RADIX_SIZE; ++k ) {
+			int next = sum + c[k];
+			c[k] = sum;
+			sum = next;
+		}
+		for( i = 0, item = src; i < n; ++i, ++item )
+			dst[c[SortDigit( item, d )]++] = *item;
+		tmp = src; src = dst; dst = tmp;
+	}
+
+	for( i = 0; i < n; ++i )
+		pq->order[i] = src[i].key;
+
+	return 1;
+}
+
+#endif
+
+/* really tessPqSortInit */
+int pqInit( TESSalloc* alloc, PriorityQ *pq )
+{
+	PQkey **p, **r, **i, *piv;
+
+	/* Create an array of indirect pointers to the keys, so that we
+	* the handles we have returned are still valid.
+	*/
+	/*
+	pq->order = (PQkey **)memAlloc( (size_t)
+	(pq->size * sizeof(pq->order[0])) );
+	*/
+	if( pq->order == NULL || pq->size+1 > pq->orderMax ) {
+		if (pq->order != NULL) alloc->memfree( alloc->userData, pq->order );
+		pq->orderMax = 0;
+		pq->order = (PQkey **)alloc->memalloc( alloc->userData,
+											  (size_t)((pq->size+1) * sizeof(pq->order[0])) );
+		/* the previous line is a patch to compensate for the fact that IBM */
+		/* machines return a null on a malloc of zero bytes (unlike SGI),   */
+		/* so we have to put in this defense to guard against a memory      */
+		/* fault four lines down. from fossum@austin.ibm.com.               */
+		if (pq->order == NULL) return 0;
+		pq->orderMax = pq->size+1;
+	}
+
+#ifndef FOR_TRITE_TEST_PROGRAM
+	if( pq->size >= RADIX_SORT_MIN ) {
+		if ( !RadixSort( alloc, pq ) ) return 0;
+	} else
+#endif
+	{
+		p = pq->order;
+		r = p + pq->size - 1;
+		for( piv = pq->keys, i = p; i <= r; ++piv, ++i ) {
+			*i = piv;
+		}
+		QuickSort( pq );
+	}
 	pq->max = pq->size;
 	pq->initialized = TRUE;
 	pqHeapInit( pq->heap );  /* always succeeds */
@@ -443,6 +623,7 @@ PQhandle pqInsert( TESSalloc* alloc, PriorityQ *pq, PQkey keyNew )
 				pq->keys = saveKey;  // restore ptr to free upon return 
 				return INV_HANDLE;
 			}
+			pq->keysMax = pq->max;
 		}
 	}
 	assert(curr != INV_HANDLE); 
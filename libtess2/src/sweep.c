@@ -685,11 +685,9 @@ static int CheckForIntersect( TESStesselator *tess, ActiveRegion *regUp )
 
 	/* General case -- split both edges, splice into new vertex.
 	* When we do the splice operation, the order of the arguments is
-	* arbitrary as far as correctness goes.  However, when the operation
-	* creates a new face, the work done is proportional to the size of
-	* the new face.  We expect the faces in the processed part of
-	* the mesh (ie. eUp->Lface) to be smaller than the faces in the
-	* unprocessed original contours (which will be eLo->Oprev->Lface).
+	* arbitrary as far as correctness goes.  When the operation creates
+	* a new face, the work done is proportional to the smaller of the
+	* two faces, whichever order is used.
 	*/
 	if (tessMeshSplitEdge( tess->mesh, eUp->Sym ) == NULL) longjmp(tess->env,1);
 	if (tessMeshSplitEdge( tess->mesh, eLo->Sym ) == NULL) longjmp(tess->env,1);
@@ -1115,8 +1113,13 @@ static void InitEdgeDict( TESStesselator *tess )
 	TESSreal w, h;
 	TESSreal smin, smax, tmin, tmax;
 
-	tess->dict = dictNewDict( &tess->alloc, tess, (int (*)(void *, DictKey, DictKey)) EdgeLeq );
-	if (tess->dict == NULL) longjmp(tess->env,1);
+	/* The dictionary is kept by the tesselator, along with its node pool. */
+	if (tess->dict != NULL) {
+		dictReset( tess->dict );
+	} else {
+		tess->dict = dictNewDict( &tess->alloc, tess, (int (*)(void *, DictKey, DictKey)) EdgeLeq );
+		if (tess->dict == NULL) longjmp(tess->env,1);
+	}
 
 	w = (tess->bmax[0] - tess->bmin[0]);
 	h = (tess->bmax[1] - tess->bmin[1]);
@@ -1152,7 +1155,6 @@ static void DoneEdgeDict( TESStesselator *tess )
 		DeleteRegion( tess, reg );
 		/*    tessMeshDelete( reg->eUp );*/
 	}
-	dictDeleteDict( &tess->alloc, tess->dict );
 }
 
 
@@ -1207,8 +1209,18 @@ static int InitPriorityQ( TESStesselator *tess )
 	/* Make sure there is enough space for sentinels. */
 	vertexCount += MAX( 8, tess->alloc.extraVertices );
 	
-	pq = tess->pq = pqNewPriorityQ( &tess->alloc, vertexCount, (int (*)(PQkey, PQkey)) tesvertLeq );
-	if (pq == NULL) return 0;
+	/* Reuse the queue of the previous tesselation if there is one. */
+	if (tess->pq != NULL) {
+		if ( !pqReset( &tess->alloc, tess->pq, vertexCount ) ) {
+			pqDeletePriorityQ( &tess->alloc, tess->pq );
+			tess->pq = NULL;
+			return 0;
+		}
+		pq = tess->pq;
+	} else {
+		pq = tess->pq = pqNewPriorityQ( &tess->alloc, vertexCount, (int (*)(PQkey, PQkey)) tesvertLeq );
+		if (pq == NULL) return 0;
+	}
 
 	vHead = &tess->mesh->vHead;
 	for( v = vHead->next; v != vHead; v = v->next ) {
@@ -1226,10 +1238,6 @@ static int InitPriorityQ( TESStesselator *tess )
 }
 
 
-static void DonePriorityQ( TESStesselator *tess )
-{
-	pqDeletePriorityQ( &tess->alloc, tess->pq );
-}
 
 
 static int RemoveDegenerateFaces( TESStesselator *tess, TESSmesh *mesh )
@@ -1283,6 +1291,9 @@ int tessComputeInterior( TESStesselator *tess )
 	*
 	*	e1 < e2  iff  e1.x < e2.x || (e1.x == e2.x && e1.y < e2.y)
 	*/
+	/* No regions survive a sweep, but a failed one may have left some. */
+	resetBucketAlloc( tess->regionPool );
+
 	RemoveDegenerateEdges( tess );
 	if ( !InitPriorityQ( tess ) ) return 0; /* if error */
 	InitEdgeDict( tess );
@@ -1316,7 +1327,6 @@ int tessComputeInterior( TESStesselator *tess )
 	tess->event = ((ActiveRegion *) dictKey( dictMin( tess->dict )))->eUp->Org;
 	DebugEvent( tess );
 	DoneEdgeDict( tess );
-	DonePriorityQ( tess );
 
 	if ( !RemoveDegenerateFaces( tess, tess->mesh ) ) return 0;
 	tessMeshCheckMesh( tess->mesh );
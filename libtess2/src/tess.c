@@ -40,6 +40,7 @@
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #define TRUE 1
 #define FALSE 0
@@ -60,6 +61,8 @@ static void Normalize( TESSreal v[3] )
 #endif
 
 #define ABS(x)	((x) < 0 ? -(x) : (x))
+#define MAX(x,y)	((x) >= (y) ? (x) : (y))
+#define MIN(x,y)	((x) <= (y) ? (x) : (y))
 
 static int LongAxis( TESSreal v[3] )
 {
@@ -152,7 +155,7 @@ static void ComputeNormal( TESStesselator *tess, TESSreal norm[3] )
 
 static void CheckOrientation( TESStesselator *tess )
 {
-	TESSreal area;
+	TESSreal area, tmin;
 	TESSface *f, *fHead = &tess->mesh->fHead;
 	TESSvertex *v, *vHead = &tess->mesh->vHead;
 	TESShalfEdge *e;
@@ -177,9 +180,51 @@ static void CheckOrientation( TESStesselator *tess )
 		tess->tUnit[0] = - tess->tUnit[0];
 		tess->tUnit[1] = - tess->tUnit[1];
 		tess->tUnit[2] = - tess->tUnit[2];
+		tmin = tess->bmin[1];
+		tess->bmin[1] = - tess->bmax[1];
+		tess->bmax[1] = - tmin;
 	}
 }
 
+/* Translate one sweep coordinate by -c, if that is exact for all of
+* [lo,hi]: by Sterbenz lemma, x - c is exact when c/2 <= x <= 2c.
+*/
+static TESSreal CenterOffset( TESSreal lo, TESSreal hi )
+{
+	TESSreal c = lo + (hi - lo) / 2;
+
+	if( c > 0 && lo >= c / 2 && hi <= c * 2 )
+		return c;
+	if( c < 0 && hi <= c / 2 && lo >= c * 2 )
+		return c;
+	return 0;
+}
+
+/* NormalizeBounds() moves the sweep coordinates next to the origin when
+* the polygon is far from it, as with geographic or projected coordinates.
+* The intersections computed by the sweep are then rounded relative to the
+* size of the polygon, rather than to its distance to the origin.  Only the
+* s,t coordinates are moved; the output uses the original coordinates.
+*/
+static void NormalizeBounds( TESStesselator *tess )
+{
+	TESSvertex *v, *vHead = &tess->mesh->vHead;
+	TESSreal ds = CenterOffset( tess->bmin[0], tess->bmax[0] );
+	TESSreal dt = CenterOffset( tess->bmin[1], tess->bmax[1] );
+
+	if( ds == 0 && dt == 0 )
+		return;
+
+	for( v = vHead->next; v != vHead; v = v->next ) {
+		v->s -= ds;
+		v->t -= dt;
+	}
+	tess->bmin[0] -= ds;
+	tess->bmax[0] -= ds;
+	tess->bmin[1] -= dt;
+	tess->bmax[1] -= dt;
+}
+
 #ifdef FOR_TRITE_TEST_PROGRAM
 #include <stdlib.h>
 extern int RandomSweep;
@@ -264,9 +309,6 @@ void tessProjectPolygon( TESStesselator *tess )
 		v->s = Dot( v->coords, sUnit );
 		v->t = Dot( v->coords, tUnit );
 	}
-	if( computedNormal ) {
-		CheckOrientation( tess );
-	}
 
 	/* Compute ST bounds. */
 	first = 1;
@@ -286,6 +328,13 @@ void tessProjectPolygon( TESStesselator *tess )
 			if (v->t > tess->bmax[1]) tess->bmax[1] = v->t;
 		}
 	}
+
+	if( tess->normalize ) {
+		NormalizeBounds( tess );
+	}
+	if( computedNormal ) {
+		CheckOrientation( tess );
+	}
 }
 
 #define AddWinding(eDst,eSrc)	(eDst->winding += eSrc->winding, \
@@ -527,6 +576,9 @@ TESStesselator* tessNewTess( TESSalloc* alloc )
 
 	// Initialize to begin polygon.
 	tess->mesh = NULL;
+	tess->spareMesh = NULL;
+	tess->dict = NULL;
+	tess->pq = NULL;
 
 	tess->outOfMemory = 0;
 	tess->vertexIndexCounter = 0;
@@ -536,6 +588,16 @@ TESStesselator* tessNewTess( TESSalloc* alloc )
 	tess->vertexCount = 0;
 	tess->elements = 0;
 	tess->elementCount = 0;
+	tess->verticesMax = 0;
+	tess->vertexIndicesMax = 0;
+	tess->elementsMax = 0;
+
+	tess->fastPath = 1;
+	tess->normalize = 1;
+	tess->simpleVerts = 0;
+	tess->simpleVertsMax = 0;
+	tess->simpleIndices = 0;
+	tess->simpleIndicesMax = 0;
 
 	return tess;
 }
@@ -551,6 +613,18 @@ void tessDeleteTess( TESStesselator *tess )
 		tessMeshDeleteMesh( &alloc, tess->mesh );
 		tess->mesh = NULL;
 	}
+	if( tess->spareMesh != NULL ) {
+		tessMeshDeleteMesh( &alloc, tess->spareMesh );
+		tess->spareMesh = NULL;
+	}
+	if( tess->dict != NULL ) {
+		dictDeleteDict( &alloc, tess->dict );
+		tess->dict = NULL;
+	}
+	if( tess->pq != NULL ) {
+		pqDeletePriorityQ( &alloc, tess->pq );
+		tess->pq = NULL;
+	}
 	if (tess->vertices != NULL) {
 		alloc.memfree( alloc.userData, tess->vertices );
 		tess->vertices = 0;
@@ -563,10 +637,96 @@ void tessDeleteTess( TESStesselator *tess )
 		alloc.memfree( alloc.userData, tess->elements );
 		tess->elements = 0;
 	}
+	if (tess->simpleVerts != NULL) {
+		alloc.memfree( alloc.userData, tess->simpleVerts );
+		tess->simpleVerts = 0;
+	}
+	if (tess->simpleIndices != NULL) {
+		alloc.memfree( alloc.userData, tess->simpleIndices );
+		tess->simpleIndices = 0;
+	}
 
 	alloc.memfree( alloc.userData, tess );
 }
 
+/* RecycleMesh( tess ) empties the current mesh and keeps it, with the
+* memory of its edges, vertices and faces, for the next contours.
+*/
+static void RecycleMesh( TESStesselator *tess )
+{
+	if( tess->mesh == NULL ) return;
+
+	if( tess->spareMesh != NULL )
+		tessMeshDeleteMesh( &tess->alloc, tess->spareMesh );
+	tessMeshResetMesh( tess->mesh );
+	tess->spareMesh = tess->mesh;
+	tess->mesh = NULL;
+}
+
+void tessReset( TESStesselator *tess )
+{
+	RecycleMesh( tess );
+
+	tess->outOfMemory = 0;
+	tess->vertexIndexCounter = 0;
+
+	tess->normal[0] = 0;
+	tess->normal[1] = 0;
+	tess->normal[2] = 0;
+
+	tess->vertexCount = 0;
+	tess->elementCount = 0;
+}
+
+/* ReserveArray() returns an array of at least count items, reusing array
+* when it is large enough.  Returns NULL, leaving array untouched, if out
+* of memory.
+*/
+static void* ReserveArray( TESStesselator *tess, void *array, int *max,
+						  int count, int itemSize )
+{
+	void *newArray;
+
+	if( array != NULL && count <= *max )
+		return array;
+
+	/* Leave some slack so slowly growing inputs don't reallocate every time. */
+	count += count / 2;
+	if( count < 16 )
+		count = 16;
+
+	newArray = tess->alloc.memalloc( tess->alloc.userData, count * itemSize );
+	if( newArray == NULL )
+		return NULL;
+	if( array != NULL )
+		tess->alloc.memfree( tess->alloc.userData, array );
+	*max = count;
+	return newArray;
+}
+
+static int ReserveOutput( TESStesselator *tess, int vertexCount, int vertexSize,
+						 int elementCount )
+{
+	void *array;
+
+	array = ReserveArray( tess, tess->vertices, &tess->verticesMax,
+						 vertexCount * vertexSize, sizeof(TESSreal) );
+	if( array == NULL ) return 0;
+	tess->vertices = (TESSreal*)array;
+
+	array = ReserveArray( tess, tess->vertexIndices, &tess->vertexIndicesMax,
+						 vertexCount, sizeof(TESSindex) );
+	if( array == NULL ) return 0;
+	tess->vertexIndices = (TESSindex*)array;
+
+	array = ReserveArray( tess, tess->elements, &tess->elementsMax,
+						 elementCount, sizeof(TESSindex) );
+	if( array == NULL ) return 0;
+	tess->elements = (TESSindex*)array;
+
+	return 1;
+}
+
 
 static TESSindex GetNeighbourFace(TESShalfEdge* edge)
 {
@@ -633,30 +793,12 @@ void OutputPolymesh( TESStesselator *tess, TESSmesh *mesh, int elementType, int
 	tess->elementCount = maxFaceCount;
 	if (elementType == TESS_CONNECTED_POLYGONS)
 		maxFaceCount *= 2;
-	tess->elements = (TESSindex*)tess->alloc.memalloc( tess->alloc.userData,
-													  sizeof(TESSindex) * maxFaceCount * polySize );
-	if (!tess->elements)
+	if (!ReserveOutput( tess, maxVertexCount, vertexSize, maxFaceCount * polySize ))
 	{
 		tess->outOfMemory = 1;
 		return;
 	}
-	
 	tess->vertexCount = maxVertexCount;
-	tess->vertices = (TESSreal*)tess->alloc.memalloc( tess->alloc.userData,
-													 sizeof(TESSreal) * tess->vertexCount * vertexSize );
-	if (!tess->vertices)
-	{
-		tess->outOfMemory = 1;
-		return;
-	}
-
-	tess->vertexIndices = (TESSindex*)tess->alloc.memalloc( tess->alloc.userData,
-														    sizeof(TESSindex) * tess->vertexCount );
-	if (!tess->vertexIndices)
-	{
-		tess->outOfMemory = 1;
-		return;
-	}
 	
 	// Output vertices.
 	for ( v = mesh->vHead.next; v != &mesh->vHead; v = v->next )
@@ -712,6 +854,334 @@ void OutputPolymesh( TESStesselator *tess, TESSmesh *mesh, int elementType, int
 	}
 }
 
+/* Fast path for a single contour.
+*
+* Most polygons drawn are one convex or simple contour, for which the sweep
+* is overkill: convex contours are split into fans, and small simple ones
+* triangulated by ear clipping, which is quadratic.  Anything else, and any
+* doubt about the input, is left to the sweep.
+*/
+
+#define MAX_EAR_CLIP_VERTICES	64
+
+static double Orient( const TESSvertex *u, const TESSvertex *v, const TESSvertex *w )
+{
+	return ((double)v->s - u->s) * ((double)w->t - u->t)
+		- ((double)v->t - u->t) * ((double)w->s - u->s);
+}
+
+/* CollectContour() stores the vertices of the only contour of the mesh in
+* tess->simpleVerts, in order.  Returns the number of vertices, or -1 if
+* the mesh holds several contours, or if two consecutive vertices are
+* equal or three are collinear.  The fans and ears must use every input
+* vertex, as the sweep does, or a vertex lying on an edge would become a
+* T-junction with the neighbouring polygons, so such contours are left to
+* the sweep.
+*/
+static int CollectContour( TESStesselator *tess )
+{
+	TESSmesh *mesh = tess->mesh;
+	TESSvertex *v, **verts;
+	TESShalfEdge *e, *start;
+	int count = 0, n = 0;
+
+	for( v = mesh->vHead.next; v != &mesh->vHead; v = v->next )
+		++count;
+	if( count < 3 )
+		return -1;
+
+	verts = (TESSvertex**)ReserveArray( tess, tess->simpleVerts, &tess->simpleVertsMax,
+									   count, sizeof(TESSvertex*) );
+	if( verts == NULL )
+		return -1;
+	tess->simpleVerts = verts;
+
+	start = e = mesh->vHead.next->anEdge;
+	do {
+		if( n == count )
+			return -1;
+		v = e->Org;
+		if( n > 0 && VertEq( v, verts[n-1] ) )
+			return -1;
+		verts[n++] = v;
+		if( n >= 3 && Orient( verts[n-3], verts[n-2], verts[n-1] ) == 0 )
+			return -1;
+		e = e->Lnext;
+	} while( e != start );
+
+	if( n != count )
+		return -1;
+
+	/* Close the loop. */
+	if( VertEq( verts[n-1], verts[0] )
+		|| Orient( verts[n-2], verts[n-1], verts[0] ) == 0
+		|| Orient( verts[n-1], verts[0], verts[1] ) == 0 )
+		return -1;
+
+	return n;
+}
+
+/* IsConvex() tells whether all turns of the contour have the same
+* direction, and it winds around only once.
+*/
+static int IsConvex( TESSvertex **verts, int n )
+{
+	int i, sign = 0, sFlips = 0, tFlips = 0, sDir = 0, tDir = 0, sFirst = 0, tFirst = 0;
+
+	for( i = 0; i < n; ++i ) {
+		TESSvertex *a = verts[i];
+		TESSvertex *b = verts[(i+1) % n];
+		double o = Orient( a, b, verts[(i+2) % n] );
+		int d;
+
+		if( o == 0 || (sign != 0 && (o > 0) != (sign > 0)) )
+			return 0;
+		sign = o > 0 ? 1 : -1;
+
+		/* Count the changes of direction along each axis. */
+		d = (b->s > a->s) - (b->s < a->s);
+		if( d != 0 ) {
+			if( sDir == 0 ) sFirst = d;
+			else if( d != sDir ) ++sFlips;
+			sDir = d;
+		}
+		d = (b->t > a->t) - (b->t < a->t);
+		if( d != 0 ) {
+			if( tDir == 0 ) tFirst = d;
+			else if( d != tDir ) ++tFlips;
+			tDir = d;
+		}
+	}
+	if( sDir != sFirst ) ++sFlips;
+	if( tDir != tFirst ) ++tFlips;
+
+	return sFlips <= 2 && tFlips <= 2;
+}
+
+static int OnSegment( const TESSvertex *a, const TESSvertex *b, const TESSvertex *p )
+{
+	return MIN( a->s, b->s ) <= p->s && p->s <= MAX( a->s, b->s )
+		&& MIN( a->t, b->t ) <= p->t && p->t <= MAX( a->t, b->t );
+}
+
+/* SegmentsTouch() tells whether segments ab and cd have any point in common. */
+static int SegmentsTouch( const TESSvertex *a, const TESSvertex *b,
+						 const TESSvertex *c, const TESSvertex *d )
+{
+	double o1, o2, o3, o4;
+
+	if( MAX( a->s, b->s ) < MIN( c->s, d->s ) || MAX( c->s, d->s ) < MIN( a->s, b->s )
+		|| MAX( a->t, b->t ) < MIN( c->t, d->t ) || MAX( c->t, d->t ) < MIN( a->t, b->t ) )
+		return 0;
+
+	o1 = Orient( a, b, c );
+	o2 = Orient( a, b, d );
+	o3 = Orient( c, d, a );
+	o4 = Orient( c, d, b );
+
+	if( ((o1 > 0 && o2 < 0) || (o1 < 0 && o2 > 0))
+		&& ((o3 > 0 && o4 < 0) || (o3 < 0 && o4 > 0)) )
+		return 1;
+
+	return (o1 == 0 && OnSegment( a, b, c )) || (o2 == 0 && OnSegment( a, b, d ))
+		|| (o3 == 0 && OnSegment( c, d, a )) || (o4 == 0 && OnSegment( c, d, b ));
+}
+
+static int IsSimple( TESSvertex **verts, int n )
+{
+	int i, j;
+
+	for( i = 0; i < n; ++i ) {
+		/* Adjacent edges only share their common vertex. */
+		for( j = i + 2; j < n; ++j ) {
+			if( i == 0 && j == n - 1 )
+				continue;
+			if( SegmentsTouch( verts[i], verts[i+1], verts[j], verts[(j+1) % n] ) )
+				return 0;
+		}
+	}
+	return 1;
+}
+
+/* EarClip() triangulates a simple CCW contour into tris.  Returns the number
+* of triangles, or 0 if no ear could be found, which only happens through
+* rounding errors.
+*/
+static int EarClip( TESSvertex **verts, int n, int *links, int *tris )
+{
+	int *prev = links, *next = links + n, *reflex = links + 2 * n;
+	int i, j, p, q, remaining = n, misses = 0, ntris = 0;
+
+	for( i = 0; i < n; ++i ) {
+		prev[i] = (i + n - 1) % n;
+		next[i] = (i + 1) % n;
+	}
+	/* Only reflex vertices can lie inside an ear. */
+	for( i = 0; i < n; ++i )
+		reflex[i] = Orient( verts[prev[i]], verts[i], verts[next[i]] ) <= 0;
+
+	i = 0;
+	while( remaining > 3 ) {
+		int ear;
+
+		p = prev[i];
+		q = next[i];
+		ear = !reflex[i];
+
+		/* No other vertex may lie inside or on the ear. */
+		for( j = next[q]; ear && j != p; j = next[j] ) {
+			if( reflex[j]
+				&& Orient( verts[p], verts[i], verts[j] ) >= 0
+				&& Orient( verts[i], verts[q], verts[j] ) >= 0
+				&& Orient( verts[q], verts[p], verts[j] ) >= 0 )
+				ear = 0;
+		}
+
+		if( !ear ) {
+			if( ++misses > remaining )
+				return 0;
+			i = q;
+			continue;
+		}
+
+		tris[ntris*3+0] = p;
+		tris[ntris*3+1] = i;
+		tris[ntris*3+2] = q;
+		++ntris;
+
+		next[p] = q;
+		prev[q] = p;
+		reflex[p] = Orient( verts[prev[p]], verts[p], verts[q] ) <= 0;
+		reflex[q] = Orient( verts[p], verts[q], verts[next[q]] ) <= 0;
+		--remaining;
+		misses = 0;
+		i = p;
+	}
+
+	tris[ntris*3+0] = prev[i];
+	tris[ntris*3+1] = i;
+	tris[ntris*3+2] = next[i];
+	return ntris + 1;
+}
+
+/* TesselateSimple() outputs the polygons of a single convex or simple
+* contour.  Returns 1 if it did, 0 if the contour needs the sweep.
+*/
+static int TesselateSimple( TESStesselator *tess, int polySize, int vertexSize )
+{
+	TESSvertex **verts, *v;
+	TESSindex *elements;
+	int *tris = NULL;
+	int i, j, n, start, end, winding, inside, convex, ntris = 0, nelems;
+	double area = 0;
+
+	n = CollectContour( tess );
+	if( n < 3 )
+		return 0;
+	verts = tess->simpleVerts;
+
+	for( i = 0; i < n; ++i ) {
+		TESSvertex *a = verts[i], *b = verts[(i+1) % n];
+		area += ((double)a->s - b->s) * ((double)a->t + b->t);
+	}
+	if( area == 0 )
+		return 0;
+
+	/* A CCW contour adds one to the winding number of its inside.  Make the
+	* contour CCW, the orientation of the polygons of the sweep.
+	*/
+	winding = area > 0 ? 1 : -1;
+	if( winding < 0 ) {
+		for( i = 0, j = n - 1; i < j; ++i, --j ) {
+			v = verts[i];
+			verts[i] = verts[j];
+			verts[j] = v;
+		}
+	}
+
+	convex = IsConvex( verts, n );
+	if( !convex ) {
+		if( n > MAX_EAR_CLIP_VERTICES || !IsSimple( verts, n ) )
+			return 0;
+		tris = (int*)ReserveArray( tess, tess->simpleIndices, &tess->simpleIndicesMax,
+								  6 * n, sizeof(int) );
+		if( tris == NULL )
+			return 0;
+		tess->simpleIndices = tris;
+		ntris = EarClip( verts, n, tris, tris + 3 * n );
+		if( ntris == 0 )
+			return 0;
+		tris += 3 * n;
+	}
+
+	switch( tess->windingRule ) {
+		case TESS_WINDING_POSITIVE:
+			inside = winding > 0;
+			break;
+		case TESS_WINDING_NEGATIVE:
+			inside = winding < 0;
+			break;
+		case TESS_WINDING_ABS_GEQ_TWO:
+			inside = 0;
+			break;
+		default:
+			inside = 1;
+			break;
+	}
+
+	if( !inside ) {
+		if( !ReserveOutput( tess, 0, vertexSize, 0 ) )
+			tess->outOfMemory = 1;
+		return 1;
+	}
+
+	/* Polygons, fans of up to polySize vertices if convex. */
+	if( !convex )
+		nelems = ntris;
+	else if( polySize >= n )
+		nelems = 1;
+	else
+		nelems = (n - 2 + polySize - 3) / (polySize - 2);
+
+	if( !ReserveOutput( tess, n, vertexSize, nelems * polySize ) ) {
+		tess->outOfMemory = 1;
+		return 1;
+	}
+	tess->vertexCount = n;
+	tess->elementCount = nelems;
+
+	for( i = 0; i < n; ++i ) {
+		TESSreal *vert = &tess->vertices[i*vertexSize];
+		vert[0] = verts[i]->coords[0];
+		vert[1] = verts[i]->coords[1];
+		if( vertexSize > 2 )
+			vert[2] = verts[i]->coords[2];
+		tess->vertexIndices[i] = verts[i]->idx;
+	}
+
+	elements = tess->elements;
+	if( !convex ) {
+		for( i = 0; i < ntris; ++i ) {
+			*elements++ = tris[i*3+0];
+			*elements++ = tris[i*3+1];
+			*elements++ = tris[i*3+2];
+			for( j = 3; j < polySize; ++j )
+				*elements++ = TESS_UNDEF;
+		}
+	} else {
+		for( start = 1; start < n - 1; start = end ) {
+			end = MIN( start + polySize - 2, n - 1 );
+			*elements++ = 0;
+			for( j = start; j <= end; ++j )
+				*elements++ = j;
+			for( j = end - start + 2; j < polySize; ++j )
+				*elements++ = TESS_UNDEF;
+		}
+	}
+
+	return 1;
+}
+
 void OutputContours( TESStesselator *tess, TESSmesh *mesh, int vertexSize )
 {
 	TESSface *f = 0;
@@ -741,25 +1211,7 @@ void OutputContours( TESStesselator *tess, TESSmesh *mesh, int vertexSize )
 		++tess->elementCount;
 	}
 
-	tess->elements = (TESSindex*)tess->alloc.memalloc( tess->alloc.userData,
-													  sizeof(TESSindex) * tess->elementCount * 2 );
-	if (!tess->elements)
-	{
-		tess->outOfMemory = 1;
-		return;
-	}
-	
-	tess->vertices = (TESSreal*)tess->alloc.memalloc( tess->alloc.userData,
-													  sizeof(TESSreal) * tess->vertexCount * vertexSize );
-	if (!tess->vertices)
-	{
-		tess->outOfMemory = 1;
-		return;
-	}
-
-	tess->vertexIndices = (TESSindex*)tess->alloc.memalloc( tess->alloc.userData,
-														    sizeof(TESSindex) * tess->vertexCount );
-	if (!tess->vertexIndices)
+	if (!ReserveOutput( tess, tess->vertexCount, vertexSize, tess->elementCount * 2 ))
 	{
 		tess->outOfMemory = 1;
 		return;
@@ -804,6 +1256,10 @@ void tessAddContour( TESStesselator *tess, int size, const void* vertices,
 	TESShalfEdge *e;
 	int i;
 
+	if ( tess->mesh == NULL && tess->spareMesh != NULL ) {
+		tess->mesh = tess->spareMesh;
+		tess->spareMesh = NULL;
+	}
 	if ( tess->mesh == NULL )
 	  	tess->mesh = tessMeshNewMesh( &tess->alloc );
  	if ( tess->mesh == NULL ) {
@@ -865,24 +1321,42 @@ void tessAddContour( TESStesselator *tess, int size, const void* vertices,
 	}
 }
 
+static int FinishTesselate( TESStesselator *tess )
+{
+	RecycleMesh( tess );
+
+	if (tess->outOfMemory)
+	{
+		tess->outOfMemory = 0;
+		tess->vertexCount = 0;
+		tess->elementCount = 0;
+		return 0;
+	}
+	return 1;
+}
+
+void tessSetOption( TESStesselator *tess, int option, int value )
+{
+	switch( option )
+	{
+		case TESS_FAST_PATH:
+			tess->fastPath = value != 0;
+			break;
+		case TESS_NORMALIZE:
+			tess->normalize = value != 0;
+			break;
+	}
+}
+
 int tessTesselate( TESStesselator *tess, int windingRule, int elementType,
 				  int polySize, int vertexSize, const TESSreal* normal )
 {
 	TESSmesh *mesh;
 	int rc = 1;
 
-	if (tess->vertices != NULL) {
-		tess->alloc.memfree( tess->alloc.userData, tess->vertices );
-		tess->vertices = 0;
-	}
-	if (tess->elements != NULL) {
-		tess->alloc.memfree( tess->alloc.userData, tess->elements );
-		tess->elements = 0;
-	}
-	if (tess->vertexIndices != NULL) {
-		tess->alloc.memfree( tess->alloc.userData, tess->vertexIndices );
-		tess->vertexIndices = 0;
-	}
+	/* The output arrays are reused, only forget the previous result. */
+	tess->vertexCount = 0;
+	tess->elementCount = 0;
 
 	tess->vertexIndexCounter = 0;
 	
@@ -902,6 +1376,16 @@ int tessTesselate( TESStesselator *tess, int windingRule, int elementType,
 
 	if (setjmp(tess->env) != 0) { 
 		/* come back here if out of memory */
+		RecycleMesh( tess );
+		tess->outOfMemory = 0;
+		return 0;
+	}
+
+	if (tess->outOfMemory)
+	{
+		/* tessAddContour() ran out of memory, the contours are incomplete. */
+		RecycleMesh( tess );
+		tess->outOfMemory = 0;
 		return 0;
 	}
 
@@ -915,6 +1399,10 @@ int tessTesselate( TESStesselator *tess, int windingRule, int elementType,
 	*/
 	tessProjectPolygon( tess );
 
+	if ( tess->fastPath && elementType == TESS_POLYGONS
+		&& TesselateSimple( tess, polySize, vertexSize ) )
+		return FinishTesselate( tess );
+
 	/* tessComputeInterior( tess ) computes the planar arrangement specified
 	* by the given contours, and further subdivides this arrangement
 	* into regions.  Each region is marked "inside" if it belongs
@@ -948,12 +1436,7 @@ int tessTesselate( TESStesselator *tess, int windingRule, int elementType,
 		OutputPolymesh( tess, mesh, elementType, polySize, vertexSize );     /* output polygons */
 	}
 
-	tessMeshDeleteMesh( &tess->alloc, mesh );
-	tess->mesh = NULL;
-
-	if (tess->outOfMemory)
-		return 0;
-	return 1;
+	return FinishTesselate( tess );
 }
 
 int tessGetVertexCount( TESStesselator *tess )
@@ -0,0 +1,150 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Helpers for the libtess2 tests.
+ *
+ ***************************************************************************
+ *   Copyright (C) 2024 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#ifndef __TESS_TEST_H__
+#define __TESS_TEST_H__
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "tesselator.h"
+
+// Fails the current test function, which returns the number of failures
+#define CHECK(x)                                                       \
+  do {                                                                 \
+    if (!(x)) {                                                        \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, \
+              #x);                                                     \
+      return 1;                                                        \
+    }                                                                  \
+  } while (0)
+
+typedef std::vector<TESSreal> Contour;  // x,y pairs
+typedef std::vector<Contour> Polygon;
+
+// What a tesselator returned, copied out of it
+struct Output {
+  bool ok;
+  std::vector<TESSreal> vertices;
+  std::vector<TESSindex> vertexIndices;
+  std::vector<TESSindex> elements;
+
+  bool operator==(const Output &other) const {
+    return ok == other.ok && vertices == other.vertices &&
+           vertexIndices == other.vertexIndices && elements == other.elements;
+  }
+};
+
+// A malloc based TESSalloc counting its allocations
+struct CountingAlloc {
+  TESSalloc alloc;
+  long allocs;
+
+  CountingAlloc() : allocs(0) {
+    alloc.memalloc = Alloc;
+    alloc.memrealloc = Realloc;
+    alloc.memfree = Free;
+    alloc.userData = this;
+    alloc.meshEdgeBucketSize = 0;
+    alloc.meshVertexBucketSize = 0;
+    alloc.meshFaceBucketSize = 0;
+    alloc.dictNodeBucketSize = 0;
+    alloc.regionBucketSize = 0;
+    alloc.extraVertices = 0;
+  }
+
+  static void *Alloc(void *userData, unsigned int size) {
+    ((CountingAlloc *)userData)->allocs++;
+    return malloc(size);
+  }
+  static void *Realloc(void *userData, void *ptr, unsigned int size) {
+    ((CountingAlloc *)userData)->allocs++;
+    return realloc(ptr, size);
+  }
+  static void Free(void *, void *ptr) { free(ptr); }
+};
+
+inline void AddPolygon(TESStesselator *tess, const Polygon &polygon) {
+  for (size_t i = 0; i < polygon.size(); i++)
+    tessAddContour(tess, 2, &polygon[i][0], 2 * sizeof(TESSreal),
+                   (int)polygon[i].size() / 2);
+}
+
+// Tessellates polygon into triangles and copies the result
+inline Output Tessellate(TESStesselator *tess, const Polygon &polygon,
+                         int windingRule = TESS_WINDING_ODD) {
+  Output out;
+
+  AddPolygon(tess, polygon);
+  out.ok = tessTesselate(tess, windingRule, TESS_POLYGONS, 3, 2, NULL) != 0;
+  if (!out.ok) return out;
+
+  int n = tessGetVertexCount(tess);
+  const TESSreal *v = tessGetVertices(tess);
+  const TESSindex *vi = tessGetVertexIndices(tess);
+  const TESSindex *e = tessGetElements(tess);
+
+  out.vertices.assign(v, v + 2 * n);
+  out.vertexIndices.assign(vi, vi + n);
+  out.elements.assign(e, e + 3 * tessGetElementCount(tess));
+  return out;
+}
+
+// Sum of the areas of the triangles of out
+inline double TriangleArea(const Output &out) {
+  double area = 0;
+  for (size_t i = 0; i + 2 < out.elements.size(); i += 3) {
+    const TESSreal *a = &out.vertices[2 * out.elements[i]];
+    const TESSreal *b = &out.vertices[2 * out.elements[i + 1]];
+    const TESSreal *c = &out.vertices[2 * out.elements[i + 2]];
+    area += std::fabs((b[0] - a[0]) * (c[1] - a[1]) -
+                      (c[0] - a[0]) * (b[1] - a[1])) /
+            2;
+  }
+  return area;
+}
+
+// Regular star of n points, alternating between two radii
+inline Contour Star(int n, double inner, double outer, double cx = 0,
+                    double cy = 0) {
+  Contour c;
+  for (int i = 0; i < 2 * n; i++) {
+    double a = i * 3.14159265358979323846 / n;
+    double r = i % 2 ? inner : outer;
+    c.push_back((TESSreal)(cx + r * std::cos(a)));
+    c.push_back((TESSreal)(cy + r * std::sin(a)));
+  }
+  return c;
+}
+
+inline Contour Rectangle(double x0, double y0, double x1, double y1) {
+  TESSreal v[] = {(TESSreal)x0, (TESSreal)y0, (TESSreal)x1, (TESSreal)y0,
+                  (TESSreal)x1, (TESSreal)y1, (TESSreal)x0, (TESSreal)y1};
+  return Contour(v, v + 8);
+}
+
+#endif
@@ -0,0 +1,176 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Tests of the libtess2 batch API.
+ *
+ ***************************************************************************
+ *   Copyright (C) 2024 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#include "tess_test.h"
+
+namespace {
+
+// Many small polygons, convex, concave and holed
+struct Corpus {
+  std::vector<Contour> vertices;  // all contours of a polygon, concatenated
+  std::vector<std::vector<int> > counts;
+  std::vector<Polygon> polygons;
+
+  Corpus() {
+    for (int i = 0; i < 300; i++) {
+      Polygon p;
+      switch (i % 4) {
+        case 0:
+          p.push_back(Rectangle(i, 0, i + 5, 3));
+          break;
+        case 1:
+          p.push_back(Star(5 + i % 7, 2, 6, i, 0));
+          break;
+        case 2:
+          p.push_back(Rectangle(0, i, 10, i + 10));
+          p.push_back(Rectangle(2, i + 2, 8, i + 8));
+          break;
+        case 3:
+          p.push_back(Star(40, 5, 9, 0, i));
+          break;
+      }
+      Add(p);
+    }
+  }
+
+  void Add(const Polygon &p) {
+    Contour all;
+    std::vector<int> n;
+    for (size_t c = 0; c < p.size(); c++) {
+      all.insert(all.end(), p[c].begin(), p[c].end());
+      n.push_back((int)p[c].size() / 2);
+    }
+    vertices.push_back(all);
+    counts.push_back(n);
+    polygons.push_back(p);
+  }
+
+  std::vector<TESSpolygon> Batch() const {
+    std::vector<TESSpolygon> batch(polygons.size());
+    for (size_t i = 0; i < polygons.size(); i++) {
+      batch[i].vertices = &vertices[i][0];
+      batch[i].size = 2;
+      batch[i].stride = 0;
+      batch[i].counts = &counts[i][0];
+      batch[i].contourCount = (int)counts[i].size();
+      batch[i].windingRule = TESS_WINDING_ODD;
+    }
+    return batch;
+  }
+};
+
+// The part of the batch output of one polygon, with its indices made
+// relative to the polygon again
+Output BatchRange(TESSbatch *batch, int polygon) {
+  Output out;
+  int firstVertex, vertexCount, firstElement, elementCount;
+
+  out.ok = tessBatchGetRange(batch, polygon, &firstVertex, &vertexCount,
+                             &firstElement, &elementCount) != 0;
+  if (!out.ok) return out;
+
+  const TESSreal *v = tessBatchGetVertices(batch) + 2 * firstVertex;
+  const TESSindex *vi = tessBatchGetVertexIndices(batch) + firstVertex;
+  const TESSindex *e = tessBatchGetElements(batch) + 3 * firstElement;
+
+  out.vertices.assign(v, v + 2 * vertexCount);
+  out.vertexIndices.assign(vi, vi + vertexCount);
+  for (int i = 0; i < 3 * elementCount; i++)
+    out.elements.push_back(e[i] == TESS_UNDEF ? TESS_UNDEF
+                                              : e[i] - firstVertex);
+  return out;
+}
+
+// Each polygon of a batch gets exactly what a tesselator with the same
+// options returns, whatever the number of threads
+int TestMatchesTesselator(int threadCount, bool fastPath, bool normalize) {
+  Corpus corpus;
+  std::vector<TESSpolygon> polygons = corpus.Batch();
+  TESStesselator *tess = tessNewTess(NULL);
+  TESSbatch *batch = tessNewBatch(NULL, threadCount);
+
+  CHECK(batch != NULL);
+
+  tessSetOption(tess, TESS_FAST_PATH, fastPath);
+  tessSetOption(tess, TESS_NORMALIZE, normalize);
+  tessBatchSetOption(batch, TESS_FAST_PATH, fastPath);
+  tessBatchSetOption(batch, TESS_NORMALIZE, normalize);
+
+  for (int round = 0; round < 2; round++) {
+    int ok = tessBatchTesselate(batch, &polygons[0], (int)polygons.size(),
+                                TESS_POLYGONS, 3, 2, NULL);
+    CHECK(ok == (int)polygons.size());
+
+    for (size_t i = 0; i < polygons.size(); i++)
+      CHECK(BatchRange(batch, (int)i) == Tessellate(tess, corpus.polygons[i]));
+  }
+
+  tessDeleteBatch(batch);
+  tessDeleteTess(tess);
+  return 0;
+}
+
+// The options reach the tesselators of the threads: the fast path fans a
+// convex contour from its first vertex, the sweep doesn't
+int TestOptions() {
+  Corpus corpus;
+  std::vector<TESSpolygon> polygons = corpus.Batch();
+  TESSbatch *batch = tessNewBatch(NULL, 4);
+  std::vector<Output> fast, sweep;
+
+  CHECK(batch != NULL);
+
+  tessBatchTesselate(batch, &polygons[0], (int)polygons.size(), TESS_POLYGONS,
+                     3, 2, NULL);
+  for (size_t i = 0; i < polygons.size(); i++)
+    fast.push_back(BatchRange(batch, (int)i));
+
+  tessBatchSetOption(batch, TESS_FAST_PATH, 0);
+  tessBatchTesselate(batch, &polygons[0], (int)polygons.size(), TESS_POLYGONS,
+                     3, 2, NULL);
+  for (size_t i = 0; i < polygons.size(); i++)
+    sweep.push_back(BatchRange(batch, (int)i));
+
+  CHECK(fast != sweep);
+
+  tessDeleteBatch(batch);
+  return 0;
+}
+
+}  // namespace
+
+int main() {
+  int failures = 0;
+
+  for (int threads = 1; threads <= 4; threads += 3) {
+    failures += TestMatchesTesselator(threads, true, true);
+    failures += TestMatchesTesselator(threads, false, true);
+    failures += TestMatchesTesselator(threads, true, false);
+  }
+  failures += TestOptions();
+
+  if (failures == 0) printf("test_batch: all tests passed\n");
+  return failures != 0;
+}
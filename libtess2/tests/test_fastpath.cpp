@@ -0,0 +1,158 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Tests of the libtess2 single contour fast path against the
+ *           sweep.
+ *
+ ***************************************************************************
+ *   Copyright (C) 2024 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#include <algorithm>
+
+#include "tess_test.h"
+
+namespace {
+
+// Tessellates polygon with the fast path on or off
+Output Run(const Polygon &polygon, bool fastPath,
+           int windingRule = TESS_WINDING_ODD) {
+  TESStesselator *tess = tessNewTess(NULL);
+  tessSetOption(tess, TESS_FAST_PATH, fastPath);
+  Output out = Tessellate(tess, polygon, windingRule);
+  tessDeleteTess(tess);
+  return out;
+}
+
+std::vector<TESSindex> SortedIndices(const Output &out) {
+  std::vector<TESSindex> indices = out.vertexIndices;
+  std::sort(indices.begin(), indices.end());
+  return indices;
+}
+
+// Twice the signed area of triangle i of out
+double Orient(const Output &out, size_t i) {
+  const TESSreal *a = &out.vertices[2 * out.elements[3 * i]];
+  const TESSreal *b = &out.vertices[2 * out.elements[3 * i + 1]];
+  const TESSreal *c = &out.vertices[2 * out.elements[3 * i + 2]];
+  return (b[0] - a[0]) * (c[1] - a[1]) - (c[0] - a[0]) * (b[1] - a[1]);
+}
+
+// The triangles turn the same way as those of the sweep, which follow the
+// orientation of the contour. The sweep itself may emit flat triangles.
+bool SameTurn(const Output &out, const Output &sweep) {
+  double area = 0;
+  for (size_t i = 0; i < sweep.elements.size() / 3; i++)
+    area += Orient(sweep, i);
+
+  bool ccw = area > 0;
+  for (size_t i = 0; i < out.elements.size() / 3; i++) {
+    if (ccw ? Orient(out, i) < 0 : Orient(out, i) > 0) return false;
+  }
+  return true;
+}
+
+// The fast path output uses the same input vertices as the sweep, and
+// covers the same area with as many triangles
+int CheckAgainstSweep(const Polygon &polygon, int windingRule) {
+  Output fast = Run(polygon, true, windingRule);
+  Output sweep = Run(polygon, false, windingRule);
+
+  CHECK(fast.ok && sweep.ok);
+  CHECK(SortedIndices(fast) == SortedIndices(sweep));
+  CHECK(fast.elements.size() == sweep.elements.size());
+  CHECK(std::fabs(TriangleArea(fast) - TriangleArea(sweep)) <=
+        1e-4 * (1 + TriangleArea(sweep)));
+  CHECK(SameTurn(fast, sweep));
+  return 0;
+}
+
+Contour Reversed(const Contour &c) {
+  Contour r;
+  for (size_t i = c.size(); i >= 2; i -= 2) {
+    r.push_back(c[i - 2]);
+    r.push_back(c[i - 1]);
+  }
+  return r;
+}
+
+// A vertex lying on an edge must be kept, or the edge would meet the
+// neighbouring polygon in a T-junction
+int TestCollinearVertex() {
+  TESSreal v[] = {0, 0, 5, 0, 10, 0, 10, 10, 0, 10};
+  Polygon square(1, Contour(v, v + 10));
+  Output out = Run(square, true);
+
+  CHECK(out.ok);
+  CHECK(out.vertexIndices.size() == 5);
+  CHECK(out.elements.size() == 3 * 3);
+  CHECK(CheckAgainstSweep(square, TESS_WINDING_ODD) == 0);
+
+  // Also as the closing vertex, and in a concave contour
+  TESSreal w[] = {10, 0, 10, 10, 0, 10, 0, 0, 5, 0};
+  CHECK(CheckAgainstSweep(Polygon(1, Contour(w, w + 10)), TESS_WINDING_ODD) ==
+        0);
+  TESSreal l[] = {0, 0, 10, 0, 10, 5, 10, 10, 5, 10, 5, 5, 0, 5};
+  CHECK(CheckAgainstSweep(Polygon(1, Contour(l, l + 14)), TESS_WINDING_ODD) ==
+        0);
+  return 0;
+}
+
+// Repeated vertices, consecutive or closing the contour, give what the
+// sweep gives
+int TestRepeatedVertex() {
+  TESSreal v[] = {0, 0, 10, 0, 10, 0, 10, 10, 0, 10};
+  TESSreal w[] = {0, 0, 10, 0, 10, 10, 0, 10, 0, 0};
+  Polygon repeated(1, Contour(v, v + 10));
+  Polygon closed(1, Contour(w, w + 10));
+
+  CHECK(Run(repeated, true) == Run(repeated, false));
+  CHECK(Run(closed, true) == Run(closed, false));
+  return 0;
+}
+
+// Convex, star shaped and nearly convex contours of many sizes, in both
+// orientations and with all winding rules
+int TestCorpus() {
+  int rules[] = {TESS_WINDING_ODD, TESS_WINDING_NONZERO, TESS_WINDING_POSITIVE,
+                 TESS_WINDING_NEGATIVE, TESS_WINDING_ABS_GEQ_TWO};
+
+  for (int n = 3; n <= 40; n++) {
+    Contour shapes[] = {Star(n, 10, 10), Star(n, 6, 10, 1000, -50),
+                        Star(n, 9.5, 10, 0.25, 0.5)};
+
+    for (int s = 0; s < 3; s++) {
+      for (int r = 0; r < 5; r++) {
+        CHECK(CheckAgainstSweep(Polygon(1, shapes[s]), rules[r]) == 0);
+        CHECK(CheckAgainstSweep(Polygon(1, Reversed(shapes[s])), rules[r]) ==
+              0);
+      }
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+
+int main() {
+  int failures = TestCollinearVertex() + TestRepeatedVertex() + TestCorpus();
+
+  if (failures == 0) printf("test_fastpath: all tests passed\n");
+  return failures != 0;
+}
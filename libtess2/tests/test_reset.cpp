@@ -0,0 +1,130 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Tests of the reuse of a libtess2 tesselator and tessReset().
+ *
+ ***************************************************************************
+ *   Copyright (C) 2024 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#include "tess_test.h"
+
+namespace {
+
+// A few polygons of different sizes and shapes
+std::vector<Polygon> Corpus() {
+  std::vector<Polygon> corpus;
+
+  Polygon holed;
+  holed.push_back(Rectangle(0, 0, 100, 100));
+  holed.push_back(Rectangle(20, 20, 80, 80));
+  corpus.push_back(holed);
+
+  corpus.push_back(Polygon(1, Star(500, 40, 100)));
+
+  Polygon stars;
+  for (int i = 0; i < 10; i++)
+    stars.push_back(Star(7 + i, 5, 12, 30.0 * i, 10.0 * (i % 3)));
+  corpus.push_back(stars);
+
+  corpus.push_back(Polygon(1, Star(5, 3, 10)));
+  return corpus;
+}
+
+// A reused tesselator returns exactly what a new one returns
+int TestReuse() {
+  std::vector<Polygon> corpus = Corpus();
+  TESStesselator *reused = tessNewTess(NULL);
+
+  for (int round = 0; round < 3; round++) {
+    for (size_t i = 0; i < corpus.size(); i++) {
+      TESStesselator *fresh = tessNewTess(NULL);
+      Output expected = Tessellate(fresh, corpus[i]);
+      tessDeleteTess(fresh);
+
+      CHECK(expected.ok);
+      CHECK(Tessellate(reused, corpus[i]) == expected);
+    }
+  }
+
+  tessDeleteTess(reused);
+  return 0;
+}
+
+// tessReset() drops contours added since the last tessTesselate(), and
+// the normal of the last result
+int TestReset() {
+  std::vector<Polygon> corpus = Corpus();
+  TESStesselator *fresh = tessNewTess(NULL);
+  Output expected = Tessellate(fresh, corpus[0]);
+  tessDeleteTess(fresh);
+
+  TESStesselator *tess = tessNewTess(NULL);
+  Tessellate(tess, corpus[1]);
+  AddPolygon(tess, corpus[2]);
+  tessReset(tess);
+  CHECK(tessGetVertexCount(tess) == 0 && tessGetElementCount(tess) == 0);
+  CHECK(Tessellate(tess, corpus[0]) == expected);
+
+  // Twice in a row, and on a new tesselator
+  tessReset(tess);
+  tessReset(tess);
+  CHECK(Tessellate(tess, corpus[0]) == expected);
+  tessDeleteTess(tess);
+
+  tess = tessNewTess(NULL);
+  tessReset(tess);
+  CHECK(Tessellate(tess, corpus[0]) == expected);
+  tessDeleteTess(tess);
+  return 0;
+}
+
+// Once a tesselator has processed the largest polygon, it stops
+// allocating
+int TestNoAllocations() {
+  std::vector<Polygon> corpus = Corpus();
+  CountingAlloc counter;
+  TESStesselator *tess = tessNewTess(&counter.alloc);
+
+  for (size_t i = 0; i < corpus.size(); i++) Tessellate(tess, corpus[i]);
+  long warm = counter.allocs;
+
+  for (int round = 0; round < 3; round++) {
+    for (size_t i = 0; i < corpus.size(); i++) {
+      CHECK(Tessellate(tess, corpus[i]).ok);
+      if (i == 1) {
+        AddPolygon(tess, corpus[2]);
+        tessReset(tess);
+      }
+    }
+  }
+  CHECK(counter.allocs == warm);
+
+  tessDeleteTess(tess);
+  return 0;
+}
+
+}  // namespace
+
+int main() {
+  int failures = TestReuse() + TestReset() + TestNoAllocations();
+
+  if (failures == 0) printf("test_reset: all tests passed\n");
+  return failures != 0;
+}
@@ -0,0 +1,731 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  tessbench, a benchmark and differential check of libtess2
+ *           against the GLU tessellator bundled in plugin_dc.
+ *
+ ***************************************************************************
+ *   Copyright (C) 2024 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ *
+ * Usage: tessbench [-runs n] [-max-vertices n] [-nonzero] [-fast]
+ *                  [-normalize] [-small n] [file...]
+ *
+ * Without files, runs a generated corpus of convex, concave, holed,
+ * self-intersecting, coastline and depth area polygons from 10 vertices up
+ * to -max-vertices, 100000 by default: the coastlines of a million vertices
+ * take GLU minutes.  A file holds one polygon, as one "x y" vertex per line
+ * with a blank line between contours; lines starting with # are ignored.
+ *
+ * Each polygon is tessellated into triangles by both libraries, reusing one
+ * tesselator object as a caller drawing many polygons does.  For each the
+ * best time of the runs, the allocations of the first and of the last run
+ * and the triangle count are reported.  The total triangle areas must agree,
+ * and so must the coverage of sample points with the winding rule applied
+ * to the input contours.  The exit status is 0 if all polygons agree, 1
+ * otherwise.
+ *
+ * With -small n, n small polygons of 3 to 16 vertices, 10000 for instance,
+ * are tessellated by libtess2 only, as symbols and soundings are drawn: with
+ * a new tesselator for each polygon, with one tesselator reused for all of
+ * them, and with one tesselator reset by tessReset() before each. The time
+ * and the allocations per polygon of the best run are reported for each.
+ *
+ * The first line gives the size of TESSreal. tessbench is linked with
+ * libtess2 as configured by LIBTESS2_USE_DOUBLE; unless that is ON, the
+ * tools also build tessbench_double against a double precision libtess2,
+ * so that float and double coordinates can be compared from one build.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "tesselator.h"
+#include "GL/glu.h"
+
+// Counting allocations needs malloc() interposition, which only glibc makes
+// easy. Elsewhere the allocation columns read -1.
+#if defined(__GLIBC__)
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+
+static bool g_counting = false;
+static long long g_allocs = 0;
+
+extern "C" void *malloc(size_t size) __THROW {
+  if (g_counting) g_allocs++;
+  return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size) __THROW {
+  if (g_counting) g_allocs++;
+  return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size) __THROW {
+  if (g_counting) g_allocs++;
+  return __libc_realloc(ptr, size);
+}
+
+static void StartCounting() {
+  g_allocs = 0;
+  g_counting = true;
+}
+
+static long long StopCounting() {
+  g_counting = false;
+  return g_allocs;
+}
+#else
+static void StartCounting() {}
+static long long StopCounting() { return -1; }
+#endif
+
+namespace {
+
+const double kPi = 3.14159265358979323846;
+
+// Winding() of a point too close to an edge to tell
+const int kNearEdge = INT_MIN;
+
+struct Point {
+  double x, y;
+};
+
+typedef std::vector<Point> Contour;
+
+struct Polygon {
+  std::string name;
+  std::vector<Contour> contours;
+
+  size_t Size() const {
+    size_t n = 0;
+    for (size_t i = 0; i < contours.size(); i++) n += contours[i].size();
+    return n;
+  }
+};
+
+// Triangles as x,y of 3 vertices each, and how long they took
+struct Result {
+  std::vector<double> triangles;
+  double seconds;
+  long long firstAllocs, lastAllocs;
+  bool ok;
+};
+
+double Now() {
+  return std::chrono::duration<double>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Small deterministic generator, so every run tessellates the same corpus
+struct Random {
+  unsigned long long state;
+
+  explicit Random(unsigned long long seed) : state(seed) {}
+
+  double Next() {  // in [0, 1)
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (state >> 11) * (1.0 / 9007199254740992.0);
+  }
+};
+
+/************************************************************************/
+/*                              Generated corpus                        */
+/************************************************************************/
+
+Contour Circle(double cx, double cy, double r, int n, bool clockwise) {
+  Contour c(n);
+  for (int i = 0; i < n; i++) {
+    double a = 2 * kPi * i / n * (clockwise ? -1 : 1);
+    c[i].x = cx + r * cos(a);
+    c[i].y = cy + r * sin(a);
+  }
+  return c;
+}
+
+// Rectangle with a saw tooth top edge of random depth. All the teeth point
+// across the sweep, so that only a few edges are active at a time.
+Contour Sawtooth(double r, int n, Random &random) {
+  Contour c(std::max(n, 4));
+  int teeth = (int)c.size() - 2;
+  for (int i = 0; i < teeth; i++) {
+    c[i].x = -r + 2 * r * i / (teeth - 1);
+    c[i].y = i % 2 ? r * (0.5 + 0.3 * random.Next()) : r;
+  }
+  c[teeth].x = r, c[teeth].y = -r;
+  c[teeth + 1].x = -r, c[teeth + 1].y = -r;
+  return c;
+}
+
+// Two turns around the origin with a radius ripple which makes the second
+// turn cross the first a fixed number of times, whatever n.
+Contour DoubleLoop(double r, int n) {
+  Contour c(n);
+  for (int i = 0; i < n; i++) {
+    double a = 4 * kPi * i / n;
+    double radius = r * (1 + 0.2 * sin(3.5 * a));
+    c[i].x = radius * cos(a);
+    c[i].y = radius * sin(a);
+  }
+  return c;
+}
+
+// Midpoint displacement of a circle, which looks like a coast line and may
+// touch or cross itself in places.
+Contour Fractal(double cx, double cy, double r, int n, Random &random) {
+  Contour c = Circle(cx, cy, r, std::min(n, 8), false);
+  while ((int)c.size() < n) {
+    // A midpoint after each of the first edges, until there are n points
+    size_t split = std::min(c.size(), (size_t)n - c.size());
+    Contour next;
+    next.reserve(c.size() + split);
+    for (size_t i = 0; i < c.size(); i++) {
+      const Point &a = c[i], &b = c[(i + 1) % c.size()];
+      next.push_back(a);
+      if (i < split) {
+        double d = 0.25 * (random.Next() - 0.5);
+        Point m = {(a.x + b.x) / 2 - (b.y - a.y) * d,
+                   (a.y + b.y) / 2 + (b.x - a.x) * d};
+        next.push_back(m);
+      }
+    }
+    c.swap(next);
+  }
+  return c;
+}
+
+std::vector<Polygon> MakeCorpus(int maxVertices) {
+  std::vector<Polygon> corpus;
+  Random random(42);
+  char name[64];
+
+  for (int n = 10; n <= maxVertices; n *= 10) {
+    Polygon p;
+
+    snprintf(name, sizeof(name), "convex-%d", n);
+    p.name = name;
+    p.contours.assign(1, Circle(0, 0, 1000, n, false));
+    corpus.push_back(p);
+
+    snprintf(name, sizeof(name), "concave-%d", n);
+    p.name = name;
+    p.contours.assign(1, Sawtooth(1000, n, random));
+    corpus.push_back(p);
+
+    // About sqrt(n) holes, each of them a small circle
+    int holes = std::max(1, (int)sqrt((double)n) / 4);
+    int side = (int)ceil(sqrt((double)holes));
+    int holeSize = std::max(3, n / 2 / holes);
+    snprintf(name, sizeof(name), "holes-%d", n);
+    p.name = name;
+    p.contours.assign(1, Circle(0, 0, 1000, std::max(3, n / 2), false));
+    for (int i = 0; i < holes; i++) {
+      double step = 1000.0 / side;
+      double x = -500 + step * (i % side + 0.5);
+      double y = -500 + step * (i / side + 0.5);
+      p.contours.push_back(Circle(x, y, step / 3, holeSize, true));
+    }
+    corpus.push_back(p);
+
+    snprintf(name, sizeof(name), "crossing-%d", n);
+    p.name = name;
+    p.contours.assign(1, DoubleLoop(1000, n));
+    corpus.push_back(p);
+
+    snprintf(name, sizeof(name), "coastline-%d", n);
+    p.name = name;
+    p.contours.assign(1, Fractal(0, 0, 1000, n, random));
+    corpus.push_back(p);
+
+    // Nested rings, as the depth areas between contour lines
+    snprintf(name, sizeof(name), "depth-%d", n);
+    p.name = name;
+    p.contours.clear();
+    for (int i = 0; i < 4; i++)
+      p.contours.push_back(
+          Fractal(0, 0, 1000 - 220 * i, std::max(8, n / 4), random));
+    corpus.push_back(p);
+  }
+  return corpus;
+}
+
+bool ReadPolygon(const char *filename, Polygon &p) {
+  FILE *fp = fopen(filename, "r");
+  if (fp == NULL) return false;
+
+  char line[256];
+  p.name = filename;
+  p.contours.assign(1, Contour());
+  while (fgets(line, sizeof(line), fp)) {
+    Point pt;
+    if (line[0] == '#') continue;
+    if (sscanf(line, "%lf %lf", &pt.x, &pt.y) == 2)
+      p.contours.back().push_back(pt);
+    else if (!p.contours.back().empty())
+      p.contours.push_back(Contour());
+  }
+  fclose(fp);
+  if (p.contours.back().empty()) p.contours.pop_back();
+  return !p.contours.empty();
+}
+
+/************************************************************************/
+/*                               Tessellators                           */
+/************************************************************************/
+
+struct Options {
+  int runs;
+  int windingRule;  // TESS_WINDING_ODD or TESS_WINDING_NONZERO
+  bool fastPath, normalize;
+};
+
+Result RunLibtess2(const Polygon &polygon, const Options &options) {
+  std::vector<std::vector<TESSreal> > coords(polygon.contours.size());
+  for (size_t i = 0; i < polygon.contours.size(); i++) {
+    const Contour &c = polygon.contours[i];
+    for (size_t j = 0; j < c.size(); j++) {
+      coords[i].push_back((TESSreal)c[j].x);
+      coords[i].push_back((TESSreal)c[j].y);
+    }
+  }
+
+  Result result;
+  result.seconds = HUGE_VAL;
+  result.ok = true;
+
+  TESStesselator *tess = tessNewTess(NULL);
+  tessSetOption(tess, TESS_FAST_PATH, options.fastPath);
+  tessSetOption(tess, TESS_NORMALIZE, options.normalize);
+  for (int run = 0; run < options.runs; run++) {
+    StartCounting();
+    double start = Now();
+    for (size_t i = 0; i < coords.size(); i++) {
+      tessAddContour(tess, 2, coords[i].data(), 2 * sizeof(TESSreal),
+                     (int)coords[i].size() / 2);
+    }
+    int ok = tessTesselate(tess, options.windingRule == TESS_WINDING_ODD
+                                     ? TESS_WINDING_ODD
+                                     : TESS_WINDING_NONZERO,
+                           TESS_POLYGONS, 3, 2, NULL);
+    result.seconds = std::min(result.seconds, Now() - start);
+    long long allocs = StopCounting();
+    if (run == 0) result.firstAllocs = allocs;
+    result.lastAllocs = allocs;
+    result.ok = ok != 0;
+  }
+
+  const TESSreal *verts = tessGetVertices(tess);
+  const TESSindex *elems = tessGetElements(tess);
+  int nelems = result.ok ? tessGetElementCount(tess) : 0;
+  for (int i = 0; i < nelems * 3; i++) {
+    result.triangles.push_back(verts[elems[i] * 2]);
+    result.triangles.push_back(verts[elems[i] * 2 + 1]);
+  }
+  tessDeleteTess(tess);
+  return result;
+}
+
+// State of one gluTess run, passed as the polygon data of the callbacks
+struct GluCapture {
+  std::vector<double> *triangles;
+  std::deque<Point> combined;
+  bool error;
+};
+
+void GLAPIENTRY GluBegin(GLenum, void *) {}
+
+// Registering an edge flag callback makes GLU emit GL_TRIANGLES only.
+void GLAPIENTRY GluEdgeFlag(GLboolean, void *) {}
+
+void GLAPIENTRY GluVertex(void *vertex, void *data) {
+  GluCapture *capture = (GluCapture *)data;
+  const GLdouble *v = (const GLdouble *)vertex;
+  capture->triangles->push_back(v[0]);
+  capture->triangles->push_back(v[1]);
+}
+
+void GLAPIENTRY GluCombine(GLdouble coords[3], void *[4], GLfloat[4],
+                           void **dataOut, void *data) {
+  GluCapture *capture = (GluCapture *)data;
+  Point p = {coords[0], coords[1]};
+  capture->combined.push_back(p);
+  *dataOut = &capture->combined.back();
+}
+
+void GLAPIENTRY GluEnd(void *) {}
+
+void GLAPIENTRY GluError(GLenum, void *data) {
+  ((GluCapture *)data)->error = true;
+}
+
+Result RunGlu(const Polygon &polygon, const Options &options) {
+  // gluTessVertex() wants x, y and z, and keeps the pointers
+  std::vector<GLdouble> coords;
+  coords.reserve(3 * polygon.Size());
+  for (size_t i = 0; i < polygon.contours.size(); i++) {
+    const Contour &c = polygon.contours[i];
+    for (size_t j = 0; j < c.size(); j++) {
+      coords.push_back(c[j].x);
+      coords.push_back(c[j].y);
+      coords.push_back(0.0);
+    }
+  }
+
+  Result result;
+  result.seconds = HUGE_VAL;
+
+  GluCapture capture;
+  capture.triangles = &result.triangles;
+
+  GLUtesselator *tobj = gluNewTess();
+  gluTessCallback(tobj, GLU_TESS_BEGIN_DATA, (_GLUfuncptr)&GluBegin);
+  gluTessCallback(tobj, GLU_TESS_EDGE_FLAG_DATA, (_GLUfuncptr)&GluEdgeFlag);
+  gluTessCallback(tobj, GLU_TESS_VERTEX_DATA, (_GLUfuncptr)&GluVertex);
+  gluTessCallback(tobj, GLU_TESS_COMBINE_DATA, (_GLUfuncptr)&GluCombine);
+  gluTessCallback(tobj, GLU_TESS_END_DATA, (_GLUfuncptr)&GluEnd);
+  gluTessCallback(tobj, GLU_TESS_ERROR_DATA, (_GLUfuncptr)&GluError);
+  gluTessNormal(tobj, 0, 0, 1);
+  gluTessProperty(tobj, GLU_TESS_WINDING_RULE,
+                  options.windingRule == TESS_WINDING_ODD
+                      ? GLU_TESS_WINDING_ODD
+                      : GLU_TESS_WINDING_NONZERO);
+
+  for (int run = 0; run < options.runs; run++) {
+    result.triangles.clear();
+    capture.combined.clear();
+    capture.error = false;
+
+    StartCounting();
+    double start = Now();
+    gluTessBeginPolygon(tobj, &capture);
+    GLdouble *v = coords.data();
+    for (size_t i = 0; i < polygon.contours.size(); i++) {
+      gluTessBeginContour(tobj);
+      for (size_t j = 0; j < polygon.contours[i].size(); j++, v += 3)
+        gluTessVertex(tobj, v, v);
+      gluTessEndContour(tobj);
+    }
+    gluTessEndPolygon(tobj);
+    result.seconds = std::min(result.seconds, Now() - start);
+    long long allocs = StopCounting();
+    if (run == 0) result.firstAllocs = allocs;
+    result.lastAllocs = allocs;
+  }
+  gluDeleteTess(tobj);
+
+  result.ok = !capture.error;
+  result.triangles.resize(result.triangles.size() / 6 * 6);
+  return result;
+}
+
+/************************************************************************/
+/*                             Differential check                       */
+/************************************************************************/
+
+double TrianglesArea(const std::vector<double> &t) {
+  double area = 0;
+  for (size_t i = 0; i + 6 <= t.size(); i += 6)
+    area += fabs((t[i + 2] - t[i]) * (t[i + 5] - t[i + 1]) -
+                 (t[i + 4] - t[i]) * (t[i + 3] - t[i + 1])) /
+            2;
+  return area;
+}
+
+bool TrianglesCover(const std::vector<double> &t, const Point &p) {
+  for (size_t i = 0; i + 6 <= t.size(); i += 6) {
+    double d1 = (t[i + 2] - t[i]) * (p.y - t[i + 1]) -
+                (t[i + 3] - t[i + 1]) * (p.x - t[i]);
+    double d2 = (t[i + 4] - t[i + 2]) * (p.y - t[i + 3]) -
+                (t[i + 5] - t[i + 3]) * (p.x - t[i + 2]);
+    double d3 = (t[i] - t[i + 4]) * (p.y - t[i + 5]) -
+                (t[i + 1] - t[i + 5]) * (p.x - t[i + 4]);
+    if ((d1 >= 0 && d2 >= 0 && d3 >= 0) || (d1 <= 0 && d2 <= 0 && d3 <= 0))
+      return true;
+  }
+  return false;
+}
+
+// Winding number of the contours around p, or kNearEdge when p is too close
+// to an edge for the coverage of either tessellation to be meaningful.
+int Winding(const Polygon &polygon, const Point &p, double eps) {
+  int winding = 0;
+  for (size_t i = 0; i < polygon.contours.size(); i++) {
+    const Contour &c = polygon.contours[i];
+    for (size_t j = 0; j < c.size(); j++) {
+      const Point &a = c[j], &b = c[(j + 1) % c.size()];
+      double dx = b.x - a.x, dy = b.y - a.y;
+      double len2 = dx * dx + dy * dy;
+      double u = len2 > 0 ? ((p.x - a.x) * dx + (p.y - a.y) * dy) / len2 : 0;
+      u = std::max(0.0, std::min(1.0, u));
+      double ex = a.x + u * dx - p.x, ey = a.y + u * dy - p.y;
+      if (ex * ex + ey * ey < eps * eps) return kNearEdge;
+
+      double cross = dx * (p.y - a.y) - dy * (p.x - a.x);
+      if (a.y <= p.y) {
+        if (b.y > p.y && cross > 0) winding++;
+      } else {
+        if (b.y <= p.y && cross < 0) winding--;
+      }
+    }
+  }
+  return winding;
+}
+
+struct Check {
+  double areaError;  // relative
+  int samples;
+  int libtess2Misses, gluMisses;  // samples covered wrongly
+};
+
+Check Compare(const Polygon &polygon, const Options &options,
+              const Result &a, const Result &b) {
+  Check check;
+  double areaA = TrianglesArea(a.triangles), areaB = TrianglesArea(b.triangles);
+  check.areaError =
+      fabs(areaA - areaB) / std::max(std::max(areaA, areaB), 1e-30);
+
+  Point lo = polygon.contours[0][0], hi = lo;
+  for (size_t i = 0; i < polygon.contours.size(); i++) {
+    for (size_t j = 0; j < polygon.contours[i].size(); j++) {
+      const Point &p = polygon.contours[i][j];
+      lo.x = std::min(lo.x, p.x), lo.y = std::min(lo.y, p.y);
+      hi.x = std::max(hi.x, p.x), hi.y = std::max(hi.y, p.y);
+    }
+  }
+  double eps = 1e-4 * std::max(hi.x - lo.x, hi.y - lo.y);
+
+  // Each sample costs a pass over the edges and over both triangle lists
+  size_t work = polygon.Size() + (a.triangles.size() + b.triangles.size()) / 6;
+  int wanted = (int)std::max<size_t>(16, std::min<size_t>(2000, 20000000 / work));
+
+  Random random(7);
+  check.samples = check.libtess2Misses = check.gluMisses = 0;
+  for (int i = 0; i < wanted; i++) {
+    Point p = {lo.x + (hi.x - lo.x) * random.Next(),
+               lo.y + (hi.y - lo.y) * random.Next()};
+    int winding = Winding(polygon, p, eps);
+    if (winding == kNearEdge) continue;
+    bool inside = options.windingRule == TESS_WINDING_ODD ? (winding & 1) != 0
+                                                          : winding != 0;
+    check.samples++;
+    if (TrianglesCover(a.triangles, p) != inside) check.libtess2Misses++;
+    if (TrianglesCover(b.triangles, p) != inside) check.gluMisses++;
+  }
+  return check;
+}
+
+/************************************************************************/
+/*                              Small polygons                          */
+/************************************************************************/
+
+// Circles and saw tooth areas of 3 to 16 vertices around random centers,
+// as x,y coordinates of one contour each.
+std::vector<std::vector<TESSreal> > MakeSmallPolygons(int count) {
+  std::vector<std::vector<TESSreal> > polygons(count);
+  Random random(42);
+
+  for (int i = 0; i < count; i++) {
+    int n = 3 + (int)(14 * random.Next());
+    double cx = 1000 * random.Next(), cy = 1000 * random.Next();
+    Contour c = i % 2 && n >= 4 ? Sawtooth(10, n, random)
+                                : Circle(0, 0, 10, n, false);
+    for (size_t j = 0; j < c.size(); j++) {
+      polygons[i].push_back((TESSreal)(cx + c[j].x));
+      polygons[i].push_back((TESSreal)(cy + c[j].y));
+    }
+  }
+  return polygons;
+}
+
+enum SmallMode { kNewTess, kReuseTess, kResetTess };
+
+struct SmallResult {
+  double seconds;
+  long long allocs, triangles;
+};
+
+// Tessellates all polygons the way given by mode, keeping the best run
+SmallResult RunSmall(const std::vector<std::vector<TESSreal> > &polygons,
+                     SmallMode mode, const Options &options) {
+  SmallResult result;
+  result.seconds = HUGE_VAL;
+
+  for (int run = 0; run < options.runs; run++) {
+    long long triangles = 0;
+
+    StartCounting();
+    double start = Now();
+    TESStesselator *tess = NULL;
+    for (size_t i = 0; i < polygons.size(); i++) {
+      if (tess == NULL) {
+        tess = tessNewTess(NULL);
+        tessSetOption(tess, TESS_FAST_PATH, options.fastPath);
+        tessSetOption(tess, TESS_NORMALIZE, options.normalize);
+      } else if (mode == kResetTess) {
+        tessReset(tess);
+      }
+
+      tessAddContour(tess, 2, polygons[i].data(), 2 * sizeof(TESSreal),
+                     (int)polygons[i].size() / 2);
+      if (tessTesselate(tess, options.windingRule, TESS_POLYGONS, 3, 2, NULL))
+        triangles += tessGetElementCount(tess);
+
+      if (mode == kNewTess) {
+        tessDeleteTess(tess);
+        tess = NULL;
+      }
+    }
+    if (tess != NULL) tessDeleteTess(tess);
+    double seconds = Now() - start;
+    long long allocs = StopCounting();
+
+    if (seconds < result.seconds) {
+      result.seconds = seconds;
+      result.allocs = allocs;
+    }
+    result.triangles = triangles;
+  }
+  return result;
+}
+
+int RunSmallBench(int count, const Options &options) {
+  std::vector<std::vector<TESSreal> > polygons = MakeSmallPolygons(count);
+  const char *names[] = {"new", "reuse", "reset"};
+  SmallResult results[3];
+
+  printf("%d polygons of 3 to 16 vertices, best of %d runs\n", count,
+         options.runs);
+  printf("%-6s %12s %14s %10s\n", "tess", "us/polygon", "allocs/polygon",
+         "triangles");
+
+  for (int mode = kNewTess; mode <= kResetTess; mode++) {
+    SmallResult &r = results[mode];
+    r = RunSmall(polygons, (SmallMode)mode, options);
+    printf("%-6s %12.3f %14.2f %10lld\n", names[mode], r.seconds * 1e6 / count,
+           r.allocs < 0 ? -1.0 : (double)r.allocs / count, r.triangles);
+  }
+
+  // Reusing a tesselator must not change the result
+  if (results[kReuseTess].triangles != results[kNewTess].triangles ||
+      results[kResetTess].triangles != results[kNewTess].triangles) {
+    printf("the triangle counts differ\n");
+    return 1;
+  }
+  return 0;
+}
+
+void Usage() {
+  fprintf(stderr,
+          "Usage: tessbench [-runs n] [-max-vertices n] [-nonzero] [-fast]\n"
+          "                 [-normalize] [-small n] [file...]\n");
+  exit(2);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  options.runs = 3;
+  options.windingRule = TESS_WINDING_ODD;
+  options.fastPath = options.normalize = false;
+  int maxVertices = 100000;
+  int small = 0;
+  int iarg;
+
+  for (iarg = 1; iarg < argc && argv[iarg][0] == '-'; iarg++) {
+    if (!strcmp(argv[iarg], "-runs") && iarg + 1 < argc)
+      options.runs = std::max(1, atoi(argv[++iarg]));
+    else if (!strcmp(argv[iarg], "-max-vertices") && iarg + 1 < argc)
+      maxVertices = atoi(argv[++iarg]);
+    else if (!strcmp(argv[iarg], "-nonzero"))
+      options.windingRule = TESS_WINDING_NONZERO;
+    else if (!strcmp(argv[iarg], "-fast"))
+      options.fastPath = true;
+    else if (!strcmp(argv[iarg], "-normalize"))
+      options.normalize = true;
+    else if (!strcmp(argv[iarg], "-small") && iarg + 1 < argc)
+      small = std::max(1, atoi(argv[++iarg]));
+    else
+      Usage();
+  }
+
+  printf("libtess2 TESSreal: %s, %d bytes\n",
+         sizeof(TESSreal) == sizeof(double) ? "double" : "float",
+         (int)sizeof(TESSreal));
+
+  if (small > 0) {
+    if (iarg < argc) Usage();
+    return RunSmallBench(small, options);
+  }
+
+  std::vector<Polygon> corpus;
+  if (iarg == argc) corpus = MakeCorpus(maxVertices);
+  for (; iarg < argc; iarg++) {
+    Polygon p;
+    if (!ReadPolygon(argv[iarg], p)) {
+      fprintf(stderr, "tessbench: cannot read a polygon from %s\n",
+              argv[iarg]);
+      return 2;
+    }
+    corpus.push_back(p);
+  }
+
+  printf("%-16s %8s | %-9s %9s %11s %9s | %-4s %9s %11s %9s | %7s %s\n",
+         "polygon", "vertices", "", "ms", "allocs", "triangles", "", "ms",
+         "allocs", "triangles", "area", "misses");
+
+  int failed = 0;
+  for (size_t i = 0; i < corpus.size(); i++) {
+    const Polygon &p = corpus[i];
+    Result a = RunLibtess2(p, options);
+    Result b = RunGlu(p, options);
+    Check check = Compare(p, options, a, b);
+
+    // Coverage may differ on a few samples next to crossings; libtess2
+    // works in floats unless built with TESS_USE_DOUBLE.
+    int allowed = check.samples / 100;
+    bool agree = a.ok && b.ok && check.areaError < 1e-3 &&
+                 check.libtess2Misses <= allowed && check.gluMisses <= allowed;
+    if (!agree) failed++;
+
+    printf("%-16s %8d | %-9s %9.3f %5lld/%-5lld %9d | %-4s %9.3f %5lld/%-5lld "
+           "%9d | %7.1e %d,%d/%d%s\n",
+           p.name.c_str(), (int)p.Size(), a.ok ? "libtess2" : "libtess2!",
+           a.seconds * 1e3, a.firstAllocs, a.lastAllocs,
+           (int)(a.triangles.size() / 6), b.ok ? "glu" : "glu!",
+           b.seconds * 1e3, b.firstAllocs, b.lastAllocs,
+           (int)(b.triangles.size() / 6), check.areaError,
+           check.libtess2Misses, check.gluMisses, check.samples,
+           agree ? "" : "  MISMATCH");
+    fflush(stdout);
+  }
+
+  if (failed) printf("%d of %d polygons differ\n", failed, (int)corpus.size());
+  return failed ? 1 : 0;
+}
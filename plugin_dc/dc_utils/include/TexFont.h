@@ -26,26 +26,22 @@
 #ifndef __TEXFONT_H__
 #define __TEXFONT_H__
 
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #include <wx/colour.h>
 #include <wx/font.h>
+#include <wx/gdicmn.h>
 #include <wx/string.h>
 
-/* support ascii plus degree symbol for now pack font in a single texture 16x8
- */
-#define DEGREE_GLYPH 127
-#define MIN_GLYPH 32
-#define MAX_GLYPH 128
-
-#define NUM_GLYPHS (MAX_GLYPH - MIN_GLYPH)
-
-#define COLS_GLYPHS 16
-#define ROWS_GLYPHS ((NUM_GLYPHS / COLS_GLYPHS) + 1)
-
-struct TexGlyphInfo {
-  int x, y, width, height;
-  float advance;
-};
+class piGlyphFont;
+class piRasterSink;
 
+/* Text drawn from the glyphs of the shared piGlyphAtlas, any Unicode code
+ * point the font has. Glyphs are rasterized the first time they are used.
+ */
 class TexFontPI {
 public:
   TexFontPI();
@@ -57,27 +53,50 @@ public:
   void GetTextExtent(const wxString &string, int *width, int *height);
   void RenderString(const char *string, int x = 0, int y = 0);
   void RenderString(const wxString &string, int x = 0, int y = 0);
+  /* Renders string into raster at x,y, without GL. */
+  void RenderString(piRasterSink &raster, const wxString &string, int x,
+                    int y);
+  /* Renders n strings, string i at positions[i], with a single draw call. */
+  void RenderStrings(int n, const wxString strings[],
+                     const wxPoint positions[]);
   bool IsBuilt() { return m_built; }
   void SetColor(wxColor &color) { m_color = color; }
+  /* Keeps the glyph quads of the last n strings rendered, so that static
+   * labels are not laid out again every frame. 0 disables the cache.
+   */
+  void SetCacheSize(size_t n);
 
 private:
+  // Glyph quads of a string, 6 vertices of x,y,u,v each per glyph, and
+  // the atlas page and vertex count of each run of glyphs on the same page
+  struct QuadRun {
+    std::string text;
+    std::vector<float> quads;
+    std::vector<int> spans;
+  };
+  typedef std::list<QuadRun> QuadRunList;
+
   void GetTextExtent(const char *string, int *width, int *height);
-  void RenderGlyph(int c);
+  void Decode(const char *string);
+  void AddQuads(float x, float y, QuadRun &run);
+  const QuadRun &GetQuads(const char *string);
+  void DrawQuads(const QuadRun &run, int x, int y);
+  void ClearCache();
+  void CheckGeneration();
 
   wxFont m_font;
   bool m_blur;
 
-  TexGlyphInfo tgi[MAX_GLYPH];
-
-  unsigned int texobj;
-  int tex_w, tex_h;
-  int m_maxglyphw;
-  int m_maxglyphh;
+  piGlyphFont *m_glyphs;
+  int m_lineHeight;
   bool m_built;
   wxColor m_color;
-#ifdef __ANDROID__
-  float m_dx;
-  float m_dy;
-#endif
+
+  QuadRunList m_runs;  // most recently used first
+  std::unordered_map<std::string, QuadRunList::iterator> m_runIndex;
+  size_t m_cacheSize;
+  unsigned long m_generation;  // of the atlas, when the quads were made
+  QuadRun m_quads;  // uncached string, or the strings of a batch
+  std::vector<unsigned int> m_codes;  // decoded string
 };
 #endif  // guard
@@ -0,0 +1,128 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Retained mode batching of piDC primitives
+ *
+ ***************************************************************************
+ *   Copyright (C) 2024 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ **************************************************************************/
+
+#ifndef __PIDRAWBATCH_H__
+#define __PIDRAWBATCH_H__
+
+#include <cstddef>
+#include <vector>
+
+/*
+ * Everything a batched primitive needs from the GL state besides its
+ * vertices. Primitives are only merged into one draw call when their
+ * states compare equal.
+ */
+struct piDrawState {
+  enum Mode { LINES, TRIANGLES };
+
+  piDrawState() : mode(LINES), width(1.0f), blend(false) {
+    color[0] = color[1] = color[2] = color[3] = 255;
+  }
+
+  bool operator==(const piDrawState &other) const {
+    return mode == other.mode && color[0] == other.color[0] &&
+           color[1] == other.color[1] && color[2] == other.color[2] &&
+           color[3] == other.color[3] && width == other.width &&
+           blend == other.blend;
+  }
+  bool operator!=(const piDrawState &other) const { return !(*this == other); }
+
+  Mode mode;
+  unsigned char color[4];  // RGBA
+  float width;             // line width, LINES only
+  bool blend;              // blending, and line smoothing for LINES
+};
+
+/*
+ * Receives the flushed vertex streams of a piDrawBatch, as x,y pairs.
+ * piDC submits them to OpenGL, piDrawRecorder keeps them in memory.
+ */
+class piDrawSink {
+public:
+  virtual ~piDrawSink() {}
+
+  virtual void Draw(const piDrawState &state, const float *vertices,
+                    int count) = 0;
+};
+
+/*
+ * Accumulates consecutive primitives with the same state into a single
+ * vertex stream, which goes to the sink as one draw call when the state
+ * changes or on Flush(). Only runs of equal state are merged, so the
+ * drawing order is the same as without batching.
+ */
+class piDrawBatch {
+public:
+  piDrawBatch() : m_sink(0) {}
+
+  void SetSink(piDrawSink *sink) { m_sink = sink; }
+  piDrawSink *GetSink() const { return m_sink; }
+
+  /* Returns room for count vertices drawn with state, valid until the next
+   * call. Flushes first if state differs from the pending primitives.
+   */
+  float *Append(const piDrawState &state, int count);
+
+  void AddLine(const piDrawState &state, float x1, float y1, float x2,
+               float y2);
+  /* Adds the n - 1 segments of a polyline, closed back to the first point
+   * if closed is set.
+   */
+  void AddLineStrip(const piDrawState &state, const float *points, int n,
+                    bool closed);
+  /* Adds the n - 2 triangles of a fan around points[0]. */
+  void AddTriangleFan(const piDrawState &state, const float *points, int n);
+
+  void Flush();
+  bool IsEmpty() const { return m_vertices.empty(); }
+
+private:
+  piDrawSink *m_sink;
+  piDrawState m_state;
+  std::vector<float> m_vertices;
+};
+
+/*
+ * A piDrawSink which records the draw calls instead of rendering them, to
+ * check what piDC submits without a GL context.
+ */
+class piDrawRecorder : public piDrawSink {
+public:
+  struct Call {
+    piDrawState state;
+    std::vector<float> vertices;
+  };
+
+  void Draw(const piDrawState &state, const float *vertices, int count);
+
+  size_t GetCallCount() const { return m_calls.size(); }
+  size_t GetVertexCount() const;
+  const std::vector<Call> &GetCalls() const { return m_calls; }
+  void Clear() { m_calls.clear(); }
+
+private:
+  std::vector<Call> m_calls;
+};
+
+#endif
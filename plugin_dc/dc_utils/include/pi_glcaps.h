@@ -0,0 +1,88 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  GL context limits used by piDC
+ *
+ ***************************************************************************
+ *   Copyright (C) 2024 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ **************************************************************************/
+
+#ifndef __PIGLCAPS_H__
+#define __PIGLCAPS_H__
+
+#include <map>
+
+class wxGLContext;
+
+/*
+ * Implementation limits of a GL context. piDC queries them once per context,
+ * the first time it draws with it, so that no primitive has to stall the
+ * pipeline on glGet calls.
+ */
+struct piGLCaps {
+  piGLCaps()
+      : minLineWidth(1.0f),
+        maxSmoothLineWidth(1.0f),
+        maxAliasedLineWidth(1.0f),
+        maxTextureSize(64),
+        gles(false) {}
+
+  /* Asks the current GL context. */
+  static piGLCaps Query();
+
+  // Widest line both smooth and aliased lines can draw
+  float MaxLineWidth() const {
+    return maxSmoothLineWidth < maxAliasedLineWidth ? maxSmoothLineWidth
+                                                    : maxAliasedLineWidth;
+  }
+
+  float minLineWidth;         // narrowest smooth line, at least 1
+  float maxSmoothLineWidth;   // widest anti-aliased line
+  float maxAliasedLineWidth;  // widest aliased line
+  int maxTextureSize;
+  bool gles;  // OpenGL ES context
+};
+
+/*
+ * The piGLCaps of the GL contexts piDCs draw with. An entry lives as long
+ * as a piDC holds it, and goes with the last of them: a context created
+ * later at the same address is asked again.
+ */
+class piGLCapsCache {
+public:
+  static piGLCapsCache &Get();
+
+  /* Returns the caps of context, which must be current the first time.
+   * Each Acquire() is paired with a Release().
+   */
+  const piGLCaps &Acquire(wxGLContext *context);
+  void Release(wxGLContext *context);
+
+  /* Number of contexts held. */
+  size_t Size() const { return m_entries.size(); }
+
+private:
+  struct Entry {
+    piGLCaps caps;
+    int users;
+  };
+
+  std::map<wxGLContext *, Entry> m_entries;
+};
+
+#endif
@@ -0,0 +1,113 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Shadow of the GLES2 state set by piDC
+ *
+ ***************************************************************************
+ *   Copyright (C) 2024 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ **************************************************************************/
+
+#ifndef __PIGLSTATE_H__
+#define __PIGLSTATE_H__
+
+#ifdef USE_ANDROID_GLES2
+#include "GLES2/gl2.h"
+
+/*
+ * Attribute and uniform locations of a shader program, -1 where the program
+ * has no such variable. They are resolved when the pi_ programs are linked,
+ * and on first use for any other program. The last colour and transform
+ * sent are kept too, so unchanged uniforms are not sent again.
+ */
+struct piShaderProgram {
+  GLint program;
+
+  GLint position;  // "position", or "aPos"
+  GLint uv;        // "aUV"
+  GLint colorv;    // "colorv"
+
+  GLint mvMatrix;         // "MVMatrix"
+  GLint transformMatrix;  // "TransformMatrix"
+  GLint color;            // "color"
+  GLint tex;              // "uTex"
+  GLint circleRadius;     // "circle_radius"
+  GLint circleCenter;     // "circle_center"
+  GLint circleColor;      // "circle_color"
+  GLint borderColor;      // "border_color"
+  GLint borderWidth;      // "border_width"
+
+  bool owned;  // a pi_ program, nobody else sets its uniforms
+  bool colorValid, transformValid, mvMatrixValid;
+  GLfloat lastColor[4];
+  GLfloat lastTransform[16];
+  GLfloat lastMVMatrix[16];
+};
+
+piShaderProgram &pi_getShader(GLint program);
+
+/*
+ * Shadow of the GL state set through these functions, which skips the
+ * calls that would not change anything. The uniforms take effect on the
+ * current program, as glUniform does.
+ *
+ * The host and other plugins draw between piDC calls, so the current
+ * program and capabilities are forgotten at the start of each piDC draw
+ * call by pi_resetGLState(); call it too after changing them directly.
+ * The uniforms of the pi_ programs are kept, nobody else sets them.
+ */
+void pi_useProgram(GLint program);
+void pi_setEnabled(GLenum cap, bool enable);
+void pi_setColor(GLint program, const GLfloat *color);
+void pi_setTransform(GLint program, const GLfloat *matrix);
+void pi_setMVMatrix(GLint program, const GLfloat *matrix);
+void pi_drawArrays(GLenum mode, GLint first, GLsizei count);
+void pi_resetGLState();
+
+// Sends both matrices, binding the program only if one of them changed
+void pi_setViewMatrices(GLint program, const GLfloat *mvMatrix,
+                        const GLfloat *transform);
+
+// Calls made through the functions above, and the redundant ones skipped
+struct piGLCallCounts {
+  unsigned int programs;
+  unsigned int uniforms;
+  unsigned int enables;
+  unsigned int draws;
+  unsigned int skipped;
+};
+
+// Starts a new frame, keeping the counts of the last one
+void pi_beginGLFrame();
+
+// Counts of the last complete frame, from one pi_beginGLFrame() to the next
+const piGLCallCounts &pi_getGLCallCounts();
+
+#else
+inline void pi_setEnabled(GLenum cap, bool enable) {
+  if (enable)
+    glEnable(cap);
+  else
+    glDisable(cap);
+}
+inline void pi_drawArrays(GLenum mode, GLint first, GLsizei count) {
+  glDrawArrays(mode, first, count);
+}
+inline void pi_resetGLState() {}
+#endif
+
+#endif
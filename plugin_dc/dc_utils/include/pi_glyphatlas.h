@@ -0,0 +1,142 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Shared glyph atlas for TexFontPI
+ *
+ ***************************************************************************
+ *   Copyright (C) 2024 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ **************************************************************************/
+
+#ifndef __PIGLYPHATLAS_H__
+#define __PIGLYPHATLAS_H__
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <wx/font.h>
+
+/*
+ * Packs rectangles into a page in rows ("shelves"): a rectangle goes on the
+ * first shelf which is tall enough without wasting more than a quarter of
+ * its height, or on a new shelf below the last one.
+ */
+class piShelfPacker {
+public:
+  piShelfPacker(int width = 0, int height = 0) { Reset(width, height); }
+
+  void Reset(int width, int height);
+  /* Finds room for a w x h rectangle, false if the page is full. */
+  bool Insert(int w, int h, int *x, int *y);
+
+private:
+  struct Shelf {
+    int y, height, used;
+  };
+
+  int m_width, m_height;
+  int m_bottom;  // top of the next shelf
+  std::vector<Shelf> m_shelves;
+};
+
+/* A glyph in the atlas: its cell in a page, and its metrics. */
+struct piGlyph {
+  int page;
+  int x, y, width, height;  // cell, the glyph is drawn at pad, pad
+  int pad;
+  float advance;
+  int textHeight;
+};
+
+/* The glyphs rasterized so far for one font and blur setting. */
+class piGlyphFont {
+public:
+  const piGlyph *GetGlyph(unsigned int code) const {
+    std::unordered_map<unsigned int, piGlyph>::const_iterator it =
+        m_glyphs.find(code);
+    return it == m_glyphs.end() ? 0 : &it->second;
+  }
+
+private:
+  friend class piGlyphAtlas;
+
+  wxFont m_font;
+  bool m_blur;
+  int m_refs;
+  std::unordered_map<unsigned int, piGlyph> m_glyphs;
+};
+
+/*
+ * Glyph textures shared by all TexFontPI instances. Glyphs are rasterized
+ * the first time a string needs them, any Unicode code point the font has,
+ * and packed into a few alpha texture pages. Fonts are shared by face, size,
+ * style and blur, so that building a font size again at zoom costs nothing.
+ *
+ * When all pages are full the least recently drawn page is emptied, and
+ * the generation changes so that cached glyph quads are dropped. A page
+ * used since the last NextTick() is never emptied: pages are added instead,
+ * up to a limit past which glyphs are left out. Only the part of a page
+ * that changed is uploaded, when it is next bound.
+ */
+class piGlyphAtlas {
+public:
+  static piGlyphAtlas &Get();
+
+  piGlyphFont *Acquire(const wxFont &font, bool blur);
+  void Release(piGlyphFont *font);
+
+  /* Rasterizes the glyphs of codes which font does not have yet. A glyph
+   * which does not fit in the atlas is left out.
+   */
+  void Prepare(piGlyphFont *font, const std::vector<unsigned int> &codes);
+  /* Keeps page until the next tick, for glyph quads about to be drawn. */
+  void Use(int page);
+
+  /* Binds the texture of page to GL_TEXTURE_2D, after uploading changes. */
+  void Bind(int page);
+  /* The alpha texels of page, GetPageSize() square, to draw without GL. */
+  const unsigned char *GetPixels(int page);
+  int GetPageSize() const;
+  /* Changes whenever glyphs are evicted. */
+  unsigned long GetGeneration() const { return m_generation; }
+  /* Starts a new draw, pages used since are not evicted. */
+  void NextTick() { m_tick++; }
+
+private:
+  struct Page {
+    piShelfPacker packer;
+    std::vector<unsigned char> pixels;  // alpha
+    unsigned int texture;
+    int dirtyX0, dirtyY0, dirtyX1, dirtyY1;  // empty if dirtyX0 >= dirtyX1
+    unsigned long lastUse;
+  };
+
+  piGlyphAtlas();
+  ~piGlyphAtlas();
+
+  bool Allocate(int w, int h, int *page, int *x, int *y);
+  void Evict(int page);
+
+  std::map<std::string, piGlyphFont *> m_fonts;
+  std::vector<Page> m_pages;
+  unsigned long m_generation;
+  unsigned long m_tick;
+};
+
+#endif
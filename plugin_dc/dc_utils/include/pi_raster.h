@@ -0,0 +1,95 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Software rasterizer for a headless piDC
+ *
+ ***************************************************************************
+ *   Copyright (C) 2024 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ **************************************************************************/
+
+
+#ifndef __PIRASTER_H__
+#define __PIRASTER_H__
+
+#include <vector>
+
+#include "pi_drawbatch.h"
+
+/*
+ * A piDrawSink which renders into an RGBA image in memory, with a scanline
+ * rasterizer. A piDC made on it draws without a display or GL context, so
+ * overlays can be compared with golden images, timed, or rendered to
+ * thumbnails offscreen.
+ *
+ * A pixel is covered when its center is inside a triangle, edges on the
+ * left and top included, so that triangles sharing an edge never both
+ * cover a pixel. There is no anti-aliasing.
+ */
+class piRasterSink : public piDrawSink {
+public:
+  piRasterSink(int width = 0, int height = 0);
+
+  /* Resizes the image, which is cleared to transparent black. */
+  void Resize(int width, int height);
+  void Clear(unsigned char r, unsigned char g, unsigned char b,
+             unsigned char a = 255);
+
+  int GetWidth() const { return m_width; }
+  int GetHeight() const { return m_height; }
+  /* The width * height RGBA pixels, rows from the top down. */
+  const unsigned char *GetPixels() const {
+    return m_pixels.empty() ? 0 : &m_pixels[0];
+  }
+
+  void Draw(const piDrawState &state, const float *vertices, int count);
+
+  /* Fills the triangle strip of count x,y vertices, as from piStroker. */
+  void FillTriangleStrip(const float *vertices, int count,
+                         const unsigned char color[4], bool blend);
+  /* Draws triangles of count x,y,u,v vertices moved by dx,dy, in color with
+   * the alpha of a texture of width x height texels, sampled at the nearest
+   * texel to u,v in 0..1.
+   */
+  void DrawAlphaTriangles(const float *vertices, int count, float dx, float dy,
+                          const unsigned char *texture, int width, int height,
+                          const unsigned char color[4]);
+  /* Draws w x h pixels at x,y, rows from the top down: RGBA blended over the
+   * image if alpha is set, otherwise RGB replacing it.
+   */
+  void DrawImage(int x, int y, int w, int h, const unsigned char *pixels,
+                 bool alpha);
+
+private:
+  struct Texture {
+    const unsigned char *alpha;
+    int width, height;
+  };
+
+  void FillTriangle(const float *a, const float *b, const float *c,
+                    const unsigned char color[4], bool blend,
+                    const Texture *texture = 0);
+  void FillQuad(float x0, float y0, float x1, float y1, float x2, float y2,
+                float x3, float y3, const unsigned char color[4], bool blend);
+  void Put(unsigned char *p, const unsigned char color[4], int alpha,
+           bool blend);
+
+  int m_width, m_height;
+  std::vector<unsigned char> m_pixels;
+};
+
+#endif
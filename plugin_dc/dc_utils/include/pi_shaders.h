@@ -29,9 +29,7 @@
 #include "wx/wx.h"
 #endif  // precompiled headers
 
-#ifdef USE_ANDROID_GLES2
-#include "GLES2/gl2.h"
-#endif
+#include "pi_glstate.h"
 
 extern GLint pi_color_tri_shader_program;
 extern GLint pi_colorv_tri_shader_program;
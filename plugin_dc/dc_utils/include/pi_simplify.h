@@ -0,0 +1,94 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Viewport culling and decimation of piDC polylines
+ *
+ ***************************************************************************
+ *   Copyright (C) 2024 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ **************************************************************************/
+
+
+#ifndef __PISIMPLIFY_H__
+#define __PISIMPLIFY_H__
+
+#include <vector>
+
+#include <wx/gdicmn.h>
+
+/*
+ * Reduces polylines and polygons to what can be seen on screen, before they
+ * are drawn: segments outside the clip rectangle are dropped, and points
+ * closer than the tolerance to the last point kept are merged. The result
+ * only depends on the input, and no GL is involved.
+ *
+ * A polyline whose middle is culled is split into pieces. A polygon is
+ * clipped to the rectangle, so that its fill stays correct; the edges added
+ * along the rectangle are not visible if it is larger than the viewport by
+ * the pen width.
+ */
+class piSimplifier {
+public:
+  struct Stats {
+    unsigned long calls;
+    unsigned long pointsIn, pointsOut;
+  };
+
+  piSimplifier();
+
+  /* Drops what lies outside rect, an empty rect disables clipping. */
+  void SetClipRect(const wxRect &rect) { m_clip = rect; }
+  /* Merges points closer than tolerance pixels, 0 keeps them all. */
+  void SetTolerance(float tolerance) { m_tolerance = tolerance; }
+
+  /* Simplifies the polyline of n points, and returns the number of pieces
+   * left, whose points follow each other in GetPoints().
+   */
+  int SimplifyLines(int n, const wxPoint points[]);
+  /* Simplifies the polygon of n points, and returns the number of points
+   * left, 0 if nothing remains to be drawn.
+   */
+  int SimplifyPolygon(int n, const wxPoint points[]);
+
+  wxPoint *GetPoints() { return m_points.empty() ? NULL : &m_points[0]; }
+  /* Number of points of each piece of the last SimplifyLines(). */
+  const int *GetPieces() const {
+    return m_pieces.empty() ? NULL : &m_pieces[0];
+  }
+
+  const Stats &GetStats() const { return m_stats; }
+  void ResetStats();
+
+private:
+  int OutCode(const wxPoint &p) const;
+  void BeginPiece(const wxPoint &p);
+  void AddPoint(const wxPoint &p);
+  void Clip(const wxPoint points[], int n);
+
+  wxRect m_clip;
+  float m_tolerance;
+
+  std::vector<wxPoint> m_points;
+  std::vector<int> m_pieces;
+  std::vector<wxPoint> m_clipped[2];  // polygon clipped to successive sides
+  wxPoint m_anchor;                   // last point kept for its distance
+  bool m_provisional;  // the last point is only kept as the end of a piece
+
+  Stats m_stats;
+};
+
+#endif
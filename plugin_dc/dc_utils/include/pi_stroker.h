@@ -0,0 +1,92 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Polyline stroker for piDC thick and dashed lines
+ *
+ ***************************************************************************
+ *   Copyright (C) 2024 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ **************************************************************************/
+
+#ifndef __PISTROKER_H__
+#define __PISTROKER_H__
+
+#include <vector>
+
+/*
+ * Turns a polyline into the outline of a pen of some width, as a single
+ * triangle strip which can be drawn with one call whatever the number of
+ * points. Separate pieces, i.e. dashes, are connected by degenerate
+ * triangles. Joins are built around the inner miter point, so adjacent
+ * segments do not overlap and translucent pens show no darker spots.
+ *
+ * The output buffer is kept between calls, a stroker used for every frame
+ * stops allocating once it has seen the longest polyline.
+ */
+class piStroker {
+public:
+  enum Join { JOIN_MITER, JOIN_ROUND, JOIN_BEVEL };
+  enum Cap { CAP_BUTT, CAP_SQUARE, CAP_ROUND };
+
+  piStroker();
+
+  void SetWidth(float width);
+  void SetJoin(Join join) { m_join = join; }
+  /* Longest miter, in pen widths, before a miter join falls back to bevel. */
+  void SetMiterLimit(float limit) { m_miterLimit = limit; }
+  void SetCap(Cap cap) { m_cap = cap; }
+  /* Lengths in pixels, alternately drawn and skipped, n = 0 for a solid
+   * line. An odd pattern is repeated twice, as in SVG.
+   */
+  void SetDashes(const float *dashes, int n);
+
+  /* Strokes the polyline of n points, as x,y pairs, and returns the number
+   * of vertices of the strip, 0 if nothing is to be drawn.
+   */
+  int Stroke(const float *points, int n, bool closed = false);
+
+  /* The triangle strip of the last Stroke(), as x,y pairs. */
+  const float *GetVertices() const {
+    return m_vertices.empty() ? 0 : &m_vertices[0];
+  }
+  int GetVertexCount() const { return (int)(m_vertices.size() / 2); }
+
+private:
+  void StrokePiece(const float *points, int n, bool closed);
+  void AddJoin(float x, float y, float dx0, float dy0, float len0, float dx1,
+               float dy1, float len1);
+  void AddCap(float x, float y, float dx, float dy, bool start);
+  void AddOuter(bool left, float ox, float oy, float px, float py);
+  void AddPair(float lx, float ly, float rx, float ry);
+  void AddVertex(float x, float y);
+
+  float m_width;
+  float m_miterLimit;
+  float m_roundStep;  // angle between the points of round joins and caps
+  Join m_join;
+  Cap m_cap;
+  std::vector<float> m_dashes;
+
+  std::vector<float> m_vertices;
+  std::vector<float> m_points;  // deduplicated input
+  std::vector<float> m_piece;   // current dash
+  std::vector<float> m_pairs;   // output of AddJoin, for closed polylines
+  bool m_link;                  // the next vertex starts a new piece
+  bool m_capture;               // AddPair writes to m_pairs
+};
+
+#endif
@@ -0,0 +1,104 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Cache of tessellated polygon fills for piDC
+ *
+ ***************************************************************************
+ *   Copyright (C) 2024 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ **************************************************************************/
+
+#ifndef __PITESSCACHE_H__
+#define __PITESSCACHE_H__
+
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include <wx/gdicmn.h>
+
+/*
+ * Vertex storage for the GLU tessellator callbacks, handed out with a
+ * pointer bump and released all at once by Reset() at the start of each
+ * draw. The blocks are merged on Reset(), so after the first few draws a
+ * polygon needs no heap allocation at all.
+ */
+class piTessArena {
+public:
+  piTessArena() : m_block(0), m_used(0) {}
+
+  /* Releases all vertices, and makes room for at least estimate doubles. */
+  void Reset(size_t estimate = 0);
+  /* Returns storage for n doubles, valid until the next Reset(). */
+  double *Alloc(size_t n);
+
+private:
+  std::vector<std::vector<double> > m_blocks;
+  size_t m_block, m_used;
+};
+
+/*
+ * Tessellates polygon fills into plain triangle lists and keeps the results
+ * in a bounded LRU cache, so that overlays redrawn every frame with the same
+ * outline skip the GLU tessellator and its per-vertex allocations.
+ *
+ * The triangles are stored relative to the first point of the polygon, and
+ * the key is built from the points relative to that same point: a polygon
+ * which is only translated on screen, e.g. while panning, still hits.
+ */
+class piTessCache {
+public:
+  static piTessCache &Get();
+
+  /* Returns the triangles of the polygon made of ncontours contours of
+   * npoints[i] points each, as x,y pairs relative to points[0]. The
+   * reference is valid until the next call.
+   */
+  const std::vector<float> &Tessellate(int ncontours, const int npoints[],
+                                       const wxPoint points[],
+                                       int windingRule);
+
+  /* Limits the cache to about maxVertices stored vertices, 0 disables it. */
+  void SetLimit(size_t maxVertices);
+  void Clear();
+
+private:
+  struct Entry {
+    unsigned long long hash;
+    int windingRule;
+    std::vector<int> contours;
+    std::vector<wxPoint> points;  // relative to the first point
+    std::vector<float> triangles;
+
+    size_t Size() const { return points.size() + triangles.size() / 2; }
+  };
+  typedef std::list<Entry> EntryList;
+
+  piTessCache();
+
+  void Run(Entry &entry);
+  void Trim();
+
+  piTessArena m_arena;
+  EntryList m_entries;  // most recently used first
+  std::unordered_map<unsigned long long, EntryList::iterator> m_index;
+  size_t m_size, m_limit;
+  Entry m_scratch;  // lookup key, and result of uncacheable polygons
+};
+
+#endif
@@ -0,0 +1,91 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Cache of text extents for piDC
+ *
+ ***************************************************************************
+ *   Copyright (C) 2024 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ **************************************************************************/
+
+
+#ifndef __PITEXTCACHE_H__
+#define __PITEXTCACHE_H__
+
+#include <cstddef>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+#include <wx/font.h>
+#include <wx/string.h>
+
+/*
+ * Extents of the strings measured so far, in a bounded LRU list per font.
+ * Measuring is slow, with wx on GTK in particular, and layout code measures
+ * the same labels again for every collision check and every frame.
+ *
+ * The cache is shared by all piDC instances. Entries are found by the hash
+ * of the string and checked against the string itself.
+ */
+class piTextExtentCache {
+public:
+  struct Extent {
+    int width, height;
+    int descent;  // < 0 if not measured
+  };
+
+  static piTextExtentCache &Get();
+
+  /* Identifies font, measured with TexFontPI or with a wxDC. */
+  static std::string FontKey(const wxFont &font, bool texture);
+
+  /* The extent of text stored for font, NULL if there is none. The pointer
+   * is valid until the next Store().
+   */
+  const Extent *Find(const std::string &font, const wxString &text);
+  void Store(const std::string &font, const wxString &text,
+             const Extent &extent);
+
+  /* Keeps at most n strings per font, 0 disables the cache. */
+  void SetLimit(size_t n);
+  void Clear();
+
+private:
+  struct Entry {
+    unsigned long hash;
+    wxString text;
+    Extent extent;
+  };
+  typedef std::list<Entry> EntryList;
+
+  struct Font {
+    EntryList entries;  // most recently used first
+    std::unordered_map<unsigned long, EntryList::iterator> index;
+    unsigned long lastUse;
+  };
+
+  piTextExtentCache();
+
+  void Trim(Font &font);
+
+  std::unordered_map<std::string, Font> m_fonts;
+  size_t m_limit;
+  unsigned long m_tick;
+};
+
+#endif
@@ -53,10 +53,17 @@ typedef void (*_GLUfuncptr)();
 typedef void (__stdcall* _GLUfuncptr)();
 #endif
 
+#include <string>
 #include <vector>
 #include "linmath.h"
 
 #include "TexFont.h"
+#include "pi_drawbatch.h"
+#include "pi_glcaps.h"
+#include "pi_raster.h"
+#include "pi_simplify.h"
+#include "pi_stroker.h"
+#include "pi_tesscache.h"
 #include "ocpn_plugin.h"
 
 #ifdef ocpnUSE_GL
@@ -81,6 +88,11 @@ class piDC {
 public:
   piDC(wxGLContext *context);
   piDC(wxDC &pdc);
+  /* Draws into raster, without a display or GL context: everything goes
+   * through the batch to the raster, and text uses the glyph atlas.
+   * Patterns and GL textures are not drawn.
+   */
+  piDC(piRasterSink &raster);
   piDC();
 
   ~piDC();
@@ -180,6 +192,32 @@ public:
 
   void DestroyClippingRegion() {}
 
+  /* Retained mode: from BeginBatch() on, consecutive GL lines, rectangles,
+   * ellipses and polygon fills with the same pen or brush are merged into
+   * one draw call. Anything else flushes the pending primitives first, so
+   * the drawing order is kept. With a sink, e.g. a piDrawRecorder, the
+   * batches go there instead of to OpenGL. EndBatch() flushes, call it at
+   * the end of the frame.
+   */
+  void BeginBatch(piDrawSink *sink = NULL);
+  void EndBatch();
+  void FlushBatch();
+  bool IsBatching() const { return m_batching; }
+
+  /* Optional stage before the GL drawing of DrawLines(), StrokeLines() and
+   * DrawPolygon(): what lies outside the viewport given to SetVP() is
+   * dropped, and points closer than tolerance pixels are merged.
+   */
+  void SetSimplify(bool enable, float tolerance = 1.0f);
+  /* Points given to and left by that stage. */
+  const piSimplifier::Stats &GetSimplifyStats() const {
+    return m_simplifier.GetStats();
+  }
+  void ResetSimplifyStats() { m_simplifier.ResetStats(); }
+
+  /* Limits of the GL context this piDC draws with. */
+  const piGLCaps &GetGLCaps() const;
+
   wxDC *GetDC() const { return dc; }
 
   void DrawGLLineArray(int n, float *vertex_array, unsigned char *color_array,
@@ -195,6 +233,11 @@ public:
   int ArcSectorPoints(wxPoint *&points, wxCoord xc, wxCoord yc, wxCoord x1,
                       wxCoord y1, wxCoord x2, wxCoord y2, wxCoord x3,
                       wxCoord y3, wxCoord x4, wxCoord y4, bool bHighQuality);
+  /* Same, into points, which keeps its storage from call to call. */
+  int ArcSectorPoints(std::vector<wxPoint> &points, wxCoord xc, wxCoord yc,
+                      wxCoord x1, wxCoord y1, wxCoord x2, wxCoord y2,
+                      wxCoord x3, wxCoord y3, wxCoord x4, wxCoord y4,
+                      bool bHighQuality);
 
 #ifdef ocpnUSE_GL
   GLfloat *s_odc_tess_work_buf;
@@ -210,6 +253,7 @@ public:
   vec4 s_odc_tess_color;
   ViewPort *s_odc_tessVP;
   GLint s_odc_activeProgram;
+  piTessArena s_odc_tess_arena;
 
 #endif
   GLUtesselator *m_tobj;
@@ -222,6 +266,10 @@ protected:
   bool ConfigurePen();
   bool ConfigureBrush();
 
+  bool CanBatchPen() const;
+  bool GetPenState(piDrawState &state, bool blend) const;
+  bool GetBrushState(piDrawState &state, bool blend) const;
+
   void GLDrawBlendData(wxCoord x, wxCoord y, wxCoord w, wxCoord h, int format,
                        const unsigned char *data);
   void drawrrhelperGLES2(wxCoord x0, wxCoord y0, wxCoord r, int quadrant,
@@ -231,7 +279,20 @@ protected:
                        bool b_hiqual);
   void DrawGLThickLines(int n, wxPoint points[], wxCoord xoffset,
                         wxCoord yoffset, wxPen pen, bool b_hiqual);
-  void DrawEndCap(float x1, float y1, float t1, float angle);
+  void ConfigureStroker(const wxPen &pen);
+  void DrawStroke(const wxColour &colour);
+
+  void MeasureText(const wxString &string, const wxFont *font, wxCoord *w,
+                   wxCoord *h, wxCoord *descent);
+
+  void DrawLinesDirect(int n, wxPoint points[], wxCoord xoffset,
+                       wxCoord yoffset, bool b_hiqual);
+  void SetSimplifyClip(wxCoord xoffset, wxCoord yoffset);
+
+  void BatchLines(const float *points, int n, bool closed, bool blend);
+  void BatchShape(const float *points, int n, bool blend);
+  void RasterPolygon(int n, wxPoint points[], wxCoord xoffset, wxCoord yoffset,
+                     float scale, float angle);
 
   wxGLContext *glcontext;
   wxDC *dc;
@@ -240,6 +301,7 @@ protected:
   wxColour m_textforegroundcolour;
   wxColour m_textbackgroundcolour;
   wxFont m_font;
+  std::string m_fontKey;  // of m_font in piTextExtentCache, empty until used
 
 #ifdef ocpnUSE_GL
   TexFontPI m_texfont;
@@ -256,6 +318,19 @@ protected:
   unsigned int workBufIndex;
 
   wxSize m_vpSize;
+
+  piDrawBatch m_batch;
+  bool m_batching;
+
+  piStroker m_stroker;
+  std::vector<wxPoint> m_shapePoints;  // outline of the last disk or sector
+
+  piSimplifier m_simplifier;
+  bool m_simplify;
+
+  mutable const piGLCaps *m_glcaps;  // resolved by GetGLCaps()
+  mutable piGLCaps m_ownglcaps;      // of a piDC() with no context
+  piRasterSink *m_raster;             // headless, instead of GL
 };
 
 #endif
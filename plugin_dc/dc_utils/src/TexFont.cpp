@@ -26,11 +26,14 @@
 #include <wx/wx.h>
 
 #include "TexFont.h"
+#include "pi_glyphatlas.h"
+#include "pi_raster.h"
 
 #ifdef USE_ANDROID_GLES2
 #include "GLES2/gl2.h"
 #include "linmath.h"
 #include "shaders.h"
+#include "pi_shaders.h"
 #include "qdebug.h"
 #elif defined(__WXOSX__)
 #include <OpenGL/gl.h>
@@ -39,11 +42,17 @@
 #include <GL/gl.h>
 #endif
 
+// Default number of strings whose glyph quads are kept
+#define TEXFONT_CACHE_STRINGS 256
+
 TexFontPI::TexFontPI() {
-  texobj = 0;
+  m_glyphs = NULL;
+  m_lineHeight = 0;
   m_blur = false;
   m_built = false;
   m_color = wxColor(0, 0, 0);
+  m_cacheSize = TEXFONT_CACHE_STRINGS;
+  m_generation = 0;
 }
 
 TexFontPI::~TexFontPI() { Delete(); }
@@ -52,243 +61,215 @@ void TexFontPI::Build(wxFont &font, bool blur) {
   /* avoid rebuilding if the parameters are the same */
   if (font == m_font && blur == m_blur && m_built) return;
 
+  Delete();
   m_font = font;
   m_blur = blur;
+  ClearCache();  // the quads depend on the glyph metrics
 
-  m_maxglyphw = 0;
-  m_maxglyphh = 0;
+  // Another instance may have built this font already, glyphs are shared
+  m_glyphs = piGlyphAtlas::Get().Acquire(font, blur);
+  m_generation = piGlyphAtlas::Get().GetGeneration();
 
   wxScreenDC sdc;
+  wxCoord gw;
+  sdc.GetTextExtent(_T("A"), &gw, &m_lineHeight, NULL, NULL, &font);
 
-  sdc.SetFont(font);
-
-  for (int i = MIN_GLYPH; i < MAX_GLYPH; i++) {
-    wxCoord gw, gh;
-    wxString text;
-    if (i == DEGREE_GLYPH)
-      text = wxString::Format(_T("%c"), 0x00B0);  //_T("°");
-    else
-      text = wxString::Format(_T("%c"), i);
-    wxCoord descent, exlead;
-    sdc.GetTextExtent(text, &gw, &gh, &descent, &exlead,
-                      &font);  // measure the text
-
-    tgi[i].width = gw;
-    tgi[i].height = gh;
-
-    tgi[i].advance = gw;
+  m_built = true;
+}
 
-    m_maxglyphw = wxMax(tgi[i].width, m_maxglyphw);
-    m_maxglyphh = wxMax(tgi[i].height, m_maxglyphh);
+void TexFontPI::Delete() {
+  if (m_glyphs) {
+    piGlyphAtlas::Get().Release(m_glyphs);
+    m_glyphs = NULL;
   }
+  m_built = false;
+}
 
-  /* add extra pixel to give a border between rows of characters
-     without this, in some cases a faint line can be see on the edge
-     from the character above */
-  m_maxglyphh++;
-
-  int w = COLS_GLYPHS * m_maxglyphw;
-  int h = ROWS_GLYPHS * m_maxglyphh;
-
-  wxASSERT(w < 2048 && h < 2048);
-
-  /* make power of 2 */
-  for (tex_w = 1; tex_w < w; tex_w *= 2)
-    ;
-  for (tex_h = 1; tex_h < h; tex_h *= 2)
-    ;
-
-  wxBitmap tbmp(tex_w, tex_h);
-  wxMemoryDC dc;
-  dc.SelectObject(tbmp);
-  dc.SetFont(font);
-
-  /* fill bitmap with black */
-  dc.SetBackground(wxBrush(wxColour(0, 0, 0)));
-  dc.Clear();
-
-  /* draw the text white */
-  dc.SetTextForeground(wxColour(255, 255, 255));
-
-  /*    wxPen pen(wxColour( 255, 255, 255 ));
-      wxBrush brush(wxColour( 255, 255, 255 ), wxTRANSPARENT);
-      dc.SetPen(pen);
-      dc.SetBrush(brush);
-   */
-  int row = 0, col = 0;
-  for (int i = MIN_GLYPH; i < MAX_GLYPH; i++) {
-    if (col == COLS_GLYPHS) {
-      col = 0;
-      row++;
-    }
-
-    tgi[i].x = col * m_maxglyphw;
-    tgi[i].y = row * m_maxglyphh;
-
-    wxString text;
-    if (i == DEGREE_GLYPH)
-      text = wxString::Format(_T("%c"), 0x00B0);  //_T("°");
-    else
-      text = wxString::Format(_T("%c"), i);
-
-    dc.DrawText(text, tgi[i].x, tgi[i].y);
+// Decodes the UTF-8 string into m_codes, and makes sure the atlas has the
+// glyphs. Invalid bytes are skipped.
+void TexFontPI::Decode(const char *string) {
+  m_codes.clear();
+  const unsigned char *s = (const unsigned char *)string;
+  while (*s) {
+    unsigned int c = *s++;
+    int more = 0;
+    if (c >= 0xf0 && c < 0xf8)
+      c &= 0x07, more = 3;
+    else if (c >= 0xe0)
+      c &= 0x0f, more = 2;
+    else if (c >= 0xc0)
+      c &= 0x1f, more = 1;
+    else if (c >= 0x80)
+      continue;
 
-    //        dc.DrawRectangle(tgi[i].x, tgi[i].y, tgi[i].advance,
-    //        tgi[i].height);
-    col++;
+    for (; more && (*s & 0xc0) == 0x80; more--) c = (c << 6) | (*s++ & 0x3f);
+    if (!more) m_codes.push_back(c);
   }
 
-  dc.SelectObject(wxNullBitmap);
-
-  wxImage image = tbmp.ConvertToImage();
-
-  GLuint format, internalformat;
-  int stride;
-
-  format = GL_ALPHA;
-  internalformat = format;
-  stride = 1;
-
-  if (m_blur) image = image.Blur(1);
-
-  unsigned char *imgdata = image.GetData();
-
-  if (imgdata) {
-    unsigned char *teximage = (unsigned char *)malloc(stride * tex_w * tex_h);
-
-    for (int j = 0; j < tex_w * tex_h; j++)
-      for (int k = 0; k < stride; k++)
-        teximage[j * stride + k] = imgdata[3 * j];
-
-    Delete();
-
-    glGenTextures(1, &texobj);
-    glBindTexture(GL_TEXTURE_2D, texobj);
+  if (m_glyphs) piGlyphAtlas::Get().Prepare(m_glyphs, m_codes);
+  CheckGeneration();
+}
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
-                    GL_NEAREST /*GL_LINEAR*/);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+void TexFontPI::GetTextExtent(const char *string, int *width, int *height) {
+  int w = 0, h = 0;
 
-    glTexImage2D(GL_TEXTURE_2D, 0, internalformat, tex_w, tex_h, 0, format,
-                 GL_UNSIGNED_BYTE, teximage);
+  Decode(string);
+  for (size_t i = 0; i < m_codes.size(); i++) {
+    unsigned int c = m_codes[i];
+    if (c == '\n') {
+      h += m_lineHeight;
+      continue;
+    }
+    const piGlyph *glyph = m_glyphs ? m_glyphs->GetGlyph(c) : NULL;
+    if (!glyph) continue;
 
-    free(teximage);
+    w += glyph->advance;
+    if (glyph->textHeight > h) h = glyph->textHeight;
   }
-
-  m_built = true;
+  if (width) *width = w;
+  if (height) *height = h;
 }
 
-void TexFontPI::Delete() {
-  if (texobj) {
-    glDeleteTextures(1, &texobj);
-    texobj = 0;
-  }
-  m_built = false;
+void TexFontPI::GetTextExtent(const wxString &string, int *width, int *height) {
+  GetTextExtent((const char *)string.ToUTF8(), width, height);
 }
 
-void TexFontPI::GetTextExtent(const char *string, int *width, int *height) {
-  int w = 0, h = 0;
+// Appends the glyph quads of the string last decoded, starting at x,y
+void TexFontPI::AddQuads(float x, float y, QuadRun &run) {
+  if (!m_glyphs) return;
+  float size = piGlyphAtlas::Get().GetPageSize();
+  float dx = x, dy = y;
 
-  for (int i = 0; string[i]; i++) {
-    unsigned char c = string[i];
+  for (size_t i = 0; i < m_codes.size(); i++) {
+    unsigned int c = m_codes[i];
     if (c == '\n') {
-      h += tgi[(int)'A'].height;
+      dx = x;
+      dy += m_lineHeight;
       continue;
     }
-    if (c == 0xc2 && (unsigned char)string[i + 1] == 0xb0) {
-      c = DEGREE_GLYPH;
-      i++;
+    const piGlyph *glyph = m_glyphs->GetGlyph(c);
+    if (!glyph) continue;
+
+    // The cell has a border of pad pixels around the glyph
+    float x1 = dx - glyph->pad, y1 = dy - glyph->pad;
+    float x2 = x1 + glyph->width, y2 = y1 + glyph->height;
+    float tx1 = glyph->x / size, tx2 = (glyph->x + glyph->width) / size;
+    float ty1 = glyph->y / size, ty2 = (glyph->y + glyph->height) / size;
+
+    // Two triangles, so that consecutive glyphs need no restart
+    const float quad[] = {x1, y1, tx1, ty1, x2, y1, tx2, ty1,
+                          x2, y2, tx2, ty2, x2, y2, tx2, ty2,
+                          x1, y2, tx1, ty2, x1, y1, tx1, ty1};
+    run.quads.insert(run.quads.end(), quad, quad + 24);
+
+    size_t n = run.spans.size();
+    if (n && run.spans[n - 2] == glyph->page)
+      run.spans[n - 1] += 6;
+    else {
+      run.spans.push_back(glyph->page);
+      run.spans.push_back(6);
     }
-    if (c < MIN_GLYPH || c >= MAX_GLYPH) continue;
 
-    TexGlyphInfo &tgisi = tgi[c];
-    w += tgisi.advance;
-    if (tgisi.height > h) h = tgisi.height;
+    dx += glyph->advance;
   }
-  if (width) *width = w;
-  if (height) *height = h;
 }
 
-void TexFontPI::GetTextExtent(const wxString &string, int *width, int *height) {
-  GetTextExtent((const char *)string.ToUTF8(), width, height);
+const TexFontPI::QuadRun &TexFontPI::GetQuads(const char *string) {
+  if (!m_cacheSize) {
+    Decode(string);
+    m_quads.quads.clear();
+    m_quads.spans.clear();
+    AddQuads(0, 0, m_quads);
+    return m_quads;
+  }
+
+  CheckGeneration();
+  std::string key(string);
+  std::unordered_map<std::string, QuadRunList::iterator>::iterator found =
+      m_runIndex.find(key);
+  if (found != m_runIndex.end()) {
+    m_runs.splice(m_runs.begin(), m_runs, found->second);
+    return *found->second;
+  }
+
+  Decode(string);  // may evict glyphs of cached strings
+  m_runs.push_front(QuadRun());
+  m_runs.front().text = key;
+  AddQuads(0, 0, m_runs.front());
+  m_runIndex[key] = m_runs.begin();
+
+  if (m_runs.size() > m_cacheSize) {
+    m_runIndex.erase(m_runs.back().text);
+    m_runs.pop_back();
+  }
+  return m_runs.front();
 }
 
-void TexFontPI::RenderGlyph(int c) {
-  if (c < MIN_GLYPH || c >= MAX_GLYPH) return;
+void TexFontPI::SetCacheSize(size_t n) {
+  m_cacheSize = n;
+  while (m_runs.size() > m_cacheSize) {
+    m_runIndex.erase(m_runs.back().text);
+    m_runs.pop_back();
+  }
+}
 
-  TexGlyphInfo &tgic = tgi[c];
+void TexFontPI::ClearCache() {
+  m_runs.clear();
+  m_runIndex.clear();
+}
 
-  int x = tgic.x, y = tgic.y;
-  float w = m_maxglyphw, h = m_maxglyphh;
-  float tx1 = (float)x / (float)tex_w;
-  float tx2 = (float)(x + w) / (float)tex_w;
-  float ty1 = (float)y / (float)tex_h;
-  float ty2 = (float)(y + h) / (float)tex_h;
+// Drops the cached quads once the atlas has moved glyphs
+void TexFontPI::CheckGeneration() {
+  unsigned long generation = piGlyphAtlas::Get().GetGeneration();
+  if (generation == m_generation) return;
+  ClearCache();
+  m_generation = generation;
+}
 
-#ifndef USE_ANDROID_GLES2
+// Draws quads translated by x,y, one call per atlas page used
+void TexFontPI::DrawQuads(const QuadRun &run, int x, int y) {
+  if (run.quads.empty()) return;
+  const std::vector<float> &quads = run.quads;
+  piGlyphAtlas &atlas = piGlyphAtlas::Get();
 
-  glBegin(GL_QUADS);
+#ifndef USE_ANDROID_GLES2
+  glPushMatrix();
+  glTranslatef(x, y, 0);
 
-  glTexCoord2f(tx1, ty1);
-  glVertex2i(0, 0);
-  glTexCoord2f(tx2, ty1);
-  glVertex2i(w, 0);
-  glTexCoord2f(tx2, ty2);
-  glVertex2i(w, h);
-  glTexCoord2f(tx1, ty2);
-  glVertex2i(0, h);
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+  glVertexPointer(2, GL_FLOAT, 4 * sizeof(float), &quads[0]);
+  glTexCoordPointer(2, GL_FLOAT, 4 * sizeof(float), &quads[2]);
+  for (size_t i = 0, first = 0; i < run.spans.size(); i += 2) {
+    atlas.Bind(run.spans[i]);
+    glDrawArrays(GL_TRIANGLES, first, run.spans[i + 1]);
+    first += run.spans[i + 1];
+  }
+  glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+  glDisableClientState(GL_VERTEX_ARRAY);
 
-  glEnd();
-  glTranslatef(tgic.advance, 0.0, 0.0);
+  glPopMatrix();
 #else
-
-  float uv[8];
-  float coords[8];
-
-  // normal uv
-  uv[0] = tx1;
-  uv[1] = ty1;
-  uv[2] = tx2;
-  uv[3] = ty1;
-  uv[4] = tx2;
-  uv[5] = ty2;
-  uv[6] = tx1;
-  uv[7] = ty2;
-
-  // pixels
-  coords[0] = 0;
-  coords[1] = 0;
-  coords[2] = w;
-  coords[3] = 0;
-  coords[4] = w;
-  coords[5] = h;
-  coords[6] = 0;
-  coords[7] = h;
-
-  glUseProgram(texture_2DA_shader_program);
+  pi_useProgram(texture_2DA_shader_program);
 
   // Get pointers to the attributes in the program.
-  GLint mPosAttrib = glGetAttribLocation(texture_2DA_shader_program, "aPos");
-  GLint mUvAttrib = glGetAttribLocation(texture_2DA_shader_program, "aUV");
+  GLint mPosAttrib = pi_getShader(texture_2DA_shader_program).position;
+  GLint mUvAttrib = pi_getShader(texture_2DA_shader_program).uv;
 
   // Set up the texture sampler to texture unit 0
-  GLint texUni = glGetUniformLocation(texture_2DA_shader_program, "uTex");
+  GLint texUni = pi_getShader(texture_2DA_shader_program).tex;
   glUniform1i(texUni, 0);
 
   // Disable VBO's (vertex buffer objects) for attributes.
   glBindBuffer(GL_ARRAY_BUFFER, 0);
   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
-  // Set the attribute mPosAttrib with the vertices in the screen coordinates...
-  glVertexAttribPointer(mPosAttrib, 2, GL_FLOAT, GL_FALSE, 0, coords);
-  // ... and enable it.
+  // Positions and texture coordinates are interleaved
+  glVertexAttribPointer(mPosAttrib, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float),
+                        &quads[0]);
   glEnableVertexAttribArray(mPosAttrib);
-
-  // Set the attribute mUvAttrib with the vertices in the GL coordinates...
-  glVertexAttribPointer(mUvAttrib, 2, GL_FLOAT, GL_FALSE, 0, uv);
-  // ... and enable it.
+  glVertexAttribPointer(mUvAttrib, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float),
+                        &quads[2]);
   glEnableVertexAttribArray(mUvAttrib);
 
   float colorv[4];
@@ -297,122 +278,93 @@ void TexFontPI::RenderGlyph(int c) {
   colorv[2] = m_color.Blue() / float(256);
   colorv[3] = 0;
 
-  GLint colloc = glGetUniformLocation(texture_2DA_shader_program, "color");
-  glUniform4fv(colloc, 1, colorv);
-
-  // Rotate
-  float angle = 0;
-  mat4x4 I, Q;
-  mat4x4_identity(I);
-  mat4x4_rotate_Z(Q, I, angle);
+  pi_setColor(texture_2DA_shader_program, colorv);
 
   // Translate
-  Q[3][0] = m_dx;
-  Q[3][1] = m_dy;
-
-  // mat4x4 X;
-  // mat4x4_mul(X, (float (*)[4])vp->vp_transform, Q);
+  mat4x4 Q;
+  mat4x4_identity(Q);
+  Q[3][0] = x;
+  Q[3][1] = y;
 
-  GLint matloc =
-      glGetUniformLocation(texture_2DA_shader_program, "TransformMatrix");
-  glUniformMatrix4fv(matloc, 1, GL_FALSE, (const GLfloat *)Q);
+  pi_setTransform(texture_2DA_shader_program, (const GLfloat *)Q);
 
   // Select the active texture unit.
   glActiveTexture(GL_TEXTURE0);
 
-// For some reason, glDrawElements is busted on Android
-// So we do this a hard ugly way, drawing two triangles...
-#if 0
-    GLushort indices1[] = {0,1,3,2}; 
-    glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_SHORT, indices1);
-#else
-
-  float co1[8];
-  co1[0] = coords[0];
-  co1[1] = coords[1];
-  co1[2] = coords[2];
-  co1[3] = coords[3];
-  co1[4] = coords[6];
-  co1[5] = coords[7];
-  co1[6] = coords[4];
-  co1[7] = coords[5];
-
-  float tco1[8];
-  tco1[0] = uv[0];
-  tco1[1] = uv[1];
-  tco1[2] = uv[2];
-  tco1[3] = uv[3];
-  tco1[4] = uv[6];
-  tco1[5] = uv[7];
-  tco1[6] = uv[4];
-  tco1[7] = uv[5];
-
-  glVertexAttribPointer(mPosAttrib, 2, GL_FLOAT, GL_FALSE, 0, co1);
-  glVertexAttribPointer(mUvAttrib, 2, GL_FLOAT, GL_FALSE, 0, tco1);
-
-  glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-
-#endif
-
-  m_dx += tgic.advance;
-
+  for (size_t i = 0, first = 0; i < run.spans.size(); i += 2) {
+    atlas.Bind(run.spans[i]);
+    pi_drawArrays(GL_TRIANGLES, first, run.spans[i + 1]);
+    first += run.spans[i + 1];
+  }
 #endif
 }
 
 void TexFontPI::RenderString(const char *string, int x, int y) {
-#ifndef USE_ANDROID_GLES2
+  piGlyphAtlas::Get().NextTick();
+  const QuadRun &run = GetQuads(string);
+  DrawQuads(run, x, y);
+}
 
-  glPushMatrix();
-  glTranslatef(x, y, 0);
+void TexFontPI::RenderString(const wxString &string, int x, int y) {
+  RenderString((const char *)string.ToUTF8(), x, y);
+}
 
-  glPushMatrix();
-  glBindTexture(GL_TEXTURE_2D, texobj);
+// Draws the quads from the atlas pages kept in memory
+void TexFontPI::RenderString(piRasterSink &raster, const wxString &string,
+                             int x, int y) {
+  piGlyphAtlas &atlas = piGlyphAtlas::Get();
+  atlas.NextTick();
+  const QuadRun &run = GetQuads(string.ToUTF8());
+
+  unsigned char color[4] = {m_color.Red(), m_color.Green(), m_color.Blue(),
+                            255};
+  int size = atlas.GetPageSize();
+  for (size_t i = 0, first = 0; i < run.spans.size(); i += 2) {
+    raster.DrawAlphaTriangles(&run.quads[4 * first], run.spans[i + 1], x, y,
+                              atlas.GetPixels(run.spans[i]), size, size,
+                              color);
+    first += run.spans[i + 1];
+  }
+}
 
-  for (int i = 0; string[i]; i++) {
-    if (string[i] == '\n') {
-      glPopMatrix();
-      glTranslatef(0, tgi[(int)'A'].height, 0);
-      glPushMatrix();
-      continue;
-    }
-    /* degree symbol */
-    if ((unsigned char)string[i] == 0xc2 &&
-        (unsigned char)string[i + 1] == 0xb0) {
-      RenderGlyph(DEGREE_GLYPH);
-      i++;
+void TexFontPI::RenderStrings(int n, const wxString strings[],
+                              const wxPoint positions[]) {
+  piGlyphAtlas &atlas = piGlyphAtlas::Get();
+  atlas.NextTick();
+
+  // m_quads is only used by GetQuads() while the cache is off
+  m_quads.quads.clear();
+  m_quads.spans.clear();
+  for (int i = 0; i < n; i++) {
+    wxCharBuffer text = strings[i].ToUTF8();
+    if (!m_cacheSize) {
+      Decode(text);
+      AddQuads(positions[i].x, positions[i].y, m_quads);
       continue;
     }
-    RenderGlyph(string[i]);
-  }
-
-  glPopMatrix();
-  glPopMatrix();
-#else
-  m_dx = x;
-  m_dy = y;
-
-  glBindTexture(GL_TEXTURE_2D, texobj);
 
-  for (int i = 0; string[i]; i++) {
-    if (string[i] == '\n') {
-      m_dy += tgi[(int)'A'].height;
-      continue;
+    const QuadRun &run = GetQuads(text);
+    size_t start = m_quads.quads.size();
+    m_quads.quads.insert(m_quads.quads.end(), run.quads.begin(),
+                         run.quads.end());
+    for (size_t j = start; j < m_quads.quads.size(); j += 4) {
+      m_quads.quads[j] += positions[i].x;
+      m_quads.quads[j + 1] += positions[i].y;
     }
-    /* degree symbol */
-    if ((unsigned char)string[i] == 0xc2 &&
-        (unsigned char)string[i + 1] == 0xb0) {
-      RenderGlyph(DEGREE_GLYPH);
-      i++;
-      continue;
+
+    // The glyphs of the batch must not be evicted for the next strings
+    for (size_t j = 0; j < run.spans.size(); j += 2) {
+      atlas.Use(run.spans[j]);
+      size_t k = m_quads.spans.size();
+      if (k && m_quads.spans[k - 2] == run.spans[j])
+        m_quads.spans[k - 1] += run.spans[j + 1];
+      else {
+        m_quads.spans.push_back(run.spans[j]);
+        m_quads.spans.push_back(run.spans[j + 1]);
+      }
     }
-    RenderGlyph(string[i]);
   }
-
-#endif
-}
-
-void TexFontPI::RenderString(const wxString &string, int x, int y) {
-  RenderString((const char *)string.ToUTF8(), x, y);
+  DrawQuads(m_quads, 0, 0);
 }
 
 //#endif     //#ifdef ocpnUSE_GL
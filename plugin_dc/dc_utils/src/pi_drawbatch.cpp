@@ -0,0 +1,96 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Retained mode batching of piDC primitives
+ *
+ ***************************************************************************
+ *   Copyright (C) 2024 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ **************************************************************************/
+
+#include "pi_drawbatch.h"
+
+float *piDrawBatch::Append(const piDrawState &state, int count) {
+  if (!m_vertices.empty() && state != m_state) Flush();
+  m_state = state;
+
+  size_t used = m_vertices.size();
+  m_vertices.resize(used + 2 * count);
+  return &m_vertices[used];
+}
+
+void piDrawBatch::AddLine(const piDrawState &state, float x1, float y1,
+                          float x2, float y2) {
+  float *v = Append(state, 2);
+  v[0] = x1;
+  v[1] = y1;
+  v[2] = x2;
+  v[3] = y2;
+}
+
+void piDrawBatch::AddLineStrip(const piDrawState &state, const float *points,
+                               int n, bool closed) {
+  if (n < 2) return;
+
+  int segments = closed ? n : n - 1;
+  float *v = Append(state, 2 * segments);
+  for (int i = 0; i < segments; i++) {
+    int j = (i + 1) % n;
+    *v++ = points[2 * i];
+    *v++ = points[2 * i + 1];
+    *v++ = points[2 * j];
+    *v++ = points[2 * j + 1];
+  }
+}
+
+void piDrawBatch::AddTriangleFan(const piDrawState &state, const float *points,
+                                 int n) {
+  if (n < 3) return;
+
+  float *v = Append(state, 3 * (n - 2));
+  for (int i = 1; i + 1 < n; i++) {
+    *v++ = points[0];
+    *v++ = points[1];
+    *v++ = points[2 * i];
+    *v++ = points[2 * i + 1];
+    *v++ = points[2 * i + 2];
+    *v++ = points[2 * i + 3];
+  }
+}
+
+void piDrawBatch::Flush() {
+  if (m_vertices.empty()) return;
+
+  if (m_sink)
+    m_sink->Draw(m_state, &m_vertices[0], (int)(m_vertices.size() / 2));
+  m_vertices.clear();  // keeps the capacity for the next run
+}
+
+void piDrawRecorder::Draw(const piDrawState &state, const float *vertices,
+                          int count) {
+  Call call;
+  call.state = state;
+  call.vertices.assign(vertices, vertices + 2 * count);
+  m_calls.push_back(call);
+}
+
+size_t piDrawRecorder::GetVertexCount() const {
+  size_t count = 0;
+  for (size_t i = 0; i < m_calls.size(); i++)
+    count += m_calls[i].vertices.size() / 2;
+  return count;
+}
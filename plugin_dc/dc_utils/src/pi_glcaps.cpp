@@ -0,0 +1,99 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  GL context limits used by piDC
+ *
+ ***************************************************************************
+ *   Copyright (C) 2024 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ **************************************************************************/
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef __ANDROID__
+#include <qopengl.h>
+#include "GLES2/gl2.h"
+#include "glu_gl.h"
+
+#elif defined(__WXOSX__)
+#include "OpenGL/gl.h"
+
+#else
+#include "GL/gl.h"
+#endif
+
+#include "pi_glcaps.h"
+
+// Most error flags a GL implementation keeps at once
+#define GL_ERROR_FLAGS 16
+
+piGLCaps piGLCaps::Query() {
+  piGLCaps caps;
+
+#ifdef ocpnUSE_GL
+  // Errors left behind by earlier calls would be taken for the answer to
+  // the smooth line query. Without a context glGetError() may never return
+  // GL_NO_ERROR, hence the bound.
+  for (int i = 0; i < GL_ERROR_FLAGS && glGetError() != GL_NO_ERROR; i++) {
+  }
+
+  GLint aliased[2] = {1, 1};
+  glGetIntegerv(GL_ALIASED_LINE_WIDTH_RANGE, &aliased[0]);
+  caps.maxAliasedLineWidth = std::max(aliased[1], 1);
+
+  // OpenGL ES has no smooth lines, and rejects the query
+  GLint smooth[2] = {1, 1};
+  glGetIntegerv(GL_SMOOTH_LINE_WIDTH_RANGE, &smooth[0]);
+  if (glGetError() != GL_NO_ERROR) {
+    smooth[0] = aliased[0];
+    smooth[1] = aliased[1];
+  }
+  caps.minLineWidth = std::max(smooth[0], 1);
+  caps.maxSmoothLineWidth = std::max(smooth[1], 1);
+
+  GLint size = 0;
+  glGetIntegerv(GL_MAX_TEXTURE_SIZE, &size);
+  if (size > 0) caps.maxTextureSize = size;
+
+  const char *version = (const char *)glGetString(GL_VERSION);
+  caps.gles = version && strstr(version, "OpenGL ES");
+#endif
+  return caps;
+}
+
+piGLCapsCache &piGLCapsCache::Get() {
+  static piGLCapsCache cache;
+  return cache;
+}
+
+const piGLCaps &piGLCapsCache::Acquire(wxGLContext *context) {
+  std::map<wxGLContext *, Entry>::iterator it = m_entries.find(context);
+  if (it == m_entries.end()) {
+    Entry entry;
+    entry.caps = piGLCaps::Query();
+    entry.users = 0;
+    it = m_entries.insert(std::make_pair(context, entry)).first;
+  }
+  it->second.users++;
+  return it->second.caps;
+}
+
+void piGLCapsCache::Release(wxGLContext *context) {
+  std::map<wxGLContext *, Entry>::iterator it = m_entries.find(context);
+  if (it != m_entries.end() && --it->second.users == 0) m_entries.erase(it);
+}
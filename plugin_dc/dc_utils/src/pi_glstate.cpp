@@ -0,0 +1,188 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Shadow of the GLES2 state set by piDC
+ *
+ ***************************************************************************
+ *   Copyright (C) 2024 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ **************************************************************************/
+
+#ifdef USE_ANDROID_GLES2
+#include <cstring>
+#include <list>
+
+#include "GLES2/gl2.h"
+#include "pi_glstate.h"
+
+// Shadow GL state, -1 for unknown
+#define PI_MAX_CAPS 8
+
+static GLint s_program = -1;
+static struct {
+  GLenum cap;
+  int state;
+} s_caps[PI_MAX_CAPS];
+static int s_ncaps;
+
+static piGLCallCounts s_counts, s_lastCounts;
+
+static std::list<piShaderProgram> s_shaders;  // elements never move
+
+piShaderProgram& pi_getShader(GLint program) {
+  for (std::list<piShaderProgram>::iterator it = s_shaders.begin();
+       it != s_shaders.end(); ++it)
+    if (it->program == program) return *it;
+
+  piShaderProgram shader;
+  memset(&shader, 0, sizeof(shader));
+  shader.program = program;
+  shader.position = glGetAttribLocation(program, "position");
+  if (shader.position < 0)
+    shader.position = glGetAttribLocation(program, "aPos");
+  shader.uv = glGetAttribLocation(program, "aUV");
+  shader.colorv = glGetAttribLocation(program, "colorv");
+
+  shader.mvMatrix = glGetUniformLocation(program, "MVMatrix");
+  shader.transformMatrix = glGetUniformLocation(program, "TransformMatrix");
+  shader.color = glGetUniformLocation(program, "color");
+  shader.tex = glGetUniformLocation(program, "uTex");
+  shader.circleRadius = glGetUniformLocation(program, "circle_radius");
+  shader.circleCenter = glGetUniformLocation(program, "circle_center");
+  shader.circleColor = glGetUniformLocation(program, "circle_color");
+  shader.borderColor = glGetUniformLocation(program, "border_color");
+  shader.borderWidth = glGetUniformLocation(program, "border_width");
+
+  s_shaders.push_back(shader);
+  return s_shaders.back();
+}
+
+void pi_useProgram(GLint program) {
+  if (program == s_program) {
+    s_counts.skipped++;
+    return;
+  }
+  glUseProgram(program);
+  s_program = program;
+  s_counts.programs++;
+}
+
+void pi_setEnabled(GLenum cap, bool enable) {
+  int i;
+  for (i = 0; i < s_ncaps; i++)
+    if (s_caps[i].cap == cap) break;
+
+  if (i < s_ncaps && s_caps[i].state == (int)enable) {
+    s_counts.skipped++;
+    return;
+  }
+
+  if (enable)
+    glEnable(cap);
+  else
+    glDisable(cap);
+  s_counts.enables++;
+
+  if (i == s_ncaps) {
+    if (s_ncaps == PI_MAX_CAPS) return;  // not tracked
+    s_caps[s_ncaps++].cap = cap;
+  }
+  s_caps[i].state = enable;
+}
+
+void pi_setColor(GLint program, const GLfloat* color) {
+  piShaderProgram& shader = pi_getShader(program);
+  if (shader.color < 0) return;
+  if (shader.colorValid &&
+      !memcmp(shader.lastColor, color, sizeof(shader.lastColor))) {
+    s_counts.skipped++;
+    return;
+  }
+  glUniform4fv(shader.color, 1, color);
+  memcpy(shader.lastColor, color, sizeof(shader.lastColor));
+  shader.colorValid = true;
+  s_counts.uniforms++;
+}
+
+void pi_setTransform(GLint program, const GLfloat* matrix) {
+  piShaderProgram& shader = pi_getShader(program);
+  if (shader.transformMatrix < 0) return;
+  if (shader.transformValid &&
+      !memcmp(shader.lastTransform, matrix, sizeof(shader.lastTransform))) {
+    s_counts.skipped++;
+    return;
+  }
+  glUniformMatrix4fv(shader.transformMatrix, 1, GL_FALSE, matrix);
+  memcpy(shader.lastTransform, matrix, sizeof(shader.lastTransform));
+  shader.transformValid = true;
+  s_counts.uniforms++;
+}
+
+void pi_setMVMatrix(GLint program, const GLfloat* matrix) {
+  piShaderProgram& shader = pi_getShader(program);
+  if (shader.mvMatrix < 0) return;
+  if (shader.mvMatrixValid &&
+      !memcmp(shader.lastMVMatrix, matrix, sizeof(shader.lastMVMatrix))) {
+    s_counts.skipped++;
+    return;
+  }
+  glUniformMatrix4fv(shader.mvMatrix, 1, GL_FALSE, matrix);
+  memcpy(shader.lastMVMatrix, matrix, sizeof(shader.lastMVMatrix));
+  shader.mvMatrixValid = true;
+  s_counts.uniforms++;
+}
+
+void pi_drawArrays(GLenum mode, GLint first, GLsizei count) {
+  glDrawArrays(mode, first, count);
+  s_counts.draws++;
+}
+
+void pi_resetGLState() {
+  s_program = -1;
+  s_ncaps = 0;
+
+  // The uniforms of programs shared with the host may have changed as well
+  for (std::list<piShaderProgram>::iterator it = s_shaders.begin();
+       it != s_shaders.end(); ++it)
+    if (!it->owned)
+      it->colorValid = it->transformValid = it->mvMatrixValid = false;
+}
+
+void pi_setViewMatrices(GLint program, const GLfloat* mvMatrix,
+                        const GLfloat* transform) {
+  piShaderProgram& shader = pi_getShader(program);
+  if (shader.mvMatrixValid &&
+      !memcmp(shader.lastMVMatrix, mvMatrix, sizeof(shader.lastMVMatrix)) &&
+      shader.transformValid &&
+      !memcmp(shader.lastTransform, transform, sizeof(shader.lastTransform))) {
+    s_counts.skipped++;
+    return;
+  }
+
+  pi_useProgram(program);
+  pi_setMVMatrix(program, mvMatrix);
+  pi_setTransform(program, transform);
+}
+
+void pi_beginGLFrame() {
+  s_lastCounts = s_counts;
+  memset(&s_counts, 0, sizeof(s_counts));
+  pi_resetGLState();
+}
+
+const piGLCallCounts& pi_getGLCallCounts() { return s_lastCounts; }
+#endif
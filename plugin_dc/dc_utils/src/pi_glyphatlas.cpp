@@ -0,0 +1,336 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Shared glyph atlas for TexFontPI
+ *
+ ***************************************************************************
+ *   Copyright (C) 2024 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ **************************************************************************/
+
+#include <algorithm>
+
+#include <wx/wx.h>
+
+#include "pi_glyphatlas.h"
+
+#ifdef USE_ANDROID_GLES2
+#include "GLES2/gl2.h"
+#elif defined(__WXOSX__)
+#include <OpenGL/gl.h>
+#include <OpenGL/glext.h>
+#else
+#include <GL/gl.h>
+#endif
+
+// Pages are square alpha textures of this size. Beyond ATLAS_MAX_PAGES a
+// page is evicted, unless all are used by the current draw: then more are
+// added, up to ATLAS_PAGE_LIMIT.
+#define ATLAS_PAGE_SIZE 512
+#define ATLAS_MAX_PAGES 8
+#define ATLAS_PAGE_LIMIT 32
+
+// Fonts no TexFontPI uses any more are deleted beyond this count
+#define ATLAS_MAX_FONTS 64
+
+// Widest strip of glyphs rasterized in one wxMemoryDC pass
+#define ATLAS_STRIP_WIDTH 1024
+
+void piShelfPacker::Reset(int width, int height) {
+  m_width = width;
+  m_height = height;
+  m_bottom = 0;
+  m_shelves.clear();
+}
+
+bool piShelfPacker::Insert(int w, int h, int *x, int *y) {
+  if (w > m_width || h > m_height) return false;
+
+  for (size_t i = 0; i < m_shelves.size(); i++) {
+    Shelf &shelf = m_shelves[i];
+    if (h <= shelf.height && 4 * (shelf.height - h) <= shelf.height &&
+        shelf.used + w <= m_width) {
+      *x = shelf.used;
+      *y = shelf.y;
+      shelf.used += w;
+      return true;
+    }
+  }
+
+  if (m_bottom + h > m_height) return false;
+  Shelf shelf = {m_bottom, h, w};
+  m_shelves.push_back(shelf);
+  m_bottom += h;
+  *x = 0;
+  *y = shelf.y;
+  return true;
+}
+
+piGlyphAtlas &piGlyphAtlas::Get() {
+  static piGlyphAtlas atlas;
+  return atlas;
+}
+
+piGlyphAtlas::piGlyphAtlas() : m_generation(0), m_tick(0) {}
+
+// The textures are left to the GL context, which is gone by now
+piGlyphAtlas::~piGlyphAtlas() {
+  for (std::map<std::string, piGlyphFont *>::iterator it = m_fonts.begin();
+       it != m_fonts.end(); ++it)
+    delete it->second;
+}
+
+int piGlyphAtlas::GetPageSize() const { return ATLAS_PAGE_SIZE; }
+
+piGlyphFont *piGlyphAtlas::Acquire(const wxFont &font, bool blur) {
+  std::string key = (const char *)font.GetNativeFontInfoDesc().ToUTF8();
+  if (blur) key += "|blur";
+
+  std::map<std::string, piGlyphFont *>::iterator it = m_fonts.find(key);
+  if (it != m_fonts.end()) {
+    it->second->m_refs++;
+    return it->second;
+  }
+
+  // Their glyphs stay in the pages until evicted
+  if (m_fonts.size() >= ATLAS_MAX_FONTS) {
+    for (it = m_fonts.begin(); it != m_fonts.end();) {
+      if (it->second->m_refs == 0) {
+        delete it->second;
+        m_fonts.erase(it++);
+      } else
+        ++it;
+    }
+  }
+
+  piGlyphFont *glyphFont = new piGlyphFont;
+  glyphFont->m_font = font;
+  glyphFont->m_blur = blur;
+  glyphFont->m_refs = 1;
+  m_fonts[key] = glyphFont;
+  return glyphFont;
+}
+
+void piGlyphAtlas::Release(piGlyphFont *font) {
+  if (font && font->m_refs > 0) font->m_refs--;
+}
+
+void piGlyphAtlas::Prepare(piGlyphFont *font,
+                           const std::vector<unsigned int> &codes) {
+  std::vector<unsigned int> missing;
+  for (size_t i = 0; i < codes.size(); i++) {
+    unsigned int c = codes[i];
+    if (c < ' ') continue;
+
+    // The glyphs already there must stay while the missing ones are added
+    const piGlyph *glyph = font->GetGlyph(c);
+    if (glyph) {
+      m_pages[glyph->page].lastUse = m_tick;
+      continue;
+    }
+    if (std::find(missing.begin(), missing.end(), c) == missing.end())
+      missing.push_back(c);
+  }
+  if (missing.empty()) return;
+
+  wxScreenDC sdc;
+  sdc.SetFont(font->m_font);
+  int pad = font->m_blur ? 2 : 1;  // room for the blur, and a border
+
+  // Rasterizes the glyphs side by side, in strips of limited width
+  size_t first = 0;
+  while (first < missing.size()) {
+    std::vector<wxString> texts;
+    std::vector<int> widths, heights;
+    int stripw = 0, striph = 0;
+    size_t last = first;
+    for (; last < missing.size(); last++) {
+      wxString text(wxUniChar(missing[last]));
+      wxCoord gw, gh;
+      sdc.GetTextExtent(text, &gw, &gh, NULL, NULL, &font->m_font);
+      if (last > first && stripw + gw + 2 * pad > ATLAS_STRIP_WIDTH) break;
+
+      texts.push_back(text);
+      widths.push_back(gw);
+      heights.push_back(gh);
+      stripw += gw + 2 * pad;
+      striph = wxMax(striph, gh + 2 * pad);
+    }
+
+    wxBitmap bmp(wxMax(stripw, 1), wxMax(striph, 1));
+    wxMemoryDC dc;
+    dc.SelectObject(bmp);
+    dc.SetFont(font->m_font);
+
+    /* fill bitmap with black */
+    dc.SetBackground(wxBrush(wxColour(0, 0, 0)));
+    dc.Clear();
+
+    /* draw the text white */
+    dc.SetTextForeground(wxColour(255, 255, 255));
+    int x = 0;
+    for (size_t i = 0; i < texts.size(); i++) {
+      dc.DrawText(texts[i], x + pad, pad);
+      x += widths[i] + 2 * pad;
+    }
+    dc.SelectObject(wxNullBitmap);
+
+    wxImage image = bmp.ConvertToImage();
+    if (font->m_blur) image = image.Blur(1);
+    unsigned char *imgdata = image.GetData();
+
+    x = 0;
+    for (size_t i = 0; i < texts.size(); i++) {
+      piGlyph glyph;
+      glyph.width = widths[i] + 2 * pad;
+      glyph.height = heights[i] + 2 * pad;
+      glyph.pad = pad;
+      glyph.advance = widths[i];
+      glyph.textHeight = heights[i];
+
+      // A glyph larger than a page is left out
+      if (imgdata && Allocate(glyph.width, glyph.height, &glyph.page,
+                              &glyph.x, &glyph.y)) {
+        Page &page = m_pages[glyph.page];
+        for (int row = 0; row < glyph.height; row++) {
+          unsigned char *src = imgdata + 3 * (row * image.GetWidth() + x);
+          unsigned char *dst =
+              &page.pixels[(glyph.y + row) * ATLAS_PAGE_SIZE + glyph.x];
+          for (int col = 0; col < glyph.width; col++) dst[col] = src[3 * col];
+        }
+
+        page.dirtyX0 = wxMin(page.dirtyX0, glyph.x);
+        page.dirtyY0 = wxMin(page.dirtyY0, glyph.y);
+        page.dirtyX1 = wxMax(page.dirtyX1, glyph.x + glyph.width);
+        page.dirtyY1 = wxMax(page.dirtyY1, glyph.y + glyph.height);
+        font->m_glyphs[missing[first + i]] = glyph;
+      }
+      x += glyph.width;
+    }
+    first = last;
+  }
+}
+
+bool piGlyphAtlas::Allocate(int w, int h, int *page, int *x, int *y) {
+  if (w > ATLAS_PAGE_SIZE || h > ATLAS_PAGE_SIZE) return false;
+
+  for (size_t i = 0; i < m_pages.size(); i++) {
+    if (m_pages[i].packer.Insert(w, h, x, y)) {
+      *page = i;
+      m_pages[i].lastUse = m_tick;
+      return true;
+    }
+  }
+
+  // Least recently drawn page, if one is not used by the current draw
+  int lru = -1;
+  if (m_pages.size() >= ATLAS_MAX_PAGES) {
+    for (size_t i = 0; i < m_pages.size(); i++)
+      if (m_pages[i].lastUse < m_tick &&
+          (lru < 0 || m_pages[i].lastUse < m_pages[lru].lastUse))
+        lru = i;
+  }
+
+  if (lru >= 0) {
+    Evict(lru);
+    *page = lru;
+  } else if (m_pages.size() < ATLAS_PAGE_LIMIT) {
+    m_pages.push_back(Page());
+    Page &p = m_pages.back();
+    p.packer.Reset(ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE);
+    p.pixels.assign(ATLAS_PAGE_SIZE * ATLAS_PAGE_SIZE, 0);
+    p.texture = 0;
+    p.dirtyX0 = p.dirtyY0 = ATLAS_PAGE_SIZE;
+    p.dirtyX1 = p.dirtyY1 = 0;
+    p.lastUse = m_tick;
+    *page = m_pages.size() - 1;
+  } else {
+    return false;  // the draw needs more glyphs than the atlas can hold
+  }
+  return m_pages[*page].packer.Insert(w, h, x, y);
+}
+
+void piGlyphAtlas::Use(int page) { m_pages[page].lastUse = m_tick; }
+
+void piGlyphAtlas::Evict(int page) {
+  for (std::map<std::string, piGlyphFont *>::iterator it = m_fonts.begin();
+       it != m_fonts.end(); ++it) {
+    std::unordered_map<unsigned int, piGlyph> &glyphs = it->second->m_glyphs;
+    for (std::unordered_map<unsigned int, piGlyph>::iterator g =
+             glyphs.begin();
+         g != glyphs.end();) {
+      if (g->second.page == page)
+        g = glyphs.erase(g);
+      else
+        ++g;
+    }
+  }
+
+  // The new glyphs overwrite their whole cells, no need to clear the pixels
+  m_pages[page].packer.Reset(ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE);
+  m_pages[page].lastUse = m_tick;
+  m_generation++;
+}
+
+const unsigned char *piGlyphAtlas::GetPixels(int page) {
+  Page &p = m_pages[page];
+  p.lastUse = m_tick;
+  return &p.pixels[0];
+}
+
+void piGlyphAtlas::Bind(int page) {
+  Page &p = m_pages[page];
+  p.lastUse = m_tick;
+
+  if (!p.texture) {
+    glGenTextures(1, &p.texture);
+    glBindTexture(GL_TEXTURE_2D, p.texture);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE,
+                 0, GL_ALPHA, GL_UNSIGNED_BYTE, &p.pixels[0]);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  } else {
+    glBindTexture(GL_TEXTURE_2D, p.texture);
+
+    if (p.dirtyX0 < p.dirtyX1) {
+      glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+#ifndef USE_ANDROID_GLES2
+      glPixelStorei(GL_UNPACK_ROW_LENGTH, ATLAS_PAGE_SIZE);
+      glTexSubImage2D(GL_TEXTURE_2D, 0, p.dirtyX0, p.dirtyY0,
+                      p.dirtyX1 - p.dirtyX0, p.dirtyY1 - p.dirtyY0, GL_ALPHA,
+                      GL_UNSIGNED_BYTE,
+                      &p.pixels[p.dirtyY0 * ATLAS_PAGE_SIZE + p.dirtyX0]);
+      glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+#else
+      // No GL_UNPACK_ROW_LENGTH, the dirty rows go in full
+      glTexSubImage2D(GL_TEXTURE_2D, 0, 0, p.dirtyY0, ATLAS_PAGE_SIZE,
+                      p.dirtyY1 - p.dirtyY0, GL_ALPHA, GL_UNSIGNED_BYTE,
+                      &p.pixels[p.dirtyY0 * ATLAS_PAGE_SIZE]);
+#endif
+      glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+  }
+
+  p.dirtyX0 = p.dirtyY0 = ATLAS_PAGE_SIZE;
+  p.dirtyX1 = p.dirtyY1 = 0;
+}
@@ -0,0 +1,225 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Software rasterizer for a headless piDC
+ *
+ ***************************************************************************
+ *   Copyright (C) 2024 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ **************************************************************************/
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "pi_raster.h"
+
+namespace {
+
+// v limited to lo..hi, lo if v is not a number
+float Clamp(float v, float lo, float hi) {
+  return v > lo ? std::min(v, hi) : lo;
+}
+
+}  // namespace
+
+piRasterSink::piRasterSink(int width, int height) { Resize(width, height); }
+
+void piRasterSink::Resize(int width, int height) {
+  m_width = std::max(width, 0);
+  m_height = std::max(height, 0);
+  m_pixels.assign(4 * (size_t)m_width * m_height, 0);
+}
+
+void piRasterSink::Clear(unsigned char r, unsigned char g, unsigned char b,
+                         unsigned char a) {
+  for (size_t i = 0; i < m_pixels.size(); i += 4) {
+    m_pixels[i] = r;
+    m_pixels[i + 1] = g;
+    m_pixels[i + 2] = b;
+    m_pixels[i + 3] = a;
+  }
+}
+
+void piRasterSink::Draw(const piDrawState &state, const float *vertices,
+                        int count) {
+  if (state.mode == piDrawState::TRIANGLES) {
+    for (int i = 0; i + 2 < count; i += 3) {
+      const float *v = vertices + 2 * i;
+      FillTriangle(v, v + 2, v + 4, state.color, state.blend);
+    }
+    return;
+  }
+
+  // Lines are quads of their width around the segment, moved by half a
+  // pixel so that a line at integer coordinates covers the pixels named,
+  // and not half of the ones on either side
+  float hw = std::max(state.width, 1.0f) / 2;
+  for (int i = 0; i + 1 < count; i += 2) {
+    const float *v = vertices + 2 * i;
+    float x0 = v[0] + 0.5f, y0 = v[1] + 0.5f;
+    float x1 = v[2] + 0.5f, y1 = v[3] + 0.5f;
+    float len = sqrtf((x1 - x0) * (x1 - x0) + (y1 - y0) * (y1 - y0));
+    if (len <= 0) continue;
+
+    float nx = (y0 - y1) / len * hw, ny = (x1 - x0) / len * hw;
+    FillQuad(x0 + nx, y0 + ny, x1 + nx, y1 + ny, x1 - nx, y1 - ny, x0 - nx,
+             y0 - ny, state.color, state.blend);
+  }
+}
+
+void piRasterSink::FillTriangleStrip(const float *vertices, int count,
+                                     const unsigned char color[4],
+                                     bool blend) {
+  for (int i = 0; i + 2 < count; i++) {
+    const float *v = vertices + 2 * i;
+    FillTriangle(v, v + 2, v + 4, color, blend);
+  }
+}
+
+void piRasterSink::DrawAlphaTriangles(const float *vertices, int count,
+                                      float dx, float dy,
+                                      const unsigned char *texture, int width,
+                                      int height,
+                                      const unsigned char color[4]) {
+  Texture tex = {texture, width, height};
+  for (int i = 0; i + 2 < count; i += 3) {
+    float v[12];
+    memcpy(v, vertices + 4 * i, sizeof v);
+    for (int j = 0; j < 12; j += 4) v[j] += dx, v[j + 1] += dy;
+    FillTriangle(v, v + 4, v + 8, color, true, &tex);
+  }
+}
+
+void piRasterSink::DrawImage(int x, int y, int w, int h,
+                             const unsigned char *pixels, bool alpha) {
+  int x0 = std::max(x, 0), x1 = std::min(x + w, m_width);
+  int y0 = std::max(y, 0), y1 = std::min(y + h, m_height);
+  int channels = alpha ? 4 : 3;
+
+  for (int row = y0; row < y1; row++) {
+    const unsigned char *s =
+        pixels + ((size_t)(row - y) * w + (x0 - x)) * channels;
+    unsigned char *p = &m_pixels[4 * ((size_t)row * m_width + x0)];
+    for (int col = x0; col < x1; col++, s += channels, p += 4) {
+      if (alpha)
+        Put(p, s, s[3], true);
+      else {
+        p[0] = s[0];
+        p[1] = s[1];
+        p[2] = s[2];
+        p[3] = 255;
+      }
+    }
+  }
+}
+
+// Fills the rows whose pixel centers are inside the triangle, between the
+// long edge from the top to the bottom vertex and the two short ones. The
+// vertices are x,y, followed by u,v with a texture.
+void piRasterSink::FillTriangle(const float *a, const float *b, const float *c,
+                                const unsigned char color[4], bool blend,
+                                const Texture *texture) {
+  if (b[1] < a[1]) std::swap(a, b);
+  if (c[1] < b[1]) std::swap(b, c);
+  if (b[1] < a[1]) std::swap(a, b);
+
+  // Nothing to draw beyond the image
+  float left = std::min(std::min(a[0], b[0]), c[0]);
+  float right = std::max(std::max(a[0], b[0]), c[0]);
+  if (!(right > -0.5f && left < m_width + 0.5f && c[1] > -0.5f &&
+        a[1] < m_height + 0.5f))
+    return;
+
+  // Degenerate, infinite or not a number
+  float area = (b[0] - a[0]) * (c[1] - a[1]) - (c[0] - a[0]) * (b[1] - a[1]);
+  if (!(fabsf(area) > 0 && fabsf(area) < HUGE_VALF)) return;
+
+  // Texture coordinates are affine, their steps along x and y
+  float dudx = 0, dudy = 0, dvdx = 0, dvdy = 0;
+  if (texture) {
+    dudx = ((b[2] - a[2]) * (c[1] - a[1]) - (c[2] - a[2]) * (b[1] - a[1])) /
+           area;
+    dudy = ((c[2] - a[2]) * (b[0] - a[0]) - (b[2] - a[2]) * (c[0] - a[0])) /
+           area;
+    dvdx = ((b[3] - a[3]) * (c[1] - a[1]) - (c[3] - a[3]) * (b[1] - a[1])) /
+           area;
+    dvdy = ((c[3] - a[3]) * (b[0] - a[0]) - (b[3] - a[3]) * (c[0] - a[0])) /
+           area;
+  }
+
+  // Rows and columns whose centers are in [top, bottom) and [left, right)
+  int y0 = (int)ceilf(Clamp(a[1] - 0.5f, 0, m_height));
+  int y1 = (int)ceilf(Clamp(c[1] - 0.5f, 0, m_height));
+  for (int y = y0; y < y1; y++) {
+    float yc = y + 0.5f;
+    float xl = a[0] + (yc - a[1]) * (c[0] - a[0]) / (c[1] - a[1]);
+    float xr = yc < b[1] ? a[0] + (yc - a[1]) * (b[0] - a[0]) / (b[1] - a[1])
+                         : b[0] + (yc - b[1]) * (c[0] - b[0]) / (c[1] - b[1]);
+    if (xr < xl) std::swap(xl, xr);
+
+    int x0 = (int)ceilf(Clamp(xl - 0.5f, 0, m_width));
+    int x1 = (int)ceilf(Clamp(xr - 0.5f, 0, m_width));
+    if (x0 >= x1) continue;
+
+    unsigned char *p = &m_pixels[4 * ((size_t)y * m_width + x0)];
+    if (!texture) {
+      for (int x = x0; x < x1; x++, p += 4) Put(p, color, color[3], blend);
+      continue;
+    }
+
+    float u = a[2] + dudx * (x0 + 0.5f - a[0]) + dudy * (yc - a[1]);
+    float v = a[3] + dvdx * (x0 + 0.5f - a[0]) + dvdy * (yc - a[1]);
+    for (int x = x0; x < x1; x++, p += 4, u += dudx, v += dvdx) {
+      int tx = std::min(std::max((int)floorf(u * texture->width), 0),
+                        texture->width - 1);
+      int ty = std::min(std::max((int)floorf(v * texture->height), 0),
+                        texture->height - 1);
+      int alpha = texture->alpha[(size_t)ty * texture->width + tx];
+      if (alpha) Put(p, color, alpha, true);
+    }
+  }
+}
+
+void piRasterSink::FillQuad(float x0, float y0, float x1, float y1, float x2,
+                            float y2, float x3, float y3,
+                            const unsigned char color[4], bool blend) {
+  float v[8] = {x0, y0, x1, y1, x2, y2, x3, y3};
+  FillTriangle(v, v + 2, v + 4, color, blend);
+  FillTriangle(v, v + 4, v + 6, color, blend);
+}
+
+// Writes color to the pixel at p, or blends it over with alpha as GL would
+// with GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, keeping the image alpha that
+// of the composite
+void piRasterSink::Put(unsigned char *p, const unsigned char color[4],
+                       int alpha, bool blend) {
+  if (!blend || alpha >= 255) {
+    p[0] = color[0];
+    p[1] = color[1];
+    p[2] = color[2];
+    p[3] = blend ? 255 : color[3];
+    return;
+  }
+
+  int inv = 255 - alpha;
+  p[0] = (color[0] * alpha + p[0] * inv + 127) / 255;
+  p[1] = (color[1] * alpha + p[1] * inv + 127) / 255;
+  p[2] = (color[2] * alpha + p[2] * inv + 127) / 255;
+  p[3] = alpha + (p[3] * inv + 127) / 255;
+}
@@ -628,11 +628,23 @@ bool pi_loadShaders() {
     }
 #endif
 
+  // Resolve the attribute and uniform locations once, now they are linked
+  if (ret_val) {
+    pi_getShader(pi_color_tri_shader_program).owned = true;
+    pi_getShader(pi_colorv_tri_shader_program).owned = true;
+    pi_getShader(pi_texture_2D_shader_program).owned = true;
+    pi_getShader(pi_texture_2DA_shader_program).owned = true;
+    pi_getShader(pi_texture_text_shader_program).owned = true;
+    pi_getShader(pi_circle_filled_shader_program).owned = true;
+  }
+
   // qDebug() << "pi_loadShaders: " << ret_val;
   return ret_val;
 }
 
 void configureShaders(float width, float height) {
+  pi_beginGLFrame();
+
   //  Set the shader viewport transform matrix
   float vp_transform[16];
   mat4x4 m;
@@ -645,54 +657,18 @@ void configureShaders(float width, float height) {
   mat4x4 I;
   mat4x4_identity(I);
 
-  glUseProgram(pi_color_tri_shader_program);
-  GLint matloc = glGetUniformLocation(pi_color_tri_shader_program, "MVMatrix");
-  glUniformMatrix4fv(matloc, 1, GL_FALSE, (const GLfloat*)vp_transform);
-  GLint transloc =
-      glGetUniformLocation(pi_color_tri_shader_program, "TransformMatrix");
-  glUniformMatrix4fv(transloc, 1, GL_FALSE, (const GLfloat*)I);
-
-  // qDebug() << pi_color_tri_shader_program << transloc;
-
-  glUseProgram(pi_circle_filled_shader_program);
-  matloc = glGetUniformLocation(pi_circle_filled_shader_program, "MVMatrix");
-  glUniformMatrix4fv(matloc, 1, GL_FALSE, (const GLfloat*)vp_transform);
-  transloc =
-      glGetUniformLocation(pi_circle_filled_shader_program, "TransformMatrix");
-  glUniformMatrix4fv(transloc, 1, GL_FALSE, (const GLfloat*)I);
-
-  // qDebug() << pi_circle_filled_shader_program << transloc;
-
-  glUseProgram(pi_texture_2D_shader_program);
-  matloc = glGetUniformLocation(pi_texture_2D_shader_program, "MVMatrix");
-  glUniformMatrix4fv(matloc, 1, GL_FALSE, (const GLfloat*)vp_transform);
-  transloc =
-      glGetUniformLocation(pi_texture_2D_shader_program, "TransformMatrix");
-  glUniformMatrix4fv(transloc, 1, GL_FALSE, (const GLfloat*)I);
-
-  glUseProgram(pi_texture_2DA_shader_program);
-  matloc = glGetUniformLocation(pi_texture_2DA_shader_program, "MVMatrix");
-  glUniformMatrix4fv(matloc, 1, GL_FALSE, (const GLfloat*)vp_transform);
-  transloc =
-      glGetUniformLocation(pi_texture_2DA_shader_program, "TransformMatrix");
-  glUniformMatrix4fv(transloc, 1, GL_FALSE, (const GLfloat*)I);
-
-  glUseProgram(pi_texture_text_shader_program);
-  matloc = glGetUniformLocation(pi_texture_text_shader_program, "MVMatrix");
-  glUniformMatrix4fv(matloc, 1, GL_FALSE, (const GLfloat*)vp_transform);
-  transloc =
-      glGetUniformLocation(pi_texture_text_shader_program, "TransformMatrix");
-  glUniformMatrix4fv(transloc, 1, GL_FALSE, (const GLfloat*)I);
-
-  // qDebug() << pi_texture_2D_shader_program << transloc;
-
-  glUseProgram(pi_colorv_tri_shader_program);
-  matloc = glGetUniformLocation(pi_colorv_tri_shader_program, "MVMatrix");
-  glUniformMatrix4fv(matloc, 1, GL_FALSE, (const GLfloat*)vp_transform);
-  transloc =
-      glGetUniformLocation(pi_colorv_tri_shader_program, "TransformMatrix");
-  glUniformMatrix4fv(transloc, 1, GL_FALSE, (const GLfloat*)I);
+  GLint programs[] = {pi_color_tri_shader_program,
+                      pi_circle_filled_shader_program,
+                      pi_texture_2D_shader_program,
+                      pi_texture_2DA_shader_program,
+                      pi_texture_text_shader_program,
+                      pi_colorv_tri_shader_program};
+
+  // The matrices only need sending when the viewport size changed
+  for (size_t i = 0; i < sizeof(programs) / sizeof(programs[0]); i++)
+    pi_setViewMatrices(programs[i], vp_transform, (const GLfloat*)I);
 }
+
 #else
 bool pi_loadShaders() { return true; }
 void configureShaders(float width, float height) {}
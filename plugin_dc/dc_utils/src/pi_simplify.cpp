@@ -0,0 +1,190 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Viewport culling and decimation of piDC polylines
+ *
+ ***************************************************************************
+ *   Copyright (C) 2024 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ **************************************************************************/
+
+
+#include <cmath>
+
+#include "pi_simplify.h"
+
+namespace {
+
+enum { LEFT = 1, RIGHT = 2, TOP = 4, BOTTOM = 8 };
+
+bool Inside(const wxPoint &p, int side, int bound) {
+  switch (side) {
+    case LEFT:
+      return p.x >= bound;
+    case RIGHT:
+      return p.x <= bound;
+    case TOP:
+      return p.y >= bound;
+    default:
+      return p.y <= bound;
+  }
+}
+
+// Where the edge a,b crosses the vertical or horizontal line of side
+wxPoint Intersect(const wxPoint &a, const wxPoint &b, int side, int bound) {
+  if (side == LEFT || side == RIGHT) {
+    double t = (double)(bound - a.x) / (b.x - a.x);
+    return wxPoint(bound, (int)floor(a.y + t * (b.y - a.y) + 0.5));
+  }
+  double t = (double)(bound - a.y) / (b.y - a.y);
+  return wxPoint((int)floor(a.x + t * (b.x - a.x) + 0.5), bound);
+}
+
+}  // namespace
+
+piSimplifier::piSimplifier() : m_tolerance(0), m_provisional(false) {
+  ResetStats();
+}
+
+void piSimplifier::ResetStats() {
+  m_stats.calls = 0;
+  m_stats.pointsIn = 0;
+  m_stats.pointsOut = 0;
+}
+
+// Cohen-Sutherland: the sides of the clip rectangle p lies beyond
+int piSimplifier::OutCode(const wxPoint &p) const {
+  int code = 0;
+  if (p.x < m_clip.x)
+    code |= LEFT;
+  else if (p.x > m_clip.x + m_clip.width)
+    code |= RIGHT;
+  if (p.y < m_clip.y)
+    code |= TOP;
+  else if (p.y > m_clip.y + m_clip.height)
+    code |= BOTTOM;
+  return code;
+}
+
+void piSimplifier::BeginPiece(const wxPoint &p) {
+  m_pieces.push_back(1);
+  m_points.push_back(p);
+  m_anchor = p;
+  m_provisional = false;
+}
+
+// Appends p to the current piece. A point too close to the anchor is kept
+// only until the next one replaces it, so that the piece ends where the
+// input does.
+void piSimplifier::AddPoint(const wxPoint &p) {
+  float dx = p.x - m_anchor.x, dy = p.y - m_anchor.y;
+  bool close = dx * dx + dy * dy < m_tolerance * m_tolerance;
+
+  if (m_provisional)
+    m_points.back() = p;
+  else {
+    m_points.push_back(p);
+    m_pieces.back()++;
+  }
+  m_provisional = close;
+  if (!close) m_anchor = p;
+}
+
+int piSimplifier::SimplifyLines(int n, const wxPoint points[]) {
+  m_points.clear();
+  m_pieces.clear();
+  m_stats.calls++;
+  m_stats.pointsIn += n;
+
+  // A segment with both ends beyond the same side cannot be seen
+  bool clip = !m_clip.IsEmpty();
+  bool open = false;
+  for (int i = 1; i < n; i++) {
+    if (clip && (OutCode(points[i - 1]) & OutCode(points[i]))) {
+      open = false;
+      continue;
+    }
+    if (!open) BeginPiece(points[i - 1]);
+    AddPoint(points[i]);
+    open = true;
+  }
+
+  m_stats.pointsOut += m_points.size();
+  return (int)m_pieces.size();
+}
+
+int piSimplifier::SimplifyPolygon(int n, const wxPoint points[]) {
+  m_points.clear();
+  m_pieces.clear();
+  m_stats.calls++;
+  m_stats.pointsIn += n;
+  if (n < 3) return 0;
+
+  if (!m_clip.IsEmpty()) {
+    int all = ~0, any = 0;
+    for (int i = 0; i < n; i++) {
+      int code = OutCode(points[i]);
+      all &= code;
+      any |= code;
+    }
+    if (all) return 0;  // all beyond the same side
+    if (any) {
+      Clip(points, n);
+      points = m_clipped[0].empty() ? NULL : &m_clipped[0][0];
+      n = (int)m_clipped[0].size();
+    }
+  }
+
+  if (n >= 3) {
+    BeginPiece(points[0]);
+    for (int i = 1; i < n; i++) AddPoint(points[i]);
+
+    // The outline closes on the first point, the last one need not be kept
+    if (m_provisional && m_points.size() > 3) m_points.pop_back();
+    wxPoint &last = m_points.back();
+    float dx = last.x - points[0].x, dy = last.y - points[0].y;
+    if (m_points.size() > 3 && dx * dx + dy * dy < m_tolerance * m_tolerance)
+      m_points.pop_back();
+    if (m_points.size() < 3) m_points.clear();
+  }
+
+  m_pieces.clear();
+  m_stats.pointsOut += m_points.size();
+  return (int)m_points.size();
+}
+
+// Sutherland-Hodgman, one side of the rectangle after the other. The result
+// is left in m_clipped[0].
+void piSimplifier::Clip(const wxPoint points[], int n) {
+  const int sides[4] = {LEFT, RIGHT, TOP, BOTTOM};
+  const int bounds[4] = {m_clip.x, m_clip.x + m_clip.width, m_clip.y,
+                         m_clip.y + m_clip.height};
+
+  m_clipped[0].assign(points, points + n);
+  for (int s = 0; s < 4; s++) {
+    std::vector<wxPoint> &in = m_clipped[0], &out = m_clipped[1];
+    out.clear();
+    for (size_t i = 0; i < in.size(); i++) {
+      const wxPoint &a = in[i ? i - 1 : in.size() - 1], &b = in[i];
+      bool ina = Inside(a, sides[s], bounds[s]);
+      bool inb = Inside(b, sides[s], bounds[s]);
+      if (ina != inb) out.push_back(Intersect(a, b, sides[s], bounds[s]));
+      if (inb) out.push_back(b);
+    }
+    in.swap(out);
+  }
+}
@@ -0,0 +1,309 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Polyline stroker for piDC thick and dashed lines
+ *
+ ***************************************************************************
+ *   Copyright (C) 2024 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ **************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+
+#include "pi_stroker.h"
+
+#ifndef M_PI
+#define M_PI 3.1415926535897931160E0
+#endif
+
+// Points closer than this are merged, they have no usable direction
+#define STROKE_EPSILON 1e-3f
+
+// Largest distance between a round join or cap and its true arc, in pixels
+#define STROKE_ROUND_TOLERANCE 0.25f
+
+namespace {
+
+void AddPoint(std::vector<float> &points, float x, float y) {
+  size_t n = points.size();
+  if (n && fabsf(points[n - 2] - x) < STROKE_EPSILON &&
+      fabsf(points[n - 1] - y) < STROKE_EPSILON)
+    return;
+  points.push_back(x);
+  points.push_back(y);
+}
+
+}  // namespace
+
+piStroker::piStroker()
+    : m_miterLimit(4.0f),
+      m_join(JOIN_MITER),
+      m_cap(CAP_BUTT),
+      m_link(false),
+      m_capture(false) {
+  SetWidth(1.0f);
+}
+
+void piStroker::SetWidth(float width) {
+  m_width = width;
+
+  float radius = width / 2;
+  if (radius > STROKE_ROUND_TOLERANCE)
+    m_roundStep = 2 * acosf(1 - STROKE_ROUND_TOLERANCE / radius);
+  else
+    m_roundStep = M_PI / 2;
+}
+
+void piStroker::SetDashes(const float *dashes, int n) {
+  m_dashes.clear();
+
+  float total = 0;
+  for (int i = 0; i < n; i++) total += std::max(dashes[i], 0.0f);
+  if (total <= 0) return;  // solid
+
+  for (int repeat = n % 2 ? 2 : 1; repeat; repeat--)
+    for (int i = 0; i < n; i++) m_dashes.push_back(std::max(dashes[i], 0.0f));
+}
+
+int piStroker::Stroke(const float *points, int n, bool closed) {
+  m_vertices.clear();
+  m_link = false;
+  if (m_width <= 0) return 0;
+
+  m_points.clear();
+  for (int i = 0; i < n; i++)
+    AddPoint(m_points, points[2 * i], points[2 * i + 1]);
+  int count = (int)(m_points.size() / 2);
+  if (closed && count > 2) {  // drop an explicit closing point
+    float dx = m_points[0] - m_points[2 * count - 2];
+    float dy = m_points[1] - m_points[2 * count - 1];
+    if (fabsf(dx) < STROKE_EPSILON && fabsf(dy) < STROKE_EPSILON) count--;
+  }
+  if (count < 2) return 0;
+  if (count < 3) closed = false;
+
+  if (m_dashes.empty()) {
+    StrokePiece(&m_points[0], count, closed);
+    return GetVertexCount();
+  }
+
+  // Walks the polyline, the pattern runs on across the corners
+  size_t dash = 0;
+  float left = m_dashes[0];
+  m_piece.clear();
+  AddPoint(m_piece, m_points[0], m_points[1]);
+
+  int segments = closed ? count : count - 1;
+  for (int i = 0; i < segments; i++) {
+    int j = (i + 1) % count;
+    float x0 = m_points[2 * i], y0 = m_points[2 * i + 1];
+    float x1 = m_points[2 * j], y1 = m_points[2 * j + 1];
+    float length = sqrtf((x1 - x0) * (x1 - x0) + (y1 - y0) * (y1 - y0));
+
+    float t = 0;
+    while (left < length - t) {
+      t += left;
+      float x = x0 + (x1 - x0) * t / length;
+      float y = y0 + (y1 - y0) * t / length;
+      if (dash % 2 == 0) {
+        AddPoint(m_piece, x, y);
+        if (m_piece.size() >= 4)
+          StrokePiece(&m_piece[0], (int)(m_piece.size() / 2), false);
+        m_piece.clear();
+      } else
+        AddPoint(m_piece, x, y);
+
+      dash = (dash + 1) % m_dashes.size();
+      left = m_dashes[dash];
+    }
+    left -= length - t;
+    if (dash % 2 == 0) AddPoint(m_piece, x1, y1);
+  }
+  if (dash % 2 == 0 && m_piece.size() >= 4)
+    StrokePiece(&m_piece[0], (int)(m_piece.size() / 2), false);
+
+  return GetVertexCount();
+}
+
+void piStroker::StrokePiece(const float *points, int n, bool closed) {
+  // Repeats the last vertex, AddVertex() repeats the next one
+  m_link = !m_vertices.empty();
+  if (m_link) {
+    float x = m_vertices[m_vertices.size() - 2], y = m_vertices.back();
+    m_vertices.push_back(x);
+    m_vertices.push_back(y);
+  }
+
+  // Direction and length of the segment from point i to i + 1
+  float dx0, dy0, len0;
+  int last = n - 1;
+  {
+    float dx = points[2] - points[0], dy = points[3] - points[1];
+    len0 = sqrtf(dx * dx + dy * dy);
+    dx0 = dx / len0, dy0 = dy / len0;
+  }
+
+  float first[4];
+  if (closed) {
+    float dx = points[0] - points[2 * last];
+    float dy = points[1] - points[2 * last + 1];
+    float len = sqrtf(dx * dx + dy * dy);
+
+    m_pairs.clear();
+    m_capture = true;
+    AddJoin(points[0], points[1], dx / len, dy / len, len, dx0, dy0, len0);
+    m_capture = false;
+    std::copy(m_pairs.begin(), m_pairs.begin() + 4, first);
+    for (size_t i = 0; i < m_pairs.size(); i += 4)
+      AddPair(m_pairs[i], m_pairs[i + 1], m_pairs[i + 2], m_pairs[i + 3]);
+  } else
+    AddCap(points[0], points[1], dx0, dy0, true);
+
+  int end = closed ? n : last;
+  for (int i = 1; i < end; i++) {
+    int j = (i + 1) % n;
+    float dx = points[2 * j] - points[2 * i];
+    float dy = points[2 * j + 1] - points[2 * i + 1];
+    float len1 = sqrtf(dx * dx + dy * dy);
+    float dx1 = dx / len1, dy1 = dy / len1;
+
+    AddJoin(points[2 * i], points[2 * i + 1], dx0, dy0, len0, dx1, dy1, len1);
+    dx0 = dx1, dy0 = dy1, len0 = len1;
+  }
+
+  if (closed)
+    AddPair(first[0], first[1], first[2], first[3]);
+  else
+    AddCap(points[2 * last], points[2 * last + 1], dx0, dy0, false);
+}
+
+// Emits the vertices around point x,y between the segment arriving with unit
+// direction dx0,dy0 and the one leaving with dx1,dy1. Where both segments are
+// long enough, they end on the inner miter point, and the outer side is a fan
+// around that point: the two segments and the join do not overlap.
+void piStroker::AddJoin(float x, float y, float dx0, float dy0, float len0,
+                        float dx1, float dy1, float len1) {
+  float hw = m_width / 2;
+  float nx0 = -dy0 * hw, ny0 = dx0 * hw;  // left normals
+  float nx1 = -dy1 * hw, ny1 = dx1 * hw;
+
+  float dot = dx0 * dx1 + dy0 * dy1;
+  float cross = dx0 * dy1 - dy0 * dx1;
+  if (fabsf(cross) < 1e-4f && dot > 0) {  // straight on
+    AddPair(x + nx0, y + ny0, x - nx0, y - ny0);
+    return;
+  }
+
+  // Half the turn, the miter is hw / cos(half) long, and the inner point
+  // lies hw * tan(half) back along both segments
+  float cosHalf = sqrtf(std::max((1 + dot) / 2, 0.0f));
+  bool inner = 1 + dot > 1e-3f &&
+               hw * fabsf(cross) / (1 + dot) <= std::min(len0, len1);
+
+  float bx = nx0 + nx1, by = ny0 + ny1;  // bisector, towards the left
+  float blen = sqrtf(bx * bx + by * by);
+  float miter = cosHalf > 0 ? hw / cosHalf : 0;
+  if (blen > 0) bx *= miter / blen, by *= miter / blen;
+
+  // Turning left puts the outer side on the right
+  bool outerLeft = cross < 0;
+  float side = outerLeft ? 1.0f : -1.0f;
+  float px = x, py = y;
+  if (inner) px -= side * bx, py -= side * by;
+
+  if (!inner) AddPair(x + nx0, y + ny0, x - nx0, y - ny0);
+  AddOuter(outerLeft, x + side * nx0, y + side * ny0, px, py);
+
+  if (m_join == JOIN_MITER) {
+    if (blen > 0 && miter <= m_miterLimit * m_width / 2)
+      AddOuter(outerLeft, x + side * bx, y + side * by, px, py);
+  } else if (m_join == JOIN_ROUND) {
+    float angle = atan2f(fabsf(cross), dot);
+    int steps = (int)ceilf(angle / m_roundStep);
+    float step = (cross > 0 ? angle : -angle) / steps;
+    float c = cosf(step), s = sinf(step);
+    float vx = side * nx0, vy = side * ny0;
+    for (int i = 1; i < steps; i++) {
+      float t = vx * c - vy * s;
+      vy = vx * s + vy * c;
+      vx = t;
+      AddOuter(outerLeft, x + vx, y + vy, px, py);
+    }
+  }
+
+  AddOuter(outerLeft, x + side * nx1, y + side * ny1, px, py);
+  if (!inner) AddPair(x + nx1, y + ny1, x - nx1, y - ny1);
+}
+
+// Emits the end of a piece at x,y, where the line has unit direction dx,dy
+void piStroker::AddCap(float x, float y, float dx, float dy, bool start) {
+  float hw = m_width / 2;
+  float nx = -dy * hw, ny = dx * hw;
+  float ex = dx * hw, ey = dy * hw;
+  if (start) ex = -ex, ey = -ey;  // outwards
+
+  switch (m_cap) {
+    case CAP_BUTT:
+      AddPair(x + nx, y + ny, x - nx, y - ny);
+      break;
+    case CAP_SQUARE:
+      AddPair(x + ex + nx, y + ey + ny, x + ex - nx, y + ey - ny);
+      break;
+    case CAP_ROUND: {
+      // Zigzag across the half disk, from the tip to the sides or back
+      int steps = std::max((int)ceilf(M_PI / 2 / m_roundStep), 1);
+      for (int i = 0; i <= steps; i++) {
+        float a = M_PI / 2 * (start ? i : steps - i) / steps;
+        float c = cosf(a), s = sinf(a);
+        AddPair(x + ex * c + nx * s, y + ey * c + ny * s, x + ex * c - nx * s,
+                y + ey * c - ny * s);
+      }
+      break;
+    }
+  }
+}
+
+// Emits an outer point of a join, paired with the pivot px,py
+void piStroker::AddOuter(bool left, float ox, float oy, float px, float py) {
+  if (left)
+    AddPair(ox, oy, px, py);
+  else
+    AddPair(px, py, ox, oy);
+}
+
+void piStroker::AddPair(float lx, float ly, float rx, float ry) {
+  if (m_capture) {
+    m_pairs.push_back(lx);
+    m_pairs.push_back(ly);
+    m_pairs.push_back(rx);
+    m_pairs.push_back(ry);
+    return;
+  }
+  AddVertex(lx, ly);
+  AddVertex(rx, ry);
+}
+
+void piStroker::AddVertex(float x, float y) {
+  m_vertices.push_back(x);
+  m_vertices.push_back(y);
+  if (m_link) {  // second half of the degenerate bridge from the last piece
+    m_vertices.push_back(x);
+    m_vertices.push_back(y);
+    m_link = false;
+  }
+}
@@ -0,0 +1,258 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Cache of tessellated polygon fills for piDC
+ *
+ ***************************************************************************
+ *   Copyright (C) 2024 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ **************************************************************************/
+
+#include <algorithm>
+
+#ifdef __ANDROID__
+#include <qopengl.h>
+typedef double GLdouble;
+#define GL_GLEXT_LEGACY 1
+#include "GLES2/gl2.h"
+#include "glu_gl.h"
+#include "GL/glu.h"
+
+#elif defined(__WXOSX__)
+#include "OpenGL/gl.h"
+#include "OpenGL/glu.h"
+typedef void (*_GLUfuncptr)();
+
+#else
+#include "GL/gl.h"
+#include "GL/glu.h"
+#endif
+
+#ifdef _MSC_VER
+typedef void(__stdcall *_GLUfuncptr)();
+#endif
+
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+#include "pi_tesscache.h"
+
+// Default limit, in stored vertices, and maximum number of cached polygons
+#define TESS_CACHE_VERTICES 500000
+#define TESS_CACHE_ENTRIES 1024
+
+namespace {
+
+// State of one gluTess run, passed as the polygon data of the callbacks
+struct TessCapture {
+  std::vector<float> *triangles;
+  piTessArena *arena;  // combined vertices
+};
+
+void APIENTRY TessBeginCallback(GLenum type, void *data) {}
+
+// Registering an edge flag callback makes GLU emit GL_TRIANGLES only.
+void APIENTRY TessEdgeFlagCallback(GLboolean flag, void *data) {}
+
+void APIENTRY TessVertexCallback(void *vertex, void *data) {
+  TessCapture *capture = (TessCapture *)data;
+  GLdouble *v = (GLdouble *)vertex;
+  capture->triangles->push_back((float)v[0]);
+  capture->triangles->push_back((float)v[1]);
+}
+
+void APIENTRY TessCombineCallback(GLdouble coords[3], void *vertex_data[4],
+                                  GLfloat weight[4], void **dataOut,
+                                  void *data) {
+  TessCapture *capture = (TessCapture *)data;
+  GLdouble *vertex = capture->arena->Alloc(3);
+  vertex[0] = coords[0];
+  vertex[1] = coords[1];
+  vertex[2] = coords[2];
+  *dataOut = vertex;
+}
+
+void APIENTRY TessEndCallback(void *data) {}
+
+void APIENTRY TessErrorCallback(GLenum errorCode, void *data) {}
+
+// FNV-1a
+inline unsigned long long HashInt(unsigned long long hash, int value) {
+  unsigned int v = (unsigned int)value;
+  for (int i = 0; i < 4; i++) {
+    hash ^= (v >> (i * 8)) & 0xff;
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+}  // namespace
+
+void piTessArena::Reset(size_t estimate) {
+  size_t capacity = 0;
+  for (size_t i = 0; i < m_blocks.size(); i++)
+    capacity += m_blocks[i].size();
+  if (m_blocks.size() > 1 || capacity < estimate) {
+    m_blocks.clear();
+    m_blocks.push_back(std::vector<double>(std::max(capacity, estimate)));
+  }
+  m_block = 0;
+  m_used = 0;
+}
+
+double *piTessArena::Alloc(size_t n) {
+  if (m_block < m_blocks.size() && m_used + n > m_blocks[m_block].size()) {
+    m_block++;
+    m_used = 0;
+  }
+  if (m_block >= m_blocks.size()) {
+    size_t size = m_blocks.empty() ? 1024 : 2 * m_blocks.back().size();
+    m_blocks.push_back(std::vector<double>(std::max(size, n)));
+  }
+  double *p = &m_blocks[m_block][m_used];
+  m_used += n;
+  return p;
+}
+
+piTessCache &piTessCache::Get() {
+  static piTessCache cache;
+  return cache;
+}
+
+piTessCache::piTessCache() : m_size(0), m_limit(TESS_CACHE_VERTICES) {}
+
+void piTessCache::SetLimit(size_t maxVertices) {
+  m_limit = maxVertices;
+  Trim();
+}
+
+void piTessCache::Clear() {
+  m_entries.clear();
+  m_index.clear();
+  m_size = 0;
+}
+
+void piTessCache::Trim() {
+  while (!m_entries.empty() &&
+         (m_size > m_limit || m_entries.size() > TESS_CACHE_ENTRIES)) {
+    m_size -= m_entries.back().Size();
+    m_index.erase(m_entries.back().hash);
+    m_entries.pop_back();
+  }
+}
+
+const std::vector<float> &piTessCache::Tessellate(int ncontours,
+                                                  const int npoints[],
+                                                  const wxPoint points[],
+                                                  int windingRule) {
+  Entry &key = m_scratch;
+  key.windingRule = windingRule;
+  key.contours.assign(npoints, npoints + ncontours);
+  key.points.clear();
+  key.triangles.clear();
+
+  unsigned long long hash = HashInt(14695981039346656037ULL, windingRule);
+  int total = 0;
+  for (int j = 0; j < ncontours; j++) {
+    hash = HashInt(hash, npoints[j]);
+    total += npoints[j];
+  }
+  if (total == 0) return key.triangles;
+
+  const wxPoint origin = points[0];
+  key.points.reserve(total);
+  for (int i = 0; i < total; i++) {
+    wxPoint p = points[i] - origin;
+    hash = HashInt(HashInt(hash, p.x), p.y);
+    key.points.push_back(p);
+  }
+  key.hash = hash;
+
+  std::unordered_map<unsigned long long, EntryList::iterator>::iterator found =
+      m_index.find(hash);
+  if (found != m_index.end()) {
+    EntryList::iterator entry = found->second;
+    if (entry->windingRule == windingRule && entry->contours == key.contours &&
+        entry->points == key.points) {
+      m_entries.splice(m_entries.begin(), m_entries, entry);
+      return entry->triangles;
+    }
+    // Hash collision, the new polygon replaces the old one
+    m_size -= entry->Size();
+    m_entries.erase(entry);
+    m_index.erase(found);
+  }
+
+  Run(key);
+  if (key.Size() > m_limit) return key.triangles;
+
+  // Copied, so that the scratch keeps the capacity of its vectors and the
+  // next lookups don't allocate
+  m_entries.push_front(key);
+  m_index[hash] = m_entries.begin();
+  m_size += m_entries.front().Size();
+  Trim();
+  return m_entries.front().triangles;
+}
+
+void piTessCache::Run(Entry &entry) {
+  // The points, and a few intersections; about one triangle per point
+  size_t npoints = entry.points.size();
+  m_arena.Reset(3 * (npoints + npoints / 8 + 16));
+  entry.triangles.reserve(6 * (npoints + 2 * entry.contours.size()));
+
+  GLdouble *coords = m_arena.Alloc(3 * npoints);
+  for (size_t i = 0; i < npoints; i++) {
+    coords[3 * i] = entry.points[i].x;
+    coords[3 * i + 1] = entry.points[i].y;
+    coords[3 * i + 2] = 0.0;
+  }
+
+  TessCapture capture;
+  capture.triangles = &entry.triangles;
+  capture.arena = &m_arena;
+
+  GLUtesselator *tobj = gluNewTess();
+  gluTessCallback(tobj, GLU_TESS_BEGIN_DATA, (_GLUfuncptr)&TessBeginCallback);
+  gluTessCallback(tobj, GLU_TESS_EDGE_FLAG_DATA,
+                  (_GLUfuncptr)&TessEdgeFlagCallback);
+  gluTessCallback(tobj, GLU_TESS_VERTEX_DATA,
+                  (_GLUfuncptr)&TessVertexCallback);
+  gluTessCallback(tobj, GLU_TESS_COMBINE_DATA,
+                  (_GLUfuncptr)&TessCombineCallback);
+  gluTessCallback(tobj, GLU_TESS_END_DATA, (_GLUfuncptr)&TessEndCallback);
+  gluTessCallback(tobj, GLU_TESS_ERROR_DATA, (_GLUfuncptr)&TessErrorCallback);
+
+  gluTessNormal(tobj, 0, 0, 1);
+  gluTessProperty(tobj, GLU_TESS_WINDING_RULE, entry.windingRule);
+  gluTessProperty(tobj, GLU_TESS_BOUNDARY_ONLY, GL_FALSE);
+
+  gluTessBeginPolygon(tobj, &capture);
+  GLdouble *v = coords;
+  for (size_t j = 0; j < entry.contours.size(); j++) {
+    gluTessBeginContour(tobj);
+    for (int i = 0; i < entry.contours[j]; i++, v += 3)
+      gluTessVertex(tobj, v, v);
+    gluTessEndContour(tobj);
+  }
+  gluTessEndPolygon(tobj);
+  gluDeleteTess(tobj);
+
+  // An error may leave an incomplete triangle behind
+  entry.triangles.resize(entry.triangles.size() / 6 * 6);
+}
@@ -0,0 +1,115 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Cache of text extents for piDC
+ *
+ ***************************************************************************
+ *   Copyright (C) 2024 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ **************************************************************************/
+
+
+#include <wx/hashmap.h>
+
+#include "pi_textcache.h"
+
+// Default number of strings per font, and number of fonts kept
+#define EXTENT_CACHE_STRINGS 4096
+#define EXTENT_CACHE_FONTS 32
+
+piTextExtentCache &piTextExtentCache::Get() {
+  static piTextExtentCache cache;
+  return cache;
+}
+
+piTextExtentCache::piTextExtentCache()
+    : m_limit(EXTENT_CACHE_STRINGS), m_tick(0) {}
+
+std::string piTextExtentCache::FontKey(const wxFont &font, bool texture) {
+  std::string key = (const char *)font.GetNativeFontInfoDesc().ToUTF8();
+  key += texture ? "|tex" : "|dc";
+  return key;
+}
+
+const piTextExtentCache::Extent *piTextExtentCache::Find(
+    const std::string &font, const wxString &text) {
+  std::unordered_map<std::string, Font>::iterator f = m_fonts.find(font);
+  if (f == m_fonts.end()) return NULL;
+
+  std::unordered_map<unsigned long, EntryList::iterator>::iterator found =
+      f->second.index.find(wxStringHash()(text));
+  if (found == f->second.index.end() || found->second->text != text)
+    return NULL;
+
+  f->second.lastUse = ++m_tick;
+  EntryList &entries = f->second.entries;
+  entries.splice(entries.begin(), entries, found->second);
+  return &found->second->extent;
+}
+
+void piTextExtentCache::Store(const std::string &font, const wxString &text,
+                              const Extent &extent) {
+  if (!m_limit) return;
+
+  std::unordered_map<std::string, Font>::iterator f = m_fonts.find(font);
+  if (f == m_fonts.end()) {
+    // Makes room by dropping the least recently used font
+    if (m_fonts.size() >= EXTENT_CACHE_FONTS) {
+      std::unordered_map<std::string, Font>::iterator oldest = m_fonts.begin();
+      for (f = m_fonts.begin(); f != m_fonts.end(); ++f)
+        if (f->second.lastUse < oldest->second.lastUse) oldest = f;
+      m_fonts.erase(oldest);
+    }
+    f = m_fonts.insert(std::make_pair(font, Font())).first;
+  }
+
+  Font &cache = f->second;
+  cache.lastUse = ++m_tick;
+  unsigned long hash = wxStringHash()(text);
+
+  // Same string measured again, or a hash collision: the entry is replaced
+  std::unordered_map<unsigned long, EntryList::iterator>::iterator found =
+      cache.index.find(hash);
+  if (found != cache.index.end()) {
+    cache.entries.erase(found->second);
+    cache.index.erase(found);
+  }
+
+  cache.entries.push_front(Entry());
+  Entry &entry = cache.entries.front();
+  entry.hash = hash;
+  entry.text = text;
+  entry.extent = extent;
+  cache.index[hash] = cache.entries.begin();
+  Trim(cache);
+}
+
+void piTextExtentCache::SetLimit(size_t n) {
+  m_limit = n;
+  for (std::unordered_map<std::string, Font>::iterator f = m_fonts.begin();
+       f != m_fonts.end(); ++f)
+    Trim(f->second);
+}
+
+void piTextExtentCache::Clear() { m_fonts.clear(); }
+
+void piTextExtentCache::Trim(Font &font) {
+  while (font.entries.size() > m_limit) {
+    font.index.erase(font.entries.back().hash);
+    font.entries.pop_back();
+  }
+}
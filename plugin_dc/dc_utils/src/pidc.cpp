@@ -42,12 +42,15 @@
 #include <wx/graphics.h>
 #include <wx/dcclient.h>
 
+#include <algorithm>
 #include <vector>
 
 #include "pidc.h"
 
 #include "linmath.h"
 #include "pi_shaders.h"
+#include "pi_tesscache.h"
+#include "pi_textcache.h"
 
 #ifdef __ANDROID__
 #include "qdebug.h"
@@ -57,9 +60,6 @@
 #pragma message("Compiling with wxUSE_GRAPHICS_CONTEXT")
 #endif
 
-static float GLMinSymbolLineWidth;
-static wxArrayPtrVoid pi_gTesselatorVertices;
-
 #ifdef USE_ANDROID_GLES2
 extern GLint pi_color_tri_shader_program;
 extern GLint pi_circle_filled_shader_program;
@@ -160,12 +160,27 @@ piDC::piDC(wxDC &pdc)
 #endif
 }
 
+piDC::piDC(piRasterSink &raster)
+    : glcontext(NULL), dc(NULL), m_pen(wxNullPen), m_brush(wxNullBrush) {
+  Init();
+  m_raster = &raster;
+  m_buseTex = true;  // the glyph atlas keeps its pages in memory
+  m_vpSize = wxSize(raster.GetWidth(), raster.GetHeight());
+  BeginBatch(m_raster);
+}
+
 piDC::piDC()
     : glcontext(NULL), dc(NULL), m_pen(wxNullPen), m_brush(wxNullBrush) {
   Init();
 }
 
 piDC::~piDC() {
+  EndBatch();
+
+#ifdef ocpnUSE_GL
+  if (glcontext && m_glcaps) piGLCapsCache::Get().Release(glcontext);
+#endif
+
 #if wxUSE_GRAPHICS_CONTEXT
   if (pgc) delete pgc;
 #endif
@@ -206,19 +221,38 @@ void piDC::Init() {
 
   g_textureId = -1;
   m_tobj = NULL;
+  m_batching = false;
+  m_glcaps = NULL;
+  m_raster = NULL;
+  m_simplify = false;
 #ifdef ocpnUSE_GL
-  //if (glcontext)
-  {
-    GLint parms[2];
-    glGetIntegerv(GL_SMOOTH_LINE_WIDTH_RANGE, &parms[0]);
-    GLMinSymbolLineWidth = wxMax(parms[0], 1);
+  pi_loadShaders();
+#endif
+}
 
-    pi_loadShaders();
-  }
+const piGLCaps &piDC::GetGLCaps() const {
+  if (!m_glcaps) {
+#ifdef ocpnUSE_GL
+    if (!dc && !m_raster) {
+      // piDC() draws with whatever context is current, it has its own copy
+      if (glcontext) {
+        m_glcaps = &piGLCapsCache::Get().Acquire(glcontext);
+      } else {
+        m_ownglcaps = piGLCaps::Query();
+        m_glcaps = &m_ownglcaps;
+      }
+      return *m_glcaps;
+    }
 #endif
+    // Drawing to a wxDC or a raster, there is no GL context to ask
+    static const piGLCaps defaults;
+    m_glcaps = &defaults;
+  }
+  return *m_glcaps;
 }
 
 void piDC::SetVP(PlugIn_ViewPort *vp) {
+  FlushBatch();
 #ifdef USE_ANDROID_GLES2
   configureShaders(vp->pix_width, vp->pix_height);
 #endif
@@ -257,11 +291,11 @@ void piDC::SetGLAttrs(bool highQuality) {
   if (highQuality) {
     glEnable(GL_LINE_SMOOTH);
     glEnable(GL_POLYGON_SMOOTH);
-    glEnable(GL_BLEND);
+    pi_setEnabled(GL_BLEND, true);
   } else {
     glDisable(GL_LINE_SMOOTH);
     glDisable(GL_POLYGON_SMOOTH);
-    glDisable(GL_BLEND);
+    pi_setEnabled(GL_BLEND, false);
   }
 
 #endif
@@ -318,8 +352,10 @@ void piDC::SetTextBackground( const wxColour &colour )
 void piDC::SetFont(const wxFont &font) {
   if (dc)
     dc->SetFont(font);
-  else
+  else {
     m_font = font;
+    m_fontKey.clear();
+  }
 }
 
 const wxPen &piDC::GetPen() const {
@@ -340,7 +376,10 @@ const wxFont &piDC::GetFont() const {
 void piDC::GetSize(wxCoord *width, wxCoord *height) const {
   if (dc)
     dc->GetSize(width, height);
-  else {
+  else if (m_raster) {
+    *width = m_raster->GetWidth();
+    *height = m_raster->GetHeight();
+  } else {
 //#ifdef ocpnUSE_GL
 //    glcanvas->GetSize(width, height);
 //#endif
@@ -380,250 +419,162 @@ void piDC::SetGLStipple() const {
 }
 
 #ifdef ocpnUSE_GL
-/* draw a half circle using triangles */
-void piDC::DrawEndCap(float x1, float y1, float t1, float angle) {
-#ifndef USE_ANDROID_GLES2
-  const int steps = 16;
-  float xa, ya;
-  bool first = true;
-  for (int i = 0; i <= steps; i++) {
-    float a = angle + M_PI / 2 + M_PI / steps * i;
-
-    float xb = x1 + t1 / 2 * cos(a);
-    float yb = y1 + t1 / 2 * sin(a);
-    if (first)
-      first = false;
-    else {
-      glVertex2f(x1, y1);
-      glVertex2f(xa, ya);
-      glVertex2f(xb, yb);
-    }
-    xa = xb, ya = yb;
+// Dash pattern of a pen in pixels, for the stroker. The wx styles use the
+// line stipple patterns of SetGLStipple(), both are scaled by the width.
+static int GetPenDashes(const wxPen &pen, float *dashes, int max) {
+  static const float dot[] = {5, 3}, long_dash[] = {28, 4},
+                     short_dash[] = {12, 4}, dot_dash[] = {8, 2, 4, 2};
+
+  float width = wxMax(1, pen.GetWidth());
+  wxDash *wxdashes;
+  int n = pen.GetDashes(&wxdashes);
+  if (n) {
+    n = wxMin(n, max);
+    for (int i = 0; i < n; i++) dashes[i] = width * wxdashes[i];
+    return n;
   }
-#endif
-}
-#endif  // ocpnUSE_GL
-
-// Draws a line between (x1,y1) - (x2,y2) with a start thickness of t1
-void piDC::DrawGLThickLine(float x1, float y1, float x2, float y2, wxPen pen,
-                           bool b_hiqual) {
-#ifdef ocpnUSE_GL
 
-  float angle = atan2f(y2 - y1, x2 - x1);
-  float t1 = pen.GetWidth();
-  float t2sina1 = t1 / 2 * sinf(angle);
-  float t2cosa1 = t1 / 2 * cosf(angle);
-
-#ifndef USE_ANDROID_GLES2
-  glBegin(GL_TRIANGLES);
-
-  //    n.b.  The dwxDash interpretation for GL only allows for 2 elements in
-  //    the dash table. The first is assumed drawn, second is assumed space
-  wxDash *dashes;
-  int n_dashes = pen.GetDashes(&dashes);
-  if (n_dashes) {
-    float lpix = sqrtf(powf((float)(x1 - x2), 2) + powf((float)(y1 - y2), 2));
-    float lrun = 0.;
-    float xa = x1;
-    float ya = y1;
-    float ldraw = t1 * dashes[0];
-    float lspace = t1 * dashes[1];
-
-    while (lrun < lpix) {
-      //    Dash
-      float xb = xa + ldraw * cosf(angle);
-      float yb = ya + ldraw * sinf(angle);
-
-      if ((lrun + ldraw) >= lpix)  // last segment is partial draw
-      {
-        xb = x2;
-        yb = y2;
-      }
-
-      glVertex2f(xa + t2sina1, ya - t2cosa1);
-      glVertex2f(xb + t2sina1, yb - t2cosa1);
-      glVertex2f(xb - t2sina1, yb + t2cosa1);
-
-      glVertex2f(xb - t2sina1, yb + t2cosa1);
-      glVertex2f(xa - t2sina1, ya + t2cosa1);
-      glVertex2f(xa + t2sina1, ya - t2cosa1);
-
-      xa = xb;
-      ya = yb;
-      lrun += ldraw;
-
-      //    Space
-      xb = xa + lspace * cos(angle);
-      yb = ya + lspace * sin(angle);
-
-      xa = xb;
-      ya = yb;
-      lrun += lspace;
-    }
-  } else {
-    glVertex2f(x1 + t2sina1, y1 - t2cosa1);
-    glVertex2f(x2 + t2sina1, y2 - t2cosa1);
-    glVertex2f(x2 - t2sina1, y2 + t2cosa1);
-
-    glVertex2f(x2 - t2sina1, y2 + t2cosa1);
-    glVertex2f(x1 - t2sina1, y1 + t2cosa1);
-    glVertex2f(x1 + t2sina1, y1 - t2cosa1);
-
-    /* wx draws a nice rounded end in dc mode, so replicate
-       this for opengl mode, should this be done for the dashed mode case? */
-    if (pen.GetCap() == wxCAP_ROUND) {
-      DrawEndCap(x1, y1, t1, angle);
-      DrawEndCap(x2, y2, t1, angle + M_PI);
-    }
+  const float *style;
+  switch (pen.GetStyle()) {
+    case wxPENSTYLE_DOT:
+      style = dot, n = 2;
+      break;
+    case wxPENSTYLE_LONG_DASH:
+      style = long_dash, n = 2;
+      break;
+    case wxPENSTYLE_SHORT_DASH:
+      style = short_dash, n = 2;
+      break;
+    case wxPENSTYLE_DOT_DASH:
+      style = dot_dash, n = 4;
+      break;
+    default:
+      return 0;
   }
+  n = wxMin(n, max);
+  for (int i = 0; i < n; i++) dashes[i] = width * style[i];
+  return n;
+}
 
-  glEnd();
-#else
-  //    n.b.  The dwxDash interpretation for GL only allows for 2 elements in
-  //    the dash table. The first is assumed drawn, second is assumed space
-  wxDash *dashes;
-  int n_dashes = pen.GetDashes(&dashes);
-  if (n_dashes) {
-    float lpix = sqrtf(powf((float)(x1 - x2), 2) + powf((float)(y1 - y2), 2));
-    float lrun = 0.;
-    float xa = x1;
-    float ya = y1;
-    float ldraw = t1 * dashes[0];
-    float lspace = t1 * dashes[1];
-
-    GLint program = pi_color_tri_shader_program;
-    glUseProgram(program);
-
-    float vert[12];
-
-    // Disable VBO's (vertex buffer objects) for attributes.
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-
-    GLint pos = glGetAttribLocation(program, "position");
-    glEnableVertexAttribArray(pos);
-    glVertexAttribPointer(pos, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), vert);
+static bool IsDashedPen(const wxPen &pen) {
+  float dashes[4];
+  return GetPenDashes(pen, dashes, 4) > 0;
+}
+#endif
 
-    // Build Transform matrix
-    mat4x4 I;
-    mat4x4_identity(I);
+void piDC::ConfigureStroker(const wxPen &pen) {
+#ifdef ocpnUSE_GL
+  m_stroker.SetWidth(wxMax(1, pen.GetWidth()));
 
-    GLint matloc = glGetUniformLocation(program, "TransformMatrix");
-    glUniformMatrix4fv(matloc, 1, GL_FALSE, (const GLfloat *)I);
+  switch (pen.GetJoin()) {
+    case wxJOIN_BEVEL:
+      m_stroker.SetJoin(piStroker::JOIN_BEVEL);
+      break;
+    case wxJOIN_MITER:
+      m_stroker.SetJoin(piStroker::JOIN_MITER);
+      break;
+    default:
+      m_stroker.SetJoin(piStroker::JOIN_ROUND);
+      break;
+  }
 
-    wxColor c = pen.GetColour();
-    float colorv[4];
-    colorv[0] = c.Red() / float(256);
-    colorv[1] = c.Green() / float(256);
-    colorv[2] = c.Blue() / float(256);
-    colorv[3] = c.Alpha() / float(256);
-
-    GLint colloc = glGetUniformLocation(program, "color");
-    glUniform4fv(colloc, 1, colorv);
-
-    while (lrun < lpix) {
-      //    Dash
-      float xb = xa + ldraw * cosf(angle);
-      float yb = ya + ldraw * sinf(angle);
-
-      if ((lrun + ldraw) >= lpix)  // last segment is partial draw
-      {
-        xb = x2;
-        yb = y2;
-      }
+  switch (pen.GetCap()) {
+    case wxCAP_BUTT:
+      m_stroker.SetCap(piStroker::CAP_BUTT);
+      break;
+    case wxCAP_PROJECTING:
+      m_stroker.SetCap(piStroker::CAP_SQUARE);
+      break;
+    default:
+      m_stroker.SetCap(piStroker::CAP_ROUND);
+      break;
+  }
 
-      vert[0] = xa + t2sina1;
-      vert[1] = ya - t2cosa1;
-      vert[2] = xb + t2sina1;
-      vert[3] = yb - t2cosa1;
-      vert[4] = xb - t2sina1;
-      vert[5] = yb + t2cosa1;
-      vert[6] = xb - t2sina1;
-      vert[7] = yb + t2cosa1;
-      vert[8] = xa - t2sina1;
-      vert[9] = ya + t2cosa1;
-      vert[10] = xa + t2sina1;
-      vert[11] = ya - t2cosa1;
-
-      glDrawArrays(GL_TRIANGLES, 0, 6);
-
-      xa = xb;
-      ya = yb;
-      lrun += ldraw;
-
-      //    Space
-      xb = xa + lspace * cos(angle);
-      yb = ya + lspace * sin(angle);
-
-      xa = xb;
-      ya = yb;
-      lrun += lspace;
-    }
+  float dashes[16];
+  int n_dashes = GetPenDashes(pen, dashes, 16);
+  m_stroker.SetDashes(dashes, n_dashes);
+#endif  // ocpnUSE_GL
+}
 
-    glUseProgram(0);
-  } else {
-    float vert[12];
-    vert[0] = x1 + t2sina1;
-    vert[1] = y1 - t2cosa1;
-    vert[2] = x2 + t2sina1;
-    vert[3] = y2 - t2cosa1;
-    vert[4] = x2 - t2sina1;
-    vert[5] = y2 + t2cosa1;
-    vert[6] = x2 - t2sina1;
-    vert[7] = y2 + t2cosa1;
-    vert[8] = x1 - t2sina1;
-    vert[9] = y1 + t2cosa1;
-    vert[10] = x1 + t2sina1;
-    vert[11] = y1 - t2cosa1;
+// Draws the triangle strip of the last m_stroker.Stroke(), in one call
+void piDC::DrawStroke(const wxColour &c) {
+#ifdef ocpnUSE_GL
+  int count = m_stroker.GetVertexCount();
+  if (!count) return;
 
-    GLint program = pi_color_tri_shader_program;
-    glUseProgram(program);
+  if (m_raster) {
+    FlushBatch();
+    unsigned char color[4] = {c.Red(), c.Green(), c.Blue(), c.Alpha()};
+    m_raster->FillTriangleStrip(m_stroker.GetVertices(), count, color, true);
+    return;
+  }
 
-    // Disable VBO's (vertex buffer objects) for attributes.
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+#ifndef USE_ANDROID_GLES2
+  glDisable(GL_POLYGON_SMOOTH);  // would show the inner edges of the strip
+  glColor4ub(c.Red(), c.Green(), c.Blue(), c.Alpha());
 
-    GLint pos = glGetAttribLocation(program, "position");
-    glEnableVertexAttribArray(pos);
-    glVertexAttribPointer(pos, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), vert);
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glVertexPointer(2, GL_FLOAT, 2 * sizeof(float), m_stroker.GetVertices());
+  pi_drawArrays(GL_TRIANGLE_STRIP, 0, count);
+  glDisableClientState(GL_VERTEX_ARRAY);
+#else
+  GLint program = pi_color_tri_shader_program;
+  pi_useProgram(program);
 
-    // Build Transform matrix
-    mat4x4 I;
-    mat4x4_identity(I);
+  // Disable VBO's (vertex buffer objects) for attributes.
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
-    GLint matloc = glGetUniformLocation(program, "TransformMatrix");
-    glUniformMatrix4fv(matloc, 1, GL_FALSE, (const GLfloat *)I);
+  GLint pos = pi_getShader(program).position;
+  glEnableVertexAttribArray(pos);
+  glVertexAttribPointer(pos, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float),
+                        m_stroker.GetVertices());
 
-    wxColor c = pen.GetColour();
-    float colorv[4];
-    colorv[0] = c.Red() / float(256);
-    colorv[1] = c.Green() / float(256);
-    colorv[2] = c.Blue() / float(256);
-    colorv[3] = c.Alpha() / float(256);
+  // Build Transform matrix
+  mat4x4 I;
+  mat4x4_identity(I);
 
-    GLint colloc = glGetUniformLocation(program, "color");
-    glUniform4fv(colloc, 1, colorv);
+  pi_setTransform(program, (const GLfloat *)I);
 
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+  float colorv[4];
+  colorv[0] = c.Red() / float(256);
+  colorv[1] = c.Green() / float(256);
+  colorv[2] = c.Blue() / float(256);
+  colorv[3] = c.Alpha() / float(256);
 
-    /* wx draws a nice rounded end in dc mode, so replicate
-     *           this for opengl mode, should this be done for the dashed mode
-     * case? */
-    //         if(pen.GetCap() == wxCAP_ROUND) {
-    //             DrawEndCap( x1, y1, t1, angle);
-    //             DrawEndCap( x2, y2, t1, angle + M_PI);
-    //         }
-    //
-    glUseProgram(0);
-  }
+  pi_setColor(program, colorv);
 
+  pi_drawArrays(GL_TRIANGLE_STRIP, 0, count);
+  pi_useProgram(0);
 #endif
+#endif  // ocpnUSE_GL
+}
 
+// Draws a line between (x1,y1) - (x2,y2) with the width, caps and dashes of
+// pen
+void piDC::DrawGLThickLine(float x1, float y1, float x2, float y2, wxPen pen,
+                           bool b_hiqual) {
+#ifdef ocpnUSE_GL
+  float points[4] = {x1, y1, x2, y2};
+  ConfigureStroker(pen);
+  if (m_stroker.Stroke(points, 2)) DrawStroke(pen.GetColour());
 #endif  // ocpnUSE_GL
 }
 
 void piDC::DrawLine(wxCoord x1, wxCoord y1, wxCoord x2, wxCoord y2,
                     bool b_hiqual) {
+#ifdef ocpnUSE_GL
+  if (!dc && CanBatchPen()) {
+    piDrawState state;
+    if (GetPenState(state, b_hiqual)) m_batch.AddLine(state, x1, y1, x2, y2);
+    return;
+  }
+  if (m_raster) {  // dashed or too wide for the batch
+    DrawGLThickLine(x1, y1, x2, y2, m_pen, b_hiqual);
+    return;
+  }
+#endif
+
   if (dc) {
     dc->DrawLine(x1, y1, x2, y2);
   }
@@ -631,22 +582,18 @@ void piDC::DrawLine(wxCoord x1, wxCoord y1, wxCoord x2, wxCoord y2,
   else if (ConfigurePen()) {
     bool b_draw_thick = false;
 
-    float pen_width = wxMax(GLMinSymbolLineWidth, m_pen.GetWidth());
+    const piGLCaps &caps = GetGLCaps();
+    float pen_width = wxMax(caps.minLineWidth, m_pen.GetWidth());
 
     //      Enable anti-aliased lines, at best quality
     if (b_hiqual) {
-      SetGLStipple();
-
 #ifndef __WXQT__
-      glEnable(GL_BLEND);
+      pi_setEnabled(GL_BLEND, true);
       glEnable(GL_LINE_SMOOTH);
 #endif
 
       if (pen_width > 1.0) {
-        GLint parms[2];
-        glGetIntegerv(GL_SMOOTH_LINE_WIDTH_RANGE, &parms[0]);
-        if (glGetError()) glGetIntegerv(GL_ALIASED_LINE_WIDTH_RANGE, &parms[0]);
-        if (pen_width > parms[1]) {
+        if (pen_width > caps.maxSmoothLineWidth) {
           b_draw_thick = true;
         } else
           glLineWidth(pen_width);
@@ -655,9 +602,7 @@ void piDC::DrawLine(wxCoord x1, wxCoord y1, wxCoord x2, wxCoord y2,
       }
     } else {
       if (pen_width > 1) {
-        GLint parms[2];
-        glGetIntegerv(GL_ALIASED_LINE_WIDTH_RANGE, &parms[0]);
-        if (pen_width > parms[1])
+        if (pen_width > caps.maxAliasedLineWidth)
           b_draw_thick = true;
         else
           glLineWidth(pen_width);
@@ -665,22 +610,25 @@ void piDC::DrawLine(wxCoord x1, wxCoord y1, wxCoord x2, wxCoord y2,
         glLineWidth(pen_width);
     }
 
+    // Dashes are stroked as well, line stipple is not there with GLES
+    if (IsDashedPen(m_pen)) b_draw_thick = true;
+
 #ifdef USE_ANDROID_GLES2
     if (b_draw_thick) {
       DrawGLThickLine(x1, y1, x2, y2, m_pen, b_hiqual);
     } else {
       checkGlError("Before glUseProgram", "piDC", __LINE__);
       GLint program = pi_color_tri_shader_program;
-      glUseProgram(program);
+      pi_useProgram(program);
       checkGlError("After glUseProgram", "piDC", __LINE__);
 
       float fBuf[4];
-      GLint pos = glGetAttribLocation(program, "position");
+      GLint pos = pi_getShader(program).position;
       glVertexAttribPointer(pos, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float),
                             fBuf);
       glEnableVertexAttribArray(pos);
 
-      // GLint matloc = glGetUniformLocation(program,"MVMatrix");
+      // GLint matloc = pi_getShader(program).mvMatrix;
       // glUniformMatrix4fv( matloc, 1, GL_FALSE, (const
       // GLfloat*)cc1->GetpVP()->vp_transform);
 
@@ -690,234 +638,117 @@ void piDC::DrawLine(wxCoord x1, wxCoord y1, wxCoord x2, wxCoord y2,
       colorv[2] = m_pen.GetColour().Blue() / float(256);
       colorv[3] = 1.0;
 
-      GLint colloc = glGetUniformLocation(program, "color");
-      glUniform4fv(colloc, 1, colorv);
-
-      wxDash *dashes;
-      int n_dashes = m_pen.GetDashes(&dashes);
-      if (n_dashes) {
-        float angle = atan2f((float)(y2 - y1), (float)(x2 - x1));
-        float cosa = cosf(angle);
-        float sina = sinf(angle);
-        float t1 = m_pen.GetWidth();
-
-        float lpix = sqrtf(powf(x1 - x2, 2) + powf(y1 - y2, 2));
-        float lrun = 0.;
-        float xa = x1;
-        float ya = y1;
-        float ldraw = t1 * dashes[0];
-        float lspace = t1 * dashes[1];
-
-        ldraw = wxMax(ldraw, 4.0);
-        lspace = wxMax(lspace, 4.0);
-        lpix = wxMin(lpix, 2000.0);
-
-        while (lrun < lpix) {
-          //    Dash
-          float xb = xa + ldraw * cosa;
-          float yb = ya + ldraw * sina;
-
-          if ((lrun + ldraw) >= lpix)  // last segment is partial draw
-          {
-            xb = x2;
-            yb = y2;
-          }
-
-          fBuf[0] = xa;
-          fBuf[1] = ya;
-          fBuf[2] = xb;
-          fBuf[3] = yb;
+      pi_setColor(program, colorv);
 
-          glDrawArrays(GL_LINES, 0, 2);
+      fBuf[0] = x1;
+      fBuf[1] = y1;
+      fBuf[2] = x2;
+      fBuf[3] = y2;
 
-          xa = xa + (lspace + ldraw) * cosa;
-          ya = ya + (lspace + ldraw) * sina;
-          lrun += lspace + ldraw;
-        }
-      } else  // not dashed
-      {
-        fBuf[0] = x1;
-        fBuf[1] = y1;
-        fBuf[2] = x2;
-        fBuf[3] = y2;
-
-        glDrawArrays(GL_LINES, 0, 2);
-      }
+      pi_drawArrays(GL_LINES, 0, 2);
 
-      glUseProgram(0);
+      pi_useProgram(0);
     }
 
 #else
     if (b_draw_thick) {
       DrawGLThickLine(x1, y1, x2, y2, m_pen, b_hiqual);
     } else {
-      wxDash *dashes;
-      int n_dashes = m_pen.GetDashes(&dashes);
-      if (n_dashes) {
-        float angle = atan2f((float)(y2 - y1), (float)(x2 - x1));
-        float cosa = cosf(angle);
-        float sina = sinf(angle);
-        float t1 = m_pen.GetWidth();
-
-        float lpix = sqrtf(powf(x1 - x2, 2) + powf(y1 - y2, 2));
-        float lrun = 0.;
-        float xa = x1;
-        float ya = y1;
-        float ldraw = t1 * dashes[0];
-        float lspace = t1 * dashes[1];
-
-        ldraw = wxMax(ldraw, 4.0);
-        lspace = wxMax(lspace, 4.0);
-        lpix = wxMin(lpix, 2000.0);
-
-        glBegin(GL_LINES);
-        while (lrun < lpix) {
-          //    Dash
-          float xb = xa + ldraw * cosa;
-          float yb = ya + ldraw * sina;
-
-          if ((lrun + ldraw) >= lpix)  // last segment is partial draw
-          {
-            xb = x2;
-            yb = y2;
-          }
-
-          glVertex2f(xa, ya);
-          glVertex2f(xb, yb);
-
-          xa = xa + (lspace + ldraw) * cosa;
-          ya = ya + (lspace + ldraw) * sina;
-          lrun += lspace + ldraw;
-        }
-        glEnd();
-      } else  // not dashed
-      {
-        glBegin(GL_LINES);
-        glVertex2i(x1, y1);
-        glVertex2i(x2, y2);
-        glEnd();
-      }
+      glBegin(GL_LINES);
+      glVertex2i(x1, y1);
+      glVertex2i(x2, y2);
+      glEnd();
     }
 #endif
     glDisable(GL_LINE_STIPPLE);
 
     if (b_hiqual) {
       glDisable(GL_LINE_SMOOTH);
-      glDisable(GL_BLEND);
+      pi_setEnabled(GL_BLEND, false);
     }
   }
 #endif  // ocpnUSE_GL
 }
 
-// Draws thick lines from triangles
+// Draws thick or dashed lines from triangles: the whole polyline is a single
+// triangle strip, with proper joins between the segments
 void piDC::DrawGLThickLines(int n, wxPoint points[], wxCoord xoffset,
                             wxCoord yoffset, wxPen pen, bool b_hiqual) {
 #ifdef ocpnUSE_GL
   if (n < 2) return;
 
-#ifdef USE_ANDROID_GLES2
-  wxPoint p0 = points[0];
-  for (int i = 1; i < n; i++) {
-    DrawGLThickLine(p0.x + xoffset, p0.y + yoffset, points[i].x + xoffset,
-                    points[i].y + yoffset, pen, b_hiqual);
-    p0 = points[i];
-  }
-  return;
-#else
-  /* for dashed case, for now just draw thick lines */
-  wxDash *dashes;
-  if (pen.GetDashes(&dashes)) {
-    wxPoint p0 = points[0];
-    for (int i = 1; i < n; i++) {
-      DrawGLThickLine(p0.x + xoffset, p0.y + yoffset, points[i].x + xoffset,
-                      points[i].y + yoffset, pen, b_hiqual);
-      p0 = points[i];
-    }
-    return;
+  //  Grow the work buffer as necessary
+  if (workBufSize < (size_t)n * 2) {
+    workBuf = (float *)realloc(workBuf, (n * 4) * sizeof(float));
+    workBufSize = n * 4;
   }
 
-  /* cull zero segments */
-  wxPoint *cpoints = new wxPoint[n];
-  cpoints[0] = points[0];
-  int c = 1;
-  for (int i = 1; i < n; i++) {
-    if (points[i].x != points[i - 1].x || points[i].y != points[i - 1].y)
-      cpoints[c++] = points[i];
+  for (int i = 0; i < n; i++) {
+    workBuf[i * 2] = points[i].x + xoffset;
+    workBuf[(i * 2) + 1] = points[i].y + yoffset;
   }
 
-  /* nicer than than rendering each segment separately, this is because thick
-     line segments drawn as rectangles which have different angles have
-     rectangles which overlap and also leave a gap.
-     This code properly calculates vertexes for adjoining segments */
-  float t1 = pen.GetWidth();
-
-  float x0 = cpoints[0].x, y0 = cpoints[0].y, x1 = cpoints[1].x,
-        y1 = cpoints[1].y;
-  float a0 = atan2f(y1 - y0, x1 - x0);
-
-  // It is also possible to use triangle strip, (and triangle fan for endcap)
-  // to reduce vertex count.. is it worth it?
-  glBegin(GL_TRIANGLES);
+  ConfigureStroker(pen);
+  if (m_stroker.Stroke(workBuf, n)) DrawStroke(pen.GetColour());
+#endif  // ocpnUSE_GL
+}
 
-  float t2sina0 = t1 / 2 * sinf(a0);
-  float t2cosa0 = t1 / 2 * cosf(a0);
+void piDC::SetSimplify(bool enable, float tolerance) {
+  m_simplify = enable;
+  m_simplifier.SetTolerance(tolerance);
+}
 
-  for (int i = 1; i < c; i++) {
-    float x2, y2;
-    float a1;
+// Clips to the viewport, in the coordinates of the points drawn at offset,
+// with room for the pen
+void piDC::SetSimplifyClip(wxCoord xoffset, wxCoord yoffset) {
+  wxRect clip;
+  if (m_vpSize.x > 0 && m_vpSize.y > 0) {
+    clip = wxRect(-xoffset, -yoffset, m_vpSize.x, m_vpSize.y);
+    clip.Inflate(m_pen.GetWidth() + 2);
+  }
+  m_simplifier.SetClipRect(clip);
+}
 
-    if (i < c - 1) {
-      x2 = cpoints[i + 1].x, y2 = cpoints[i + 1].y;
-      a1 = atan2f(y2 - y1, x2 - x1);
-    } else {
-      x2 = x1, y2 = y1;
-      a1 = a0;
+void piDC::DrawLines(int n, wxPoint points[], wxCoord xoffset, wxCoord yoffset,
+                     bool b_hiqual) {
+#ifdef ocpnUSE_GL
+  if (!dc && m_simplify) {
+    SetSimplifyClip(xoffset, yoffset);
+    int pieces = m_simplifier.SimplifyLines(n, points);
+    wxPoint *piece = m_simplifier.GetPoints();
+    for (int i = 0; i < pieces; i++) {
+      int count = m_simplifier.GetPieces()[i];
+      DrawLinesDirect(count, piece, xoffset, yoffset, b_hiqual);
+      piece += count;
     }
-
-    float aa = (a0 + a1) / 2;
-    float diff = fabsf(a0 - a1);
-    if (diff > M_PI) diff -= 2 * (float)M_PI;
-    float rad = t1 / 2 / wxMax(cosf(diff / 2), .4);
-
-    float t2sina1 = rad * sinf(aa);
-    float t2cosa1 = rad * cosf(aa);
-
-    glVertex2f(x1 + t2sina1, y1 - t2cosa1);
-    glVertex2f(x1 - t2sina1, y1 + t2cosa1);
-    glVertex2f(x0 + t2sina0, y0 - t2cosa0);
-
-    glVertex2f(x0 - t2sina0, y0 + t2cosa0);
-    glVertex2f(x0 + t2sina0, y0 - t2cosa0);
-
-    float dot = t2sina0 * t2sina1 + t2cosa0 * t2cosa1;
-    if (dot > 0)
-      glVertex2f(x1 - t2sina1, y1 + t2cosa1);
-    else
-      glVertex2f(x1 + t2sina1, y1 - t2cosa1);
-
-    x0 = x1, x1 = x2;
-    y0 = y1, y1 = y2;
-    a0 = a1;
-    t2sina0 = t2sina1, t2cosa0 = t2cosa1;
+    return;
   }
+#endif
+  DrawLinesDirect(n, points, xoffset, yoffset, b_hiqual);
+}
 
-  if (pen.GetCap() == wxCAP_ROUND) {
-    DrawEndCap(x0, y0, t1, a0);
-    DrawEndCap(x0, y0, t1, a0 + M_PI);
+void piDC::DrawLinesDirect(int n, wxPoint points[], wxCoord xoffset,
+                           wxCoord yoffset, bool b_hiqual) {
+#ifdef ocpnUSE_GL
+  if (!dc && CanBatchPen()) {
+    piDrawState state;
+    if (GetPenState(state, b_hiqual) && n > 1) {
+      float *v = m_batch.Append(state, 2 * (n - 1));
+      for (int i = 1; i < n; i++) {
+        *v++ = points[i - 1].x + xoffset;
+        *v++ = points[i - 1].y + yoffset;
+        *v++ = points[i].x + xoffset;
+        *v++ = points[i].y + yoffset;
+      }
+    }
+    return;
+  }
+  if (m_raster) {
+    DrawGLThickLines(n, points, xoffset, yoffset, m_pen, b_hiqual);
+    return;
   }
-
-  glEnd();
-
-  glPopAttrib();
-
-  delete[] cpoints;
-
 #endif
-#endif  // ocpnUSE_GL
-}
 
-void piDC::DrawLines(int n, wxPoint points[], wxCoord xoffset, wxCoord yoffset,
-                     bool b_hiqual) {
   if (dc) dc->DrawLines(n, points, xoffset, yoffset);
 #ifdef ocpnUSE_GL
   else if (ConfigurePen()) {
@@ -927,37 +758,34 @@ void piDC::DrawLines(int n, wxPoint points[], wxCoord xoffset, wxCoord yoffset,
 #else
     SetGLAttrs(b_hiqual);
 #endif
+    const piGLCaps &caps = GetGLCaps();
     bool b_draw_thick = false;
 
     glDisable(GL_LINE_STIPPLE);
-    SetGLStipple();
 
     //      Enable anti-aliased lines, at best quality
     if (b_hiqual) {
-      glEnable(GL_BLEND);
+      pi_setEnabled(GL_BLEND, true);
       if (m_pen.GetWidth() > 1) {
-        GLint parms[2];
-        glGetIntegerv(GL_SMOOTH_LINE_WIDTH_RANGE, &parms[0]);
-        if (glGetError()) glGetIntegerv(GL_ALIASED_LINE_WIDTH_RANGE, &parms[0]);
-
-        if (m_pen.GetWidth() > parms[1])
+        if (m_pen.GetWidth() > caps.maxSmoothLineWidth)
           b_draw_thick = true;
         else
-          glLineWidth(wxMax(GLMinSymbolLineWidth, m_pen.GetWidth()));
+          glLineWidth(wxMax(caps.minLineWidth, m_pen.GetWidth()));
       } else
-        glLineWidth(wxMax(GLMinSymbolLineWidth, 1));
+        glLineWidth(wxMax(caps.minLineWidth, 1));
     } else {
       if (m_pen.GetWidth() > 1) {
-        GLint parms[2];
-        glGetIntegerv(GL_ALIASED_LINE_WIDTH_RANGE, &parms[0]);
-        if (m_pen.GetWidth() > parms[1])
+        if (m_pen.GetWidth() > caps.maxAliasedLineWidth)
           b_draw_thick = true;
         else
-          glLineWidth(wxMax(GLMinSymbolLineWidth, m_pen.GetWidth()));
+          glLineWidth(wxMax(caps.minLineWidth, m_pen.GetWidth()));
       } else
-        glLineWidth(wxMax(GLMinSymbolLineWidth, 1));
+        glLineWidth(wxMax(caps.minLineWidth, 1));
     }
 
+    // Dashes are stroked as well, line stipple is not there with GLES
+    if (IsDashedPen(m_pen)) b_draw_thick = true;
+
     if (b_draw_thick) {
       DrawGLThickLines(n, points, xoffset, yoffset, m_pen, b_hiqual);
     } else {
@@ -965,52 +793,51 @@ void piDC::DrawLines(int n, wxPoint points[], wxCoord xoffset, wxCoord yoffset,
         glEnable(GL_LINE_SMOOTH);
         glDisable(GL_LINE_STIPPLE);
         glDisable(GL_POLYGON_SMOOTH);
-        glDisable(GL_BLEND);
+        pi_setEnabled(GL_BLEND, false);
       }
-    }
 #ifndef USE_ANDROID_GLES2
-    glBegin(GL_LINE_STRIP);
-    for (int i = 0; i < n; i++) {
-      glVertex2i(points[i].x + xoffset, points[i].y + yoffset);
-    }
-    glEnd();
+      glBegin(GL_LINE_STRIP);
+      for (int i = 0; i < n; i++) {
+        glVertex2i(points[i].x + xoffset, points[i].y + yoffset);
+      }
+      glEnd();
 #else
-    //  Grow the work buffer as necessary
-    if (workBufSize < (size_t)n * 2) {
-      workBuf = (float *)realloc(workBuf, (n * 4) * sizeof(float));
-      workBufSize = n * 4;
-    }
+      //  Grow the work buffer as necessary
+      if (workBufSize < (size_t)n * 2) {
+        workBuf = (float *)realloc(workBuf, (n * 4) * sizeof(float));
+        workBufSize = n * 4;
+      }
 
-    for (int i = 0; i < n; i++) {
-      workBuf[i * 2] = points[i].x + xoffset;
-      workBuf[(i * 2) + 1] = points[i].y + yoffset;
-    }
+      for (int i = 0; i < n; i++) {
+        workBuf[i * 2] = points[i].x + xoffset;
+        workBuf[(i * 2) + 1] = points[i].y + yoffset;
+      }
 
-    GLint program = pi_color_tri_shader_program;
-    glUseProgram(program);
+      GLint program = pi_color_tri_shader_program;
+      pi_useProgram(program);
 
-    GLint pos = glGetAttribLocation(program, "position");
-    glVertexAttribPointer(pos, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float),
-                          workBuf);
-    glEnableVertexAttribArray(pos);
+      GLint pos = pi_getShader(program).position;
+      glVertexAttribPointer(pos, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float),
+                            workBuf);
+      glEnableVertexAttribArray(pos);
 
-    float colorv[4];
-    colorv[0] = m_pen.GetColour().Red() / float(256);
-    colorv[1] = m_pen.GetColour().Green() / float(256);
-    colorv[2] = m_pen.GetColour().Blue() / float(256);
-    colorv[3] = m_pen.GetColour().Alpha() / float(256);
+      float colorv[4];
+      colorv[0] = m_pen.GetColour().Red() / float(256);
+      colorv[1] = m_pen.GetColour().Green() / float(256);
+      colorv[2] = m_pen.GetColour().Blue() / float(256);
+      colorv[3] = m_pen.GetColour().Alpha() / float(256);
 
-    GLint colloc = glGetUniformLocation(program, "color");
-    glUniform4fv(colloc, 1, colorv);
+      pi_setColor(program, colorv);
 
-    glDrawArrays(GL_LINE_STRIP, 0, n);
-    glUseProgram(0);
+      pi_drawArrays(GL_LINE_STRIP, 0, n);
+      pi_useProgram(0);
 
 #endif
+    }
     if (b_hiqual) {
       glDisable(GL_LINE_STIPPLE);
       glDisable(GL_POLYGON_SMOOTH);
-      glDisable(GL_BLEND);
+      pi_setEnabled(GL_BLEND, false);
     }
 
     SetGLAttrs(false);
@@ -1023,24 +850,23 @@ void piDC::DrawArc(wxCoord xc, wxCoord yc, wxCoord x1, wxCoord y1, wxCoord x2,
 #ifndef USE_ANDROID_GLES2
   if (dc) dc->DrawArc(x1, y1, x2, y2, xc, yc);
 #ifdef ocpnUSE_GL
+  else if (m_raster)
+    DrawLine(x1, y1, x2, y2, b_hiqual);  // as the GL path, a chord
   else if (ConfigurePen()) {
     bool b_draw_thick = false;
 
-    float pen_width = wxMax(GLMinSymbolLineWidth, m_pen.GetWidth());
+    const piGLCaps &caps = GetGLCaps();
+    float pen_width = wxMax(caps.minLineWidth, m_pen.GetWidth());
 
     //      Enable anti-aliased lines, at best quality
     if (b_hiqual) {
-      SetGLStipple();
-
 #ifndef __WXQT__
-      glEnable(GL_BLEND);
+      pi_setEnabled(GL_BLEND, true);
       glEnable(GL_LINE_SMOOTH);
 #endif
 
       if (pen_width > 1.0) {
-        GLint parms[2];
-        glGetIntegerv(GL_SMOOTH_LINE_WIDTH_RANGE, &parms[0]);
-        if (pen_width > parms[1])
+        if (pen_width > caps.maxSmoothLineWidth)
           b_draw_thick = true;
         else
           glLineWidth(pen_width);
@@ -1048,9 +874,7 @@ void piDC::DrawArc(wxCoord xc, wxCoord yc, wxCoord x1, wxCoord y1, wxCoord x2,
         glLineWidth(pen_width);
     } else {
       if (pen_width > 1) {
-        GLint parms[2];
-        glGetIntegerv(GL_ALIASED_LINE_WIDTH_RANGE, &parms[0]);
-        if (pen_width > parms[1])
+        if (pen_width > caps.maxAliasedLineWidth)
           b_draw_thick = true;
         else
           glLineWidth(pen_width);
@@ -1058,58 +882,21 @@ void piDC::DrawArc(wxCoord xc, wxCoord yc, wxCoord x1, wxCoord y1, wxCoord x2,
         glLineWidth(pen_width);
     }
 
+    // Dashes are stroked as well, as in DrawLine()
+    if (IsDashedPen(m_pen)) b_draw_thick = true;
+
     if (b_draw_thick) {
       DrawGLThickLine(x1, y1, x2, y2, m_pen, b_hiqual);
     } else {
-      wxDash *dashes;
-      int n_dashes = m_pen.GetDashes(&dashes);
-      if (n_dashes) {
-        float angle = atan2f((float)(y2 - y1), (float)(x2 - x1));
-        float cosa = cosf(angle);
-        float sina = sinf(angle);
-        float t1 = m_pen.GetWidth();
-
-        float lpix = sqrtf(powf(x1 - x2, 2) + powf(y1 - y2, 2));
-        float lrun = 0.;
-        float xa = x1;
-        float ya = y1;
-        float ldraw = t1 * dashes[0];
-        float lspace = t1 * dashes[1];
-
-        glBegin(GL_LINES);
-        while (lrun < lpix) {
-          //    Dash
-          float xb = xa + ldraw * cosa;
-          float yb = ya + ldraw * sina;
-
-          if ((lrun + ldraw) >= lpix)  // last segment is partial draw
-          {
-            xb = x2;
-            yb = y2;
-          }
-
-          glVertex2f(xa, ya);
-          glVertex2f(xb, yb);
-
-          xa = xa + (lspace + ldraw) * cosa;
-          ya = ya + (lspace + ldraw) * sina;
-          lrun += lspace + ldraw;
-        }
-        glEnd();
-      } else  // not dashed
-      {
-        glBegin(GL_LINES);
-        glVertex2i(x1, y1);
-        glVertex2i(x2, y2);
-        glEnd();
-      }
+      glBegin(GL_LINES);
+      glVertex2i(x1, y1);
+      glVertex2i(x2, y2);
+      glEnd();
     }
 
-    glDisable(GL_LINE_STIPPLE);
-
     if (b_hiqual) {
       glDisable(GL_LINE_SMOOTH);
-      glDisable(GL_BLEND);
+      pi_setEnabled(GL_BLEND, false);
     }
   }
 #endif  // ocpnUSE_GL
@@ -1157,21 +944,19 @@ void piDC::DrawSector(wxCoord xc, wxCoord yc, wxCoord x1, wxCoord y1,
       wxGC->FillPath(gpath);
     }
 #else
-    wxPoint *points;
-    int numpoints =
-        ArcSectorPoints(*&points, xc, yc, x1, y1, x2, y2, x3, y3, x4, y4, true);
-    DrawPolygon(numpoints, points);
-    delete[] points;
+    int numpoints = ArcSectorPoints(m_shapePoints, xc, yc, x1, y1, x2, y2, x3,
+                                    y3, x4, y4, true);
+    if (numpoints == 0) return;
+    DrawPolygon(numpoints, &m_shapePoints[0]);
 #endif
   }
 #ifdef ocpnUSE_GL
   else {
-    wxPoint *points;
-    int numpoints =
-        ArcSectorPoints(*&points, xc, yc, x1, y1, x2, y2, x3, y3, x4, y4, true);
-    DrawLines(numpoints, points);
-    DrawPolygon(numpoints, points, 0, 0);
-    delete[] points;
+    int numpoints = ArcSectorPoints(m_shapePoints, xc, yc, x1, y1, x2, y2, x3,
+                                    y3, x4, y4, true);
+    if (numpoints == 0) return;
+    DrawLines(numpoints, &m_shapePoints[0]);
+    DrawPolygon(numpoints, &m_shapePoints[0], 0, 0);
   }
 #endif  // ocpnUSE_GL
 }
@@ -1212,6 +997,11 @@ void piDC::StrokeLines(int n, wxPoint *points) {
 void piDC::DrawGLLineArray(int n, float *vertex_array, float *color_array,
                            bool b_hiqual) {
 #ifdef ocpnUSE_GL
+  if (m_raster) {
+    BatchLines(vertex_array, n, false, b_hiqual);
+    return;
+  }
+
   if (ConfigurePen()) {
 #ifdef __WXQT__
     SetGLAttrs(false);  // Some QT platforms (Android) have trouble with
@@ -1219,10 +1009,16 @@ void piDC::DrawGLLineArray(int n, float *vertex_array, float *color_array,
 #else
     SetGLAttrs(b_hiqual);
 #endif
-    // bool b_draw_thick = false;
+    const piGLCaps &caps = GetGLCaps();
 
-    glDisable(GL_LINE_STIPPLE);
-    SetGLStipple();
+    // Dashed and too wide pens are stroked into triangles, as a polyline
+    // with GLES too
+    if (IsDashedPen(m_pen) ||
+        wxMax(caps.minLineWidth, m_pen.GetWidth()) > caps.MaxLineWidth()) {
+      ConfigureStroker(m_pen);
+      if (m_stroker.Stroke(vertex_array, n)) DrawStroke(m_pen.GetColour());
+      return;
+    }
 
     //      Enable anti-aliased lines, at best quality
     if (b_hiqual) {
@@ -1232,16 +1028,16 @@ void piDC::DrawGLLineArray(int n, float *vertex_array, float *color_array,
         // if(glGetError())
         // glGetIntegerv( GL_ALIASED_LINE_WIDTH_RANGE, &parms[0] );
 
-        glLineWidth(wxMax(GLMinSymbolLineWidth, m_pen.GetWidth()));
+        glLineWidth(wxMax(caps.minLineWidth, m_pen.GetWidth()));
       } else
-        glLineWidth(wxMax(GLMinSymbolLineWidth, 1));
+        glLineWidth(wxMax(caps.minLineWidth, 1));
     } else {
       if (m_pen.GetWidth() > 1) {
         // GLint parms[2];
         // glGetIntegerv( GL_ALIASED_LINE_WIDTH_RANGE, &parms[0] );
-        glLineWidth(wxMax(GLMinSymbolLineWidth, m_pen.GetWidth()));
+        glLineWidth(wxMax(caps.minLineWidth, m_pen.GetWidth()));
       } else
-        glLineWidth(wxMax(GLMinSymbolLineWidth, 1));
+        glLineWidth(wxMax(caps.minLineWidth, 1));
     }
 
 #ifndef USE_ANDROID_GLES2
@@ -1252,25 +1048,22 @@ void piDC::DrawGLLineArray(int n, float *vertex_array, float *color_array,
     glEnd();
 
 #else
-    glUseProgram(pi_colorv_tri_shader_program);
+    pi_useProgram(pi_colorv_tri_shader_program);
 
-    GLint pos = glGetAttribLocation(pi_colorv_tri_shader_program, "position");
+    GLint pos = pi_getShader(pi_colorv_tri_shader_program).position;
     glVertexAttribPointer(pos, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float),
                           vertex_array);
     glEnableVertexAttribArray(pos);
 
-    GLint colloc = glGetAttribLocation(pi_colorv_tri_shader_program, "colorv");
+    GLint colloc = pi_getShader(pi_colorv_tri_shader_program).colorv;
     glVertexAttribPointer(colloc, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float),
                           color_array);
     glEnableVertexAttribArray(colloc);
 
-    glDrawArrays(GL_LINES, 0, n);
-    glUseProgram(0);
+    pi_drawArrays(GL_LINES, 0, n);
+    pi_useProgram(0);
 #endif
-    if (b_hiqual) {
-      glDisable(GL_LINE_STIPPLE);
-      glDisable(GL_POLYGON_SMOOTH);
-    }
+    if (b_hiqual) glDisable(GL_POLYGON_SMOOTH);
   }
 #endif  // ocpnUSE_GL
 }
@@ -1336,6 +1129,17 @@ void piDC::StrokeSector(wxCoord xc, wxCoord yc, wxCoord x1, wxCoord y1,
 }
 
 void piDC::DrawRectangle(wxCoord x, wxCoord y, wxCoord w, wxCoord h) {
+#ifdef ocpnUSE_GL
+  if (!dc && (CanBatchPen() || m_raster)) {
+    float corners[8] = {(float)x,       (float)y,
+                        (float)(x + w), (float)y,
+                        (float)(x + w), (float)(y + h),
+                        (float)x,       (float)(y + h)};
+    BatchShape(corners, 4, false);
+    return;
+  }
+#endif
+
   if (dc) dc->DrawRectangle(x, y, w, h);
 #ifdef ocpnUSE_GL
   else {
@@ -1437,11 +1241,29 @@ void piDC::DrawRoundedRectangle(wxCoord x, wxCoord y, wxCoord w, wxCoord h,
   if (dc) dc->DrawRoundedRectangle(x, y, w, h, r);
 #ifdef ocpnUSE_GL
   else {
+    FlushBatch();
+
     r++;
     int steps = ceil(sqrt((float)r));
 
     wxCoord x1 = x + r, x2 = x + w - r;
     wxCoord y1 = y + r, y2 = y + h - r;
+
+    if (m_raster) {
+      size_t len = 8 * ((size_t)steps + 1);
+      if (workBufSize < len) {
+        workBuf = (float *)realloc(workBuf, len * sizeof(float));
+        workBufSize = len;
+      }
+      workBufIndex = 0;
+
+      drawrrhelperGLES2(x2, y1, r, 0, steps);
+      drawrrhelperGLES2(x1, y1, r, 1, steps);
+      drawrrhelperGLES2(x1, y2, r, 2, steps);
+      drawrrhelperGLES2(x2, y2, r, 3, steps);
+      BatchShape(workBuf, workBufIndex / 2, false);
+      return;
+    }
 #ifdef USE_ANDROID_GLES2
     //  Grow the work buffer as necessary
     size_t bufReq = steps * 8 * 2 * sizeof(float);  // large, to be sure
@@ -1459,11 +1281,11 @@ void piDC::DrawRoundedRectangle(wxCoord x, wxCoord y, wxCoord w, wxCoord h,
 
     GLint program = pi_color_tri_shader_program;
     checkGlError("Before glUseProgram", "piDC", __LINE__);
-    glUseProgram(program);
+    pi_useProgram(program);
     checkGlError("After glUseProgram", "piDC", __LINE__);
 
     // Get pointers to the attributes in the program.
-    GLint mPosAttrib = glGetAttribLocation(program, "position");
+    GLint mPosAttrib = pi_getShader(program).position;
 
     // Disable VBO's (vertex buffer objects) for attributes.
     glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -1480,8 +1302,7 @@ void piDC::DrawRoundedRectangle(wxCoord x, wxCoord y, wxCoord w, wxCoord h,
     bcolorv[2] = m_brush.GetColour().Blue() / float(256);
     bcolorv[3] = m_brush.GetColour().Alpha() / float(256);
 
-    GLint bcolloc = glGetUniformLocation(program, "color");
-    glUniform4fv(bcolloc, 1, bcolorv);
+    pi_setColor(program, bcolorv);
 
     float angle = 0.;
     float xoffset = 0;
@@ -1496,18 +1317,16 @@ void piDC::DrawRoundedRectangle(wxCoord x, wxCoord y, wxCoord w, wxCoord h,
     Q[3][0] = xoffset;
     Q[3][1] = yoffset;
 
-    GLint matloc = glGetUniformLocation(program, "TransformMatrix");
-    glUniformMatrix4fv(matloc, 1, GL_FALSE, (const GLfloat *)Q);
+    pi_setTransform(program, (const GLfloat *)Q);
 
     // Perform the actual drawing.
-    glDrawArrays(GL_TRIANGLE_FAN, 0, workBufIndex / 2);
+    pi_drawArrays(GL_TRIANGLE_FAN, 0, workBufIndex / 2);
 
     // Restore the per-object transform to Identity Matrix
     mat4x4 IM;
     mat4x4_identity(IM);
-    GLint matlocf = glGetUniformLocation(program, "TransformMatrix");
-    glUniformMatrix4fv(matlocf, 1, GL_FALSE, (const GLfloat *)IM);
-    glUseProgram(0);
+    pi_setTransform(program, (const GLfloat *)IM);
+    pi_useProgram(0);
 
 #else
 
@@ -1533,11 +1352,71 @@ void piDC::DrawRoundedRectangle(wxCoord x, wxCoord y, wxCoord w, wxCoord h,
 #endif  // ocpnUSE_GL
 }
 
+// Circles and ellipses are drawn from shared tables of unit circle points.
+// The step count is rounded up to a multiple of CIRCLE_STEP_QUANTUM, so a
+// few tables serve all radii.
+#define CIRCLE_STEP_QUANTUM 8
+#define CIRCLE_MAX_STEPS 1024
+
+/* Number of steps for a smooth ellipse of size w x h, as a table level. */
+static int CircleSteps(float w, float h) {
+  /* formula for variable step count to produce smooth ellipse */
+  float steps = floorf(wxMax(sqrtf(sqrtf(w * w + h * h)), 1) * M_PI);
+  int level = (int)ceilf(steps / CIRCLE_STEP_QUANTUM) * CIRCLE_STEP_QUANTUM;
+  return wxMin(wxMax(level, CIRCLE_STEP_QUANTUM), CIRCLE_MAX_STEPS);
+}
+
+/* The steps + 1 points of the unit circle, as sin,cos pairs of the angles
+ * 2 * pi * i / steps, the last point repeating the first. steps comes from
+ * CircleSteps().
+ */
+static const float *UnitCircle(int steps) {
+  static std::vector<float> s_tables[CIRCLE_MAX_STEPS / CIRCLE_STEP_QUANTUM];
+
+  std::vector<float> &table = s_tables[steps / CIRCLE_STEP_QUANTUM - 1];
+  if (table.empty()) {
+    table.resize(2 * (steps + 1));
+    for (int i = 0; i < steps; i++) {
+      double a = 2 * M_PI * i / steps;
+      table[2 * i] = sin(a);
+      table[2 * i + 1] = cos(a);
+    }
+    table[2 * steps] = table[0];
+    table[2 * steps + 1] = table[1];
+  }
+  return &table[0];
+}
+
+/* Appends a ring of radius r around x,y to points, in the direction of
+ * increasing angle if forward, and returns its number of points.
+ */
+static int AddRing(std::vector<wxPoint> &points, wxCoord x, wxCoord y,
+                   wxCoord r, bool forward) {
+  int steps = CircleSteps(2 * r, 2 * r);
+  const float *circle = UnitCircle(steps);
+  for (int i = 0; i < steps; i++) {
+    const float *p = circle + 2 * (forward ? i : (steps - i) % steps);
+    points.push_back(wxPoint(x + r * p[0], y + r * p[1]));
+  }
+  return steps;
+}
+
+/* Fills points with the two rings of a disk, npoints with their sizes. */
+static wxPoint *DiskPoints(std::vector<wxPoint> &points, wxCoord x, wxCoord y,
+                           wxCoord innerRadius, wxCoord outerRadius,
+                           int npoints[2]) {
+  points.clear();
+  npoints[0] = AddRing(points, x, y, innerRadius, true);
+  npoints[1] = AddRing(points, x, y, outerRadius, false);
+  return &points[0];
+}
+
 void piDC::DrawCircle(wxCoord x, wxCoord y, wxCoord radius) {
 #ifdef USE_ANDROID_GLES2
+  FlushBatch();
 
   //      Enable anti-aliased lines, at best quality
-  glEnable(GL_BLEND);
+  pi_setEnabled(GL_BLEND, true);
 
   float coords[8];
   coords[0] = x - radius;
@@ -1551,11 +1430,11 @@ void piDC::DrawCircle(wxCoord x, wxCoord y, wxCoord radius) {
 
   GLint program = pi_circle_filled_shader_program;
   checkGlError("Before glUseProgram", "piDC", __LINE__);
-  glUseProgram(program);
+  pi_useProgram(program);
   checkGlError("After glUseProgram", "piDC", __LINE__);
 
   // Get pointers to the attributes in the program.
-  GLint mPosAttrib = glGetAttribLocation(program, "aPos");
+  GLint mPosAttrib = pi_getShader(program).position;
 
   // Disable VBO's (vertex buffer objects) for attributes.
   glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -1566,11 +1445,11 @@ void piDC::DrawCircle(wxCoord x, wxCoord y, wxCoord radius) {
   glEnableVertexAttribArray(mPosAttrib);
 
   //  Circle radius
-  GLint radiusloc = glGetUniformLocation(program, "circle_radius");
+  GLint radiusloc = pi_getShader(program).circleRadius;
   glUniform1f(radiusloc, radius);
 
   //  Circle center point
-  GLint centerloc = glGetUniformLocation(program, "circle_center");
+  GLint centerloc = pi_getShader(program).circleCenter;
   float ctrv[2];
   ctrv[0] = x;
   ctrv[1] = GetCanvasByIndex(0)->GetSize().y - y;
@@ -1583,7 +1462,7 @@ void piDC::DrawCircle(wxCoord x, wxCoord y, wxCoord radius) {
   colorv[2] = m_brush.GetColour().Blue() / float(256);
   colorv[3] = (m_brush.GetStyle() == wxBRUSHSTYLE_TRANSPARENT) ? 0.0 : 1.0;
 
-  GLint colloc = glGetUniformLocation(program, "circle_color");
+  GLint colloc = pi_getShader(program).circleColor;
   glUniform4fv(colloc, 1, colorv);
 
   //  Border color
@@ -1593,19 +1472,19 @@ void piDC::DrawCircle(wxCoord x, wxCoord y, wxCoord radius) {
   bcolorv[2] = m_pen.GetColour().Blue() / float(256);
   bcolorv[3] = m_pen.GetColour().Alpha() / float(256);
 
-  GLint bcolloc = glGetUniformLocation(program, "border_color");
+  GLint bcolloc = pi_getShader(program).borderColor;
   glUniform4fv(bcolloc, 1, bcolorv);
 
   //  Border Width
-  GLint borderWidthloc = glGetUniformLocation(program, "border_width");
+  GLint borderWidthloc = pi_getShader(program).borderWidth;
   glUniform1f(borderWidthloc, m_pen.GetWidth());
 
   // Perform the actual drawing.
-  glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+  pi_drawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
   //      Enable anti-aliased lines, at best quality
-  glDisable(GL_BLEND);
-  glUseProgram(0);
+  pi_setEnabled(GL_BLEND, false);
+  pi_useProgram(0);
 
 #else
   DrawEllipse(x - radius, y - radius, 2 * radius, 2 * radius);
@@ -1634,65 +1513,25 @@ void piDC::DrawDisk(wxCoord x, wxCoord y, wxCoord innerRadius,
     }
 #else
     wxDC *wxDC = GetDC();
-    float innerSteps = floorf(
-        wxMax(sqrtf(sqrtf(((innerRadius * 2) * (innerRadius * 2)) * 2)), 1) *
-        M_PI);
-    float outerSteps = floorf(
-        wxMax(sqrtf(sqrtf(((outerRadius * 2) * (outerRadius * 2)) * 2)), 1) *
-        M_PI);
-    wxPoint *disk = new wxPoint[(int)innerSteps + (int)outerSteps + 2];
-    float a = 0.;
-    for (int i = 0; i < (int)innerSteps; i++) {
-      disk[i].x = x + innerRadius * sinf(a);
-      disk[i].y = y + innerRadius * cosf(a);
-      a += 2 * M_PI / innerSteps;
-    }
-    // a = 0;
-    for (int i = 0; i < (int)outerSteps; i++) {
-      disk[i + (int)innerSteps].x = x + outerRadius * sinf(a);
-      disk[i + (int)innerSteps].y = y + outerRadius * cosf(a);
-      a -= 2 * M_PI / outerSteps;
-    }
     int npoints[2];
-    npoints[0] = (int)innerSteps;
-    npoints[1] = (int)outerSteps;
+    wxPoint *disk =
+        DiskPoints(m_shapePoints, x, y, innerRadius, outerRadius, npoints);
     wxDC->DrawPolyPolygon(2, npoints, disk, 0, 0);
-    delete[] disk;
 #endif
   }
 #ifdef ocpnUSE_GL
   else {
 
-    if (g_textureId >= 0) {
+    if (g_textureId >= 0 && !m_raster) {
       DrawDiskPattern(x, y, innerRadius, outerRadius, g_textureId,
                       wxSize(g_iTextureWidth, g_iTextureHeight));
       return;
     }
 
-    float innerSteps = floorf(
-        wxMax(sqrtf(sqrtf(((innerRadius * 2) * (innerRadius * 2)) * 2)), 1) *
-        M_PI);
-    float outerSteps = floorf(
-        wxMax(sqrtf(sqrtf(((outerRadius * 2) * (outerRadius * 2)) * 2)), 1) *
-        M_PI);
-    wxPoint *disk = new wxPoint[(int)innerSteps + (int)outerSteps + 2];
-    float a = 0.;
-    for (int i = 0; i < (int)innerSteps; i++) {
-      disk[i].x = x + innerRadius * sinf(a);
-      disk[i].y = y + innerRadius * cosf(a);
-      a += 2 * M_PI / innerSteps;
-    }
-    // a = 0;
-    for (int i = 0; i < (int)outerSteps; i++) {
-      disk[i + (int)innerSteps].x = x + outerRadius * sinf(a);
-      disk[i + (int)innerSteps].y = y + outerRadius * cosf(a);
-      a -= 2 * M_PI / outerSteps;
-    }
     int npoints[2];
-    npoints[0] = (int)innerSteps;
-    npoints[1] = (int)outerSteps;
+    wxPoint *disk =
+        DiskPoints(m_shapePoints, x, y, innerRadius, outerRadius, npoints);
     DrawPolygonsTessellated(2, npoints, disk, 0, 0);
-    delete[] disk;
   }
 #endif  // ocpnUSE_GL
 }
@@ -1705,32 +1544,10 @@ void piDC::DrawDiskPattern(wxCoord x, wxCoord y, wxCoord innerRadius,
   }
 #ifdef ocpnUSE_GL
   else {
-    // float steps = floorf(wxMax(sqrtf(sqrtf((float)(width*width +
-    // height*height))), 1) * M_PI);
-    float innerSteps = floorf(
-        wxMax(sqrtf(sqrtf(((innerRadius * 2) * (innerRadius * 2)) * 2)), 1) *
-        M_PI);
-    float outerSteps = floorf(
-        wxMax(sqrtf(sqrtf(((outerRadius * 2) * (outerRadius * 2)) * 2)), 1) *
-        M_PI);
-    wxPoint *disk = new wxPoint[(int)innerSteps + (int)outerSteps + 2];
-    float a = 0.;
-    for (int i = 0; i < (int)innerSteps; i++) {
-      disk[i].x = x + innerRadius * sinf(a);
-      disk[i].y = y + innerRadius * cosf(a);
-      a += 2 * M_PI / innerSteps;
-    }
-    // a = 0;
-    for (int i = 0; i < (int)outerSteps; i++) {
-      disk[i + (int)innerSteps].x = x + outerRadius * sinf(a);
-      disk[i + (int)innerSteps].y = y + outerRadius * cosf(a);
-      a -= 2 * M_PI / outerSteps;
-    }
     int npoints[2];
-    npoints[0] = (int)innerSteps;
-    npoints[1] = (int)outerSteps;
+    wxPoint *disk =
+        DiskPoints(m_shapePoints, x, y, innerRadius, outerRadius, npoints);
     DrawPolygonsPattern(2, npoints, disk, textureID, textureSize, 0, 0);
-    delete[] disk;
   }
 #endif  // ocpnUSE_GL
 }
@@ -1760,36 +1577,46 @@ void piDC::DrawEllipse(wxCoord x, wxCoord y, wxCoord width, wxCoord height) {
     float r1 = width / 2, r2 = height / 2;
     float cx = x + r1, cy = y + r2;
 
-    //      Enable anti-aliased lines, at best quality
-    glEnable(GL_BLEND);
+    int steps = CircleSteps(width, height);
+    const float *circle = UnitCircle(steps);
 
-    /* formula for variable step count to produce smooth ellipse */
-    float steps = floorf(
-        wxMax(sqrtf(sqrtf((float)(width * width + height * height))), 1) *
-        M_PI);
-#ifndef USE_ANDROID_GLES2
-    if (ConfigureBrush()) {
-      glBegin(GL_TRIANGLE_FAN);
-      glVertex2f(cx, cy);
-      for (float a = 0; a <= 2 * M_PI + M_PI / steps; a += 2 * M_PI / steps)
-        glVertex2f(cx + r1 * sinf(a), cy + r2 * cosf(a));
-      glEnd();
+    //  Grow the work buffer as necessary
+    size_t len = 2 * ((size_t)steps + 2);
+    if (workBufSize < len) {
+      workBuf = (float *)realloc(workBuf, len * sizeof(float));
+      workBufSize = len;
+    }
+
+    // The center, then the closed outline: the fill is a fan of all the
+    // points, the outline a strip of all but the first
+    workBuf[0] = cx;
+    workBuf[1] = cy;
+    for (int i = 0; i <= steps; i++) {
+      workBuf[2 * i + 2] = cx + r1 * circle[2 * i];
+      workBuf[2 * i + 3] = cy + r2 * circle[2 * i + 1];
+    }
+
+    if (CanBatchPen() || m_raster) {
+      piDrawState state;
+      if (GetBrushState(state, true))
+        m_batch.AddTriangleFan(state, workBuf, steps + 2);
+      BatchLines(workBuf + 2, steps, true, true);
+      return;
     }
+    FlushBatch();
 
-    if (ConfigurePen()) {
-      glBegin(GL_LINE_STRIP);
-      float a;
-      for (a = 0; a < 2 * M_PI - M_PI / steps; a += 2 * M_PI / steps)
-        glVertex2f(cx + r1 * sinf(a), cy + r2 * cosf(a));
-      glVertex2f(
-          cx + r1 * sinf(a),
-          cy + r2 * cosf(a));  // added to ensure line is closed and no holes
-                               // are shown when not using solid line
-      glEnd();
-    }
+    //      Enable anti-aliased lines, at best quality
+    pi_setEnabled(GL_BLEND, true);
+
+#ifndef USE_ANDROID_GLES2
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, GL_FLOAT, 2 * sizeof(float), workBuf);
+    if (ConfigureBrush()) pi_drawArrays(GL_TRIANGLE_FAN, 0, steps + 2);
+    if (ConfigurePen()) pi_drawArrays(GL_LINE_STRIP, 1, steps + 1);
+    glDisableClientState(GL_VERTEX_ARRAY);
 #else
 #endif
-    glDisable(GL_BLEND);
+    pi_setEnabled(GL_BLEND, false);
   }
 #endif  // ocpnUSE_GL
 }
@@ -1799,6 +1626,20 @@ void piDC::DrawPolygon(int n, wxPoint points[], wxCoord xoffset,
   if (dc) dc->DrawPolygon(n, points, xoffset, yoffset);
 #ifdef ocpnUSE_GL
   else {
+    if (m_simplify && scale == 1.0f && angle == 0.0f) {
+      SetSimplifyClip(xoffset, yoffset);
+      n = m_simplifier.SimplifyPolygon(n, points);
+      if (n < 3) return;
+      points = m_simplifier.GetPoints();
+    }
+
+    if (m_raster) {
+      RasterPolygon(n, points, xoffset, yoffset, scale, angle);
+      return;
+    }
+
+    FlushBatch();
+
 #ifdef __WXQT__
     SetGLAttrs(false);  // Some QT platforms (Android) have trouble with
                         // GL_BLEND / GL_LINE_SMOOTH
@@ -1815,9 +1656,27 @@ void piDC::DrawPolygon(int n, wxPoint points[], wxCoord xoffset,
 
 #ifdef USE_ANDROID_GLES2
 
+    if (n > 4 && CanBatchPen()) {
+      DrawPolygonTessellated(n, points, xoffset, yoffset);
+
+      piDrawState state;
+      if (GetPenState(state, true)) {
+        float *v = m_batch.Append(state, 2 * n);
+        for (int i = 0; i < n; i++) {
+          int j = (i + 1) % n;
+          *v++ = points[i].x * scale;
+          *v++ = points[i].y * scale;
+          *v++ = points[j].x * scale;
+          *v++ = points[j].y * scale;
+        }
+      }
+      SetGLAttrs(false);
+      return;
+    }
+
     ConfigurePen();
 
-    glEnable(GL_BLEND);
+    pi_setEnabled(GL_BLEND, true);
     if (n > 4) {
       if (ConfigureBrush()) {  // Check for transparent brush
         DrawPolygonTessellated(n, points, xoffset, yoffset);
@@ -1837,12 +1696,12 @@ void piDC::DrawPolygon(int n, wxPoint points[], wxCoord xoffset,
 
       GLint program = pi_color_tri_shader_program;
       checkGlError("Before glUseProgram", "piDC", __LINE__);
-      glUseProgram(program);
+      pi_useProgram(program);
       checkGlError("After glUseProgram", "piDC", __LINE__);
       checkGlError("glUseProgram", "piDC", __LINE__);
 
       // Get pointers to the attributes in the program.
-      GLint mPosAttrib = glGetAttribLocation(program, "position");
+      GLint mPosAttrib = pi_getShader(program).position;
       checkGlError("aPos", "piDC", __LINE__);
 
       // Disable VBO's (vertex buffer objects) for attributes.
@@ -1860,9 +1719,9 @@ void piDC::DrawPolygon(int n, wxPoint points[], wxCoord xoffset,
       bcolorv[2] = m_pen.GetColour().Blue() / float(256);
       bcolorv[3] = m_pen.GetColour().Alpha() / float(256);
 
-      GLint bcolloc = glGetUniformLocation(program, "color");
+      GLint bcolloc = pi_getShader(program).color;
       checkGlError("uColour", "piDC", __LINE__);
-      glUniform4fv(bcolloc, 1, bcolorv);
+      pi_setColor(program, bcolorv);
       if (bcolloc == -1) wxLogMessage(_("piDC::DrawPolygon: bcolloc -1"));
 
 #if 0
@@ -1878,14 +1737,13 @@ void piDC::DrawPolygon(int n, wxPoint points[], wxCoord xoffset,
             mat4x4 X;
             mat4x4_mul(X, (float (*)[4])gFrame->GetPrimaryCanvas()->GetpVP()->vp_transform, Q);
 
-            GLint matloc = glGetUniformLocation(program,"MVMatrix");
-            glUniformMatrix4fv( matloc, 1, GL_FALSE, (const GLfloat*)X );
+            pi_setMVMatrix(program, (const GLfloat*)X);
 #endif
 
       // Perform the actual drawing.
-      glDrawArrays(GL_LINE_LOOP, 0, n);
+      pi_drawArrays(GL_LINE_LOOP, 0, n);
 
-      glUseProgram(0);
+      pi_useProgram(0);
 
     } else {  // n = 3 or 4, most common case for pre-tesselated shapes
 #if 0
@@ -1902,10 +1760,10 @@ void piDC::DrawPolygon(int n, wxPoint points[], wxCoord xoffset,
             }
 
             GLint program = pi_texture_2D_shader_program;
-            glUseProgram( program );
+            pi_useProgram( program );
 
             // Get pointers to the attributes in the program.
-            GLint mPosAttrib = glGetAttribLocation( program, "aPos" );
+            GLint mPosAttrib = pi_getShader(program).position;
 
             // Disable VBO's (vertex buffer objects) for attributes.
             glBindBuffer( GL_ARRAY_BUFFER, 0 );
@@ -1937,11 +1795,10 @@ void piDC::DrawPolygon(int n, wxPoint points[], wxCoord xoffset,
 
             mat4x4 X;
             mat4x4_mul(X, (float (*)[4])gFrame->GetPrimaryCanvas()->GetpVP()->vp_transform, Q);
-            GLint matloc = glGetUniformLocation(program, "MVMatrix");
-            glUniformMatrix4fv( matloc, 1, GL_FALSE, (const GLfloat*)X );
+            pi_setMVMatrix(program, (const GLfloat*)X);
 #endif
             // Perform the actual drawing.
-            glDrawArrays(GL_LINE_LOOP, 0, n);
+            pi_drawArrays(GL_LINE_LOOP, 0, n);
 
             //  Fill color
             bcolorv[0] = m_brush.GetColour().Red() / float(256);
@@ -1961,19 +1818,19 @@ void piDC::DrawPolygon(int n, wxPoint points[], wxCoord xoffset,
                 workBuf[6] = x1;
                 workBuf[7] = y1;
 
-                glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+                pi_drawArrays(GL_TRIANGLE_STRIP, 0, 4);
             }
             else if(n == 3){
-                glDrawArrays(GL_TRIANGLES, 0, 3);
+                pi_drawArrays(GL_TRIANGLES, 0, 3);
             }
 
-            glUseProgram( 0 );
+            pi_useProgram( 0 );
 #endif
       GLint program = pi_color_tri_shader_program;
-      glUseProgram(program);
+      pi_useProgram(program);
 
       // Get pointers to the attributes in the program.
-      GLint mPosAttrib = glGetAttribLocation(program, "position");
+      GLint mPosAttrib = pi_getShader(program).position;
       checkGlError("mPosAttrib", "piDC", __LINE__);
 
       // Disable VBO's (vertex buffer objects) for attributes.
@@ -1991,9 +1848,9 @@ void piDC::DrawPolygon(int n, wxPoint points[], wxCoord xoffset,
       bcolorv[2] = m_pen.GetColour().Blue() / float(256);
       bcolorv[3] = m_pen.GetColour().Alpha() / float(256);
 
-      GLint bcolloc = glGetUniformLocation(program, "color");
+      GLint bcolloc = pi_getShader(program).color;
       checkGlError("uColour", "piDC", __LINE__);
-      glUniform4fv(bcolloc, 1, bcolorv);
+      pi_setColor(program, bcolorv);
 
       // Rotate
       mat4x4 I, Q;
@@ -2004,12 +1861,11 @@ void piDC::DrawPolygon(int n, wxPoint points[], wxCoord xoffset,
       Q[3][0] = xoffset;
       Q[3][1] = yoffset;
 
-      GLint matloc = glGetUniformLocation(program, "TransformMatrix");
       checkGlError("TransformMatrix", "piDC", __LINE__);
-      glUniformMatrix4fv(matloc, 1, GL_FALSE, (const GLfloat *)Q);
+      pi_setTransform(program, (const GLfloat *)Q);
 
       // Perform the actual drawing.
-      glDrawArrays(GL_LINE_LOOP, 0, n);
+      pi_drawArrays(GL_LINE_LOOP, 0, n);
 
       //  Fill color
       bcolorv[0] = m_brush.GetColour().Red() / float(256);
@@ -2020,7 +1876,7 @@ void piDC::DrawPolygon(int n, wxPoint points[], wxCoord xoffset,
       glEnableVertexAttribArray(bcolloc);
       glVertexAttribPointer(bcolloc, 4, GL_FLOAT, GL_FALSE, 2 * sizeof(float),
                             bcolorv);
-      glUniform4fv(bcolloc, 1, bcolorv);
+      pi_setColor(program, bcolorv);
 
       // For the simple common case of a convex rectangle...
       //  swizzle the array points to enable GL_TRIANGLE_STRIP
@@ -2032,18 +1888,17 @@ void piDC::DrawPolygon(int n, wxPoint points[], wxCoord xoffset,
         workBuf[6] = x1;
         workBuf[7] = y1;
 
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        pi_drawArrays(GL_TRIANGLE_STRIP, 0, 4);
       } else if (n == 3) {
-        glDrawArrays(GL_TRIANGLES, 0, 3);
+        pi_drawArrays(GL_TRIANGLES, 0, 3);
       }
 
       // Restore the per-object transform to Identity Matrix
       mat4x4 IM;
       mat4x4_identity(IM);
-      GLint matlocf = glGetUniformLocation(program, "TransformMatrix");
-      glUniformMatrix4fv(matlocf, 1, GL_FALSE, (const GLfloat *)IM);
+      pi_setTransform(program, (const GLfloat *)IM);
 
-      glUseProgram(0);
+      pi_useProgram(0);
     }
 
 #else
@@ -2089,7 +1944,9 @@ void piDC::DrawPolygonPattern(int n, wxPoint points[], int textureID,
                               wxCoord yoffset, float scale, float angle) {
   if (dc) dc->DrawPolygon(n, points, xoffset, yoffset);
 #ifdef ocpnUSE_GL
-  else {
+  else if (!m_raster) {  // there is no GL texture to fill from
+    FlushBatch();
+
 #ifdef __WXQT__
     SetGLAttrs(false);  // Some QT platforms (Android) have trouble with
                         // GL_BLEND / GL_LINE_SMOOTH
@@ -2098,7 +1955,7 @@ void piDC::DrawPolygonPattern(int n, wxPoint points[], int textureID,
 #endif
 
     ConfigurePen();
-    glEnable(GL_BLEND);
+    pi_setEnabled(GL_BLEND, true);
 
     if (n > 3) {
       if (ConfigureBrush()) {  // Check for transparent brush
@@ -2126,27 +1983,27 @@ void piDC::DrawPolygonPattern(int n, wxPoint points[], int textureID,
 
       checkGlError("Before glUseProgram", "piDC", __LINE__);
       GLint program = pi_texture_2DA_shader_program;
-      glUseProgram(program);
+      pi_useProgram(program);
       checkGlError("glUseProgram", "piDC", __LINE__);
 
       // Get pointers to the attributes in the program.
       // Position of vertex(s)
-      GLint mPosAttrib = glGetAttribLocation(program, "aPos");
+      GLint mPosAttrib = pi_getShader(program).position;
       checkGlError("mPosAttrib", "piDC", __LINE__);
       // Texture coordinates
-      GLint mUvAttrib = glGetAttribLocation(program, "aUV");
+      GLint mUvAttrib = pi_getShader(program).uv;
       checkGlError("mUvAttrib", "piDC", __LINE__);
 
       // Rotate
-      GLint uRotateMatrix = glGetUniformLocation(program, "MVMatrix");
+      GLint uRotateMatrix = pi_getShader(program).mvMatrix;
       checkGlError("MVMatrix", "piDC", __LINE__);
 
       // Transform
-      GLint uTranslateMatrix = glGetUniformLocation(program, "TransformMatrix");
+      GLint uTranslateMatrix = pi_getShader(program).transformMatrix;
       checkGlError("TransformMatrix", "piDC", __LINE__);
 
       // Set up the texture sampler to texture unit 0
-      GLint texUni = glGetUniformLocation(program, "uTex");
+      GLint texUni = pi_getShader(program).tex;
       glUniform1i(texUni, 0);
       checkGlError("texUni", "piDC", __LINE__);
 
@@ -2167,9 +2024,7 @@ void piDC::DrawPolygonPattern(int n, wxPoint points[], int textureID,
       bcolorv[2] = m_brush.GetColour().Blue() / float(256);
       bcolorv[3] = m_brush.GetColour().Alpha() / float(256);
 
-      GLint bcolloc = glGetUniformLocation(program, "color");
-      checkGlError("bcolloc", "piDC", __LINE__);
-      glUniform4fv(bcolloc, 1, bcolorv);
+      pi_setColor(program, bcolorv);
       checkGlError("glUniform4fv(bcolloc", "piDC", __LINE__);
 
       // Only a triangle can be convex all the time
@@ -2187,10 +2042,10 @@ void piDC::DrawPolygonPattern(int n, wxPoint points[], int textureID,
         glVertexAttribPointer(mUvAttrib, 2, GL_FLOAT, GL_FALSE,
                               2 * sizeof(GLfloat), UVCoords);
         checkGlError("glVertexAttribPointer", "piDC", __LINE__);
-        glDrawArrays(GL_TRIANGLES, 0, 3);
+        pi_drawArrays(GL_TRIANGLES, 0, 3);
         checkGlError("glDrawArrays(GL_TRIANGLES)", "piDC", __LINE__);
       }
-      glUseProgram(0);
+      pi_useProgram(0);
       checkGlError("glUseProgram(0)", "piDC", __LINE__);
     }
 #else  // USE_ANDROID_GLES2
@@ -2211,86 +2066,51 @@ void piDC::DrawPolygonPattern(int n, wxPoint points[], int textureID,
 
 // GL callbacks
 
-typedef union {
-  GLdouble data[6];
-  struct sGLvertex {
-    GLdouble x;
-    GLdouble y;
-    GLdouble z;
-    GLdouble r;
-    GLdouble g;
-    GLdouble b;
-    GLdouble a;
-  } info;
-} GLvertex;
-
 #ifndef USE_ANDROID_GLES2
 
-#ifdef __WXMAC__
-#ifndef APIENTRY
-#define APIENTRY
-#endif
-#endif
-
-void APIENTRY piDCcombineCallback(GLdouble coords[3], GLdouble *vertex_data[4],
-                                  GLfloat weight[4], GLdouble **dataOut) {
-  GLvertex *vertex;
-
-  vertex = new GLvertex();
-  pi_gTesselatorVertices.Add(vertex);
-
-  vertex->info.x = coords[0];
-  vertex->info.y = coords[1];
-  vertex->info.z = coords[2];
-
-  for (int i = 3; i < 6; i++) {
-    vertex->data[i] =
-        weight[0] * vertex_data[0][i] + weight[1] * vertex_data[1][i];
+// Draw triangles from piTessCache, relative to origin, optionally with the
+// pattern texture coordinates
+static void DrawTessTriangles(const std::vector<float> &triangles,
+                              const wxPoint &origin, bool texcoords) {
+  glBegin(GL_TRIANGLES);
+  for (size_t i = 0; i + 1 < triangles.size(); i += 2) {
+    GLdouble x = triangles[i] + origin.x;
+    GLdouble y = triangles[i + 1] + origin.y;
+    if (texcoords) glTexCoord2d(x / g_iTextureWidth, y / g_iTextureHeight);
+    glVertex2d(x, y);
   }
-
-  *dataOut = &(vertex->data[0]);
-}
-
-void APIENTRY piDCvertexCallback(GLvoid *arg) {
-  GLvertex *vertex;
-  vertex = (GLvertex *)arg;
-  glVertex2f((float)vertex->info.x, (float)vertex->info.y);
+  glEnd();
 }
-
-void APIENTRY piDCerrorCallback(GLenum errorCode) {}
-
-void APIENTRY piDCbeginCallback(GLenum type) { glBegin(type); }
-
-void APIENTRY piDCendCallback() { glEnd(); }
 #endif
 
 // GLSL callbacks
 
 #ifdef USE_ANDROID_GLES2
 
-static std::list<double *> odc_combine_work_data;
 static void odc_combineCallbackD(GLdouble coords[3], GLdouble *vertex_data[4],
                                  GLfloat weight[4], GLdouble **dataOut,
                                  void *data) {
-  //     double *vertex = new double[3];
-  //     odc_combine_work_data.push_back(vertex);
-  //     memcpy(vertex, coords, 3*(sizeof *coords));
-  //     *dataOut = vertex;
-  GLvertex *vertex;
-
-  vertex = new GLvertex();
-  pi_gTesselatorVertices.Add(vertex);
-
-  vertex->info.x = coords[0];
-  vertex->info.y = coords[1];
-  vertex->info.z = coords[2];
-
-  for (int i = 3; i < 6; i++) {
-    vertex->data[i] =
-        weight[0] * vertex_data[0][i] + weight[1] * vertex_data[1][i];
+  piDC *pDC = (piDC *)data;
+  GLdouble *vertex = pDC->s_odc_tess_arena.Alloc(3);
+  vertex[0] = coords[0];
+  vertex[1] = coords[1];
+  vertex[2] = coords[2];
+  *dataOut = vertex;
+}
+
+// Grow the tess work buffers to hold at least len floats
+static bool ReserveTessBuffers(piDC *pDC, int len) {
+  if (len > pDC->s_odc_tess_buf_len) {
+    GLfloat *buf = (GLfloat *)realloc(pDC->s_odc_tess_work_buf,
+                                      len * sizeof(GLfloat));
+    if (buf) pDC->s_odc_tess_work_buf = buf;
+    GLfloat *tex =
+        (GLfloat *)realloc(pDC->s_odc_tess_tex_buf, len * sizeof(GLfloat));
+    if (tex) pDC->s_odc_tess_tex_buf = tex;
+    if (!buf || !tex) return false;
+    pDC->s_odc_tess_buf_len = len;
   }
-
-  *dataOut = &(vertex->data[0]);
+  return true;
 }
 
 void odc_vertexCallbackD_GLSL(GLvoid *vertex, void *data) {
@@ -2328,6 +2148,30 @@ void odc_vertexCallbackD_GLSL(GLvoid *vertex, void *data) {
   pDC->s_odc_nvertex++;
 }
 
+// Load triangles from piTessCache, relative to origin, into the tess work
+// buffers as the GLSL callbacks above would have
+static bool LoadTessTriangles(piDC *pDC, const std::vector<float> &triangles,
+                              const wxPoint &origin) {
+  int len = (int)triangles.size();
+  if (!ReserveTessBuffers(pDC, len)) return false;
+
+  for (int i = 0; i < len; i += 2) {
+    float x = triangles[i] + origin.x;
+    float y = triangles[i + 1] + origin.y;
+    pDC->s_odc_tess_work_buf[i] = x;
+    pDC->s_odc_tess_work_buf[i + 1] = y;
+    pDC->s_odc_tess_tex_buf[i] = (float)((x - g_min_x) / g_iTextureWidth) / 2;
+    pDC->s_odc_tess_tex_buf[i + 1] =
+        (float)((y - g_min_y) / g_iTextureHeight) / 2;
+  }
+
+  pDC->s_odc_tess_vertex_idx = len;
+  pDC->s_odc_tess_vertex_idx_this = 0;
+  pDC->s_odc_tess_mode = GL_TRIANGLES;
+  pDC->s_odc_nvertex = len / 2;
+  return len > 0;
+}
+
 void odc_beginCallbackD_GLSL(GLenum mode, void *data) {
   piDC *pDC = (piDC *)data;
   pDC->s_odc_tess_vertex_idx_this = pDC->s_odc_tess_vertex_idx;
@@ -2339,16 +2183,16 @@ void odc_endCallbackD_GLSL(void *data) {
 #if 0
     piDC* pDC = (piDC*)data;
     float *bufPt = &(pDC->s_odc_tess_work_buf[pDC->s_odc_tess_vertex_idx_this]);
-    GLint pos = glGetAttribLocation(pDC->s_odc_activeProgram, "aPos");
+    GLint pos = pi_getShader(pDC->s_odc_activeProgram).position;
     glVertexAttribPointer(pos, 2, GL_FLOAT, GL_FALSE, 2*sizeof(float), bufPt);
     glEnableVertexAttribArray(pos);
 
-    glDrawArrays(pDC->s_odc_tess_mode, 0, pDC->s_odc_nvertex);
+    pi_drawArrays(pDC->s_odc_tess_mode, 0, pDC->s_odc_nvertex);
 #else
   piDC *pDC = (piDC *)data;
 
   GLint program = pDC->s_odc_activeProgram;
-  glUseProgram(program);
+  pi_useProgram(program);
   checkGlError("glUseProgram", "piDC", __LINE__);
 
   // Disable VBO's (vertex buffer objects) for attributes.
@@ -2356,16 +2200,16 @@ void odc_endCallbackD_GLSL(void *data) {
   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
   float *bufPt = &(pDC->s_odc_tess_work_buf[pDC->s_odc_tess_vertex_idx_this]);
-  GLint pos = glGetAttribLocation(program, "aPos");
+  GLint pos = pi_getShader(program).position;
   checkGlError("aPos", "piDC", __LINE__);
   glVertexAttribPointer(pos, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), bufPt);
   glEnableVertexAttribArray(pos);
 
-  //    GLint matloc = glGetUniformLocation(program, "MVMatrix");
+  //    GLint matloc = pi_getShader(program).mvMatrix;
   //    glUniformMatrix4fv( matloc, 1, GL_FALSE, (const
   //    GLfloat*)s_tessVP.vp_transform);
 
-  GLint mUvAttrib = glGetAttribLocation(program, "aUV");
+  GLint mUvAttrib = pi_getShader(program).uv;
   checkGlError("mUvAttrib", "piDC", __LINE__);
   float *bufTex = &(pDC->s_odc_tess_tex_buf[pDC->s_odc_tess_vertex_idx_this]);
   glVertexAttribPointer(mUvAttrib, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat),
@@ -2383,7 +2227,7 @@ void odc_endCallbackD_GLSL(void *data) {
       GLint colloc = glGetUniformLocation(program, "uColour");
       glUniform4fv(colloc, 1, colorv);
   */
-  glDrawArrays(pDC->s_odc_tess_mode, 0, pDC->s_odc_nvertex);
+  pi_drawArrays(pDC->s_odc_tess_mode, 0, pDC->s_odc_nvertex);
 #endif
 }
 #endif
@@ -2392,6 +2236,22 @@ void odc_endCallbackD_GLSL(void *data) {
 
 void piDC::DrawPolygonTessellated(int n, wxPoint points[], wxCoord xoffset,
                                   wxCoord yoffset) {
+#ifdef ocpnUSE_GL
+  if (!dc && m_batching) {
+    piDrawState state;
+    if (GetBrushState(state, false) && n > 0) {
+      const std::vector<float> &triangles = piTessCache::Get().Tessellate(
+          1, &n, points, GLU_TESS_WINDING_NONZERO);
+      float *v = m_batch.Append(state, triangles.size() / 2);
+      for (size_t i = 0; i + 1 < triangles.size(); i += 2) {
+        *v++ = triangles[i] + points[0].x;
+        *v++ = triangles[i + 1] + points[0].y;
+      }
+    }
+    return;
+  }
+#endif
+
   if (dc) dc->DrawPolygon(n, points, xoffset, yoffset);
 #ifdef ocpnUSE_GL
   else {
@@ -2406,57 +2266,21 @@ void piDC::DrawPolygonTessellated(int n, wxPoint points[], wxCoord xoffset,
 
 #ifdef USE_ANDROID_GLES2
 
-    m_tobj = gluNewTess();
-    s_odc_tess_vertex_idx = 0;
-
-    gluTessCallback(m_tobj, GLU_TESS_VERTEX_DATA,
-                    (_GLUfuncptr)&odc_vertexCallbackD_GLSL);
-    gluTessCallback(m_tobj, GLU_TESS_BEGIN_DATA,
-                    (_GLUfuncptr)&odc_beginCallbackD_GLSL);
-    gluTessCallback(m_tobj, GLU_TESS_END_DATA,
-                    (_GLUfuncptr)&odc_endCallbackD_GLSL);
-    gluTessCallback(m_tobj, GLU_TESS_COMBINE_DATA,
-                    (_GLUfuncptr)&odc_combineCallbackD);
-    // s_tessVP = vp;
-
-    gluTessNormal(m_tobj, 0, 0, 1);
-    gluTessProperty(m_tobj, GLU_TESS_WINDING_RULE, GLU_TESS_WINDING_NONZERO);
-
-    if (ConfigureBrush()) {
-      gluTessBeginPolygon(m_tobj, this);
-      gluTessBeginContour(m_tobj);
-
-      /*            for( int i = 0; i < n; i++ ) {
-                      double *p = new double[6];
-                      p[0] = points[i].x, p[1] = points[i].y, p[2] = 0;
-                      gluTessVertex(m_tobj, p, p);
-                  }
-      */
-      for (int i = 0; i < n; i++) {
-        GLvertex *vertex = new GLvertex();
-        pi_gTesselatorVertices.Add(vertex);
-        vertex->info.x = (GLdouble)points[i].x;
-        vertex->info.y = (GLdouble)points[i].y;
-        vertex->info.z = (GLdouble)0.0;
-        vertex->info.r = (GLdouble)0.0;
-        vertex->info.g = (GLdouble)0.0;
-        vertex->info.b = (GLdouble)0.0;
-        gluTessVertex(m_tobj, (GLdouble *)vertex, (GLdouble *)vertex);
-      }
-
-      gluTessEndContour(m_tobj);
-      gluTessEndPolygon(m_tobj);
-
+    if (ConfigureBrush() && n > 0 &&
+        LoadTessTriangles(this,
+                          piTessCache::Get().Tessellate(
+                              1, &n, points, GLU_TESS_WINDING_NONZERO),
+                          points[0])) {
       GLint program = pi_color_tri_shader_program;
       // GLint program = pi_texture_2D_shader_program;
-      glUseProgram(program);
+      pi_useProgram(program);
 
       // Disable VBO's (vertex buffer objects) for attributes.
       glBindBuffer(GL_ARRAY_BUFFER, 0);
       glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
       float *bufPt = &(s_odc_tess_work_buf[s_odc_tess_vertex_idx_this]);
-      GLint pos = glGetAttribLocation(program, "position");
+      GLint pos = pi_getShader(program).position;
       glVertexAttribPointer(pos, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float),
                             bufPt);
       glEnableVertexAttribArray(pos);
@@ -2467,126 +2291,48 @@ void piDC::DrawPolygonTessellated(int n, wxPoint points[], wxCoord xoffset,
       colorv[1] = c.Green() / float(256);
       colorv[2] = c.Blue() / float(256);
       colorv[3] = c.Alpha() / float(256);
-      GLint colloc = glGetUniformLocation(program, "color");
-      glUniform4fv(colloc, 1, colorv);
+      pi_setColor(program, colorv);
 
-      glDrawArrays(s_odc_tess_mode, 0, s_odc_nvertex);
+      pi_drawArrays(s_odc_tess_mode, 0, s_odc_nvertex);
     }
 
-    gluDeleteTess(m_tobj);
-    m_tobj = NULL;
-    glUseProgram(0);
-
-    for (std::list<double *>::iterator i = odc_combine_work_data.begin();
-         i != odc_combine_work_data.end(); ++i)
-      delete[] * i;
-    odc_combine_work_data.clear();
+    pi_useProgram(0);
   }
 #else  // USE_ANDROID_GLES2
 
-    m_tobj = gluNewTess();
-
-    gluTessCallback(m_tobj, GLU_TESS_VERTEX, (_GLUfuncptr)&piDCvertexCallback);
-    gluTessCallback(m_tobj, GLU_TESS_BEGIN, (_GLUfuncptr)&piDCbeginCallback);
-    gluTessCallback(m_tobj, GLU_TESS_END, (_GLUfuncptr)&piDCendCallback);
-    gluTessCallback(m_tobj, GLU_TESS_COMBINE,
-                    (_GLUfuncptr)&piDCcombineCallback);
-    gluTessCallback(m_tobj, GLU_TESS_ERROR, (_GLUfuncptr)&piDCerrorCallback);
-
-    gluTessNormal(m_tobj, 0, 0, 1);
-    gluTessProperty(m_tobj, GLU_TESS_WINDING_RULE, GLU_TESS_WINDING_NONZERO);
-
-    if (ConfigureBrush()) {
-      gluTessBeginPolygon(m_tobj, NULL);
-      gluTessBeginContour(m_tobj);
-
-      for (int i = 0; i < n; i++) {
-        GLvertex *vertex = new GLvertex();
-        pi_gTesselatorVertices.Add(vertex);
-        vertex->info.x = (GLdouble)points[i].x;
-        vertex->info.y = (GLdouble)points[i].y;
-        vertex->info.z = (GLdouble)0.0;
-        vertex->info.r = (GLdouble)0.0;
-        vertex->info.g = (GLdouble)0.0;
-        vertex->info.b = (GLdouble)0.0;
-        gluTessVertex(m_tobj, (GLdouble *)vertex, (GLdouble *)vertex);
-      }
-      gluTessEndContour(m_tobj);
-      gluTessEndPolygon(m_tobj);
+    if (ConfigureBrush() && n > 0) {
+      DrawTessTriangles(piTessCache::Get().Tessellate(
+                            1, &n, points, GLU_TESS_WINDING_NONZERO),
+                        points[0], false);
     }
-
-    for (unsigned int i = 0; i < pi_gTesselatorVertices.Count(); i++)
-      delete (GLvertex *)pi_gTesselatorVertices[i];
-    pi_gTesselatorVertices.Clear();
-
-    gluDeleteTess(m_tobj);
-    m_tobj = NULL;
   }
 #endif
 #endif  // ocpnUSE_GL
 }
 
-#ifdef ocpnUSE_GL
-#ifndef __ANDROID__
-
-void __CALL_CONVENTION piDCPatterncombineCallback(GLdouble coords[3],
-                                                  GLdouble *vertex_data[4],
-                                                  GLfloat weight[4],
-                                                  GLdouble **dataOut) {
-  GLvertex *vertex;
-
-  vertex = new GLvertex();
-  pi_gTesselatorVertices.Add(vertex);
-
-  vertex->info.x = coords[0];
-  vertex->info.y = coords[1];
-  vertex->info.z = coords[2];
-
-  for (int i = 3; i < 6; i++) {
-    vertex->data[i] =
-        weight[0] * vertex_data[0][i] + weight[1] * vertex_data[1][i];
-  }
-
-  *dataOut = &(vertex->data[0]);
-}
-
-void __CALL_CONVENTION piDCPatternvertexCallback(GLvoid *arg) {
-  GLvertex *vertex;
-  vertex = (GLvertex *)arg;
-  glTexCoord2d(vertex->info.x / g_iTextureWidth,
-               vertex->info.y / g_iTextureHeight);
-  glVertex2d(vertex->info.x, vertex->info.y);
-}
-
-void __CALL_CONVENTION piDCPatternerrorCallback(GLenum errorCode) {}
-
-void __CALL_CONVENTION piDCPatternbeginCallback(GLenum type) { glBegin(type); }
-
-void __CALL_CONVENTION piDCPatternendCallback() { glEnd(); }
-#endif
-#endif  // ocpnUSE_GL
-
 void piDC::DrawPolygonTessellatedPattern(int n, wxPoint points[], int textureID,
                                          wxSize textureSize, wxCoord xoffset,
                                          wxCoord yoffset) {
   if (dc) dc->DrawPolygon(n, points, xoffset, yoffset);
 #ifdef ocpnUSE_GL
-  else {
+  else if (!m_raster) {  // there is no GL texture to fill from
     if (n < 3) return;
 
+    FlushBatch();
+
 #ifdef USE_ANDROID_GLES2
       // Pre-configure the GLES program
 //
 #if 0
         //GLint program = pi_color_tri_shader_program;
         GLint program = pi_texture_2D_shader_program;
-        glUseProgram( program );
+        pi_useProgram( program );
 
         // Get pointers to the attributes in the program.
         // Position of vertex(s)
-        //GLint mPosAttrib = glGetAttribLocation( program, "aPos" );
+        //GLint mPosAttrib = pi_getShader(program).position;
         // Texture coordinates
-        GLint mUvAttrib  = glGetAttribLocation( program, "aUV" );
+        GLint mUvAttrib  = pi_getShader(program).uv;
 
         // Set up the texture sampler to texture unit 0
         GLint texUni = glGetUniformLocation( program, "uTexture" );
@@ -2618,7 +2364,7 @@ void piDC::DrawPolygonTessellatedPattern(int n, wxPoint points[], int textureID,
     // GLint program = pi_colorv_tri_shader_program;
     GLint program = pi_texture_2DA_shader_program;
     s_odc_activeProgram = program;
-    glUseProgram(program);
+    pi_useProgram(program);
     checkGlError("glUseProgram", "piDC", __LINE__);
 
     // Disable VBO's (vertex buffer objects) for attributes.
@@ -2628,13 +2374,13 @@ void piDC::DrawPolygonTessellatedPattern(int n, wxPoint points[], int textureID,
     checkGlError("glBindBuffer", "piDC", __LINE__);
 
     GLfloat *bufPt = &(s_odc_tess_work_buf[s_odc_tess_vertex_idx_this]);
-    GLint mPosAttrib = glGetAttribLocation(program, "aPos");
+    GLint mPosAttrib = pi_getShader(program).position;
     checkGlError("mPosAttrib", "piDC", __LINE__);
 
-    GLint mUvAttrib = glGetAttribLocation(program, "aUV");
+    GLint mUvAttrib = pi_getShader(program).uv;
     checkGlError("mUvAttrib", "piDC", __LINE__);
-    // GLint projection = glGetAttribLocation(program, "MVMatrix");
-    // GLint modelView = glGetAttribLocation(program, "TransformMatrix");
+    // GLint projection = pi_getShader(program).mvMatrix;
+    // GLint modelView = pi_getShader(program).transformMatrix;
     glVertexAttribPointer(mPosAttrib, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float),
                           bufPt);
     checkGlError("glVertexAttribPointer", "piDC", __LINE__);
@@ -2646,7 +2392,7 @@ void piDC::DrawPolygonTessellatedPattern(int n, wxPoint points[], int textureID,
     checkGlError("glBindTexture", "piDC", __LINE__);
 
     // Set up the texture sampler to texture unit 0
-    GLint texUni = glGetUniformLocation(program, "uTex");
+    GLint texUni = pi_getShader(program).tex;
     checkGlError("texUni", "piDC", __LINE__);
     glUniform1i(texUni, 0);
     checkGlError("texUni", "piDC", __LINE__);
@@ -2668,50 +2414,21 @@ void piDC::DrawPolygonTessellatedPattern(int n, wxPoint points[], int textureID,
     bcolorv[1] = m_brush.GetColour().Green() / float(256);
     bcolorv[2] = m_brush.GetColour().Blue() / float(256);
     bcolorv[3] = m_brush.GetColour().Alpha() / float(256);
-    GLint bcolloc = glGetUniformLocation(program, "color");
     checkGlError("bcoloc", "piDC", __LINE__);
-    glUniform4fv(bcolloc, 1, bcolorv);
+    pi_setColor(program, bcolorv);
 #endif
     // Tesselate
-    m_tobj = gluNewTess();
-    s_odc_tess_vertex_idx = 0;
-
-    gluTessCallback(m_tobj, GLU_TESS_VERTEX_DATA,
-                    (_GLUfuncptr)&odc_vertexCallbackD_GLSL);
-    gluTessCallback(m_tobj, GLU_TESS_BEGIN_DATA,
-                    (_GLUfuncptr)&odc_beginCallbackD_GLSL);
-    gluTessCallback(m_tobj, GLU_TESS_END_DATA,
-                    (_GLUfuncptr)&odc_endCallbackD_GLSL);
-    gluTessCallback(m_tobj, GLU_TESS_COMBINE_DATA,
-                    (_GLUfuncptr)&odc_combineCallbackD);
-    // s_tessVP = vp;
-
-    gluTessNormal(m_tobj, 0, 0, 1);
-    gluTessProperty(m_tobj, GLU_TESS_WINDING_RULE, GLU_TESS_WINDING_NONZERO);
-
-    if (ConfigureBrush()) {
-      gluTessBeginPolygon(m_tobj, this);
-      gluTessBeginContour(m_tobj);
-
-      for (int i = 0; i < n; i++) {
-        GLvertex *vertex = new GLvertex();
-        pi_gTesselatorVertices.Add(vertex);
-        vertex->info.x = (GLdouble)points[i].x;
-        vertex->info.y = (GLdouble)points[i].y;
-        vertex->info.z = (GLdouble)0.0;
-        vertex->info.r = (GLdouble)0.0;
-        vertex->info.g = (GLdouble)0.0;
-        vertex->info.b = (GLdouble)0.0;
-        gluTessVertex(m_tobj, (GLdouble *)vertex, (GLdouble *)vertex);
-      }
-      gluTessEndContour(m_tobj);
-      gluTessEndPolygon(m_tobj);
-    }
+    if (ConfigureBrush() &&
+        LoadTessTriangles(this,
+                          piTessCache::Get().Tessellate(
+                              1, &n, points, GLU_TESS_WINDING_NONZERO),
+                          points[0]))
+      odc_endCallbackD_GLSL(this);
 
 #if 0
         //      Render the tesselated results
         GLint program = pi_colorv_tri_shader_program;
-        glUseProgram( program );
+        pi_useProgram( program );
 
 
         // Disable VBO's (vertex buffer objects) for attributes.
@@ -2720,7 +2437,7 @@ void piDC::DrawPolygonTessellatedPattern(int n, wxPoint points[], int textureID,
 
 
         float *bufPt = &(s_odc_tess_work_buf[s_odc_tess_vertex_idx_this]);
-        GLint pos = glGetAttribLocation(program, "position");
+        GLint pos = pi_getShader(program).position;
         glVertexAttribPointer(pos, 2, GL_FLOAT, GL_FALSE, 2*sizeof(float), bufPt);
         glEnableVertexAttribArray(pos);
 
@@ -2744,72 +2461,28 @@ void piDC::DrawPolygonTessellatedPattern(int n, wxPoint points[], int textureID,
 
         //  Pattern color
         float bcolorv[4];
-        GLint bcolloc = glGetUniformLocation(program,"color");
         bcolorv[0] = m_brush.GetColour().Red() / float(256);
         bcolorv[1] = m_brush.GetColour().Green() / float(256);
         bcolorv[2] = m_brush.GetColour().Blue() / float(256);
         bcolorv[3] = m_brush.GetColour().Alpha() / float(256);
-        glUniform4fv(bcolloc, 1, bcolorv);
+        pi_setColor(program, bcolorv);
 
-        glDrawArrays(s_odc_tess_mode, 0, s_odc_nvertex);
+        pi_drawArrays(s_odc_tess_mode, 0, s_odc_nvertex);
 #endif
-    glDrawArrays(s_odc_tess_mode, 0, s_odc_nvertex);
-
-    gluDeleteTess(m_tobj);
-    m_tobj = NULL;
+    pi_drawArrays(s_odc_tess_mode, 0, s_odc_nvertex);
 
-    for (std::list<double *>::iterator i = odc_combine_work_data.begin();
-         i != odc_combine_work_data.end(); i++)
-      delete[] * i;
-    odc_combine_work_data.clear();
-
-    glUseProgram(0);
+    pi_useProgram(0);
   }
 #else
 #ifndef __ANDROID__
-    m_tobj = gluNewTess();
-
-    gluTessCallback(m_tobj, GLU_TESS_VERTEX,
-                    (_GLUfuncptr)&piDCPatternvertexCallback);
-    gluTessCallback(m_tobj, GLU_TESS_BEGIN,
-                    (_GLUfuncptr)&piDCPatternbeginCallback);
-    gluTessCallback(m_tobj, GLU_TESS_END, (_GLUfuncptr)&piDCPatternendCallback);
-    gluTessCallback(m_tobj, GLU_TESS_COMBINE,
-                    (_GLUfuncptr)&piDCPatterncombineCallback);
-    gluTessCallback(m_tobj, GLU_TESS_ERROR,
-                    (_GLUfuncptr)&piDCPatternerrorCallback);
-
-    gluTessNormal(m_tobj, 0, 0, 1);
-    gluTessProperty(m_tobj, GLU_TESS_WINDING_RULE, GLU_TESS_WINDING_ODD);
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    gluTessProperty(m_tobj, GLU_TESS_BOUNDARY_ONLY, GL_FALSE);
 
     ConfigurePen();
     if (ConfigureBrush()) {
-      gluTessBeginPolygon(m_tobj, NULL);
-      gluTessBeginContour(m_tobj);
-
-      for (int i = 0; i < n; i++) {
-        GLvertex *vertex = new GLvertex();
-        pi_gTesselatorVertices.Add(vertex);
-        vertex->info.x = (GLdouble)points[i].x;
-        vertex->info.y = (GLdouble)points[i].y;
-        vertex->info.z = (GLdouble)0.0;
-        vertex->info.r = (GLdouble)0.0;
-        vertex->info.g = (GLdouble)0.0;
-        vertex->info.b = (GLdouble)0.0;
-        gluTessVertex(m_tobj, (GLdouble *)vertex, (GLdouble *)vertex);
-      }
-      gluTessEndContour(m_tobj);
-      gluTessEndPolygon(m_tobj);
+      DrawTessTriangles(piTessCache::Get().Tessellate(1, &n, points,
+                                                      GLU_TESS_WINDING_ODD),
+                        points[0], true);
     }
-
-    for (unsigned int i = 0; i < pi_gTesselatorVertices.Count(); i++)
-      delete (GLvertex *)pi_gTesselatorVertices[i];
-    pi_gTesselatorVertices.Clear();
-
-    gluDeleteTess(m_tobj);
-    m_tobj = NULL;
   }
 #endif
 #endif
@@ -2920,6 +2593,24 @@ void piDC::DrawPolygonTessellated( int n, wxPoint points[], wxCoord xoffset, wxC
 
 void piDC::DrawPolygonsTessellated(int n, int npoints[], wxPoint points[],
                                    wxCoord xoffset, wxCoord yoffset) {
+#ifdef ocpnUSE_GL
+#ifndef __ANDROID__
+  if (!dc && m_batching) {
+    piDrawState state;
+    if (GetBrushState(state, false) && n > 0) {
+      const std::vector<float> &triangles = piTessCache::Get().Tessellate(
+          n, npoints, points, GLU_TESS_WINDING_ODD);
+      float *v = m_batch.Append(state, triangles.size() / 2);
+      for (size_t i = 0; i + 1 < triangles.size(); i += 2) {
+        *v++ = triangles[i] + points[0].x;
+        *v++ = triangles[i + 1] + points[0].y;
+      }
+    }
+    return;
+  }
+#endif  //__ANDROID__
+#endif
+
 #if 1
   if (dc) {
     int prev = 0;
@@ -2931,22 +2622,8 @@ void piDC::DrawPolygonsTessellated(int n, int npoints[], wxPoint points[],
 #ifdef ocpnUSE_GL
   else {
 #ifndef __ANDROID__
-    m_tobj = gluNewTess();
-
-    gluTessCallback(m_tobj, GLU_TESS_VERTEX,
-                    (_GLUfuncptr)&piDCPatternvertexCallback);
-    gluTessCallback(m_tobj, GLU_TESS_BEGIN,
-                    (_GLUfuncptr)&piDCPatternbeginCallback);
-    gluTessCallback(m_tobj, GLU_TESS_END, (_GLUfuncptr)&piDCPatternendCallback);
-    gluTessCallback(m_tobj, GLU_TESS_COMBINE,
-                    (_GLUfuncptr)&piDCPatterncombineCallback);
-    gluTessCallback(m_tobj, GLU_TESS_ERROR,
-                    (_GLUfuncptr)&piDCPatternerrorCallback);
-
-    gluTessNormal(m_tobj, 0, 0, 1);
-    gluTessProperty(m_tobj, GLU_TESS_WINDING_RULE, GLU_TESS_WINDING_ODD);
+    FlushBatch();
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    gluTessProperty(m_tobj, GLU_TESS_BOUNDARY_ONLY, GL_FALSE);
 
     if (glIsEnabled(GL_TEXTURE_2D))
       g_bTexture2D = true;
@@ -2954,34 +2631,12 @@ void piDC::DrawPolygonsTessellated(int n, int npoints[], wxPoint points[],
       g_bTexture2D = false;
 
     ConfigurePen();
-    if (ConfigureBrush()) {
-      gluTessBeginPolygon(m_tobj, NULL);
-      int prev = 0;
-      for (int j = 0; j < n; j++) {
-        gluTessBeginContour(m_tobj);
-        for (int i = 0; i < npoints[j]; i++) {
-          GLvertex *vertex = new GLvertex();
-          pi_gTesselatorVertices.Add(vertex);
-          vertex->info.x = (GLdouble)points[i + prev].x;
-          vertex->info.y = (GLdouble)points[i + prev].y;
-          vertex->info.z = (GLdouble)0.0;
-          vertex->info.r = (GLdouble)0.0;
-          vertex->info.g = (GLdouble)0.0;
-          vertex->info.b = (GLdouble)0.0;
-          vertex->info.a = (GLdouble)0.0;
-          gluTessVertex(m_tobj, (GLdouble *)vertex, (GLdouble *)vertex);
-        }
-        gluTessEndContour(m_tobj);
-        prev += npoints[j];
-      }
-      gluTessEndPolygon(m_tobj);
+    if (ConfigureBrush() && n > 0) {
+      DrawTessTriangles(piTessCache::Get().Tessellate(n, npoints, points,
+                                                      GLU_TESS_WINDING_ODD),
+                        points[0], true);
     }
 
-    gluDeleteTess(m_tobj);
-    for (unsigned int i = 0; i < pi_gTesselatorVertices.Count(); i++)
-      delete (GLvertex *)pi_gTesselatorVertices.Item(i);
-    pi_gTesselatorVertices.Clear();
-
 #endif  //__ANDROID__
   }
 #endif
@@ -3000,25 +2655,29 @@ void piDC::DrawPolygonsPattern(int n, int npoint[], wxPoint points[],
                                int textureID, wxSize textureSize,
                                wxCoord xoffset, wxCoord yoffset, float scale,
                                float angle) {
+  if (m_raster) return;  // there is no GL texture to fill from
+
 #ifndef __ANDROID__
 
   DrawPolygonsTessellated(n, npoint, points);
 
 #else
+  FlushBatch();
+
   // Pre-configure the GLES program
   // GLint program = pi_colorv_tri_shader_program;
   //GLint program = pi_texture_2D_shader_program;
   GLint program = pi_texture_2DA_shader_program;
   s_odc_activeProgram = program;
 
-  glUseProgram(program);
+  pi_useProgram(program);
 
   // Disable VBO's (vertex buffer objects) for attributes.
   glBindBuffer(GL_ARRAY_BUFFER, 0);
   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
   float *bufPt = &(s_odc_tess_work_buf[s_odc_tess_vertex_idx_this]);
-  GLint pos = glGetAttribLocation(program, "aPos");
+  GLint pos = pi_getShader(program).position;
   glVertexAttribPointer(pos, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), bufPt);
   glEnableVertexAttribArray(pos);
 
@@ -3026,7 +2685,7 @@ void piDC::DrawPolygonsPattern(int n, int npoint[], wxPoint points[],
   glBindTexture(GL_TEXTURE_2D, textureID);
 
   // Set up the texture sampler to texture unit 0
-  GLint texUni = glGetUniformLocation(program, "uTex");
+  GLint texUni = pi_getShader(program).tex;
   glUniform1i(texUni, 0);
 
   //        GLint texPOTWidth  = glGetUniformLocation( program, "texPOTWidth" );
@@ -3046,8 +2705,7 @@ void piDC::DrawPolygonsPattern(int n, int npoint[], wxPoint points[],
   bcolorv[1] = m_brush.GetColour().Green() / float(256);
   bcolorv[2] = m_brush.GetColour().Blue() / float(256);
   bcolorv[3] = m_brush.GetColour().Alpha() / float(256);
-  GLint bcolloc = glGetUniformLocation(program, "color");
-  glUniform4fv(bcolloc, 1, bcolorv);
+  pi_setColor(program, bcolorv);
 
   // Tesselate
   m_tobj = gluNewTess();
@@ -3068,12 +2726,19 @@ void piDC::DrawPolygonsPattern(int n, int npoint[], wxPoint points[],
   gluTessProperty(m_tobj, GLU_TESS_BOUNDARY_ONLY, GL_FALSE);
 
   if (ConfigureBrush()) {
+    // Size the vertex storage and the output from the point count, about
+    // one triangle per point plus two per hole
+    int total = 0;
+    for (int j = 0; j < n; j++) total += npoint[j];
+    s_odc_tess_arena.Reset(3 * (total + total / 8 + 16));
+    ReserveTessBuffers(this, 6 * (total + 2 * n));
+
     gluTessBeginPolygon(m_tobj, this);
     int prev = 0;
     for (int j = 0; j < n; j++) {
       gluTessBeginContour(m_tobj);
       for (int i = 0; i < npoint[j]; i++) {
-        double *p = new double[6];
+        GLdouble *p = s_odc_tess_arena.Alloc(3);
         p[0] = points[i + prev].x, p[1] = points[i + prev].y, p[2] = 0;
         gluTessVertex(m_tobj, p, p);
       }
@@ -3086,7 +2751,7 @@ void piDC::DrawPolygonsPattern(int n, int npoint[], wxPoint points[],
 #if 0
         //      Render the tesselated results
         GLint program = pi_colorv_tri_shader_program;
-        glUseProgram( program );
+        pi_useProgram( program );
 
 
         // Disable VBO's (vertex buffer objects) for attributes.
@@ -3095,7 +2760,7 @@ void piDC::DrawPolygonsPattern(int n, int npoint[], wxPoint points[],
 
 
         float *bufPt = &(s_odc_tess_work_buf[s_odc_tess_vertex_idx_this]);
-        GLint pos = glGetAttribLocation(program, "position");
+        GLint pos = pi_getShader(program).position;
         glVertexAttribPointer(pos, 2, GL_FLOAT, GL_FALSE, 2*sizeof(float), bufPt);
         glEnableVertexAttribArray(pos);
 
@@ -3119,20 +2784,19 @@ void piDC::DrawPolygonsPattern(int n, int npoint[], wxPoint points[],
 
         //  Pattern color
         float bcolorv[4];
-        GLint bcolloc = glGetUniformLocation(program,"color");
         bcolorv[0] = m_brush.GetColour().Red() / float(256);
         bcolorv[1] = m_brush.GetColour().Green() / float(256);
         bcolorv[2] = m_brush.GetColour().Blue() / float(256);
         bcolorv[3] = m_brush.GetColour().Alpha() / float(256);
-        glUniform4fv(bcolloc, 1, bcolorv);
+        pi_setColor(program, bcolorv);
 
-        glDrawArrays(s_odc_tess_mode, 0, s_odc_nvertex);
+        pi_drawArrays(s_odc_tess_mode, 0, s_odc_nvertex);
 #endif
 
   gluDeleteTess(m_tobj);
   m_tobj = NULL;
 
-  glUseProgram(0);
+  pi_useProgram(0);
 #endif
 }
 
@@ -3177,6 +2841,8 @@ void piDC::DrawBitmap(const wxBitmap &bitmap, wxCoord x, wxCoord y,
   if (dc) dc->DrawBitmap(bmp, x, y, usemask);
 #ifdef ocpnUSE_GL
   else {
+    FlushBatch();
+
 #ifdef ocpnUSE_GLES  // Do not attempt to do anything with glDrawPixels if using
                      // opengles
     return;          // this should not be hit anymore ever anyway
@@ -3217,9 +2883,12 @@ void piDC::DrawBitmap(const wxBitmap &bitmap, wxCoord x, wxCoord y,
           }
       }
 
-      glColor4f(1, 1, 1, 1);
+      if (!m_raster) glColor4f(1, 1, 1, 1);
       GLDrawBlendData(x, y, w, h, GL_RGBA, e);
       delete[](e);
+    } else if (m_raster) {
+      if (image.GetData())
+        m_raster->DrawImage(x, y, w, h, image.GetData(), false);
     } else {
       glRasterPos2i(x, y);
       glPixelZoom(1, -1); /* draw data from top to bottom */
@@ -3241,12 +2910,14 @@ void piDC::DrawTextEx(const wxString &text, wxCoord x, wxCoord y,
   if (dc) dc->DrawText(text, x, y);
 #ifdef ocpnUSE_GL
   else {
+    FlushBatch();
+
     wxCoord w = 0;
     wxCoord h = 0;
 
     if (m_buseTex) {
       m_texfont.Build(m_font);  // make sure the font is ready
-      m_texfont.GetTextExtent(text, &w, &h);
+      MeasureText(text, NULL, &w, &h, NULL);
       m_texfont.SetColor(m_textforegroundcolour);
 
       if (w && h) {
@@ -3264,7 +2935,13 @@ void piDC::DrawTextEx(const wxString &text, wxCoord x, wxCoord y,
             SetBrush(b);
         }
 
-        glEnable(GL_BLEND);
+        if (m_raster) {
+          FlushBatch();
+          m_texfont.RenderString(*m_raster, text, x, y);
+          return;
+        }
+
+        pi_setEnabled(GL_BLEND, true);
         glEnable(GL_TEXTURE_2D);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
@@ -3282,7 +2959,7 @@ void piDC::DrawTextEx(const wxString &text, wxCoord x, wxCoord y,
         m_texfont.RenderString(text, x, y);
 #endif
         glDisable(GL_TEXTURE_2D);
-        glDisable(GL_BLEND);
+        pi_setEnabled(GL_BLEND, false);
       }
     } else {
       wxScreenDC sdc;
@@ -3336,6 +3013,10 @@ void piDC::DrawTextEx(const wxString &text, wxCoord x, wxCoord y,
         y += dy;
       }
 
+      /* glTexImage2D would reject a texture this large */
+      int maxTextureSize = GetGLCaps().maxTextureSize;
+      if (NextPow2(w) > maxTextureSize || NextPow2(h) > maxTextureSize) return;
+
       unsigned char *data = new unsigned char[w * h * 4];
       unsigned char *im = image.GetData();
 
@@ -3389,7 +3070,7 @@ void piDC::DrawTextEx(const wxString &text, wxCoord x, wxCoord y,
                       data);
 
       glEnable(GL_TEXTURE_2D);
-      glEnable(GL_BLEND);
+      pi_setEnabled(GL_BLEND, true);
       glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
       float u = (float)w / TextureWidth, v = (float)h / TextureHeight;
@@ -3431,16 +3112,16 @@ void piDC::DrawTextEx(const wxString &text, wxCoord x, wxCoord y,
       coords[6] = 0;
       coords[7] = h;
 
-      glUseProgram(pi_texture_2D_shader_program);
+      pi_useProgram(pi_texture_2D_shader_program);
 
       // Get pointers to the attributes in the program.
       GLint mPosAttrib =
-          glGetAttribLocation(pi_texture_2D_shader_program, "aPos");
+          pi_getShader(pi_texture_2D_shader_program).position;
       GLint mUvAttrib =
-          glGetAttribLocation(pi_texture_2D_shader_program, "aUV");
+          pi_getShader(pi_texture_2D_shader_program).uv;
 
       // Set up the texture sampler to texture unit 0
-      GLint texUni = glGetUniformLocation(pi_texture_2D_shader_program, "uTex");
+      GLint texUni = pi_getShader(pi_texture_2D_shader_program).tex;
       glUniform1i(texUni, 0);
 
       // Disable VBO's (vertex buffer objects) for attributes.
@@ -3468,9 +3149,7 @@ void piDC::DrawTextEx(const wxString &text, wxCoord x, wxCoord y,
       Q[3][0] = x;
       Q[3][1] = y;
 
-      GLint matloc =
-          glGetUniformLocation(pi_texture_2D_shader_program, "TransformMatrix");
-      glUniformMatrix4fv(matloc, 1, GL_FALSE, (const GLfloat *)Q);
+      pi_setTransform(pi_texture_2D_shader_program, (const GLfloat *)Q);
 
       // Select the active texture unit.
       glActiveTexture(GL_TEXTURE0);
@@ -3498,14 +3177,14 @@ void piDC::DrawTextEx(const wxString &text, wxCoord x, wxCoord y,
       glVertexAttribPointer(mPosAttrib, 2, GL_FLOAT, GL_FALSE, 0, co1);
       glVertexAttribPointer(mUvAttrib, 2, GL_FLOAT, GL_FALSE, 0, tco1);
 
-      glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+      pi_drawArrays(GL_TRIANGLE_STRIP, 0, 4);
       glDisableVertexAttribArray(mPosAttrib);
       glDisableVertexAttribArray(mUvAttrib);
 
-      glUseProgram(0);
+      pi_useProgram(0);
 
 #endif
-      glDisable(GL_BLEND);
+      pi_setEnabled(GL_BLEND, false);
       glDisable(GL_TEXTURE_2D);
 
       glDeleteTextures(1, &texobj);
@@ -3525,28 +3204,59 @@ void piDC::GetTextExtent(const wxString &string, wxCoord *w, wxCoord *h,
 
   if (dc)
     dc->GetMultiLineTextExtent(string, w, h, descent, font);
+  else
+    MeasureText(string, font, w, h, descent);
+
+  //  Sometimes GetTextExtent returns really wrong, uninitialized results.
+  //  Dunno why....
+  if (w && (*w > 2000)) *w = 2000;
+  if (h && (*h > 500)) *h = 500;
+}
+
+// Measures string in font, or in m_font if font is NULL, through the
+// extent cache shared by all piDC instances
+void piDC::MeasureText(const wxString &string, const wxFont *font, wxCoord *w,
+                       wxCoord *h, wxCoord *descent) {
+  std::string fontKey;
+  if (font)
+    fontKey = piTextExtentCache::FontKey(*font, m_buseTex);
   else {
-    wxFont f = m_font;
-    if (font) f = *font;
+    if (m_fontKey.empty())
+      m_fontKey = piTextExtentCache::FontKey(m_font, m_buseTex);
+    font = &m_font;
+  }
+  const std::string &key = fontKey.empty() ? m_fontKey : fontKey;
+
+  piTextExtentCache &cache = piTextExtentCache::Get();
+  const piTextExtentCache::Extent *found = cache.Find(key, string);
+  if (found) {
+    if (w) *w = found->width;
+    if (h) *h = found->height;
+    if (descent && found->descent >= 0) *descent = found->descent;
+    return;
+  }
 
-    if (m_buseTex) {
+  piTextExtentCache::Extent extent = {0, 0, -1};
+  wxFont f = *font;
+  if (m_buseTex) {
 #ifdef ocpnUSE_GL
-      m_texfont.Build(f);  // make sure the font is ready
-      m_texfont.GetTextExtent(string, w, h);
+    m_texfont.Build(f);  // make sure the font is ready
+    m_texfont.GetTextExtent(string, &extent.width, &extent.height);
 #else
-      wxMemoryDC temp_dc;
-      temp_dc.GetMultiLineTextExtent(string, w, h, descent, &f);
+    wxMemoryDC temp_dc;
+    temp_dc.GetMultiLineTextExtent(string, &extent.width, &extent.height,
+                                   &extent.descent, &f);
 #endif
-    } else {
-      wxMemoryDC temp_dc;
-      temp_dc.GetMultiLineTextExtent(string, w, h, descent, &f);
-    }
+  } else {
+    wxMemoryDC temp_dc;
+    temp_dc.GetMultiLineTextExtent(string, &extent.width, &extent.height,
+                                   &extent.descent, &f);
   }
+  cache.Store(key, string, extent);
 
-  //  Sometimes GetTextExtent returns really wrong, uninitialized results.
-  //  Dunno why....
-  if (w && (*w > 2000)) *w = 2000;
-  if (h && (*h > 500)) *h = 500;
+  if (w) *w = extent.width;
+  if (h) *h = extent.height;
+  if (descent && extent.descent >= 0) *descent = extent.descent;
 }
 
 void piDC::ResetBoundingBox() {
@@ -3561,6 +3271,8 @@ bool piDC::ConfigurePen() {
   wxColour c = wxNullColour;
   int width = 0;
 
+  FlushBatch();  // the pending primitives go first
+
   if (!m_pen.IsOk()) return false;
   if (m_pen == *wxTRANSPARENT_PEN)
     width = 0;
@@ -3571,13 +3283,15 @@ bool piDC::ConfigurePen() {
 #ifdef ocpnUSE_GL
 #ifndef USE_ANDROID_GLES2
   if (c != wxNullColour) glColor4ub(c.Red(), c.Green(), c.Blue(), c.Alpha());
-  glLineWidth(wxMax(GLMinSymbolLineWidth, width));
+  glLineWidth(wxMax(GetGLCaps().minLineWidth, width));
 #endif
 #endif
   return true;
 }
 
 bool piDC::ConfigureBrush() {
+  FlushBatch();
+
   if (m_brush == wxNullBrush || m_brush.GetStyle() == wxBRUSHSTYLE_TRANSPARENT)
     return false;
 #ifdef ocpnUSE_GL
@@ -3589,16 +3303,206 @@ bool piDC::ConfigureBrush() {
   return true;
 }
 
+#ifdef ocpnUSE_GL
+// Submits the batches of piDC to OpenGL
+class piGLDrawSink : public piDrawSink {
+public:
+  void Draw(const piDrawState &state, const float *vertices, int count) {
+    pi_resetGLState();  // also flushed by Append(), outside FlushBatch()
+    bool lines = state.mode == piDrawState::LINES;
+    bool blend = state.blend;
+#ifdef __WXQT__
+    if (lines) blend = false;  // Some QT platforms (Android) have trouble with
+                               // GL_BLEND / GL_LINE_SMOOTH
+#endif
+    if (blend) {
+      pi_setEnabled(GL_BLEND, true);
+      if (lines) glEnable(GL_LINE_SMOOTH);
+    }
+    if (lines) glLineWidth(state.width);
+
+#ifndef USE_ANDROID_GLES2
+    glColor4ub(state.color[0], state.color[1], state.color[2], state.color[3]);
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, GL_FLOAT, 2 * sizeof(float), vertices);
+    pi_drawArrays(lines ? GL_LINES : GL_TRIANGLES, 0, count);
+    glDisableClientState(GL_VERTEX_ARRAY);
+#else
+    GLint program = pi_color_tri_shader_program;
+    pi_useProgram(program);
+
+    // Disable VBO's (vertex buffer objects) for attributes.
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    GLint pos = pi_getShader(program).position;
+    glVertexAttribPointer(pos, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float),
+                          vertices);
+    glEnableVertexAttribArray(pos);
+
+    mat4x4 I;
+    mat4x4_identity(I);
+    pi_setTransform(program, (const GLfloat *)I);
+
+    float colorv[4];
+    for (int i = 0; i < 4; i++) colorv[i] = state.color[i] / float(256);
+    pi_setColor(program, colorv);
+
+    pi_drawArrays(lines ? GL_LINES : GL_TRIANGLES, 0, count);
+    pi_useProgram(0);
+#endif
+
+    if (blend) {
+      if (lines) glDisable(GL_LINE_SMOOTH);
+      pi_setEnabled(GL_BLEND, false);
+    }
+  }
+};
+
+static piGLDrawSink s_glDrawSink;
+#endif
+
+void piDC::BeginBatch(piDrawSink *sink) {
+  FlushBatch();
+  if (!sink) sink = m_raster;
+#ifdef ocpnUSE_GL
+  if (!sink) sink = &s_glDrawSink;
+#endif
+  m_batch.SetSink(sink);
+  m_batching = sink != NULL;
+}
+
+void piDC::EndBatch() {
+  FlushBatch();
+  // A raster is only drawn through the batch
+  m_batch.SetSink(m_raster);
+  m_batching = m_raster != NULL;
+}
+
+// Every unbatched GL draw starts here, and every batched one in
+// piGLDrawSink::Draw(): both forget the GL state others may have changed
+void piDC::FlushBatch() {
+  pi_resetGLState();
+  if (m_batching) m_batch.Flush();
+}
+
+// True when the lines of the current pen can go to the batch: solid and
+// thin enough for glLineWidth. An invisible pen draws nothing, and is fine.
+bool piDC::CanBatchPen() const {
+  if (!m_batching) return false;
+  if (!m_pen.IsOk() || m_pen == *wxTRANSPARENT_PEN) return true;
+
+  wxDash *dashes;
+  if (m_pen.GetStyle() != wxPENSTYLE_SOLID || m_pen.GetDashes(&dashes))
+    return false;
+  const piGLCaps &caps = GetGLCaps();
+  return wxMax(caps.minLineWidth, m_pen.GetWidth()) <= caps.MaxLineWidth();
+}
+
+// Adds the lines between the n points to the batch, back to the first point
+// if closed, or strokes them when the batch can't draw the pen
+void piDC::BatchLines(const float *points, int n, bool closed, bool blend) {
+  if (CanBatchPen()) {
+    piDrawState state;
+    if (GetPenState(state, blend))
+      m_batch.AddLineStrip(state, points, n, closed);
+    return;
+  }
+#ifdef ocpnUSE_GL
+  FlushBatch();
+  ConfigureStroker(m_pen);
+  if (m_stroker.Stroke(points, n, closed)) DrawStroke(m_pen.GetColour());
+#endif
+}
+
+// Adds a convex shape to the batch, filled with the brush as a fan around
+// its first point, and outlined with the pen
+void piDC::BatchShape(const float *points, int n, bool blend) {
+  piDrawState state;
+  if (GetBrushState(state, blend)) m_batch.AddTriangleFan(state, points, n);
+  BatchLines(points, n, true, blend);
+}
+
+// Fills and outlines a polygon drawn to the raster, which has no transform:
+// the points are scaled, rotated by angle and moved by the offset here
+void piDC::RasterPolygon(int n, wxPoint points[], wxCoord xoffset,
+                         wxCoord yoffset, float scale, float angle) {
+#ifdef ocpnUSE_GL
+  if (n < 3) return;
+  float c = cosf(angle) * scale, s = sinf(angle) * scale;
+
+  piDrawState state;
+  if (GetBrushState(state, true)) {
+    const std::vector<float> &triangles = piTessCache::Get().Tessellate(
+        1, &n, points, GLU_TESS_WINDING_NONZERO);
+    float *v = m_batch.Append(state, triangles.size() / 2);
+    for (size_t i = 0; i + 1 < triangles.size(); i += 2) {
+      float x = triangles[i] + points[0].x, y = triangles[i + 1] + points[0].y;
+      *v++ = x * c - y * s + xoffset;
+      *v++ = x * s + y * c + yoffset;
+    }
+  }
+
+  //  Grow the work buffer as necessary
+  if (workBufSize < (size_t)n * 2) {
+    workBuf = (float *)realloc(workBuf, (n * 4) * sizeof(float));
+    workBufSize = n * 4;
+  }
+
+  for (int i = 0; i < n; i++) {
+    workBuf[i * 2] = points[i].x * c - points[i].y * s + xoffset;
+    workBuf[i * 2 + 1] = points[i].x * s + points[i].y * c + yoffset;
+  }
+  BatchLines(workBuf, n, true, true);
+#endif  // ocpnUSE_GL
+}
+
+bool piDC::GetPenState(piDrawState &state, bool blend) const {
+  if (!m_pen.IsOk() || m_pen == *wxTRANSPARENT_PEN) return false;
+
+  wxColour c = m_pen.GetColour();
+  state.mode = piDrawState::LINES;
+  state.color[0] = c.Red();
+  state.color[1] = c.Green();
+  state.color[2] = c.Blue();
+  state.color[3] = c.Alpha();
+  state.width = wxMax(GetGLCaps().minLineWidth, m_pen.GetWidth());
+  state.blend = blend;
+  return true;
+}
+
+bool piDC::GetBrushState(piDrawState &state, bool blend) const {
+  if (m_brush == wxNullBrush || m_brush.GetStyle() == wxBRUSHSTYLE_TRANSPARENT)
+    return false;
+
+  wxColour c = m_brush.GetColour();
+  state.mode = piDrawState::TRIANGLES;
+  state.color[0] = c.Red();
+  state.color[1] = c.Green();
+  state.color[2] = c.Blue();
+  state.color[3] = c.Alpha();
+  state.width = 1.0f;
+  state.blend = blend;
+  return true;
+}
+
 void piDC::GLDrawBlendData(wxCoord x, wxCoord y, wxCoord w, wxCoord h,
                            int format, const unsigned char *data) {
 #ifdef ocpnUSE_GL
 #ifndef USE_ANDROID_GLES2
-  glEnable(GL_BLEND);
+  FlushBatch();
+  if (m_raster) {
+    if (format == GL_RGBA) m_raster->DrawImage(x, y, w, h, data, true);
+    return;
+  }
+
+  pi_setEnabled(GL_BLEND, true);
   glRasterPos2i(x, y);
   glPixelZoom(1, -1);
   glDrawPixels(w, h, format, GL_UNSIGNED_BYTE, data);
   glPixelZoom(1, 1);
-  glDisable(GL_BLEND);
+  pi_setEnabled(GL_BLEND, false);
 #endif
 #endif
 }
@@ -3611,12 +3515,16 @@ void piDC::SetTextureParms(GLint textureId, int width, int height) {
 
 void piDC::DrawTexture(wxRect texRect, int width, int height, float scaleFactor,
                        wxPoint position, float rotation, wxPoint rPivot) {
+  if (m_raster) return;  // there is no GL texture to draw from
+
   float w = width;
   float h = height;
 
   w *= scaleFactor;
   h *= scaleFactor;
 
+  FlushBatch();
+
 #ifndef USE_ANDROID_GLES2
 #ifndef __ANDROID__
   glColor3f(1, 1, 1);
@@ -3668,17 +3576,17 @@ void piDC::DrawTexture(wxRect texRect, int width, int height, float scaleFactor,
   coords[5] = position.y + h;
 
   GLint program = pi_texture_2D_shader_program;
-  glUseProgram(program);
+  pi_useProgram(program);
 
   // Get pointers to the attributes in the program.
-  GLint mPosAttrib = glGetAttribLocation(program, "aPos");
-  GLint mUvAttrib = glGetAttribLocation(program, "aUV");
+  GLint mPosAttrib = pi_getShader(program).position;
+  GLint mUvAttrib = pi_getShader(program).uv;
 
   // Select the active texture unit.
   glActiveTexture(GL_TEXTURE0);
 
   // Set up the texture sampler to texture unit 0
-  GLint texUni = glGetUniformLocation(program, "uTex");
+  GLint texUni = pi_getShader(program).tex;
   glUniform1i(texUni, 0);
 
   // Disable VBO's (vertex buffer objects) for attributes.
@@ -3706,20 +3614,21 @@ void piDC::DrawTexture(wxRect texRect, int width, int height, float scaleFactor,
         mat4x4_rotate_Z(Q, I, -rotation);
         mat4x4_translate_in_place(Q, -rPivot.x, -rPivot.y, rotation);
 
-        GLint matloc = glGetUniformLocation(progam,"TransformMatrix");
-        glUniformMatrix4fv( matloc, 1, GL_FALSE, (const GLfloat*)Q);
+        pi_setTransform(progam, (const GLfloat*)Q);
 #endif
 
   // Perform the actual drawing.
-  glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+  pi_drawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
-  glUseProgram(0);
+  pi_useProgram(0);
 #endif
 }
 
 void piDC::DrawTextureAlpha(wxRect texRect, int width, int height,
                             float scaleFactor, wxPoint position, float rotation,
                             wxPoint rPivot) {
+  if (m_raster) return;  // there is no GL texture to draw from
+
   float w = width;
   float h = height;
 
@@ -3775,17 +3684,17 @@ void piDC::DrawTextureAlpha(wxRect texRect, int width, int height,
   coords[5] = position.y + h;
 
   GLint program = pi_texture_2D_shader_program;
-  glUseProgram(program);
+  pi_useProgram(program);
 
   // Get pointers to the attributes in the program.
-  GLint mPosAttrib = glGetAttribLocation(program, "aPos");
-  GLint mUvAttrib = glGetAttribLocation(program, "aUV");
+  GLint mPosAttrib = pi_getShader(program).position;
+  GLint mUvAttrib = pi_getShader(program).uv;
 
   // Select the active texture unit.
   glActiveTexture(GL_TEXTURE0);
 
   // Set up the texture sampler to texture unit 0
-  GLint texUni = glGetUniformLocation(program, "uTex");
+  GLint texUni = pi_getShader(program).tex;
   glUniform1i(texUni, 0);
 
   // Disable VBO's (vertex buffer objects) for attributes.
@@ -3822,30 +3731,33 @@ void piDC::DrawTextureAlpha(wxRect texRect, int width, int height,
         mat4x4_rotate_Z(Q, I, -rotation);
         mat4x4_translate_in_place(Q, -rPivot.x, -rPivot.y, rotation);
 
-        GLint matloc = glGetUniformLocation(program,"TransformMatrix");
-        glUniformMatrix4fv( matloc, 1, GL_FALSE, (const GLfloat*)Q);
+        pi_setTransform(program, (const GLfloat*)Q);
 #endif
 
   // Perform the actual drawing.
-  glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+  pi_drawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
-  glUseProgram(0);
+  pi_useProgram(0);
 #endif
 }
 
 void piDC::RenderSingleTexture(float *coords, float *uvCoords,
                                PlugIn_ViewPort *vp, float dx, float dy,
                                float angle_rad) {
+  if (m_raster) return;  // there is no GL texture to draw from
+
+  FlushBatch();
+
 #ifdef USE_ANDROID_GLES2
   // build_texture_shaders();
-  glUseProgram(pi_texture_2D_shader_program);
+  pi_useProgram(pi_texture_2D_shader_program);
 
   // Get pointers to the attributes in the program.
-  GLint mPosAttrib = glGetAttribLocation(pi_texture_2D_shader_program, "aPos");
-  GLint mUvAttrib = glGetAttribLocation(pi_texture_2D_shader_program, "aUV");
+  GLint mPosAttrib = pi_getShader(pi_texture_2D_shader_program).position;
+  GLint mUvAttrib = pi_getShader(pi_texture_2D_shader_program).uv;
 
   // Set up the texture sampler to texture unit 0
-  GLint texUni = glGetUniformLocation(pi_texture_2D_shader_program, "uTex");
+  GLint texUni = pi_getShader(pi_texture_2D_shader_program).tex;
   glUniform1i(texUni, 0);
 
   // Disable VBO's (vertex buffer objects) for attributes.
@@ -3875,9 +3787,7 @@ void piDC::RenderSingleTexture(float *coords, float *uvCoords,
   // mat4x4 X;
   // mat4x4_mul(X, (float (*)[4])vp->vp_transform, Q);
 
-  GLint matloc =
-      glGetUniformLocation(pi_texture_2D_shader_program, "TransformMatrix");
-  glUniformMatrix4fv(matloc, 1, GL_FALSE, (const GLfloat *)Q);
+  pi_setTransform(pi_texture_2D_shader_program, (const GLfloat *)Q);
 
   // Select the active texture unit.
   glActiveTexture(GL_TEXTURE0);
@@ -3917,7 +3827,7 @@ void piDC::RenderSingleTexture(float *coords, float *uvCoords,
   glVertexAttribPointer(mPosAttrib, 2, GL_FLOAT, GL_FALSE, 0, co1);
   glVertexAttribPointer(mUvAttrib, 2, GL_FLOAT, GL_FALSE, 0, tco1);
 
-  glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+  pi_drawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
 #endif
 
@@ -3931,7 +3841,7 @@ void piDC::RenderSingleTexture(float *coords, float *uvCoords,
 
   glTexCoordPointer(2, GL_FLOAT, 2 * sizeof(GLfloat), uvCoords);
   glVertexPointer(2, GL_FLOAT, 2 * sizeof(GLfloat), coords);
-  glDrawArrays(GL_QUADS, 0, 4);
+  pi_drawArrays(GL_QUADS, 0, 4);
   glPopMatrix();
 
 #endif
@@ -3943,6 +3853,18 @@ int piDC::ArcSectorPoints(wxPoint *&points, wxCoord xc, wxCoord yc, wxCoord x1,
                           wxCoord y1, wxCoord x2, wxCoord y2, wxCoord x3,
                           wxCoord y3, wxCoord x4, wxCoord y4,
                           bool bHighQuality) {
+  std::vector<wxPoint> sector;
+  int n = ArcSectorPoints(sector, xc, yc, x1, y1, x2, y2, x3, y3, x4, y4,
+                          bHighQuality);
+  points = new wxPoint[n];
+  std::copy(sector.begin(), sector.end(), points);
+  return n;
+}
+
+int piDC::ArcSectorPoints(std::vector<wxPoint> &points, wxCoord xc,
+                          wxCoord yc, wxCoord x1, wxCoord y1, wxCoord x2,
+                          wxCoord y2, wxCoord x3, wxCoord y3, wxCoord x4,
+                          wxCoord y4, bool bHighQuality) {
   double y1yc, x1xc, y4yc, x4xc;
   y1yc = y1 - yc;
   x1xc = x1 - xc;
@@ -3956,53 +3878,44 @@ int piDC::ArcSectorPoints(wxPoint *&points, wxCoord xc, wxCoord yc, wxCoord x1,
 
   wxDouble l_OuterRadius = sqrt(pow((y2 - yc), 2.0) + pow((x2 - xc), 2.0));
   wxDouble l_InnerRadius = sqrt(pow((y1 - yc), 2.0) + pow((x1 - xc), 2.0));
-  float innerSteps;
-  float outerSteps;
+  int innerSteps;
+  int outerSteps;
   if (bHighQuality) {
-    innerSteps = floorf(
-        wxMax(sqrtf(sqrtf(((l_InnerRadius * 2.) * (l_InnerRadius * 2.)) * 2.)),
-              1) *
-        M_PI);
-    outerSteps = floorf(
-        wxMax(sqrtf(sqrtf(((l_OuterRadius * 2.) * (l_OuterRadius * 2.)) * 2.)),
-              1) *
-        M_PI);
+    innerSteps = CircleSteps(2 * l_InnerRadius, 2 * l_InnerRadius);
+    outerSteps = CircleSteps(2 * l_OuterRadius, 2 * l_OuterRadius);
   } else {
     innerSteps = 24;
     outerSteps = 24;
   }
 
-  points = new wxPoint[(int)innerSteps + (int)outerSteps + 5];
   double dxc1 = xc - x1;
   double dxc4 = xc - x4;
   double dyc1 = yc - y1;
   double dyc4 = yc - y4;
   double angle = atan2(dxc1 * dyc4 - dyc1 * dxc4, dxc1 * dxc4 + dyc1 * dyc4);
   if (angle < 0) angle += (2 * PI);
-  int numpoints_outer = ceil(abs(outerSteps * (angle / (2. * M_PI))));
-  int numpoints_inner = ceil(abs(innerSteps * (angle / (2. * M_PI))));
-  // if(numpoints_outer == 0) return;
-  points[0].x = x1;
-  points[0].y = y1;
-  float a = l_dFirstAngle;
-  for (int i = 0; i < (int)numpoints_outer; i++) {
-    points[i + 1].x = xc + l_OuterRadius * cosf(a);
-    points[i + 1].y = yc + l_OuterRadius * sinf(a);
-    a += 2 * M_PI / outerSteps;
-  }
-  a = l_dSecondAngle;
-  points[(int)numpoints_outer + 1].x = x3;
-  points[(int)numpoints_outer + 1].y = y3;
-  points[(int)numpoints_outer + 2].x = x4;
-  points[(int)numpoints_outer + 2].y = y4;
-  for (int i = 0; i < (int)numpoints_inner; i++) {
-    points[i + (int)numpoints_outer + 3].x = xc + l_InnerRadius * cosf(a);
-    points[i + (int)numpoints_outer + 3].y = yc + l_InnerRadius * sinf(a);
-    a -= 2 * M_PI / innerSteps;
-  }
-  int npoints[1];
-  npoints[0] = numpoints_inner + numpoints_outer + 4;
-  points[npoints[0] - 1].x = x1;
-  points[npoints[0] - 1].y = y1;
-  return npoints[0];
+  int numpoints_outer = ceil(outerSteps * (angle / (2. * M_PI)));
+  int numpoints_inner = ceil(innerSteps * (angle / (2. * M_PI)));
+
+  // The arcs turn the table of unit circle points to their first angle
+  points.clear();
+  points.push_back(wxPoint(x1, y1));
+  const float *circle = UnitCircle(outerSteps);
+  float c = cos(l_dFirstAngle), s = sin(l_dFirstAngle);
+  for (int i = 0; i < numpoints_outer; i++) {
+    float sina = circle[2 * i], cosa = circle[2 * i + 1];
+    points.push_back(wxPoint(xc + l_OuterRadius * (c * cosa - s * sina),
+                             yc + l_OuterRadius * (s * cosa + c * sina)));
+  }
+  points.push_back(wxPoint(x3, y3));
+  points.push_back(wxPoint(x4, y4));
+  circle = UnitCircle(innerSteps);
+  c = cos(l_dSecondAngle), s = sin(l_dSecondAngle);
+  for (int i = 0; i < numpoints_inner; i++) {
+    float sina = circle[2 * i], cosa = circle[2 * i + 1];
+    points.push_back(wxPoint(xc + l_InnerRadius * (c * cosa + s * sina),
+                             yc + l_InnerRadius * (s * cosa - c * sina)));
+  }
+  points.push_back(wxPoint(x1, y1));
+  return points.size();
 }
@@ -0,0 +1,63 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  The part of GLES2/gl2.h used by pi_glstate.cpp, for tests
+ *           built against a stub GL instead of a GLES2 library
+ *
+ ***************************************************************************
+ *   Copyright (C) 2024 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ **************************************************************************/
+
+#ifndef __GL2_H__
+#define __GL2_H__
+
+typedef unsigned int GLenum;
+typedef unsigned char GLboolean;
+typedef int GLint;
+typedef int GLsizei;
+typedef unsigned int GLuint;
+typedef float GLfloat;
+typedef char GLchar;
+
+#define GL_FALSE 0
+#define GL_TRUE 1
+#define GL_LINES 0x0001
+#define GL_TRIANGLES 0x0004
+#define GL_BLEND 0x0BE2
+#define GL_SCISSOR_TEST 0x0C11
+#define GL_TEXTURE_2D 0x0DE1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void glUseProgram(GLuint program);
+void glEnable(GLenum cap);
+void glDisable(GLenum cap);
+void glUniform4fv(GLint location, GLsizei count, const GLfloat *value);
+void glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose,
+                        const GLfloat *value);
+void glDrawArrays(GLenum mode, GLint first, GLsizei count);
+GLint glGetAttribLocation(GLuint program, const GLchar *name);
+GLint glGetUniformLocation(GLuint program, const GLchar *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,55 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Helpers for the plugin_dc tests.
+ *
+ ***************************************************************************
+ *   Copyright (C) 2024 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ **************************************************************************/
+
+#ifndef __DC_TEST_H__
+#define __DC_TEST_H__
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Fails the current test function, which returns the number of failures
+#define CHECK(x)                                                       \
+  do {                                                                 \
+    if (!(x)) {                                                        \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, \
+              #x);                                                     \
+      return 1;                                                        \
+    }                                                                  \
+  } while (0)
+
+// Sum of the areas of a list of triangles given as x,y pairs
+inline double TriangleArea(const std::vector<float> &triangles) {
+  double area = 0;
+  for (size_t i = 0; i + 5 < triangles.size(); i += 6) {
+    const float *t = &triangles[i];
+    area += std::fabs((t[2] - t[0]) * (t[5] - t[1]) -
+                      (t[4] - t[0]) * (t[3] - t[1])) /
+            2;
+  }
+  return area;
+}
+
+#endif
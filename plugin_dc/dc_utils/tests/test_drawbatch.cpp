@@ -0,0 +1,190 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Tests of the state merging of piDrawBatch.
+ *
+ ***************************************************************************
+ *   Copyright (C) 2024 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ **************************************************************************/
+
+
+#include "dc_test.h"
+#include "pi_drawbatch.h"
+
+#ifndef M_PI
+#define M_PI 3.1415926535897931160E0
+#endif
+
+namespace {
+
+piDrawState State(piDrawState::Mode mode, unsigned char red) {
+  piDrawState state;
+  state.mode = mode;
+  state.color[0] = red;
+  return state;
+}
+
+// Consecutive primitives with equal states go out as one draw call
+int TestMerge() {
+  piDrawBatch batch;
+  piDrawRecorder recorder;
+  piDrawState lines = State(piDrawState::LINES, 10);
+
+  batch.SetSink(&recorder);
+  batch.AddLine(lines, 0, 0, 1, 1);
+  batch.AddLine(lines, 2, 2, 3, 3);
+  batch.AddLine(State(piDrawState::LINES, 10), 4, 4, 5, 5);
+  CHECK(recorder.GetCallCount() == 0 && !batch.IsEmpty());
+
+  batch.Flush();
+  CHECK(batch.IsEmpty());
+  CHECK(recorder.GetCallCount() == 1 && recorder.GetVertexCount() == 6);
+  CHECK(recorder.GetCalls()[0].state == lines);
+
+  const std::vector<float> &v = recorder.GetCalls()[0].vertices;
+  for (int i = 0; i < 12; i++) CHECK(v[i] == i / 2);
+
+  batch.Flush();
+  CHECK(recorder.GetCallCount() == 1);
+  return 0;
+}
+
+// A state change flushes the pending primitives, and the calls keep the
+// drawing order across flushes
+int TestStateChange() {
+  piDrawBatch batch;
+  piDrawRecorder recorder;
+  piDrawState red = State(piDrawState::LINES, 200);
+  piDrawState wide = red;
+  piDrawState blended = red;
+  piDrawState fill = State(piDrawState::TRIANGLES, 200);
+  float triangle[] = {0, 0, 10, 0, 0, 10};
+
+  wide.width = 3;
+  blended.blend = true;
+
+  batch.SetSink(&recorder);
+  batch.AddLine(red, 0, 0, 1, 0);
+  batch.AddLine(wide, 1, 0, 2, 0);
+  CHECK(recorder.GetCallCount() == 1);
+  batch.AddLine(blended, 2, 0, 3, 0);
+  batch.AddTriangleFan(fill, triangle, 3);
+  batch.AddLine(red, 3, 0, 4, 0);
+  batch.AddLine(red, 4, 0, 5, 0);
+  batch.Flush();
+
+  const std::vector<piDrawRecorder::Call> &calls = recorder.GetCalls();
+  CHECK(calls.size() == 5);
+  CHECK(calls[0].state == red && calls[0].vertices[0] == 0);
+  CHECK(calls[1].state == wide && calls[1].vertices[0] == 1);
+  CHECK(calls[2].state == blended && calls[2].vertices[0] == 2);
+  CHECK(calls[3].state == fill && calls[3].vertices.size() == 6);
+  CHECK(calls[4].state == red && calls[4].vertices.size() == 8);
+  CHECK(calls[4].vertices[0] == 3 && calls[4].vertices[6] == 5);
+  return 0;
+}
+
+// An open strip of n points has n - 1 segments, a closed one n, ending at
+// the first point
+int TestLineStrip() {
+  piDrawBatch batch;
+  piDrawRecorder recorder;
+  piDrawState lines;
+  float square[] = {0, 0, 10, 0, 10, 10, 0, 10};
+
+  batch.SetSink(&recorder);
+  batch.AddLineStrip(lines, square, 4, false);
+  batch.Flush();
+  CHECK(recorder.GetVertexCount() == 6);
+
+  const std::vector<float> &open = recorder.GetCalls()[0].vertices;
+  CHECK(open[2] == 10 && open[3] == 0 && open[4] == 10 && open[5] == 0);
+  CHECK(open[10] == 0 && open[11] == 10);
+
+  recorder.Clear();
+  batch.AddLineStrip(lines, square, 4, true);
+  batch.Flush();
+  CHECK(recorder.GetVertexCount() == 8);
+
+  const std::vector<float> &closed = recorder.GetCalls()[0].vertices;
+  CHECK(closed[12] == 0 && closed[13] == 10);
+  CHECK(closed[14] == 0 && closed[15] == 0);
+
+  // Too short to draw anything
+  recorder.Clear();
+  batch.AddLineStrip(lines, square, 1, true);
+  batch.Flush();
+  CHECK(recorder.GetCallCount() == 0);
+  return 0;
+}
+
+// A fan of n points has n - 2 triangles around the first point
+int TestTriangleFan() {
+  piDrawBatch batch;
+  piDrawRecorder recorder;
+  piDrawState fill = State(piDrawState::TRIANGLES, 0);
+  float hexagon[12];
+
+  for (int i = 0; i < 6; i++) {
+    hexagon[2 * i] = (float)(10 * cos(i * M_PI / 3));
+    hexagon[2 * i + 1] = (float)(10 * sin(i * M_PI / 3));
+  }
+
+  batch.SetSink(&recorder);
+  for (int n = 0; n <= 6; n++) {
+    recorder.Clear();
+    batch.AddTriangleFan(fill, hexagon, n);
+    batch.Flush();
+    CHECK(recorder.GetVertexCount() == (size_t)(n < 3 ? 0 : 3 * (n - 2)));
+  }
+
+  const std::vector<float> &v = recorder.GetCalls()[0].vertices;
+  for (size_t i = 0; i < v.size(); i += 6) CHECK(v[i] == 10 && v[i + 1] == 0);
+  CHECK(std::fabs(TriangleArea(v) - 150 * sqrt(3.0)) < 1e-3);
+  return 0;
+}
+
+// Without a sink, Flush() drops the vertices, and a sink set afterwards
+// only gets what is added from then on
+int TestNoSink() {
+  piDrawBatch batch;
+  piDrawRecorder recorder;
+  piDrawState lines;
+
+  batch.AddLine(lines, 0, 0, 1, 1);
+  batch.Flush();
+  CHECK(batch.IsEmpty());
+
+  batch.SetSink(&recorder);
+  CHECK(batch.GetSink() == &recorder);
+  batch.AddLine(lines, 2, 2, 3, 3);
+  batch.Flush();
+  CHECK(recorder.GetCallCount() == 1 && recorder.GetVertexCount() == 2);
+  CHECK(recorder.GetCalls()[0].vertices[0] == 2);
+  return 0;
+}
+
+}  // namespace
+
+int main() {
+  int failures = TestMerge() + TestStateChange() + TestLineStrip() +
+                 TestTriangleFan() + TestNoSink();
+
+  if (failures == 0) printf("test_drawbatch: all tests passed\n");
+  return failures != 0;
+}
@@ -0,0 +1,157 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Tests of piGLCapsCache against a stub GL counting its calls.
+ *
+ ***************************************************************************
+ *   Copyright (C) 2024 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ **************************************************************************/
+
+#include <new>
+
+#include "GL/gl.h"
+
+#include "dc_test.h"
+#include "pi_glcaps.h"
+
+namespace {
+
+// What the stub GL answers, and how often it was asked
+struct StubGL {
+  int lineWidth;     // widest line, the narrowest is 1
+  bool gles;         // rejects GL_SMOOTH_LINE_WIDTH_RANGE
+  int errors;        // error flags pending, -1 for never cleared
+  long gets, errorChecks;
+
+  void Reset(int width, bool es) {
+    lineWidth = width;
+    gles = es;
+    errors = 0;
+    gets = errorChecks = 0;
+  }
+} s_gl;
+
+}  // namespace
+
+extern "C" {
+
+void GLAPIENTRY glGetIntegerv(GLenum pname, GLint *params) {
+  s_gl.gets++;
+  if (pname == GL_ALIASED_LINE_WIDTH_RANGE) {
+    params[0] = 1;
+    params[1] = s_gl.lineWidth;
+  } else if (pname == GL_SMOOTH_LINE_WIDTH_RANGE) {
+    if (s_gl.gles) {
+      if (s_gl.errors >= 0) s_gl.errors++;
+      return;
+    }
+    params[0] = 1;
+    params[1] = s_gl.lineWidth / 2;
+  } else if (pname == GL_MAX_TEXTURE_SIZE) {
+    params[0] = 4096;
+  }
+}
+
+GLenum GLAPIENTRY glGetError(void) {
+  s_gl.errorChecks++;
+  if (s_gl.errors == 0) return GL_NO_ERROR;
+  if (s_gl.errors > 0) s_gl.errors--;
+  return GL_INVALID_ENUM;
+}
+
+const GLubyte *GLAPIENTRY glGetString(GLenum) {
+  s_gl.gets++;
+  return (const GLubyte *)(s_gl.gles ? "OpenGL ES 2.0" : "4.6 Mesa");
+}
+
+}  // extern "C"
+
+namespace {
+
+wxGLContext *Context(size_t id) { return (wxGLContext *)(id * 64); }
+
+// Each context is asked once, however many piDCs draw with it
+int TestOncePerContext() {
+  piGLCapsCache &cache = piGLCapsCache::Get();
+  s_gl.Reset(10, false);
+
+  for (int i = 0; i < 1000; i++) cache.Acquire(Context(1 + i % 3));
+  CHECK(s_gl.gets == 3 * 4);
+  CHECK(cache.Size() == 3);
+
+  const piGLCaps &caps = cache.Acquire(Context(1));
+  CHECK(caps.maxAliasedLineWidth == 10 && caps.maxSmoothLineWidth == 5);
+  CHECK(caps.MaxLineWidth() == 5 && caps.maxTextureSize == 4096);
+  CHECK(!caps.gles);
+
+  cache.Release(Context(1));
+  for (int i = 0; i < 1000; i++) cache.Release(Context(1 + i % 3));
+  CHECK(cache.Size() == 0);
+  return 0;
+}
+
+// The caps go with the last piDC of a context, a new context at the same
+// address is asked again
+int TestReusedAddress() {
+  piGLCapsCache &cache = piGLCapsCache::Get();
+  s_gl.Reset(10, false);
+
+  cache.Acquire(Context(1));
+  cache.Acquire(Context(1));
+  cache.Release(Context(1));
+  CHECK(cache.Size() == 1);
+  cache.Release(Context(1));
+  CHECK(cache.Size() == 0);
+
+  s_gl.Reset(8, true);
+  const piGLCaps &caps = cache.Acquire(Context(1));
+  CHECK(s_gl.gets == 4);
+  CHECK(caps.gles && caps.maxSmoothLineWidth == 8);
+  cache.Release(Context(1));
+
+  // Releasing a context not held does nothing
+  cache.Release(Context(2));
+  CHECK(cache.Size() == 0);
+  return 0;
+}
+
+// Errors left by earlier GL calls don't pass for a rejected smooth line
+// query, and a GL which never clears its errors doesn't hang the query
+int TestPendingErrors() {
+  s_gl.Reset(10, false);
+  s_gl.errors = 3;
+  piGLCaps caps = piGLCaps::Query();
+  CHECK(caps.maxSmoothLineWidth == 5 && caps.maxAliasedLineWidth == 10);
+
+  s_gl.Reset(10, false);
+  s_gl.errors = -1;
+  caps = piGLCaps::Query();
+  CHECK(s_gl.errorChecks < 100);
+  CHECK(caps.maxAliasedLineWidth == 10);
+  return 0;
+}
+
+}  // namespace
+
+int main() {
+  int failures = TestOncePerContext() + TestReusedAddress() +
+                 TestPendingErrors();
+
+  if (failures == 0) printf("test_glcaps: all tests passed\n");
+  return failures != 0;
+}
@@ -0,0 +1,243 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Tests of the GLES2 state shadow against a stub GL counting its
+ *           calls.
+ *
+ ***************************************************************************
+ *   Copyright (C) 2024 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ **************************************************************************/
+
+#include <cstring>
+
+#include "GLES2/gl2.h"
+
+#include "dc_test.h"
+#include "pi_glstate.h"
+
+namespace {
+
+// Programs of the stub GL: pi_ ones, and one of the host without matrices.
+// Each test that needs uniforms never sent uses a program of its own.
+const GLint kOwned = 1, kHost = 2, kView = 3, kFrame = 4;
+
+// What the stub GL was asked, and its current state
+struct StubGL {
+  long programs, enables, uniforms, draws;
+  GLuint program;
+  bool blend;
+
+  void Reset() {
+    programs = enables = uniforms = draws = 0;
+    program = 0;
+    blend = false;
+  }
+} s_gl;
+
+const GLfloat kRed[4] = {1, 0, 0, 1}, kBlue[4] = {0, 0, 1, 1};
+
+void Matrix(GLfloat *m, float scale) {
+  memset(m, 0, 16 * sizeof(GLfloat));
+  m[0] = m[5] = scale;
+  m[10] = m[15] = 1;
+}
+
+}  // namespace
+
+extern "C" {
+
+void glUseProgram(GLuint program) {
+  s_gl.programs++;
+  s_gl.program = program;
+}
+
+void glEnable(GLenum cap) {
+  s_gl.enables++;
+  if (cap == GL_BLEND) s_gl.blend = true;
+}
+
+void glDisable(GLenum cap) {
+  s_gl.enables++;
+  if (cap == GL_BLEND) s_gl.blend = false;
+}
+
+void glUniform4fv(GLint, GLsizei, const GLfloat *) { s_gl.uniforms++; }
+
+void glUniformMatrix4fv(GLint, GLsizei, GLboolean, const GLfloat *) {
+  s_gl.uniforms++;
+}
+
+void glDrawArrays(GLenum, GLint, GLsizei) { s_gl.draws++; }
+
+GLint glGetAttribLocation(GLuint, const GLchar *name) {
+  return strcmp(name, "position") ? -1 : 0;
+}
+
+GLint glGetUniformLocation(GLuint program, const GLchar *name) {
+  if (!strcmp(name, "color")) return 1;
+  if (program == (GLuint)kHost) return -1;
+  if (!strcmp(name, "MVMatrix")) return 2;
+  if (!strcmp(name, "TransformMatrix")) return 3;
+  return -1;
+}
+
+}  // extern "C"
+
+namespace {
+
+// A new frame with nothing known of the GL state
+void Start() {
+  pi_beginGLFrame();
+  s_gl.Reset();
+}
+
+// The same program is bound once, and 0 unbinds it
+int TestUseProgram() {
+  Start();
+  pi_useProgram(kOwned);
+  pi_useProgram(kOwned);
+  CHECK(s_gl.programs == 1 && s_gl.program == (GLuint)kOwned);
+
+  pi_useProgram(0);
+  CHECK(s_gl.programs == 2 && s_gl.program == 0);
+  pi_useProgram(0);
+  CHECK(s_gl.programs == 2);
+
+  pi_useProgram(kOwned);
+  CHECK(s_gl.programs == 3 && s_gl.program == (GLuint)kOwned);
+
+  // After a reset the program may have been changed by others
+  pi_resetGLState();
+  pi_useProgram(kOwned);
+  CHECK(s_gl.programs == 4);
+  return 0;
+}
+
+int TestEnabled() {
+  Start();
+  pi_setEnabled(GL_BLEND, true);
+  pi_setEnabled(GL_BLEND, true);
+  CHECK(s_gl.enables == 1 && s_gl.blend);
+  pi_setEnabled(GL_BLEND, false);
+  pi_setEnabled(GL_BLEND, false);
+  CHECK(s_gl.enables == 2 && !s_gl.blend);
+
+  pi_resetGLState();
+  pi_setEnabled(GL_BLEND, false);
+  CHECK(s_gl.enables == 3);
+  return 0;
+}
+
+// Unchanged uniforms are not sent again. Those of the pi_ programs survive
+// a reset, those of the host's programs don't.
+int TestUniforms() {
+  Start();
+  pi_getShader(kOwned).owned = true;
+
+  pi_useProgram(kOwned);
+  pi_setColor(kOwned, kRed);
+  pi_setColor(kOwned, kRed);
+  CHECK(s_gl.uniforms == 1);
+  pi_setColor(kOwned, kBlue);
+  CHECK(s_gl.uniforms == 2);
+
+  pi_useProgram(kHost);
+  pi_setColor(kHost, kRed);
+  pi_setColor(kHost, kRed);
+  CHECK(s_gl.uniforms == 3);
+
+  // The host program has no matrices to send
+  GLfloat m[16];
+  Matrix(m, 1);
+  pi_setTransform(kHost, m);
+  CHECK(s_gl.uniforms == 3);
+
+  pi_resetGLState();
+  pi_setColor(kHost, kRed);
+  CHECK(s_gl.uniforms == 4);
+  pi_useProgram(kOwned);
+  pi_setColor(kOwned, kBlue);
+  CHECK(s_gl.uniforms == 4);
+  return 0;
+}
+
+// The program is only bound to send matrices which changed
+int TestViewMatrices() {
+  Start();
+  GLfloat mv[16], I[16];
+  Matrix(mv, 0.5f);
+  Matrix(I, 1);
+
+  pi_getShader(kView).owned = true;
+  pi_setViewMatrices(kView, mv, I);
+  pi_setViewMatrices(kView, mv, I);
+  CHECK(s_gl.programs == 1 && s_gl.uniforms == 2);
+
+  pi_useProgram(0);
+  pi_setViewMatrices(kView, mv, I);
+  CHECK(s_gl.programs == 2 && s_gl.program == 0);
+
+  Matrix(mv, 0.25f);
+  pi_setViewMatrices(kView, mv, I);
+  CHECK(s_gl.programs == 3 && s_gl.uniforms == 3);
+  CHECK(s_gl.program == (GLuint)kView);
+  return 0;
+}
+
+// The counts of a frame are those of the calls made and skipped in it
+int TestCounts() {
+  Start();
+  pi_getShader(kFrame).owned = true;
+  GLfloat I[16];
+  Matrix(I, 1);
+
+  pi_useProgram(kFrame);              // program
+  pi_setTransform(kFrame, I);         // uniform
+  pi_setColor(kFrame, kRed);          // uniform
+  pi_setColor(kFrame, kRed);          // skipped
+  pi_setEnabled(GL_BLEND, true);      // enable
+  pi_drawArrays(GL_TRIANGLES, 0, 3);  // draw
+  pi_setEnabled(GL_BLEND, true);      // skipped
+  pi_drawArrays(GL_TRIANGLES, 0, 3);  // draw
+  pi_useProgram(kFrame);              // skipped
+  pi_useProgram(0);                   // program
+  pi_beginGLFrame();
+
+  const piGLCallCounts &counts = pi_getGLCallCounts();
+  CHECK(counts.programs == 2 && s_gl.programs == 2);
+  CHECK(counts.uniforms == 2 && s_gl.uniforms == 2);
+  CHECK(counts.enables == 1 && s_gl.enables == 1);
+  CHECK(counts.draws == 2 && s_gl.draws == 2);
+  CHECK(counts.skipped == 3);
+
+  // A frame with nothing drawn counts nothing
+  pi_beginGLFrame();
+  CHECK(pi_getGLCallCounts().programs == 0);
+  CHECK(pi_getGLCallCounts().skipped == 0);
+  return 0;
+}
+
+}  // namespace
+
+int main() {
+  int failures = TestUseProgram() + TestEnabled() + TestUniforms() +
+                 TestViewMatrices() + TestCounts();
+
+  if (failures == 0) printf("test_glstate: all tests passed\n");
+  return failures != 0;
+}
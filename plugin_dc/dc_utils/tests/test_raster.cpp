@@ -0,0 +1,191 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Tests of piRasterSink, against a golden image.
+ *
+ ***************************************************************************
+ *   Copyright (C) 2024 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ **************************************************************************/
+
+
+#include <limits>
+#include <string>
+
+#include "dc_test.h"
+#include "pi_drawbatch.h"
+#include "pi_raster.h"
+#include "pi_stroker.h"
+
+namespace {
+
+const int WIDTH = 24, HEIGHT = 12;
+
+// The pixels of a raster as one character each, by color
+std::string Ascii(const piRasterSink &raster) {
+  std::string out;
+  const unsigned char *p = raster.GetPixels();
+  for (int y = 0; y < raster.GetHeight(); y++) {
+    for (int x = 0; x < raster.GetWidth(); x++, p += 4) {
+      if (p[0] == 0 && p[1] == 0 && p[2] == 0)
+        out += '.';
+      else if (p[0] == 255 && p[1] == 0 && p[2] == 0)
+        out += 'R';
+      else if (p[0] == 0 && p[1] == 255 && p[2] == 0)
+        out += 'G';
+      else if (p[0] == 0 && p[1] == 0 && p[2] == 255)
+        out += 'B';
+      else if (p[0] == 128 && p[1] == 0 && p[2] == 0)
+        out += 'r';  // half red over black
+      else if (p[0] == 128 && p[1] == 127 && p[2] == 0)
+        out += 'y';  // over green
+      else if (p[0] == 128 && p[1] == 0 && p[2] == 127)
+        out += 'm';  // over blue
+      else if (p[0] == 255 && p[1] == 255 && p[2] == 255)
+        out += 'W';
+      else
+        out += '?';
+    }
+    out += '\n';
+  }
+  return out;
+}
+
+void Color(piDrawState &state, int r, int g, int b, int a = 255) {
+  state.color[0] = r, state.color[1] = g, state.color[2] = b;
+  state.color[3] = a;
+}
+
+// What piDC draws through the batch: a filled rectangle with its outline,
+// a half transparent triangle over it, a dashed stroke and a glyph
+void DrawScene(piRasterSink &raster) {
+  piDrawBatch batch;
+  piDrawState state;
+  batch.SetSink(&raster);
+  raster.Clear(0, 0, 0);
+
+  state.mode = piDrawState::TRIANGLES;
+  Color(state, 0, 0, 255);
+  float rect[] = {2, 1, 10, 1, 10, 7, 2, 7};
+  batch.AddTriangleFan(state, rect, 4);
+
+  state.mode = piDrawState::LINES;
+  Color(state, 0, 255, 0);
+  float outline[] = {1, 0, 10, 0, 10, 7, 1, 7};
+  batch.AddLineStrip(state, outline, 4, true);
+
+  state.mode = piDrawState::TRIANGLES;
+  state.blend = true;
+  Color(state, 255, 0, 0, 128);
+  float triangle[] = {6, 2, 14, 2, 6, 6};
+  batch.AddTriangleFan(state, triangle, 3);
+  batch.Flush();
+
+  piStroker stroker;
+  float dashes[] = {3, 2};
+  float line[] = {1, 10, 23, 10};
+  stroker.SetWidth(2);
+  stroker.SetDashes(dashes, 2);
+  unsigned char white[4] = {255, 255, 255, 255};
+  int count = stroker.Stroke(line, 2);
+  raster.FillTriangleStrip(stroker.GetVertices(), count, white, true);
+
+  // A 2 x 2 texture with one opaque texel, drawn over 4 x 4 pixels
+  unsigned char texture[4] = {0, 255, 0, 0};
+  float quad[] = {0, 0, 0, 0, 4, 0, 1, 0, 4, 4, 1, 1,
+                  4, 4, 1, 1, 0, 4, 0, 1, 0, 0, 0, 0};
+  unsigned char red[4] = {255, 0, 0, 255};
+  raster.DrawAlphaTriangles(quad, 6, 17, 2, texture, 2, 2, red);
+}
+
+// Pixels are covered when their center is inside, so the shapes end half
+// open like in GL: the outline misses its bottom right corner
+const char *golden =
+    ".GGGGGGGGGG.............\n"
+    ".GBBBBBBBBG.............\n"
+    ".GBBBBmmmmyrr......RR...\n"
+    ".GBBBBmmmmy........RR...\n"
+    ".GBBBBmmmBG.............\n"
+    ".GBBBBmBBBG.............\n"
+    ".GBBBBBBBBG.............\n"
+    ".GGGGGGGGG..............\n"
+    "........................\n"
+    ".WWW..WWW..WWW..WWW..WW.\n"
+    ".WWW..WWW..WWW..WWW..WW.\n"
+    "........................\n";
+
+int TestGolden() {
+  piRasterSink raster(WIDTH, HEIGHT);
+  DrawScene(raster);
+  std::string ascii = Ascii(raster);
+  if (ascii != golden) fprintf(stderr, "%s", ascii.c_str());
+  CHECK(ascii == golden);
+
+  // The same again in a reused raster
+  raster.Clear(255, 255, 255);
+  DrawScene(raster);
+  CHECK(Ascii(raster) == golden);
+  return 0;
+}
+
+// Triangles far outside the image, infinite or not a number draw nothing,
+// without overflowing the pixel ranges
+int TestFarTriangles() {
+  piRasterSink raster(WIDTH, HEIGHT);
+  raster.Clear(0, 0, 0);
+  std::string empty = Ascii(raster);
+
+  piDrawState state;
+  state.mode = piDrawState::TRIANGLES;
+  const float inf = std::numeric_limits<float>::infinity();
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  float far[][6] = {{3e9f, 5, 3.1e9f, 5, 3e9f, 20},
+                    {-3.1e9f, 5, -3e9f, 5, -3e9f, 20},
+                    {5, 3e9f, 20, 3e9f, 5, 3.1e9f},
+                    {5, -3e9f, 20, -3e9f, 5, -3.1e9f},
+                    {inf, 5, 3, 5, 3, 20},
+                    {1, 1, -inf, 5, 20, 20},
+                    {nan, 5, 3, 5, 3, 20},
+                    {1, 1, 20, nan, 20, 20},
+                    {nan, nan, nan, nan, nan, nan}};
+  for (size_t i = 0; i < sizeof far / sizeof far[0]; i++) {
+    raster.Draw(state, far[i], 3);
+    CHECK(Ascii(raster) == empty);
+  }
+
+  // A triangle much larger than the image covers all of it
+  float huge[] = {-3e9f, -3e9f, 3e9f, -3e9f, 0, 3e9f};
+  raster.Draw(state, huge, 3);
+  CHECK(Ascii(raster).find_first_not_of("W\n") == std::string::npos);
+
+  // Also lines, which the raster fills as quads
+  raster.Clear(0, 0, 0);
+  state.mode = piDrawState::LINES;
+  float lines[] = {3e9f, 5, 3.1e9f, 6, nan, 0, 10, 10, 0, inf, 10, 10};
+  raster.Draw(state, lines, 6);
+  CHECK(Ascii(raster) == empty);
+  return 0;
+}
+
+}  // namespace
+
+int main() {
+  int failures = TestGolden() + TestFarTriangles();
+
+  if (failures == 0) printf("test_raster: all tests passed\n");
+  return failures != 0;
+}
@@ -0,0 +1,135 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Tests of the circles, disks and sectors piDC draws from its
+ *           unit circle tables, rasterized headless against their areas.
+ *
+ ***************************************************************************
+ *   Copyright (C) 2024 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ **************************************************************************/
+
+#include <wx/wx.h>
+
+#include "dc_test.h"
+#include "pi_raster.h"
+#include "pidc.h"
+
+namespace {
+
+const int SIZE = 110, CX = 50, CY = 50;
+
+// The polygons of the tables fall inside the circles, and the pixels are
+// covered by their centers: both stay within 3% of the area at these radii
+const double TOLERANCE = 0.03;
+
+// Number of pixels drawn red over the black raster
+long Coverage(const piRasterSink &raster) {
+  long covered = 0;
+  const unsigned char *p = raster.GetPixels();
+  for (int i = 0; i < raster.GetWidth() * raster.GetHeight(); i++, p += 4)
+    if (p[0] == 255 && p[1] == 0 && p[2] == 0) covered++;
+  return covered;
+}
+
+bool Near(long covered, double area) {
+  return std::fabs(covered - area) <= TOLERANCE * area;
+}
+
+// Filled red without an outline, so that only the fill is counted
+void Setup(piDC &dc, piRasterSink &raster) {
+  raster.Clear(0, 0, 0);
+  dc.SetPen(wxPen(*wxBLACK, 1, wxPENSTYLE_TRANSPARENT));
+  dc.SetBrush(wxBrush(wxColour(255, 0, 0)));
+}
+
+int TestCircle() {
+  piRasterSink raster(SIZE, SIZE);
+  piDC dc(raster);
+
+  const int radii[] = {5, 12, 40};
+  for (size_t i = 0; i < sizeof radii / sizeof radii[0]; i++) {
+    Setup(dc, raster);
+    dc.DrawCircle(CX, CY, radii[i]);
+    dc.FlushBatch();
+    double area = M_PI * radii[i] * radii[i];
+    if (radii[i] < 12)  // a few pixels, only roughly round
+      CHECK(std::fabs(Coverage(raster) - area) <= 0.2 * area);
+    else
+      CHECK(Near(Coverage(raster), area));
+  }
+  return 0;
+}
+
+// The inner ring is a hole in the outer one
+int TestDisk() {
+  piRasterSink raster(SIZE, SIZE);
+  piDC dc(raster);
+
+  Setup(dc, raster);
+  dc.DrawDisk(CX, CY, 20, 40);
+  dc.FlushBatch();
+  CHECK(Near(Coverage(raster), M_PI * (40 * 40 - 20 * 20)));
+
+  // Nothing is drawn in the hole
+  const unsigned char *center = raster.GetPixels() + 4 * (CY * SIZE + CX);
+  CHECK(center[0] == 0);
+  return 0;
+}
+
+// Sectors of the ring between radii 20 and 40: from the inner start x1,y1
+// out to x2,y2, along the outer arc to x3,y3, in to x4,y4 and back along
+// the inner arc
+int TestSector() {
+  piRasterSink raster(SIZE, SIZE);
+  piDC dc(raster);
+  const double ring = M_PI * (40 * 40 - 20 * 20);
+
+  // A quarter, from 0 to 90 degrees
+  Setup(dc, raster);
+  dc.DrawSector(CX, CY, CX + 20, CY, CX + 40, CY, CX, CY + 40, CX, CY + 20);
+  dc.FlushBatch();
+  CHECK(Near(Coverage(raster), ring / 4));
+
+  // A half, from -90 to 90 degrees
+  Setup(dc, raster);
+  dc.DrawSector(CX, CY, CX, CY - 20, CX, CY - 40, CX, CY + 40, CX, CY + 20);
+  dc.FlushBatch();
+  CHECK(Near(Coverage(raster), ring / 2));
+
+  // Three quarters, from 90 to 0 degrees the long way round
+  Setup(dc, raster);
+  dc.DrawSector(CX, CY, CX, CY + 20, CX, CY + 40, CX + 40, CY, CX + 20, CY);
+  dc.FlushBatch();
+  CHECK(Near(Coverage(raster), 3 * ring / 4));
+
+  // An empty sector covers nothing
+  Setup(dc, raster);
+  dc.DrawSector(CX, CY, CX + 20, CY, CX + 40, CY, CX + 40, CY, CX + 20, CY);
+  dc.FlushBatch();
+  CHECK(Coverage(raster) == 0);
+  return 0;
+}
+
+}  // namespace
+
+int main() {
+  int failures = TestCircle() + TestDisk() + TestSector();
+
+  if (failures == 0) printf("test_shapes: all tests passed\n");
+  return failures != 0;
+}
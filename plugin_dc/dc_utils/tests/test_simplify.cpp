@@ -0,0 +1,204 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Tests of the culling and decimation of piSimplifier.
+ *
+ ***************************************************************************
+ *   Copyright (C) 2024 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ **************************************************************************/
+
+
+#include "dc_test.h"
+#include "pi_simplify.h"
+
+#ifndef M_PI
+#define M_PI 3.1415926535897931160E0
+#endif
+
+namespace {
+
+// Twice the signed area of a polygon
+long Area2(const wxPoint *p, int n) {
+  long area = 0;
+  for (int i = 0; i < n; i++) {
+    const wxPoint &a = p[i], &b = p[(i + 1) % n];
+    area += (long)a.x * b.y - (long)b.x * a.y;
+  }
+  return area;
+}
+
+// Points of out in the same order as in points, as a subsequence
+bool Subsequence(const wxPoint *out, int n, const std::vector<wxPoint> &in) {
+  size_t j = 0;
+  for (int i = 0; i < n; i++) {
+    while (j < in.size() && in[j] != out[i]) j++;
+    if (j == in.size()) return false;
+  }
+  return true;
+}
+
+// A line of 1000 points one pixel apart
+std::vector<wxPoint> Dense() {
+  std::vector<wxPoint> points;
+  for (int i = 0; i < 1000; i++) points.push_back(wxPoint(i, i % 2));
+  return points;
+}
+
+// Points closer than the tolerance are merged, the ends are kept
+int TestTolerance() {
+  piSimplifier simplifier;
+  std::vector<wxPoint> line = Dense();
+
+  CHECK(simplifier.SimplifyLines(1000, &line[0]) == 1);
+  CHECK(simplifier.GetPieces()[0] == 1000);
+
+  simplifier.SetTolerance(4);
+  CHECK(simplifier.SimplifyLines(1000, &line[0]) == 1);
+  int n = simplifier.GetPieces()[0];
+  const wxPoint *p = simplifier.GetPoints();
+  CHECK(n > 1000 / 5 && n <= 1000 / 3);
+  CHECK(p[0] == line[0] && p[n - 1] == line[999]);
+  CHECK(Subsequence(p, n, line));
+  for (int i = 1; i < n - 1; i++) {
+    float dx = p[i].x - p[i - 1].x, dy = p[i].y - p[i - 1].y;
+    CHECK(dx * dx + dy * dy >= 4 * 4);
+  }
+
+  // Shorter than the tolerance, a line keeps both its ends
+  CHECK(simplifier.SimplifyLines(3, &line[0]) == 1);
+  CHECK(simplifier.GetPieces()[0] == 2);
+  CHECK(simplifier.GetPoints()[1] == line[2]);
+  return 0;
+}
+
+// Segments beyond a side of the clip rectangle are dropped, and the
+// polyline is split where they were
+int TestCulling() {
+  piSimplifier simplifier;
+  simplifier.SetClipRect(wxRect(0, 0, 100, 100));
+
+  // In, out beyond the right side and back in, then out below
+  wxPoint line[] = {wxPoint(10, 10),  wxPoint(50, 50),  wxPoint(150, 50),
+                    wxPoint(200, 60), wxPoint(150, 70), wxPoint(50, 70),
+                    wxPoint(50, 150), wxPoint(60, 300)};
+  CHECK(simplifier.SimplifyLines(8, line) == 2);
+  const int *pieces = simplifier.GetPieces();
+  CHECK(pieces[0] == 3 && pieces[1] == 3);
+  const wxPoint *p = simplifier.GetPoints();
+  CHECK(p[0] == line[0] && p[2] == line[2]);
+  CHECK(p[3] == line[4] && p[5] == line[6]);
+
+  // A segment crossing the rectangle is kept, whatever its ends
+  wxPoint across[] = {wxPoint(-50, 50), wxPoint(150, 50)};
+  CHECK(simplifier.SimplifyLines(2, across) == 1);
+
+  // Nothing is left of a polyline entirely beyond one side
+  wxPoint above[] = {wxPoint(-50, -10), wxPoint(150, -20), wxPoint(50, -5)};
+  CHECK(simplifier.SimplifyLines(3, above) == 0);
+  CHECK(simplifier.GetPoints() == NULL);
+
+  // An empty rectangle clips nothing
+  simplifier.SetClipRect(wxRect());
+  CHECK(simplifier.SimplifyLines(3, above) == 1);
+  return 0;
+}
+
+// Polygons are clipped to the rectangle, keeping the area inside it
+int TestPolygonClip() {
+  piSimplifier simplifier;
+  simplifier.SetClipRect(wxRect(0, 0, 100, 100));
+
+  wxPoint inside[] = {wxPoint(10, 10), wxPoint(90, 10), wxPoint(90, 90),
+                      wxPoint(10, 90)};
+  CHECK(simplifier.SimplifyPolygon(4, inside) == 4);
+  CHECK(Area2(simplifier.GetPoints(), 4) == Area2(inside, 4));
+
+  // Covering the rectangle, in both orientations
+  wxPoint larger[] = {wxPoint(-100, -100), wxPoint(200, -100),
+                      wxPoint(200, 200), wxPoint(-100, 200)};
+  int n = simplifier.SimplifyPolygon(4, larger);
+  CHECK(n == 4 && Area2(simplifier.GetPoints(), n) == 2 * 100 * 100);
+  wxPoint reversed[] = {larger[3], larger[2], larger[1], larger[0]};
+  n = simplifier.SimplifyPolygon(4, reversed);
+  CHECK(n == 4 && Area2(simplifier.GetPoints(), n) == -2 * 100 * 100);
+
+  // A triangle across a corner keeps the square inside it
+  wxPoint corner[] = {wxPoint(50, 50), wxPoint(150, 50), wxPoint(50, 150)};
+  n = simplifier.SimplifyPolygon(3, corner);
+  CHECK(n == 5);
+  CHECK(Area2(simplifier.GetPoints(), n) == 2 * 50 * 50);
+
+  wxPoint beyond[] = {wxPoint(150, 0), wxPoint(250, 0), wxPoint(200, 90)};
+  CHECK(simplifier.SimplifyPolygon(3, beyond) == 0);
+  CHECK(simplifier.SimplifyPolygon(2, inside) == 0);
+  return 0;
+}
+
+// The tolerance merges the points of a polygon too, down to nothing when
+// it is smaller than a pixel
+int TestPolygonTolerance() {
+  piSimplifier simplifier;
+  simplifier.SetTolerance(4);
+
+  std::vector<wxPoint> circle;
+  for (int i = 0; i < 360; i++)
+    circle.push_back(wxPoint((int)floor(100 * cos(i * M_PI / 180) + 0.5),
+                             (int)floor(100 * sin(i * M_PI / 180) + 0.5)));
+  int n = simplifier.SimplifyPolygon(360, &circle[0]);
+  CHECK(n >= 100 && n < 180);
+  CHECK(Subsequence(simplifier.GetPoints(), n, circle));
+  CHECK(std::abs(Area2(simplifier.GetPoints(), n) - Area2(&circle[0], 360)) <
+        Area2(&circle[0], 360) / 100);
+
+  // The last point, close to the first, is dropped
+  const wxPoint *p = simplifier.GetPoints();
+  float dx = p[n - 1].x - p[0].x, dy = p[n - 1].y - p[0].y;
+  CHECK(dx * dx + dy * dy >= 4 * 4);
+
+  wxPoint tiny[] = {wxPoint(0, 0), wxPoint(1, 0), wxPoint(1, 1),
+                    wxPoint(0, 1)};
+  CHECK(simplifier.SimplifyPolygon(4, tiny) == 0);
+  return 0;
+}
+
+int TestStats() {
+  piSimplifier simplifier;
+  std::vector<wxPoint> line = Dense();
+  simplifier.SetTolerance(4);
+
+  simplifier.SimplifyLines(1000, &line[0]);
+  int out = simplifier.GetPieces()[0];
+  simplifier.SimplifyPolygon(2, &line[0]);
+
+  const piSimplifier::Stats &stats = simplifier.GetStats();
+  CHECK(stats.calls == 2);
+  CHECK(stats.pointsIn == 1002 && stats.pointsOut == (unsigned long)out);
+  simplifier.ResetStats();
+  CHECK(stats.calls == 0 && stats.pointsIn == 0 && stats.pointsOut == 0);
+  return 0;
+}
+
+}  // namespace
+
+int main() {
+  int failures = TestTolerance() + TestCulling() + TestPolygonClip() +
+                 TestPolygonTolerance() + TestStats();
+
+  if (failures == 0) printf("test_simplify: all tests passed\n");
+  return failures != 0;
+}
@@ -0,0 +1,182 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Tests of the geometry of piStroker.
+ *
+ ***************************************************************************
+ *   Copyright (C) 2024 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ **************************************************************************/
+
+#include <new>
+
+#include "dc_test.h"
+#include "pi_stroker.h"
+
+#ifndef M_PI
+#define M_PI 3.1415926535897931160E0
+#endif
+
+namespace {
+
+// Area of the outline of the last Stroke(): the triangles of a stroke do
+// not overlap, so it is the sum of the areas of the triangles of its strip
+double StripArea(const piStroker &stroker) {
+  const float *v = stroker.GetVertices();
+  std::vector<float> triangles;
+  for (int i = 0; i + 2 < stroker.GetVertexCount(); i++)
+    triangles.insert(triangles.end(), v + 2 * i, v + 2 * i + 6);
+  return TriangleArea(triangles);
+}
+
+bool Near(double a, double b, double tolerance = 1e-3) {
+  return std::fabs(a - b) <= tolerance;
+}
+
+// Straight lines with each cap
+int TestCaps() {
+  piStroker stroker;
+  float line[] = {0, 0, 10, 0};
+  stroker.SetWidth(2);
+
+  stroker.SetCap(piStroker::CAP_BUTT);
+  CHECK(stroker.Stroke(line, 2) > 0);
+  CHECK(Near(StripArea(stroker), 20));
+
+  stroker.SetCap(piStroker::CAP_SQUARE);
+  stroker.Stroke(line, 2);
+  CHECK(Near(StripArea(stroker), 24));
+
+  // Round caps are polygons within the round tolerance of the circle
+  stroker.SetCap(piStroker::CAP_ROUND);
+  stroker.Stroke(line, 2);
+  CHECK(StripArea(stroker) < 20 + M_PI);
+  CHECK(StripArea(stroker) > 20 + M_PI - 0.5);
+  return 0;
+}
+
+// A right angle with each join, turning either way: the outline is the
+// union of the two segments and the join, with no part covered twice
+int TestJoins() {
+  piStroker stroker;
+  float left[] = {0, 0, 10, 0, 10, 10};
+  float right[] = {0, 0, 10, 0, 10, -10};
+  stroker.SetWidth(2);
+  stroker.SetCap(piStroker::CAP_BUTT);
+
+  for (int turn = 0; turn < 2; turn++) {
+    float *points = turn ? right : left;
+
+    stroker.SetJoin(piStroker::JOIN_MITER);
+    stroker.Stroke(points, 3);
+    CHECK(Near(StripArea(stroker), 40));
+
+    stroker.SetJoin(piStroker::JOIN_BEVEL);
+    stroker.Stroke(points, 3);
+    CHECK(Near(StripArea(stroker), 39.5));
+
+    stroker.SetJoin(piStroker::JOIN_ROUND);
+    stroker.Stroke(points, 3);
+    CHECK(StripArea(stroker) < 39 + M_PI / 4);
+    CHECK(StripArea(stroker) > 39.5);
+  }
+
+  // Past the miter limit, a sharp turn is beveled
+  float sharp[] = {0, 0, 10, 0, 0, 1};
+  stroker.SetJoin(piStroker::JOIN_MITER);
+  stroker.SetMiterLimit(2);
+  stroker.Stroke(sharp, 3);
+  double beveled = StripArea(stroker);
+  stroker.SetMiterLimit(100);
+  stroker.Stroke(sharp, 3);
+  CHECK(StripArea(stroker) > beveled + 1);
+  return 0;
+}
+
+// Closed outlines join their last and first segments
+int TestClosed() {
+  piStroker stroker;
+  float square[] = {0, 0, 10, 0, 10, 10, 0, 10};
+  stroker.SetWidth(2);
+  stroker.SetJoin(piStroker::JOIN_MITER);
+
+  stroker.Stroke(square, 4, true);
+  CHECK(Near(StripArea(stroker), 12 * 12 - 8 * 8));
+
+  // Also with the first point repeated at the end
+  float repeated[] = {0, 0, 10, 0, 10, 10, 0, 10, 0, 0};
+  stroker.Stroke(repeated, 5, true);
+  CHECK(Near(StripArea(stroker), 12 * 12 - 8 * 8));
+  return 0;
+}
+
+// Dashes are cut at their length and run on across corners
+int TestDashes() {
+  piStroker stroker;
+  float dashes[] = {10, 10};
+  float line[] = {0, 0, 100, 0};
+  stroker.SetWidth(2);
+  stroker.SetCap(piStroker::CAP_BUTT);
+  stroker.SetDashes(dashes, 2);
+
+  stroker.Stroke(line, 2);
+  CHECK(Near(StripArea(stroker), 5 * 10 * 2));
+
+  // Along a corner, the gap takes the last 5 of the first segment and the
+  // first 5 of the second
+  float corner[] = {0, 0, 15, 0, 15, 15};
+  stroker.SetJoin(piStroker::JOIN_BEVEL);
+  stroker.Stroke(corner, 3);
+  CHECK(Near(StripArea(stroker), 2 * 10 * 2));
+
+  // An odd pattern is repeated twice: 10 on, 5 off, 10 on, 10 off, 5 on,
+  // 10 off
+  float odd[] = {10, 5, 10};
+  stroker.SetDashes(odd, 3);
+  stroker.Stroke(line, 2);
+  CHECK(Near(StripArea(stroker), 2 * (10 + 10 + 5) * 2));
+
+  stroker.SetDashes(NULL, 0);
+  stroker.Stroke(line, 2);
+  CHECK(Near(StripArea(stroker), 100 * 2));
+  return 0;
+}
+
+// Nothing to draw, and points too close to have a direction
+int TestDegenerate() {
+  piStroker stroker;
+  float point[] = {5, 5};
+  float same[] = {5, 5, 5, 5, 5, 5};
+  float zigzag[] = {0, 0, 10, 0, 10, 0, 10, 1e-5f, 20, 0};
+  stroker.SetWidth(2);
+
+  CHECK(stroker.Stroke(point, 1) == 0);
+  CHECK(stroker.Stroke(same, 3) == 0);
+  CHECK(stroker.Stroke(zigzag, 5) > 0);
+  CHECK(Near(StripArea(stroker), 40, 0.01));
+  return 0;
+}
+
+}  // namespace
+
+int main() {
+  int failures = TestCaps() + TestJoins() + TestClosed() + TestDashes() +
+                 TestDegenerate();
+
+  if (failures == 0) printf("test_stroker: all tests passed\n");
+  return failures != 0;
+}
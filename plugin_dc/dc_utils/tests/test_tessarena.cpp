@@ -0,0 +1,271 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Tests of piTessArena and of the allocations of piTessCache.
+ *
+ ***************************************************************************
+ *   Copyright (C) 2024 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ **************************************************************************/
+
+#include <new>
+
+#ifdef __APPLE__
+#include "OpenGL/glu.h"
+#else
+#include "GL/glu.h"
+#endif
+
+#include "dc_test.h"
+#include "pi_tesscache.h"
+
+static long s_news;
+
+void *operator new(size_t size) {
+  s_news++;
+  void *p = malloc(size ? size : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+namespace {
+
+// The storage of one draw holds what was written to it until Reset(),
+// across the growth of the arena
+int TestArenaStorage() {
+  piTessArena arena;
+  std::vector<double *> vertices;
+
+  for (int round = 0; round < 3; round++) {
+    arena.Reset(round * 100);
+    vertices.clear();
+    for (int i = 0; i < 5000; i++) {
+      double *v = arena.Alloc(3);
+      v[0] = i;
+      v[1] = -i;
+      v[2] = round;
+      vertices.push_back(v);
+    }
+    double *large = arena.Alloc(10000);
+    large[0] = large[9999] = -1;
+
+    for (int i = 0; i < 5000; i++) {
+      CHECK(vertices[i][0] == i && vertices[i][1] == -i);
+      CHECK(vertices[i][2] == round);
+    }
+    CHECK(large[0] == -1 && large[9999] == -1);
+  }
+  return 0;
+}
+
+// Once the arena has merged the blocks of the largest draw, or was reset
+// with a large enough estimate, it stops allocating
+int TestArenaNoAllocations() {
+  piTessArena arena;
+
+  for (int round = 0; round < 4; round++) {
+    long news = s_news;
+    arena.Reset(100);
+    for (int i = 0; i < 5000; i++) arena.Alloc(3);
+    if (round > 1) CHECK(s_news == news);
+  }
+
+  piTessArena sized;
+  sized.Reset(3 * 5000);
+  long news = s_news;
+  for (int i = 0; i < 5000; i++) sized.Alloc(3);
+  CHECK(s_news == news);
+  return 0;
+}
+
+// With the cache disabled, tessellating the same polygon again allocates
+// nothing, intersections included
+int TestCacheNoAllocations() {
+  piTessCache &cache = piTessCache::Get();
+  static wxPoint points[2000];
+  int npoints[2] = {1000, 1000};
+
+  for (int i = 0; i < 1000; i++) {
+    double a = i * 2 * M_PI / 1000;
+    points[i] = wxPoint(lround(500 * cos(a)), lround(500 * sin(a)));
+    points[1000 + i] =
+        wxPoint(lround(300 * cos(a + 0.3)) + 150, lround(300 * sin(a)));
+  }
+
+  cache.SetLimit(0);
+  size_t size =
+      cache.Tessellate(2, npoints, points, GLU_TESS_WINDING_ODD).size();
+  CHECK(size > 0);
+  for (int round = 0; round < 3; round++) {
+    long news = s_news;
+    CHECK(cache.Tessellate(2, npoints, points, GLU_TESS_WINDING_ODD).size() ==
+          size);
+    CHECK(s_news == news);
+  }
+  return 0;
+}
+
+// The combined vertices of crossing contours are right
+int TestCrossing() {
+  wxPoint points[] = {wxPoint(0, 0),  wxPoint(10, 0),  wxPoint(10, 10),
+                      wxPoint(0, 10), wxPoint(5, 5),   wxPoint(15, 5),
+                      wxPoint(15, 15), wxPoint(5, 15)};
+  int npoints[2] = {4, 4};
+
+  piTessCache::Get().SetLimit(0);
+  const std::vector<float> &triangles =
+      piTessCache::Get().Tessellate(2, npoints, points, GLU_TESS_WINDING_ODD);
+  CHECK(std::fabs(TriangleArea(triangles) - 150) < 1e-3);
+  return 0;
+}
+
+// Whether the polygon is found in the cache: a miss runs the tessellator,
+// which allocates
+bool Hits(int ncontours, const int npoints[], const wxPoint points[],
+          int windingRule = GLU_TESS_WINDING_ODD) {
+  long news = s_news;
+  piTessCache::Get().Tessellate(ncontours, npoints, points, windingRule);
+  return s_news == news;
+}
+
+// Square of the given side at x,y
+void Square(wxPoint *points, int x, int y, int side) {
+  points[0] = wxPoint(x, y);
+  points[1] = wxPoint(x + side, y);
+  points[2] = wxPoint(x + side, y + side);
+  points[3] = wxPoint(x, y + side);
+}
+
+// A hit returns the triangles of the first call without allocating, also
+// for a translated copy of the polygon
+int TestCacheHit() {
+  piTessCache &cache = piTessCache::Get();
+  wxPoint points[8], moved[8];
+  int npoints[2] = {4, 4};
+
+  Square(points, 0, 0, 10);
+  Square(points + 4, 5, 5, 10);
+  for (int i = 0; i < 8; i++) moved[i] = points[i] + wxPoint(-300, 70);
+
+  cache.SetLimit(1000);
+  cache.Clear();
+  std::vector<float> first =
+      cache.Tessellate(2, npoints, points, GLU_TESS_WINDING_ODD);
+  CHECK(std::fabs(TriangleArea(first) - 150) < 1e-3);
+
+  for (int round = 0; round < 3; round++) {
+    long news = s_news;
+    CHECK(cache.Tessellate(2, npoints, points, GLU_TESS_WINDING_ODD) == first);
+    CHECK(cache.Tessellate(2, npoints, moved, GLU_TESS_WINDING_ODD) == first);
+    CHECK(s_news == news);
+  }
+  return 0;
+}
+
+// Another winding rule, or the same points split into other contours, is
+// another polygon
+int TestCacheMiss() {
+  piTessCache &cache = piTessCache::Get();
+  wxPoint points[8];
+  int npoints[2] = {4, 4}, joined[1] = {8};
+
+  Square(points, 0, 0, 10);
+  Square(points + 4, 5, 5, 10);
+
+  cache.SetLimit(1000);
+  cache.Clear();
+  CHECK(!Hits(2, npoints, points));
+  CHECK(Hits(2, npoints, points));
+
+  CHECK(!Hits(2, npoints, points, GLU_TESS_WINDING_NONZERO));
+  CHECK(std::fabs(TriangleArea(cache.Tessellate(
+                      2, npoints, points, GLU_TESS_WINDING_NONZERO)) -
+                  175) < 1e-3);
+  CHECK(std::fabs(TriangleArea(cache.Tessellate(2, npoints, points,
+                                                GLU_TESS_WINDING_ODD)) -
+                  150) < 1e-3);
+
+  CHECK(!Hits(1, joined, points));
+  CHECK(Hits(1, joined, points));
+  return 0;
+}
+
+// Beyond the vertex limit, the least recently used polygons are evicted
+int TestCacheVertexLimit() {
+  piTessCache &cache = piTessCache::Get();
+  wxPoint a[4], b[4], c[4];
+  int npoints[1] = {4};
+
+  Square(a, 0, 0, 10);
+  Square(b, 0, 0, 20);
+  Square(c, 0, 0, 30);
+
+  // A square is 4 points and 2 triangles, 10 vertices: room for two
+  cache.SetLimit(25);
+  cache.Clear();
+  CHECK(!Hits(1, npoints, a));
+  CHECK(!Hits(1, npoints, b));
+  CHECK(Hits(1, npoints, a));
+  CHECK(!Hits(1, npoints, c));
+
+  CHECK(Hits(1, npoints, a));
+  CHECK(Hits(1, npoints, c));
+  CHECK(!Hits(1, npoints, b));
+  return 0;
+}
+
+// Beyond the maximum number of polygons, the least recently used ones are
+// evicted
+int TestCacheEntryLimit() {
+  piTessCache &cache = piTessCache::Get();
+  const int entries = 1024;  // TESS_CACHE_ENTRIES
+  static wxPoint triangles[entries + 1][3];
+  int npoints[1] = {3};
+
+  for (int i = 0; i <= entries; i++) {
+    triangles[i][0] = wxPoint(0, 0);
+    triangles[i][1] = wxPoint(10 + i, 0);
+    triangles[i][2] = wxPoint(0, 10);
+  }
+
+  cache.SetLimit(100000);
+  cache.Clear();
+  for (int i = 0; i < entries; i++) CHECK(!Hits(1, npoints, triangles[i]));
+  CHECK(Hits(1, npoints, triangles[0]));
+  CHECK(!Hits(1, npoints, triangles[entries]));
+
+  CHECK(Hits(1, npoints, triangles[0]));
+  CHECK(Hits(1, npoints, triangles[2]));
+  CHECK(Hits(1, npoints, triangles[entries]));
+  CHECK(!Hits(1, npoints, triangles[1]));
+  return 0;
+}
+
+}  // namespace
+
+int main() {
+  int failures = TestArenaStorage() + TestArenaNoAllocations() +
+                 TestCacheNoAllocations() + TestCrossing() + TestCacheHit() +
+                 TestCacheMiss() + TestCacheVertexLimit() +
+                 TestCacheEntryLimit();
+
+  if (failures == 0) printf("test_tessarena: all tests passed\n");
+  return failures != 0;
+}
@@ -0,0 +1,199 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  textbench, a benchmark of piDC::GetTextExtent() laying out
+ *           many labels through the text extent cache.
+ *
+ ***************************************************************************
+ *   Copyright (C) 2024 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ *
+ * Usage: textbench [-runs n] [-labels n] [-fonts n] [-limit n]
+ *
+ * Lays out -labels labels, 10000 by default, the way chart overlays do:
+ * each label is measured to size its box, and again for the collision
+ * check against the labels placed before it. The labels are spread over
+ * -fonts fonts, 4 by default, switching fonts with SetFont() as drawing
+ * code does. -limit sets the number of strings kept per font, 4096 by
+ * default as in piTextExtentCache.
+ *
+ * The layout is timed with the cache off, on a cold cache and on a warm
+ * cache, and the best time of -runs rounds, 5 by default, is reported for
+ * each.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <wx/wx.h>
+
+#include "pi_textcache.h"
+#include "pidc.h"
+
+namespace {
+
+struct Options {
+  int runs, labels, fonts;
+  long limit;
+};
+
+double Now() {
+  return std::chrono::duration<double>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Waypoint names, light characteristics and soundings, all different
+std::vector<wxString> MakeLabels(int n) {
+  std::vector<wxString> labels;
+  for (int i = 0; i < n; i++) {
+    switch (i % 3) {
+      case 0:
+        labels.push_back(wxString::Format("WPT %05d", i));
+        break;
+      case 1:
+        labels.push_back(wxString::Format("Fl(%d) G %ds %dm No %d", 1 + i % 4,
+                                          2 + i % 9, 3 + i % 20, i));
+        break;
+      case 2:
+        labels.push_back(wxString::Format("%d.%d m", i / 10, i % 10));
+        break;
+    }
+  }
+  return labels;
+}
+
+// Places the labels in columns 100 pixels wide, a label spanning as many
+// as its width needs, each below the labels already placed in its columns.
+// Returns the sum of the label positions, so that nothing is optimized away.
+long Layout(piDC &dc, const std::vector<wxString> &labels,
+            const std::vector<wxFont> &fonts) {
+  const int columns = 100, columnWidth = 100;
+  std::vector<long> bottom(columns, 0);
+  long sum = 0;
+
+  for (size_t i = 0; i < labels.size(); i++) {
+    dc.SetFont(fonts[i % fonts.size()]);
+
+    wxCoord w, h;
+    dc.GetTextExtent(labels[i], &w, &h);  // box sizing
+    int first = i % columns;
+    int last = std::min(first + w / columnWidth, columns - 1);
+
+    // The collision check measures the label again
+    long y = 0;
+    dc.GetTextExtent(labels[i], &w, &h);
+    for (int c = first; c <= last; c++) y = std::max(y, bottom[c]);
+    for (int c = first; c <= last; c++) bottom[c] = y + h + 2;
+    sum += y;
+  }
+  return sum;
+}
+
+// Best time of the runs in ms, clearing the cache before each if cold
+double BestTime(piDC &dc, const std::vector<wxString> &labels,
+                const std::vector<wxFont> &fonts, int runs, bool cold,
+                long *layout) {
+  piTextExtentCache &cache = piTextExtentCache::Get();
+  double best = 0;
+
+  for (int i = 0; i < runs; i++) {
+    if (cold) cache.Clear();
+    double start = Now();
+    *layout = Layout(dc, labels, fonts);
+    double ms = 1000 * (Now() - start);
+    if (i == 0 || ms < best) best = ms;
+  }
+  return best;
+}
+
+void Usage() {
+  fprintf(stderr,
+          "Usage: textbench [-runs n] [-labels n] [-fonts n] [-limit n]\n");
+  exit(2);
+}
+
+int RunBench(const Options &options) {
+  std::vector<wxString> labels = MakeLabels(options.labels);
+  std::vector<wxFont> fonts;
+  for (int i = 0; i < options.fonts; i++)
+    fonts.push_back(wxFont(9 + 2 * i, wxFONTFAMILY_SWISS, wxFONTSTYLE_NORMAL,
+                           i % 2 ? wxFONTWEIGHT_BOLD : wxFONTWEIGHT_NORMAL));
+
+  piDC dc;
+  piTextExtentCache &cache = piTextExtentCache::Get();
+  long layouts[3];
+
+  cache.SetLimit(0);
+  double uncached =
+      BestTime(dc, labels, fonts, options.runs, false, &layouts[0]);
+  cache.SetLimit(options.limit);
+  double cold = BestTime(dc, labels, fonts, options.runs, true, &layouts[1]);
+  double warm = BestTime(dc, labels, fonts, options.runs, false, &layouts[2]);
+
+  printf("%d labels, %d fonts, %ld strings per font\n", options.labels,
+         options.fonts, options.limit);
+  printf("%-10s %10.2f ms\n", "uncached", uncached);
+  printf("%-10s %10.2f ms\n", "cold", cold);
+  printf("%-10s %10.2f ms\n", "warm", warm);
+
+  // The cache must not change the layout
+  if (layouts[1] != layouts[0] || layouts[2] != layouts[0]) {
+    fprintf(stderr, "textbench: the cached layout differs\n");
+    return 1;
+  }
+  return 0;
+}
+
+}  // namespace
+
+// Fonts and DCs need the GUI toolkit initialized, as by a wxApp
+class TextBenchApp : public wxApp {
+public:
+  bool OnInit() { return true; }
+
+  int OnRun() {
+    Options options;
+    options.runs = 5;
+    options.labels = 10000;
+    options.fonts = 4;
+    options.limit = 4096;
+
+    for (int iarg = 1; iarg < argc; iarg++) {
+      wxString arg = argv[iarg];
+      long value;
+      if (iarg + 1 == argc || !argv[++iarg].ToLong(&value)) Usage();
+      if (arg == "-runs")
+        options.runs = std::max(1L, value);
+      else if (arg == "-labels")
+        options.labels = std::max(1L, value);
+      else if (arg == "-fonts")
+        options.fonts = std::max(1L, value);
+      else if (arg == "-limit")
+        options.limit = std::max(0L, value);
+      else
+        Usage();
+    }
+    return RunBench(options);
+  }
+};
+
+wxIMPLEMENT_APP(TextBenchApp);
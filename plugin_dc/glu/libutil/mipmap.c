@@ -37,6 +37,15 @@
 #include <limits.h>		/* UINT_MAX */
 #include <math.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIPMAP_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define MIPMAP_NEON
+#include <arm_neon.h>
+#endif
+
 typedef union {
     unsigned char ub[4];
     unsigned short us[2];
@@ -223,6 +232,15 @@ static void halve1DimagePackedPixel(int,
 
 static void halve1Dimage_ubyte(GLint, GLuint, GLuint,const GLubyte *,
 			       GLubyte *, GLint, GLint, GLint);
+static void halveImage_ubyte_generic(GLint, GLuint, GLuint, const GLubyte *,
+				     GLubyte *, GLint, GLint, GLint);
+static void halveImage_ubyte_packed(GLint, GLuint, GLuint, const GLubyte *,
+				    GLubyte *, GLint);
+static void scale_internal_ubyte_generic(GLint, GLint, GLint, const GLubyte *,
+					 GLint, GLint, GLubyte *, GLint, GLint,
+					 GLint);
+static int scale_internal_ubyte_packed(GLint, GLint, GLint, const GLubyte *,
+				       GLint, GLint, GLubyte *, GLint);
 static void halve1Dimage_byte(GLint, GLuint, GLuint,const GLbyte *, GLbyte *,
 			      GLint, GLint, GLint);
 static void halve1Dimage_ushort(GLint, GLuint, GLuint, const GLushort *,
@@ -369,12 +387,6 @@ static void halveImage_ubyte(GLint components, GLuint width, GLuint height,
 			const GLubyte *datain, GLubyte *dataout,
 			GLint element_size, GLint ysize, GLint group_size)
 {
-    int i, j, k;
-    int newwidth, newheight;
-    int padBytes;
-    GLubyte *s;
-    const char *t;
-
     /* handle case where there is only 1 column/row */
     if (width == 1 || height == 1) {
        assert( !(width == 1 && height == 1) ); /* can't be 1x1 */
@@ -383,6 +395,29 @@ static void halveImage_ubyte(GLint components, GLuint width, GLuint height,
        return;
     }
 
+    /* tightly packed components, as always for 2D textures */
+    if (element_size == 1 && group_size == components && width % 2 == 0) {
+	halveImage_ubyte_packed(components, width, height, datain, dataout,
+				ysize);
+	return;
+    }
+
+    halveImage_ubyte_generic(components, width, height, datain, dataout,
+			     element_size, ysize, group_size);
+}
+
+/* halveImage_ubyte() for any layout of the components */
+static void halveImage_ubyte_generic(GLint components, GLuint width,
+				     GLuint height, const GLubyte *datain,
+				     GLubyte *dataout, GLint element_size,
+				     GLint ysize, GLint group_size)
+{
+    int i, j, k;
+    int newwidth, newheight;
+    int padBytes;
+    GLubyte *s;
+    const char *t;
+
     newwidth = width / 2;
     newheight = height / 2;
     padBytes = ysize - (width*group_size);
@@ -406,6 +441,150 @@ static void halveImage_ubyte(GLint components, GLuint width, GLuint height,
     }
 }
 
+#if defined(MIPMAP_SSE2)
+/*
+** Sums of the 2x2 pixel blocks in 16 bytes x of one row and y of the next,
+** as 8 16-bit lanes in output order.
+*/
+static __m128i sumBlocks_ubyte(GLint components, __m128i x, __m128i y)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i mask = _mm_set1_epi16(0xff);
+    __m128i lo, hi;
+
+    if (components == 1) {
+	lo = _mm_add_epi16(_mm_and_si128(x, mask), _mm_srli_epi16(x, 8));
+	hi = _mm_add_epi16(_mm_and_si128(y, mask), _mm_srli_epi16(y, 8));
+	return _mm_add_epi16(lo, hi);
+    }
+    lo = _mm_add_epi16(_mm_unpacklo_epi8(x, zero), _mm_unpacklo_epi8(y, zero));
+    hi = _mm_add_epi16(_mm_unpackhi_epi8(x, zero), _mm_unpackhi_epi8(y, zero));
+    if (components == 2) {
+	/* put the even pixels in the low and the odd ones in the high half */
+	lo = _mm_shuffle_epi32(lo, _MM_SHUFFLE(3, 1, 2, 0));
+	hi = _mm_shuffle_epi32(hi, _MM_SHUFFLE(3, 1, 2, 0));
+    }
+    return _mm_add_epi16(_mm_unpacklo_epi64(lo, hi),
+			 _mm_unpackhi_epi64(lo, hi));
+}
+
+/* Returns the number of output pixels done. */
+static int halveRow_ubyte(GLint components, const GLubyte *t0,
+			  const GLubyte *t1, GLubyte *s, int newwidth)
+{
+    const __m128i two = _mm_set1_epi16(2);
+    __m128i lo, hi;
+    int j, step;
+
+    if (components == 3) return 0;	/* no cheap deinterleave in SSE2 */
+
+    step = 16 / components;
+    for (j = 0; j + step <= newwidth; j += step) {
+	lo = sumBlocks_ubyte(components,
+			     _mm_loadu_si128((const __m128i *)t0),
+			     _mm_loadu_si128((const __m128i *)t1));
+	hi = sumBlocks_ubyte(components,
+			     _mm_loadu_si128((const __m128i *)(t0 + 16)),
+			     _mm_loadu_si128((const __m128i *)(t1 + 16)));
+	lo = _mm_srli_epi16(_mm_add_epi16(lo, two), 2);
+	hi = _mm_srli_epi16(_mm_add_epi16(hi, two), 2);
+	_mm_storeu_si128((__m128i *)s, _mm_packus_epi16(lo, hi));
+	t0 += 32; t1 += 32; s += 16;
+    }
+    return j;
+}
+#elif defined(MIPMAP_NEON)
+/* (a+b+c+d+2)/4 of the pairs of pixels in a and b, channel k */
+#define HALVE_NEON(r, a, b, k) \
+    r.val[k] = vrshrn_n_u16(vaddq_u16(vpaddlq_u8(a.val[k]), \
+				      vpaddlq_u8(b.val[k])), 2)
+
+/* Returns the number of output pixels done. */
+static int halveRow_ubyte(GLint components, const GLubyte *t0,
+			  const GLubyte *t1, GLubyte *s, int newwidth)
+{
+    int j;
+
+    for (j = 0; j + 8 <= newwidth; j += 8) {
+	switch (components) {
+	  case 1: {
+	    uint16x8_t sum = vaddq_u16(vpaddlq_u8(vld1q_u8(t0)),
+				       vpaddlq_u8(vld1q_u8(t1)));
+	    vst1_u8(s, vrshrn_n_u16(sum, 2));
+	    break;
+	  }
+	  case 2: {
+	    uint8x16x2_t a = vld2q_u8(t0), b = vld2q_u8(t1);
+	    uint8x8x2_t r;
+	    HALVE_NEON(r, a, b, 0); HALVE_NEON(r, a, b, 1);
+	    vst2_u8(s, r);
+	    break;
+	  }
+	  case 3: {
+	    uint8x16x3_t a = vld3q_u8(t0), b = vld3q_u8(t1);
+	    uint8x8x3_t r;
+	    HALVE_NEON(r, a, b, 0); HALVE_NEON(r, a, b, 1);
+	    HALVE_NEON(r, a, b, 2);
+	    vst3_u8(s, r);
+	    break;
+	  }
+	  case 4: {
+	    uint8x16x4_t a = vld4q_u8(t0), b = vld4q_u8(t1);
+	    uint8x8x4_t r;
+	    HALVE_NEON(r, a, b, 0); HALVE_NEON(r, a, b, 1);
+	    HALVE_NEON(r, a, b, 2); HALVE_NEON(r, a, b, 3);
+	    vst4_u8(s, r);
+	    break;
+	  }
+	  default:
+	    return j;
+	}
+	t0 += 16 * components; t1 += 16 * components; s += 8 * components;
+    }
+    return j;
+}
+#undef HALVE_NEON
+#else
+static int halveRow_ubyte(GLint components, const GLubyte *t0,
+			  const GLubyte *t1, GLubyte *s, int newwidth)
+{
+    return 0;
+}
+#endif
+
+/*
+** halveImage_ubyte() for components packed in consecutive bytes and an
+** even width: each pair of rows is done with SSE2 or NEON where available,
+** the rest of the row with the same rounding as the generic loop.
+*/
+static void halveImage_ubyte_packed(GLint components, GLuint width,
+				    GLuint height, const GLubyte *datain,
+				    GLubyte *dataout, GLint ysize)
+{
+    int i, j, k;
+    int newwidth = width / 2;
+    int newheight = height / 2;
+    const GLubyte *t0, *t1;
+    GLubyte *s = dataout;
+
+    for (i = 0; i < newheight; i++) {
+	t0 = datain + 2 * i * ysize;
+	t1 = t0 + ysize;
+	j = halveRow_ubyte(components, t0, t1, s, newwidth);
+	s += j * components;
+	t0 += 2 * j * components;
+	t1 += 2 * j * components;
+	for (; j < newwidth; j++) {
+	    for (k = 0; k < components; k++) {
+		s[0] = (t0[0] + t0[components] + t1[0] + t1[components] + 2) / 4;
+		s++; t0++; t1++;
+	    }
+	    t0 += components;
+	    t1 += components;
+	}
+    }
+}
+
 /* */
 static void halve1Dimage_ubyte(GLint components, GLuint width, GLuint height,
 			       const GLubyte *dataIn, GLubyte *dataOut,
@@ -1382,11 +1561,294 @@ static void scale_internal(GLint components, GLint widthin, GLint heightin,
     }
 }
 
+/* Input pixels covered by one output pixel along x or y */
+typedef struct {
+    int lowint, highint;
+    float lowfloat, highfloat;
+} BoxSpan;
+
+/*
+** Steps the box edges across nout output pixels exactly as the generic
+** scale_internal_ubyte() loop does, which clamps them to the nin input
+** pixels along y only.
+*/
+static void computeBoxSpans(GLint nin, GLint nout, GLboolean clamp,
+			    BoxSpan *span)
+{
+    float conv = (float) nin/nout;
+    int conv_int = floor(conv);
+    float conv_float = conv - conv_int;
+    int low_int = 0, high_int = conv_int;
+    float low_float = 0, high_float = conv_float;
+    int i;
+
+    for (i = 0; i < nout; i++) {
+	if (clamp && high_int >= nin)
+	    high_int = nin - 1;
+	span[i].lowint = low_int;
+	span[i].lowfloat = low_float;
+	span[i].highint = high_int;
+	span[i].highfloat = high_float;
+	low_int = high_int;
+	low_float = high_float;
+	high_int += conv_int;
+	high_float += conv_float;
+	if (high_float > 1) {
+	    high_float -= 1.0;
+	    high_int++;
+	}
+    }
+}
+
+/*
+** Totals of all the components of one output pixel, kept in one vector
+** register where available.
+*/
+#if defined(MIPMAP_SSE2)
+typedef __m128 BoxSum;
+
+static BoxSum boxSumLoad(const float totals[4])
+{
+    return _mm_loadu_ps(totals);
+}
+
+static void boxSumSave(BoxSum sum, float totals[4])
+{
+    _mm_storeu_ps(totals, sum);
+}
+
+static BoxSum boxSumAdd(BoxSum sum, const GLubyte *p, GLint components,
+			float percent)
+{
+    const __m128i zero = _mm_setzero_si128();
+    GLuint bits = p[0];
+    __m128i v;
+
+    switch (components) {
+      case 4: bits |= (GLuint) p[3] << 24;	/* fall through */
+      case 3: bits |= (GLuint) p[2] << 16;	/* fall through */
+      case 2: bits |= (GLuint) p[1] << 8;
+    }
+    v = _mm_unpacklo_epi8(_mm_cvtsi32_si128((int) bits), zero);
+    v = _mm_unpacklo_epi16(v, zero);
+    return _mm_add_ps(sum, _mm_mul_ps(_mm_cvtepi32_ps(v),
+				      _mm_set1_ps(percent)));
+}
+
+/*
+** dataout = totals/area, converted like the scalar cast, which keeps the
+** low byte of the truncated value.
+*/
+static void boxSumStore(BoxSum sum, float area, GLubyte *dataout,
+			GLint components)
+{
+    __m128i v = _mm_cvttps_epi32(_mm_div_ps(sum, _mm_set1_ps(area)));
+    GLuint bits;
+    int k;
+
+    v = _mm_and_si128(v, _mm_set1_epi32(0xff));
+    v = _mm_packs_epi32(v, v);
+    bits = (GLuint) _mm_cvtsi128_si32(_mm_packus_epi16(v, v));
+    for (k = 0; k < components; k++, bits >>= 8)
+	dataout[k] = (GLubyte) bits;
+}
+#elif defined(MIPMAP_NEON)
+typedef float32x4_t BoxSum;
+
+static BoxSum boxSumLoad(const float totals[4])
+{
+    return vld1q_f32(totals);
+}
+
+static void boxSumSave(BoxSum sum, float totals[4])
+{
+    vst1q_f32(totals, sum);
+}
+
+static BoxSum boxSumAdd(BoxSum sum, const GLubyte *p, GLint components,
+			float percent)
+{
+    GLuint bits = p[0];
+    uint16x8_t v;
+
+    switch (components) {
+      case 4: bits |= (GLuint) p[3] << 24;	/* fall through */
+      case 3: bits |= (GLuint) p[2] << 16;	/* fall through */
+      case 2: bits |= (GLuint) p[1] << 8;
+    }
+    v = vmovl_u8(vcreate_u8(bits));
+    return vmlaq_n_f32(sum, vcvtq_f32_u32(vmovl_u16(vget_low_u16(v))),
+		       percent);
+}
+
+static void boxSumStore(BoxSum sum, float area, GLubyte *dataout,
+			GLint components)
+{
+    float totals[4];
+    int k;
+
+    vst1q_f32(totals, sum);
+    for (k = 0; k < components; k++)
+	dataout[k] = totals[k]/area;
+}
+#else
+typedef struct {
+    float totals[4];
+} BoxSum;
+
+static BoxSum boxSumLoad(const float totals[4])
+{
+    BoxSum sum;
+
+    memcpy(sum.totals, totals, sizeof(sum.totals));
+    return sum;
+}
+
+static void boxSumSave(BoxSum sum, float totals[4])
+{
+    memcpy(totals, sum.totals, sizeof(sum.totals));
+}
+
+static BoxSum boxSumAdd(BoxSum sum, const GLubyte *p, GLint components,
+			float percent)
+{
+    int k;
+
+    for (k = 0; k < components; k++)
+	sum.totals[k] += p[k] * percent;
+    return sum;
+}
+
+static void boxSumStore(BoxSum sum, float area, GLubyte *dataout,
+			GLint components)
+{
+    int k;
+
+    for (k = 0; k < components; k++)
+	dataout[k] = sum.totals[k]/area;
+}
+#endif
+
+/*
+** Adds the input row p, weighted by y_percent, to the totals of each
+** output pixel of the row.
+*/
+static void boxFilterRow(const GLubyte *p, GLint components, GLint widthin,
+			 const BoxSpan *xspan, GLint widthout,
+			 float y_percent, float *totals)
+{
+    const GLubyte *temp;
+    BoxSum sum;
+    int j, l;
+
+    for (j = 0; j < widthout; j++, xspan++, totals += 4) {
+	sum = boxSumLoad(totals);
+	temp = p + xspan->lowint * components;
+	if (xspan->highint == xspan->lowint) {
+	    sum = boxSumAdd(sum, temp, components,
+			    y_percent * (xspan->highfloat - xspan->lowfloat));
+	} else {
+	    sum = boxSumAdd(sum, temp, components,
+			    y_percent * (1 - xspan->lowfloat));
+	    for (l = xspan->lowint + 1; l < xspan->highint; l++) {
+		temp += components;
+		sum = boxSumAdd(sum, temp, components, y_percent);
+	    }
+	    /* the last box may end on a pixel past the row, with no weight */
+	    if (xspan->highint < widthin)
+		sum = boxSumAdd(sum, temp + components, components,
+				y_percent * xspan->highfloat);
+	}
+	boxSumSave(sum, totals);
+    }
+}
+
+/*
+** scale_internal_ubyte() for RGB and RGBA packed in consecutive bytes.  The
+** boxes and weights are the same, but the rows of input pixels are added
+** one at a time to the totals of a whole row of output pixels, all the
+** components at once.  Returns 0 when out of memory, for the caller to use
+** the generic loop instead.
+*/
+static int scale_internal_ubyte_packed(GLint components, GLint widthin,
+				       GLint heightin, const GLubyte *datain,
+				       GLint widthout, GLint heightout,
+				       GLubyte *dataout, GLint ysize)
+{
+    float area = ((float) widthin/widthout) * ((float) heightin/heightout);
+    BoxSpan *xspan, *yspan;
+    float *totals;
+    float y_percent;
+    int i, j, m;
+
+    xspan = (BoxSpan *) malloc((widthout + heightout) * sizeof(BoxSpan));
+    totals = (float *) malloc(4 * widthout * sizeof(float));
+    if (xspan == NULL || totals == NULL) {
+	free(xspan);
+	free(totals);
+	return 0;
+    }
+    yspan = xspan + widthout;
+    computeBoxSpans(widthin, widthout, GL_FALSE, xspan);
+    computeBoxSpans(heightin, heightout, GL_TRUE, yspan);
+
+    for (i = 0; i < heightout; i++) {
+	memset(totals, 0, 4 * widthout * sizeof(float));
+	for (m = yspan[i].lowint; m <= yspan[i].highint; m++) {
+	    if (yspan[i].highint == yspan[i].lowint)
+		y_percent = yspan[i].highfloat - yspan[i].lowfloat;
+	    else if (m == yspan[i].lowint)
+		y_percent = 1 - yspan[i].lowfloat;
+	    else if (m == yspan[i].highint)
+		y_percent = yspan[i].highfloat;
+	    else
+		y_percent = 1;
+	    /* constant component counts let the compiler unroll the loads */
+	    if (components == 4)
+		boxFilterRow(datain + m * ysize, 4, widthin, xspan, widthout,
+			     y_percent, totals);
+	    else
+		boxFilterRow(datain + m * ysize, components, widthin, xspan,
+			     widthout, y_percent, totals);
+	}
+	for (j = 0; j < widthout; j++) {
+	    boxSumStore(boxSumLoad(&totals[4 * j]), area, dataout, components);
+	    dataout += components;
+	}
+    }
+    free(xspan);
+    free(totals);
+    return 1;
+}
+
 static void scale_internal_ubyte(GLint components, GLint widthin,
 			   GLint heightin, const GLubyte *datain,
 			   GLint widthout, GLint heightout,
 			   GLubyte *dataout, GLint element_size,
 			   GLint ysize, GLint group_size)
+{
+    if (widthin == widthout*2 && heightin == heightout*2) {
+	halveImage_ubyte(components, widthin, heightin,
+	(const GLubyte *)datain, (GLubyte *)dataout,
+	element_size, ysize, group_size);
+	return;
+    }
+    if (element_size == 1 && group_size == components && components >= 3 &&
+	scale_internal_ubyte_packed(components, widthin, heightin, datain,
+				    widthout, heightout, dataout, ysize)) {
+	return;
+    }
+    scale_internal_ubyte_generic(components, widthin, heightin, datain,
+				 widthout, heightout, dataout, element_size,
+				 ysize, group_size);
+}
+
+/* scale_internal_ubyte() for any layout of the components */
+static void scale_internal_ubyte_generic(GLint components, GLint widthin,
+			   GLint heightin, const GLubyte *datain,
+			   GLint widthout, GLint heightout,
+			   GLubyte *dataout, GLint element_size,
+			   GLint ysize, GLint group_size)
 {
     float convx;
     float convy;
@@ -1408,12 +1870,6 @@ static void scale_internal_ubyte(GLint components, GLint widthin,
     int l, m;
     const char *left, *right;
 
-    if (widthin == widthout*2 && heightin == heightout*2) {
-	halveImage_ubyte(components, widthin, heightin,
-	(const GLubyte *)datain, (GLubyte *)dataout,
-	element_size, ysize, group_size);
-	return;
-    }
     convy = (float) heightin/heightout;
     convx = (float) widthin/widthout;
     convy_int = floor(convy);
@@ -0,0 +1,199 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Tests of the packed ubyte paths of the bundled GLU mipmap.c
+ *           against its generic loops.
+ *
+ ***************************************************************************
+ *   Copyright (C) 2024 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ **************************************************************************/
+
+/* The functions under test are static */
+#include "../libutil/mipmap.c"
+
+/* Fails the current test function, which returns the number of failures */
+#define CHECK(x)                                                          \
+    do {                                                                  \
+	if (!(x)) {                                                       \
+	    fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, \
+		    #x);                                                  \
+	    return 1;                                                     \
+	}                                                                 \
+    } while (0)
+
+/* A small generator of our own, so the data is the same everywhere */
+static unsigned testRandom(void)
+{
+    static unsigned state = 42;
+
+    state = state * 1103515245 + 12345;
+    return state >> 8;
+}
+
+/*
+** An image of random pixels with row padding, at a misaligned address
+** within buffer.
+*/
+static GLubyte *randomImage(GLubyte *buffer, GLint ysize, GLint height)
+{
+    GLubyte *image = buffer + testRandom() % 16;
+    int i;
+
+    for (i = 0; i < ysize * height; i++)
+	image[i] = (GLubyte) testRandom();
+    return image;
+}
+
+/*
+** The exact box filter of component k of the output pixel (j, i), from
+** the area weighted sum of the input pixels.
+*/
+static double boxFilter(GLint components, GLint widthin, GLint heightin,
+			const GLubyte *datain, GLint ysize, GLint widthout,
+			GLint heightout, int i, int j, int k)
+{
+    double convx = (double) widthin/widthout;
+    double convy = (double) heightin/heightout;
+    double x0 = j * convx, x1 = x0 + convx;
+    double y0 = i * convy, y1 = y0 + convy;
+    double total = 0;
+    int x, y;
+
+    for (y = (int) y0; y < y1 && y < heightin; y++) {
+	double wy = (y + 1 < y1 ? y + 1 : y1) - (y > y0 ? y : y0);
+	for (x = (int) x0; x < x1 && x < widthin; x++) {
+	    double wx = (x + 1 < x1 ? x + 1 : x1) - (x > x0 ? x : x0);
+	    total += datain[y * ysize + x * components + k] * wx * wy;
+	}
+    }
+    return total / (convx * convy);
+}
+
+/*
+** Largest difference between out and the exact box filter of in, leaving
+** out the last row: the clamp along y gives it a shorter box, on both the
+** packed and the generic path.
+*/
+static double maxBoxError(GLint components, GLint widthin, GLint heightin,
+			  const GLubyte *datain, GLint ysize, GLint widthout,
+			  GLint heightout, const GLubyte *dataout)
+{
+    double error = 0;
+    int i, j, k;
+
+    for (i = 0; i < heightout - 1; i++)
+	for (j = 0; j < widthout; j++)
+	    for (k = 0; k < components; k++) {
+		double d = fabs(*dataout++ -
+				boxFilter(components, widthin, heightin,
+					  datain, ysize, widthout, heightout,
+					  i, j, k));
+		if (d > error)
+		    error = d;
+	    }
+    return error;
+}
+
+/* Largest difference between two images of size bytes */
+static int maxDifference(const GLubyte *a, const GLubyte *b, int size)
+{
+    int error = 0;
+    int i;
+
+    for (i = 0; i < size; i++)
+	if (abs(a[i] - b[i]) > error)
+	    error = abs(a[i] - b[i]);
+    return error;
+}
+
+/*
+** Halving packed components gives exactly what the generic loop gives,
+** with any row padding and alignment.
+*/
+static int testHalve(void)
+{
+    static GLubyte buffer[4 * 72 * 41 + 64];
+    static GLubyte packed[4 * 36 * 20], generic[4 * 36 * 20];
+    int round;
+
+    for (round = 0; round < 2000; round++) {
+	GLint components = 1 + testRandom() % 4;
+	GLint width = 2 + 2 * (testRandom() % 35);
+	GLint height = 2 + testRandom() % 39;
+	GLint ysize = width * components + testRandom() % 4;
+	GLint size = (width / 2) * (height / 2) * components;
+	GLubyte *image = randomImage(buffer, ysize, height);
+
+	halveImage_ubyte_packed(components, width, height, image, packed,
+				ysize);
+	halveImage_ubyte_generic(components, width, height, image, generic,
+				 1, ysize, components);
+	CHECK(memcmp(packed, generic, size) == 0);
+    }
+    return 0;
+}
+
+/*
+** Rescaling RGB and RGBA stays within about 1 of the exact box filter at
+** any factor, and within 1 of the generic loop unless an axis shrinks 2x
+** or more. There the generic loop weights a wrong side column once a box
+** spans two inner rows, and the packed path does not copy that.
+*/
+static int testScale(void)
+{
+    static GLubyte buffer[4 * 100 * 80 + 64];
+    static GLubyte packed[4 * 150 * 120], generic[4 * 150 * 120];
+    int round, wide = 0;
+
+    for (round = 0; round < 2000; round++) {
+	GLint components = 3 + testRandom() % 2;
+	GLint widthin = 1 + testRandom() % 100;
+	GLint heightin = 1 + testRandom() % 80;
+	GLint widthout = 1 + testRandom() % 150;
+	GLint heightout = 1 + testRandom() % 120;
+	GLint ysize = widthin * components + testRandom() % 4;
+	GLubyte *image = randomImage(buffer, ysize, heightin);
+
+	CHECK(scale_internal_ubyte_packed(components, widthin, heightin,
+					  image, widthout, heightout, packed,
+					  ysize));
+	CHECK(maxBoxError(components, widthin, heightin, image, ysize,
+			  widthout, heightout, packed) < 1.1);
+
+	if (widthin >= 2 * widthout || heightin >= 2 * heightout) {
+	    wide++;
+	    continue;
+	}
+	scale_internal_ubyte_generic(components, widthin, heightin, image,
+				     widthout, heightout, generic, 1, ysize,
+				     components);
+	CHECK(maxDifference(packed, generic,
+			    widthout * heightout * components) <= 1);
+    }
+    CHECK(wide > 100 && wide < 1900);
+    return 0;
+}
+
+int main(void)
+{
+    int failures = testHalve() + testScale();
+
+    if (failures == 0)
+	printf("test_mipmap: all tests passed\n");
+    return failures != 0;
+}